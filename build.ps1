@@ -2,8 +2,12 @@
 
 # Set variables
 $CC = "gcc"
-$CFLAGS = @("-Wall", "-O2", "-I'D:/utils/msys64/mingw64/include'", "-L'C:/Libraries/lib'", "-lSDL3")
+$AR = "ar"
+$COMMON_PATH = "src/common"
+$CFLAGS = @("-Wall", "-O2", "-I'D:/utils/msys64/mingw64/include'", "-I$COMMON_PATH")
 $BUILD_DIR = "build"
+# libcommon calls into SDL3, so it has to come first on the link line
+$CLINK = @("$BUILD_DIR/libcommon.a", "-L'C:/Libraries/lib'", "-lSDL3")
 $COMPILE_DXIL = $true;
 $COMPILE_SPIRV = $true;
 
@@ -14,10 +18,27 @@ $SPIRV_OUTPUT_PATH = ".\shader-binaries\spv"
 if (-not (Test-Path $BUILD_DIR)) {
     New-Item -ItemType Directory -Force -Path $BUILD_DIR
 }
+if (-not (Test-Path "$BUILD_DIR/common")) {
+    New-Item -ItemType Directory -Force -Path "$BUILD_DIR/common"
+}
+
+# Compile the common library every example links against, the same sources as the Makefile's COMMON_SOURCES
+Write-Host "Compiling common library..."
+$COMMON_SOURCES = @("load.c", "pipeline_registry.c", "upload_ring.c", "buffer_allocator.c", "frame_target.c", "frame_timing.c",
+    "fence_tracker.c", "trace.c", "linear_algebra.c", "transform_batch.c", "culling.c", "command_recorder.c", "job_system.c",
+    "vertex_format.c", "mesh_optimizer.c", "meshlet.c", "mesh_simplify.c", "mesh_loader.c", "texture_codec.c",
+    "pixel_convert.c", "image_loader.c", "texture_loader.c")
+$COMMON_OBJECTS = @()
+foreach ($source in $COMMON_SOURCES) {
+    $object = "$BUILD_DIR/common/" + [System.IO.Path]::GetFileNameWithoutExtension($source) + ".o"
+    & $CC -c $CFLAGS "$COMMON_PATH/$source" -o $object
+    $COMMON_OBJECTS += $object
+}
+& $AR rcs "$BUILD_DIR/libcommon.a" $COMMON_OBJECTS
 
 # Compile triangle
 Write-Host "Compiling triangle..."
-& $CC $CFLAGS "src/hello_triangle.c" -o "$BUILD_DIR/triangle.exe" 
+& $CC $CFLAGS "src/hello_triangle/hello_triangle.c" -o "$BUILD_DIR/triangle.exe" $CLINK
 
 # Compile shaders
 
@@ -33,6 +54,6 @@ if ($COMPILE_SPIRV) {
     glslangValidator -e main -V $RESIZE_PATH\hlsl\RawTriangle.vert.hlsl -o $SPIRV_OUTPUT_PATH\RawTriangle.vert.spv
     glslangValidator -e main -V $RESIZE_PATH\hlsl\SolidColor.frag.hlsl -o $SPIRV_OUTPUT_PATH\SolidColor.frag.spv
 }
-& $CC $LDFLAGS $CFLAGS "$RESIZE_PATH\resize.c" -o "$BUILD_DIR\resize.exe" 
+& $CC $CFLAGS "$RESIZE_PATH\resize.c" -o "$BUILD_DIR\resize.exe" $CLINK
 
 Write-Host "Build completed successfully!"
@@ -6,8 +6,13 @@ NC='\033[0m'
 GREEN='\033[0;32m'
 
 CC="gcc"
-CFLAGS=""
-CLINK="-lSDL3"
+COMMON_PATH="src/common"
+CFLAGS="-I$COMMON_PATH"
+CLINK="./build/libcommon.a -lSDL3"
+# TRACE=true ./build.sh records CPU zones and writes a Chrome trace at exit
+if [ "$TRACE" = "true" ]; then
+  CFLAGS="$CFLAGS -DENABLE_TRACE"
+fi
 
 echo "Starting to build"
 SPV_BUILD_PATH="shader-binaries/spv"
@@ -17,7 +22,14 @@ use_hlsl=false
 use_glsl=true
 
 
-mkdir build/
+mkdir -p build/common
+
+echo -e "$GREEN   Building common library $NC"
+COMMON_SOURCES="$COMMON_PATH/load.c $COMMON_PATH/pipeline_registry.c $COMMON_PATH/upload_ring.c $COMMON_PATH/buffer_allocator.c $COMMON_PATH/frame_target.c $COMMON_PATH/frame_timing.c $COMMON_PATH/fence_tracker.c $COMMON_PATH/trace.c $COMMON_PATH/linear_algebra.c $COMMON_PATH/transform_batch.c $COMMON_PATH/culling.c $COMMON_PATH/command_recorder.c $COMMON_PATH/job_system.c $COMMON_PATH/vertex_format.c $COMMON_PATH/mesh_optimizer.c $COMMON_PATH/meshlet.c $COMMON_PATH/mesh_simplify.c $COMMON_PATH/mesh_loader.c $COMMON_PATH/texture_codec.c $COMMON_PATH/pixel_convert.c $COMMON_PATH/image_loader.c $COMMON_PATH/texture_loader.c"
+for source in $COMMON_SOURCES; do
+  $CC -c $source -o ./build/common/$(basename $source .c).o $CFLAGS
+done
+ar rcs ./build/libcommon.a ./build/common/*.o
 
 echo -e "$GREEN   Building Hello triangle $NC"
 HELLO_TRIANGLE_PATH="src/hello_triangle"
@@ -51,9 +63,14 @@ MANY_TRIANGLES_PATH="src/many_triangles"
 echo -e "$GREEN  Building many triangles $NC"
 if $use_hlsl; then
   glslangValidator -e main -V $MANY_TRIANGLES_PATH/hlsl/PositionColorInstanced.vert.hlsl -o $SPV_BUILD_PATH/PositionColorInstanced.vert.spv
+  glslangValidator -e main -V $MANY_TRIANGLES_PATH/hlsl/PositionColorStorageInstanced.vert.hlsl -o $SPV_BUILD_PATH/PositionColorStorageInstanced.vert.spv
   glslangValidator -e main -V $MANY_TRIANGLES_PATH/hlsl/SolidColor.frag.hlsl -o $SPV_BUILD_PATH/SolidColor.frag.spv
 fi
-$CC  $MANY_TRIANGLES_PATH/many_triangles.c $MANY_TRIANGLES_PATH/load.c -o ./build/many_triangles $CFLAGS $CLINK
+
+if $use_glsl; then
+  glslangValidator -S vert -V -o $SPV_BUILD_PATH/PositionColorStorageInstanced.vert.spv $MANY_TRIANGLES_PATH/PositionColorStorageInstanced.glsl
+fi
+$CC  $MANY_TRIANGLES_PATH/many_triangles.c -o ./build/many_triangles $CFLAGS $CLINK
 
 
 TEXTURE_QUAD_PATH="src/texture_quad"
@@ -67,7 +84,7 @@ if $use_glsl; then
  glslangValidator -S vert -DVERTEX -V -o $SPV_BUILD_PATH/TexturedQuad.vert.spv $TEXTURE_QUAD_PATH/TexturedQuad.glsl
   glslangValidator -S frag -DFRAGMENT -V -o $SPV_BUILD_PATH/TexturedQuad.frag.spv $TEXTURE_QUAD_PATH/TexturedQuad.glsl
 fi
-$CC  $TEXTURE_QUAD_PATH/texture_quad.c $TEXTURE_QUAD_PATH/load.c -o ./build/texture_quad $CFLAGS $CLINK
+$CC  $TEXTURE_QUAD_PATH/texture_quad.c -o ./build/texture_quad $CFLAGS $CLINK
 
 
 
@@ -83,7 +100,7 @@ if $use_glsl; then
  glslangValidator -S vert -DVERTEX -V -o $SPV_BUILD_PATH/TexturedQuadWithMatrix.vert.spv $TEXTURE_ANIMATED_QUAD_PATH/TextureAnimatedQuad.glsl
   glslangValidator -S frag -DFRAGMENT -V -o $SPV_BUILD_PATH/TexturedQuadWithMultiplyColor.frag.spv $TEXTURE_ANIMATED_QUAD_PATH/TextureAnimatedQuad.glsl
 fi
-$CC  $TEXTURE_ANIMATED_QUAD_PATH/texture_animated_quad.c $TEXTURE_ANIMATED_QUAD_PATH/load.c $TEXTURE_ANIMATED_QUAD_PATH/linear_algebra.c -o ./build/texture_animated_quad $CFLAGS $CLINK
+$CC  $TEXTURE_ANIMATED_QUAD_PATH/texture_animated_quad.c -o ./build/texture_animated_quad $CFLAGS $CLINK
 
 
 
@@ -101,4 +118,76 @@ if $use_glsl; then
  glslangValidator -S vert -DVERTEX -V -o $SPV_BUILD_PATH/PositionColorTransform.vert.spv $CUBE_PATH/cubeScene.glsl
   glslangValidator -S frag -DFRAGMENT -V -o $SPV_BUILD_PATH/SolidColorDepth.frag.spv $CUBE_PATH/cubeScene.glsl
 fi
-$CC  $CUBE_PATH/cube.c $CUBE_PATH/load.c $CUBE_PATH/linear_algebra.c -o ./build/cube $CFLAGS $CLINK
+$CC  $CUBE_PATH/cube.c -o ./build/cube $CFLAGS $CLINK
+
+MANY_CUBES_PATH="src/many_cubes"
+echo -e "$GREEN  Building many cubes $NC"
+if $use_hlsl; then
+  glslangValidator -e main -V $MANY_CUBES_PATH/hlsl/ManyCubes.vert.hlsl -o $SPV_BUILD_PATH/ManyCubes.vert.spv
+  glslangValidator -e main -V $MANY_CUBES_PATH/hlsl/ManyCubes.frag.hlsl -o $SPV_BUILD_PATH/ManyCubes.frag.spv
+  glslangValidator -e main -S comp -V $MANY_CUBES_PATH/hlsl/CullInstances.comp.hlsl -o $SPV_BUILD_PATH/CullInstances.comp.spv
+fi
+
+if $use_glsl; then
+  glslangValidator -S vert -DVERTEX -V -o $SPV_BUILD_PATH/ManyCubes.vert.spv $MANY_CUBES_PATH/ManyCubes.glsl
+  glslangValidator -S frag -DFRAGMENT -V -o $SPV_BUILD_PATH/ManyCubes.frag.spv $MANY_CUBES_PATH/ManyCubes.glsl
+  glslangValidator -S comp -V -o $SPV_BUILD_PATH/CullInstances.comp.spv $MANY_CUBES_PATH/CullInstances.glsl
+fi
+$CC  $MANY_CUBES_PATH/many_cubes.c -o ./build/many_cubes $CFLAGS $CLINK
+
+VERTEX_FORMATS_PATH="src/vertex_formats"
+echo -e "$GREEN  Building vertex formats $NC"
+if $use_hlsl; then
+  glslangValidator -e main -V $VERTEX_FORMATS_PATH/hlsl/QuantizedMesh.vert.hlsl -o $SPV_BUILD_PATH/QuantizedMesh.vert.spv
+  glslangValidator -e main -V $VERTEX_FORMATS_PATH/hlsl/QuantizedMesh.frag.hlsl -o $SPV_BUILD_PATH/QuantizedMesh.frag.spv
+  glslangValidator -e main -V $VERTEX_FORMATS_PATH/hlsl/QuantizedColorMesh.vert.hlsl -o $SPV_BUILD_PATH/QuantizedColorMesh.vert.spv
+  glslangValidator -e main -V $VERTEX_FORMATS_PATH/hlsl/QuantizedColorMesh.frag.hlsl -o $SPV_BUILD_PATH/QuantizedColorMesh.frag.spv
+fi
+
+if $use_glsl; then
+  glslangValidator -S vert -DVERTEX -V -o $SPV_BUILD_PATH/QuantizedMesh.vert.spv $VERTEX_FORMATS_PATH/QuantizedMesh.glsl
+  glslangValidator -S frag -DFRAGMENT -V -o $SPV_BUILD_PATH/QuantizedMesh.frag.spv $VERTEX_FORMATS_PATH/QuantizedMesh.glsl
+  glslangValidator -S vert -DVERTEX -V -o $SPV_BUILD_PATH/QuantizedColorMesh.vert.spv $VERTEX_FORMATS_PATH/QuantizedColorMesh.glsl
+  glslangValidator -S frag -DFRAGMENT -V -o $SPV_BUILD_PATH/QuantizedColorMesh.frag.spv $VERTEX_FORMATS_PATH/QuantizedColorMesh.glsl
+fi
+$CC  $VERTEX_FORMATS_PATH/vertex_formats.c -o ./build/vertex_formats $CFLAGS $CLINK
+
+MESH_VIEWER_PATH="src/mesh_viewer"
+echo -e "$GREEN  Building mesh viewer $NC"
+if $use_hlsl; then
+  glslangValidator -e main -V $MESH_VIEWER_PATH/hlsl/MeshViewer.vert.hlsl -o $SPV_BUILD_PATH/MeshViewer.vert.spv
+  glslangValidator -e main -V $MESH_VIEWER_PATH/hlsl/MeshViewer.frag.hlsl -o $SPV_BUILD_PATH/MeshViewer.frag.spv
+fi
+
+if $use_glsl; then
+  glslangValidator -S vert -DVERTEX -V -o $SPV_BUILD_PATH/MeshViewer.vert.spv $MESH_VIEWER_PATH/MeshViewer.glsl
+  glslangValidator -S frag -DFRAGMENT -V -o $SPV_BUILD_PATH/MeshViewer.frag.spv $MESH_VIEWER_PATH/MeshViewer.glsl
+fi
+$CC  $MESH_VIEWER_PATH/mesh_viewer.c -o ./build/mesh_viewer $CFLAGS $CLINK
+
+MESHLETS_PATH="src/meshlets"
+echo -e "$GREEN  Building meshlets $NC"
+if $use_hlsl; then
+  glslangValidator -e main -S comp -V $MESHLETS_PATH/hlsl/CullMeshlets.comp.hlsl -o $SPV_BUILD_PATH/CullMeshlets.comp.spv
+fi
+
+if $use_glsl; then
+  glslangValidator -S comp -V -o $SPV_BUILD_PATH/CullMeshlets.comp.spv $MESHLETS_PATH/CullMeshlets.glsl
+fi
+$CC  $MESHLETS_PATH/meshlets.c -o ./build/meshlets $CFLAGS $CLINK
+
+TEXTURE_MINIFY_PATH="src/texture_minify"
+echo -e "$GREEN  Building texture minify $NC"
+$CC  $TEXTURE_MINIFY_PATH/texture_minify.c -o ./build/texture_minify $CFLAGS $CLINK
+
+BENCHMARKS_PATH="src/benchmarks"
+echo -e "$GREEN  Building benchmarks $NC"
+$CC  $BENCHMARKS_PATH/cull_benchmark.c -o ./build/cull_benchmark $CFLAGS $CLINK
+$CC  $BENCHMARKS_PATH/job_benchmark.c -o ./build/job_benchmark $CFLAGS $CLINK
+$CC  $BENCHMARKS_PATH/image_benchmark.c -o ./build/image_benchmark $CFLAGS $CLINK
+$CC  $BENCHMARKS_PATH/pixel_benchmark.c -o ./build/pixel_benchmark $CFLAGS $CLINK
+
+TOOLS_PATH="src/tools"
+echo -e "$GREEN  Building tools $NC"
+$CC  $TOOLS_PATH/mesh_cook.c -o ./build/mesh_cook $CFLAGS $CLINK
+$CC  $TOOLS_PATH/texture_cook.c -o ./build/texture_cook $CFLAGS $CLINK
@@ -2,34 +2,36 @@
 #include <time.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include "load.h"
+#include "pipeline_registry.h"
+#include "frame_target.h"
+#include "trace.h"
+#include "upload_ring.h"
+#include "vertex_format.h"
 typedef struct Context
 {
   SDL_GPUDevice *Device;
   SDL_Window *Window;
+  FrameTarget *Target;
   SDL_GPUGraphicsPipeline *Pipeline;
+  PipelineRegistry *Pipelines;
+  UploadRing *Uploads;
 } Context;
 
-typedef struct PositionColorVertex
-{
-  float x, y, z;
-  Uint8 r, g, b, a;
-} PositionColorVertex;
-
 float rand255()
 {
   return (float)rand() / (float)(RAND_MAX) * 255.0f;
 };
 Context context = {0};
-SDL_GPUShader *LoadShader(
-    SDL_GPUDevice *device,
-    const char *shaderFilename,
-    Uint32 samplerCount,
-    Uint32 uniformBufferCount,
-    Uint32 storageBufferCount,
-    Uint32 storageTextureCount);
-int main()
+int main(int argc, char *argv[])
 {
-  if (SDL_Init(SDL_INIT_VIDEO) == false)
+  FrameTargetOptions options;
+  if (!FrameTarget_ParseArgs(argc, argv, "basic_vertex_buffer", &options))
+  {
+    return 1;
+  }
+
+  if (SDL_Init(FrameTarget_GetInitFlags(&options)) == false)
   {
     SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
     return 1;
@@ -38,7 +40,7 @@ int main()
   context.Device = SDL_CreateGPUDevice(
       SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL,
       false,
-      NULL);
+      options.driver);
 
   if (context.Device == NULL)
   {
@@ -46,16 +48,24 @@ int main()
     return -1;
   }
 
-  context.Window = SDL_CreateWindow("Basic Triangle", 640, 480, 0);
-  if (context.Window == NULL)
+  context.Target = FrameTarget_Create(context.Device, "Basic Triangle", 640, 480, 0, &options);
+  if (context.Target == NULL)
   {
-    SDL_Log("CreateWindow failed: %s", SDL_GetError());
     return -1;
   }
+  context.Window = FrameTarget_GetWindow(context.Target);
 
-  if (!SDL_ClaimWindowForGPUDevice(context.Device, context.Window))
+  context.Pipelines = PipelineRegistry_Create(context.Device);
+  if (context.Pipelines == NULL)
   {
-    SDL_Log("GPUClaimWindow failed");
+    SDL_Log("Failed to create pipeline registry!");
+    return -1;
+  }
+
+  context.Uploads = UploadRing_Create(context.Device, 64 * 1024, 2);
+  if (context.Uploads == NULL)
+  {
+    SDL_Log("Failed to create upload ring!");
     return -1;
   }
 
@@ -78,7 +88,7 @@ int main()
       .target_info = {
           .num_color_targets = 1,
           .color_target_descriptions = (SDL_GPUColorTargetDescription[]){{
-              .format = SDL_GetGPUSwapchainTextureFormat(context.Device, context.Window),
+              .format = FrameTarget_GetFormat(context.Target),
           }},
       },
       // This is set up to match the vertex shader layout!
@@ -133,16 +143,13 @@ int main()
 
   };
 
-  context.Pipeline = SDL_CreateGPUGraphicsPipeline(context.Device, &pipelineCreateInfo);
+  context.Pipeline = PipelineRegistry_Get(context.Pipelines, &pipelineCreateInfo);
   if (context.Pipeline == NULL)
   {
     SDL_Log("Failed to create pipeline!");
     return -1;
   }
 
-  SDL_ReleaseGPUShader(context.Device, vertexShader);
-  SDL_ReleaseGPUShader(context.Device, fragmentShader);
-
   // Create the vertex buffer
   uint32_t gpuBufferSize = sizeof(PositionColorVertex) * 3;
   SDL_GPUBuffer *VertexBuffer = SDL_CreateGPUBuffer(
@@ -151,18 +158,18 @@ int main()
           .usage = SDL_GPU_BUFFERUSAGE_VERTEX,
           .size = gpuBufferSize});
 
-  // To get data into the vertex buffer, we have to use a transfer buffer
-  SDL_GPUTransferBuffer *transferBuffer = SDL_CreateGPUTransferBuffer(
-      context.Device,
-      &(SDL_GPUTransferBufferCreateInfo){
-          .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-          .size = gpuBufferSize});
-
-  // writing our data to the transfer buffer
-  PositionColorVertex *transferData = SDL_MapGPUTransferBuffer(
-      context.Device,
-      transferBuffer,
-      false);
+  // To get data into the vertex buffer, we have to go through a transfer buffer, the upload ring hands us a piece of one
+  UploadRing_BeginFrame(context.Uploads);
+  PositionColorVertex *transferData = UploadRing_AllocateBufferUpload(
+      context.Uploads,
+      gpuBufferSize,
+      VertexBuffer,
+      0);
+  if (transferData == NULL)
+  {
+    SDL_Log("Failed to allocate vertex upload!");
+    return -1;
+  }
 
   srand(time(NULL));
 
@@ -170,34 +177,18 @@ int main()
   transferData[1] = (PositionColorVertex){1, -1, 0, rand255(), rand255(), rand255(), 255};
   transferData[2] = (PositionColorVertex){0, 1, 0, rand255(), rand255(), rand255(), 255};
 
-  SDL_UnmapGPUTransferBuffer(context.Device, transferBuffer);
-
-  // then we order a copy command
+  // then we order a copy command, the ring records it for us on submit
   SDL_GPUCommandBuffer *uploadCmdBuf = SDL_AcquireGPUCommandBuffer(context.Device);
-  SDL_GPUCopyPass *copyPass = SDL_BeginGPUCopyPass(uploadCmdBuf);
-
-  SDL_UploadToGPUBuffer(
-      copyPass,
-      &(SDL_GPUTransferBufferLocation){
-          .transfer_buffer = transferBuffer,
-          .offset = 0},
-      &(SDL_GPUBufferRegion){
-          .buffer = VertexBuffer,
-          .offset = 0,
-          .size = sizeof(PositionColorVertex) * 3},
-      false);
-
-  SDL_EndGPUCopyPass(copyPass);
-  SDL_SubmitGPUCommandBuffer(uploadCmdBuf);
-  SDL_ReleaseGPUTransferBuffer(context.Device, transferBuffer);
+  UploadRing_Submit(context.Uploads, uploadCmdBuf);
 
   SDL_Event event;
   int quit = 0;
 
-  while (!quit)
+  while (!quit && !FrameTarget_IsDone(context.Target))
   {
     bool changeResolution = false;
 
+    TRACE_BEGIN("poll events");
     while (SDL_PollEvent(&event))
     {
       switch (event.type)
@@ -207,8 +198,11 @@ int main()
         break;
       }
     }
+    TRACE_END();
 
+    TRACE_BEGIN("acquire command buffer");
     SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    TRACE_END();
     if (cmdbuf == NULL)
     {
       SDL_Log("Aquire GPU command buffer failed :%s", SDL_GetError());
@@ -216,7 +210,7 @@ int main()
     }
 
     SDL_GPUTexture *swapchainTexture;
-    if (!SDL_WaitAndAcquireGPUSwapchainTexture(cmdbuf, context.Window, &swapchainTexture, NULL, NULL))
+    if (!FrameTarget_Acquire(context.Target, cmdbuf, &swapchainTexture))
     {
       SDL_Log("WaitAndAcquireGPUSwapchainTexture failed: %s", SDL_GetError());
       return -1;
@@ -224,7 +218,7 @@ int main()
 
     if (swapchainTexture == NULL)
     {
-      SDL_SubmitGPUCommandBuffer(cmdbuf);
+      FrameTarget_Submit(context.Target, cmdbuf);
       continue;
     }
 
@@ -234,101 +228,22 @@ int main()
         .load_op = SDL_GPU_LOADOP_CLEAR,
         .store_op = SDL_GPU_STOREOP_STORE};
 
+    TRACE_BEGIN("render pass");
     SDL_GPURenderPass *renderPass = SDL_BeginGPURenderPass(cmdbuf, &colorTargetInfo, 1, NULL);
     SDL_BindGPUGraphicsPipeline(renderPass, context.Pipeline);
     SDL_BindGPUVertexBuffers(renderPass, 0, &(SDL_GPUBufferBinding){.buffer = VertexBuffer, .offset = 0}, 1);
     SDL_DrawGPUPrimitives(renderPass, 3, 1, 0, 0);
     SDL_EndGPURenderPass(renderPass);
-    SDL_SubmitGPUCommandBuffer(cmdbuf);
+    TRACE_END();
+    FrameTarget_Submit(context.Target, cmdbuf);
   }
 
   // cleanup
   SDL_ReleaseGPUBuffer(context.Device, VertexBuffer);
-  SDL_ReleaseGPUGraphicsPipeline(context.Device, context.Pipeline);
 
+  UploadRing_Destroy(context.Uploads);
+  PipelineRegistry_Destroy(context.Pipelines);
+  ReleaseShaderCache(context.Device);
+  FrameTarget_Destroy(context.Target);
   SDL_DestroyGPUDevice(context.Device);
-  SDL_DestroyWindow(context.Window);
-}
-SDL_GPUShader *LoadShader(
-    SDL_GPUDevice *device,
-    const char *shaderFilename,
-    Uint32 samplerCount,
-    Uint32 uniformBufferCount,
-    Uint32 storageBufferCount,
-    Uint32 storageTextureCount)
-{
-  const char *ShaderBinaryBasePath = "./shader-binaries";
-
-  // Auto-detect the shader stage from the file name for convenience
-  SDL_GPUShaderStage stage;
-  if (SDL_strstr(shaderFilename, ".vert"))
-  {
-    stage = SDL_GPU_SHADERSTAGE_VERTEX;
-  }
-  else if (SDL_strstr(shaderFilename, ".frag"))
-  {
-    stage = SDL_GPU_SHADERSTAGE_FRAGMENT;
-  }
-  else
-  {
-    SDL_Log("Invalid shader stage!");
-    return NULL;
-  }
-
-  char fullPath[1024];
-  SDL_GPUShaderFormat backendFormats = SDL_GetGPUShaderFormats(device);
-  SDL_GPUShaderFormat format = SDL_GPU_SHADERFORMAT_INVALID;
-  const char *entrypoint;
-
-  if (backendFormats & SDL_GPU_SHADERFORMAT_SPIRV)
-  {
-    SDL_snprintf(fullPath, sizeof(fullPath), "%s/spv/%s.spv", ShaderBinaryBasePath, shaderFilename);
-    format = SDL_GPU_SHADERFORMAT_SPIRV;
-    entrypoint = "main";
-  }
-  else if (backendFormats & SDL_GPU_SHADERFORMAT_MSL)
-  {
-    SDL_snprintf(fullPath, sizeof(fullPath), "%s/msl/%s.msl", ShaderBinaryBasePath, shaderFilename);
-    format = SDL_GPU_SHADERFORMAT_MSL;
-    entrypoint = "main0";
-  }
-  else if (backendFormats & SDL_GPU_SHADERFORMAT_DXIL)
-  {
-    SDL_snprintf(fullPath, sizeof(fullPath), "%s/dxil/%s.dxil", ShaderBinaryBasePath, shaderFilename);
-    format = SDL_GPU_SHADERFORMAT_DXIL;
-    entrypoint = "main";
-  }
-  else
-  {
-    SDL_Log("%s", "Unrecognized backend shader format!");
-    return NULL;
-  }
-
-  size_t codeSize;
-  void *code = SDL_LoadFile(fullPath, &codeSize);
-  if (code == NULL)
-  {
-    SDL_Log("Failed to load shader from disk! %s", fullPath);
-    return NULL;
-  }
-
-  SDL_GPUShaderCreateInfo shaderInfo = {
-      .code = code,
-      .code_size = codeSize,
-      .entrypoint = entrypoint,
-      .format = format,
-      .stage = stage,
-      .num_samplers = samplerCount,
-      .num_uniform_buffers = uniformBufferCount,
-      .num_storage_buffers = storageBufferCount,
-      .num_storage_textures = storageTextureCount};
-  SDL_GPUShader *shader = SDL_CreateGPUShader(device, &shaderInfo);
-  if (shader == NULL)
-  {
-    SDL_Log("Failed to create shader!");
-    SDL_free(code);
-    return NULL;
-  }
-  SDL_free(code);
-  return shader;
 }
@@ -0,0 +1,128 @@
+#include <SDL3/SDL.h>
+#include <stdlib.h>
+#include "linear_algebra.h"
+#include "culling.h"
+
+// Times Frustum_CullSpheres and Frustum_CullBoxes with every kernel this CPU has, and checks each one against the scalar reference.
+//   cull_benchmark [objects] [repeats]
+#define DEFAULT_OBJECT_COUNT 100000
+#define DEFAULT_REPEATS 200
+// The objects are scattered in a cube this wide around the camera, about an eighth of them end up visible
+#define SCENE_SIZE 1000.0f
+
+static float RandomRange(float min, float max)
+{
+  return min + (max - min) * (rand() / (float)RAND_MAX);
+}
+
+// Fastest of the repeats, in nanoseconds
+static Uint64 TimeSpheres(const Frustum *frustum, const BoundingSpheres *spheres, Uint32 count, Uint32 *visible, Uint32 repeats, Uint32 *visibleCount)
+{
+  Uint64 best = ~(Uint64)0;
+  for (Uint32 r = 0; r < repeats; r += 1)
+  {
+    Uint64 start = SDL_GetTicksNS();
+    *visibleCount = Frustum_CullSpheres(frustum, spheres, count, visible);
+    best = SDL_min(best, SDL_GetTicksNS() - start);
+  }
+  return best;
+}
+
+static Uint64 TimeBoxes(const Frustum *frustum, const BoundingBoxes *boxes, Uint32 count, Uint32 *visible, Uint32 repeats, Uint32 *visibleCount)
+{
+  Uint64 best = ~(Uint64)0;
+  for (Uint32 r = 0; r < repeats; r += 1)
+  {
+    Uint64 start = SDL_GetTicksNS();
+    *visibleCount = Frustum_CullBoxes(frustum, boxes, count, visible);
+    best = SDL_min(best, SDL_GetTicksNS() - start);
+  }
+  return best;
+}
+
+static bool SameIndices(const Uint32 *expected, Uint32 expectedCount, const Uint32 *actual, Uint32 actualCount)
+{
+  return expectedCount == actualCount && SDL_memcmp(expected, actual, sizeof(Uint32) * actualCount) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+  Uint32 count = argc > 1 ? (Uint32)SDL_strtoul(argv[1], NULL, 10) : DEFAULT_OBJECT_COUNT;
+  Uint32 repeats = argc > 2 ? (Uint32)SDL_strtoul(argv[2], NULL, 10) : DEFAULT_REPEATS;
+  if (count == 0 || repeats == 0)
+  {
+    SDL_Log("Usage: %s [objects] [repeats]", argv[0]);
+    return 1;
+  }
+
+  // The spheres and boxes share their centers, the radius is the box's half diagonal
+  float *data = SDL_malloc(sizeof(float) * count * 7);
+  Uint32 *expectedSpheres = SDL_malloc(sizeof(Uint32) * count);
+  Uint32 *expectedBoxes = SDL_malloc(sizeof(Uint32) * count);
+  Uint32 *visible = SDL_malloc(sizeof(Uint32) * count);
+  if (data == NULL || expectedSpheres == NULL || expectedBoxes == NULL || visible == NULL)
+  {
+    SDL_Log("Failed to allocate %u objects", count);
+    return 1;
+  }
+  float *centerX = data;
+  float *centerY = data + count;
+  float *centerZ = data + count * 2;
+  float *radius = data + count * 3;
+  float *extentX = data + count * 4;
+  float *extentY = data + count * 5;
+  float *extentZ = data + count * 6;
+  srand(1);
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    centerX[i] = RandomRange(-SCENE_SIZE / 2, SCENE_SIZE / 2);
+    centerY[i] = RandomRange(-SCENE_SIZE / 2, SCENE_SIZE / 2);
+    centerZ[i] = RandomRange(-SCENE_SIZE / 2, SCENE_SIZE / 2);
+    extentX[i] = RandomRange(0.5f, 5.0f);
+    extentY[i] = RandomRange(0.5f, 5.0f);
+    extentZ[i] = RandomRange(0.5f, 5.0f);
+    radius[i] = SDL_sqrtf(extentX[i] * extentX[i] + extentY[i] * extentY[i] + extentZ[i] * extentZ[i]);
+  }
+  BoundingSpheres spheres = {centerX, centerY, centerZ, radius};
+  BoundingBoxes boxes = {centerX, centerY, centerZ, extentX, extentY, extentZ};
+
+  // The same kind of camera as the cube example
+  Matrix4x4 proj = Matrix4x4_CreatePerspectiveFieldOfView(75.0f * SDL_PI_F / 180.0f, 16.0f / 9.0f, 0.1f, SCENE_SIZE / 2);
+  Matrix4x4 view = Matrix4x4_CreateLookAt((Vector3){0, 0, 0}, (Vector3){1, 0.2f, -1}, (Vector3){0, 1, 0});
+  Matrix4x4 viewproj = Matrix4x4_Multiply(view, proj);
+  Frustum frustum = Frustum_FromMatrix(&viewproj);
+
+  LinearAlgebra_SetPath(LINEAR_ALGEBRA_SCALAR);
+  Uint32 expectedSphereCount = Frustum_CullSpheres(&frustum, &spheres, count, expectedSpheres);
+  Uint32 expectedBoxCount = Frustum_CullBoxes(&frustum, &boxes, count, expectedBoxes);
+  SDL_Log("%u objects, %u spheres and %u boxes visible, best of %u runs", count, expectedSphereCount, expectedBoxCount, repeats);
+
+  bool allMatch = true;
+  const LinearAlgebraPath paths[] = {LINEAR_ALGEBRA_SCALAR, LINEAR_ALGEBRA_SSE2, LINEAR_ALGEBRA_AVX, LINEAR_ALGEBRA_NEON};
+  for (size_t p = 0; p < SDL_arraysize(paths); p += 1)
+  {
+    if (!LinearAlgebra_SetPath(paths[p]))
+    {
+      continue;
+    }
+    const char *name = LinearAlgebra_GetPathName(paths[p]);
+    Uint32 visibleCount;
+    Uint64 sphereNS = TimeSpheres(&frustum, &spheres, count, visible, repeats, &visibleCount);
+    bool spheresMatch = SameIndices(expectedSpheres, expectedSphereCount, visible, visibleCount);
+    Uint64 boxNS = TimeBoxes(&frustum, &boxes, count, visible, repeats, &visibleCount);
+    bool boxesMatch = SameIndices(expectedBoxes, expectedBoxCount, visible, visibleCount);
+
+    SDL_Log("%-6s spheres %7.3f ms per 100k (%5.2f ns each)%s   boxes %7.3f ms per 100k (%5.2f ns each)%s",
+            name,
+            sphereNS / 1e6 * 100000.0 / count, (double)sphereNS / count, spheresMatch ? "" : " MISMATCH",
+            boxNS / 1e6 * 100000.0 / count, (double)boxNS / count, boxesMatch ? "" : " MISMATCH");
+    allMatch = allMatch && spheresMatch && boxesMatch;
+  }
+  LinearAlgebra_SetPath(LINEAR_ALGEBRA_AUTO);
+
+  SDL_free(data);
+  SDL_free(expectedSpheres);
+  SDL_free(expectedBoxes);
+  SDL_free(visible);
+  return allMatch ? 0 : 1;
+}
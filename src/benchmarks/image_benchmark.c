@@ -0,0 +1,137 @@
+#include <SDL3/SDL.h>
+#include <stdlib.h>
+#include "image_loader.h"
+
+// Times loading a BMP into upload memory both ways: SDL_LoadBMP, SDL_ConvertSurface to ABGR8888 and a copy row by row,
+// as LoadImage and LoadTexture do, against ImageFile_ReadPixels converting straight into the destination. The destination
+// is plain memory standing in for the mapped transfer buffer, and both ways are checked to write the same pixels.
+//   image_benchmark [size] [repeats]
+#define DEFAULT_IMAGE_SIZE 4096
+#define DEFAULT_REPEATS 5
+
+typedef struct SourceFormat
+{
+  const char *name;
+  SDL_PixelFormat format; // SDL_SaveBMP writes 24 bit BGR for BGR24, 32 bit with an alpha mask for ARGB8888
+  Uint32 bytesPerPixel;
+} SourceFormat;
+
+static const SourceFormat SourceFormats[] = {
+    {"BGR24", SDL_PIXELFORMAT_BGR24, 3},
+    {"BGRA32", SDL_PIXELFORMAT_ARGB8888, 4}};
+
+static bool WriteImage(const char *path, const SourceFormat *source, Uint32 size)
+{
+  SDL_Surface *surface = SDL_CreateSurface(size, size, source->format);
+  if (surface == NULL)
+  {
+    SDL_Log("Failed to create a %ux%u surface: %s", size, size, SDL_GetError());
+    return false;
+  }
+  for (Uint32 y = 0; y < size; y += 1)
+  {
+    Uint8 *row = (Uint8 *)surface->pixels + (size_t)y * surface->pitch;
+    for (Uint32 x = 0; x < size * source->bytesPerPixel; x += 1)
+    {
+      row[x] = (Uint8)rand();
+    }
+  }
+  bool saved = SDL_SaveBMP(surface, path);
+  if (!saved)
+  {
+    SDL_Log("Failed to write %s: %s", path, SDL_GetError());
+  }
+  SDL_DestroySurface(surface);
+  return saved;
+}
+
+// Fastest of the repeats, in nanoseconds, 0 if loading failed
+static Uint64 TimeSurfaces(const char *path, Uint8 *destination, Uint32 repeats)
+{
+  Uint64 best = ~(Uint64)0;
+  for (Uint32 r = 0; r < repeats; r += 1)
+  {
+    Uint64 start = SDL_GetTicksNS();
+    SDL_Surface *loaded = SDL_LoadBMP(path);
+    SDL_Surface *converted = loaded != NULL ? SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_ABGR8888) : NULL;
+    SDL_DestroySurface(loaded);
+    if (converted == NULL)
+    {
+      SDL_Log("Failed to load %s: %s", path, SDL_GetError());
+      return 0;
+    }
+    for (int y = 0; y < converted->h; y += 1)
+    {
+      SDL_memcpy(destination + (size_t)y * converted->w * 4, (Uint8 *)converted->pixels + (size_t)y * converted->pitch, (size_t)converted->w * 4);
+    }
+    SDL_DestroySurface(converted);
+    best = SDL_min(best, SDL_GetTicksNS() - start);
+  }
+  return best;
+}
+
+static Uint64 TimeImageFile(const char *path, Uint8 *destination, Uint32 repeats)
+{
+  Uint64 best = ~(Uint64)0;
+  for (Uint32 r = 0; r < repeats; r += 1)
+  {
+    Uint64 start = SDL_GetTicksNS();
+    ImageFile *file = ImageFile_Open(path);
+    bool ok = file != NULL && ImageFile_ReadPixels(file, destination, ImageFile_GetInfo(file)->width * 4);
+    ImageFile_Close(file);
+    if (!ok)
+    {
+      return 0;
+    }
+    best = SDL_min(best, SDL_GetTicksNS() - start);
+  }
+  return best;
+}
+
+int main(int argc, char *argv[])
+{
+  Uint32 size = argc > 1 ? (Uint32)SDL_strtoul(argv[1], NULL, 10) : DEFAULT_IMAGE_SIZE;
+  Uint32 repeats = argc > 2 ? (Uint32)SDL_strtoul(argv[2], NULL, 10) : DEFAULT_REPEATS;
+  if (size == 0 || size > 16384 || repeats == 0)
+  {
+    SDL_Log("Usage: %s [size up to 16384] [repeats]", argv[0]);
+    return 1;
+  }
+  size_t destinationSize = (size_t)size * size * 4;
+  Uint8 *expected = SDL_malloc(destinationSize);
+  Uint8 *destination = SDL_malloc(destinationSize);
+  if (expected == NULL || destination == NULL)
+  {
+    SDL_Log("Failed to allocate two %ux%u images", size, size);
+    return 1;
+  }
+
+  const char *path = "image_benchmark.bmp";
+  srand(1);
+  bool ok = true;
+  for (size_t i = 0; i < SDL_arraysize(SourceFormats) && ok; i += 1)
+  {
+    const SourceFormat *source = &SourceFormats[i];
+    ok = WriteImage(path, source, size);
+    Uint64 surfaceNS = ok ? TimeSurfaces(path, expected, repeats) : 0;
+    Uint64 imageFileNS = surfaceNS != 0 ? TimeImageFile(path, destination, repeats) : 0;
+    ok = imageFileNS != 0;
+    if (ok && SDL_memcmp(expected, destination, destinationSize) != 0)
+    {
+      SDL_Log("%s: ImageFile wrote different pixels than SDL_ConvertSurface", source->name);
+      ok = false;
+    }
+    if (ok)
+    {
+      // Besides the destination the surfaces hold the file's pixels and the converted copy at once
+      double surfaceMB = ((double)size * size * source->bytesPerPixel + destinationSize) / (1024.0 * 1024.0);
+      SDL_Log("%-6s %ux%u: surfaces %.1f ms (%.1f MB in between), ImageFile %.1f ms (%.0f KB in between), %.2fx",
+              source->name, size, size, surfaceNS / 1e6, surfaceMB, imageFileNS / 1e6, IMAGE_READ_CHUNK_SIZE / 1024.0,
+              (double)surfaceNS / imageFileNS);
+    }
+  }
+  SDL_RemovePath(path);
+  SDL_free(expected);
+  SDL_free(destination);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+#include <SDL3/SDL.h>
+#include <stdlib.h>
+#include "job_system.h"
+#include "transform_batch.h"
+
+// Measures what the job system costs per job: empty jobs, parallel-for batches, a chain of dependent jobs,
+// and what it buys on transform_batch. Every part is checked, a lost or doubled job fails the run.
+//   job_benchmark [jobs] [threads]
+#define DEFAULT_JOB_COUNT 2000
+#define DEFAULT_REPEATS 50
+#define PARALLEL_FOR_COUNT (1024 * 1024)
+#define PARALLEL_FOR_BATCH 1024
+#define CHAIN_LENGTH 1000
+#define TRANSFORM_COUNT 100000
+
+static SDL_AtomicInt emptyJobsRun;
+
+static void SDLCALL EmptyJob(void *userdata)
+{
+  SDL_AddAtomicInt(&emptyJobsRun, 1);
+}
+
+static void SDLCALL MarkRange(void *userdata, Uint32 first, Uint32 count)
+{
+  Uint8 *marks = userdata;
+  for (Uint32 i = first; i < first + count; i += 1)
+  {
+    marks[i] += 1;
+  }
+}
+
+typedef struct ChainLink
+{
+  Uint32 *order;
+  Uint32 *next;
+  Uint32 index;
+} ChainLink;
+
+static void SDLCALL RunLink(void *userdata)
+{
+  ChainLink *link = userdata;
+  link->order[link->index] = *link->next;
+  *link->next += 1;
+}
+
+static float RandomRange(float min, float max)
+{
+  return min + (max - min) * (rand() / (float)RAND_MAX);
+}
+
+// Fastest of the repeats of Run + Wait on jobCount empty jobs, in nanoseconds per job
+static double TimeEmptyJobs(JobSystem *jobs, Uint32 jobCount, bool *ok)
+{
+  Uint64 best = ~(Uint64)0;
+  for (Uint32 r = 0; r < DEFAULT_REPEATS; r += 1)
+  {
+    SDL_SetAtomicInt(&emptyJobsRun, 0);
+    JobCounter counter = {0};
+    Uint64 start = SDL_GetTicksNS();
+    for (Uint32 i = 0; i < jobCount; i += 1)
+    {
+      JobSystem_Run(jobs, EmptyJob, NULL, &counter);
+    }
+    JobSystem_Wait(jobs, &counter);
+    best = SDL_min(best, SDL_GetTicksNS() - start);
+    *ok = *ok && SDL_GetAtomicInt(&emptyJobsRun) == (int)jobCount;
+  }
+  return (double)best / jobCount;
+}
+
+// Nanoseconds per batch of a parallel-for that does almost nothing per element
+static double TimeParallelFor(JobSystem *jobs, Uint8 *marks, bool *ok)
+{
+  Uint64 best = ~(Uint64)0;
+  for (Uint32 r = 0; r < DEFAULT_REPEATS; r += 1)
+  {
+    SDL_memset(marks, 0, PARALLEL_FOR_COUNT);
+    JobCounter counter = {0};
+    Uint64 start = SDL_GetTicksNS();
+    JobSystem_ParallelFor(jobs, PARALLEL_FOR_COUNT, PARALLEL_FOR_BATCH, MarkRange, marks, &counter);
+    JobSystem_Wait(jobs, &counter);
+    best = SDL_min(best, SDL_GetTicksNS() - start);
+    for (Uint32 i = 0; i < PARALLEL_FOR_COUNT; i += 1)
+    {
+      *ok = *ok && marks[i] == 1;
+    }
+  }
+  return (double)best / (PARALLEL_FOR_COUNT / PARALLEL_FOR_BATCH);
+}
+
+// Nanoseconds per link of a chain where every link runs after the previous one's counter
+static double TimeChain(JobSystem *jobs, bool *ok)
+{
+  JobCounter *counters = SDL_calloc(CHAIN_LENGTH, sizeof(JobCounter));
+  ChainLink *links = SDL_calloc(CHAIN_LENGTH, sizeof(ChainLink));
+  Uint32 *order = SDL_calloc(CHAIN_LENGTH, sizeof(Uint32));
+  if (counters == NULL || links == NULL || order == NULL)
+  {
+    *ok = false;
+    SDL_free(counters);
+    SDL_free(links);
+    SDL_free(order);
+    return 0;
+  }
+  Uint32 next = 0;
+  for (Uint32 i = 0; i < CHAIN_LENGTH; i += 1)
+  {
+    links[i] = (ChainLink){order, &next, i};
+  }
+
+  // The first link starts right away, the chain may run while it is still being declared
+  Uint64 start = SDL_GetTicksNS();
+  JobCounter none = {0};
+  for (Uint32 i = 0; i < CHAIN_LENGTH; i += 1)
+  {
+    JobSystem_RunAfter(jobs, i == 0 ? &none : &counters[i - 1], RunLink, &links[i], &counters[i]);
+  }
+  JobSystem_Wait(jobs, &counters[CHAIN_LENGTH - 1]);
+  Uint64 elapsed = SDL_GetTicksNS() - start;
+
+  for (Uint32 i = 0; i < CHAIN_LENGTH; i += 1)
+  {
+    *ok = *ok && order[i] == i;
+  }
+  SDL_free(counters);
+  SDL_free(links);
+  SDL_free(order);
+  return (double)elapsed / CHAIN_LENGTH;
+}
+
+// Fastest TransformBatch_Compose of TRANSFORM_COUNT transforms, in milliseconds
+static double TimeTransforms(JobSystem *jobs, const TransformArrays *transforms, const Matrix4x4 *viewProjection, Matrix4x4 *results)
+{
+  Uint64 best = ~(Uint64)0;
+  for (Uint32 r = 0; r < DEFAULT_REPEATS; r += 1)
+  {
+    Uint64 start = SDL_GetTicksNS();
+    TransformBatch_Compose(jobs, transforms, TRANSFORM_COUNT, viewProjection, results);
+    best = SDL_min(best, SDL_GetTicksNS() - start);
+  }
+  return best / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+  Uint32 jobCount = argc > 1 ? (Uint32)SDL_strtoul(argv[1], NULL, 10) : DEFAULT_JOB_COUNT;
+  int cores = SDL_GetNumLogicalCPUCores();
+  Uint32 maxThreads = argc > 2 ? (Uint32)SDL_strtoul(argv[2], NULL, 10) : (Uint32)SDL_max(cores - 1, 0);
+  if (jobCount == 0)
+  {
+    SDL_Log("Usage: %s [jobs] [threads]", argv[0]);
+    return 1;
+  }
+
+  Uint8 *marks = SDL_malloc(PARALLEL_FOR_COUNT);
+  float *data = SDL_malloc(sizeof(float) * TRANSFORM_COUNT * 10);
+  Matrix4x4 *results = SDL_malloc(sizeof(Matrix4x4) * TRANSFORM_COUNT);
+  Matrix4x4 *expected = SDL_malloc(sizeof(Matrix4x4) * TRANSFORM_COUNT);
+  if (marks == NULL || data == NULL || results == NULL || expected == NULL)
+  {
+    SDL_Log("Out of memory");
+    return 1;
+  }
+  srand(1);
+  for (Uint32 i = 0; i < TRANSFORM_COUNT * 10; i += 1)
+  {
+    data[i] = RandomRange(-1.0f, 1.0f);
+  }
+  TransformArrays transforms = {
+      data,
+      data + TRANSFORM_COUNT,
+      data + TRANSFORM_COUNT * 2,
+      data + TRANSFORM_COUNT * 3,
+      data + TRANSFORM_COUNT * 4,
+      data + TRANSFORM_COUNT * 5,
+      data + TRANSFORM_COUNT * 6,
+      data + TRANSFORM_COUNT * 7,
+      data + TRANSFORM_COUNT * 8,
+      data + TRANSFORM_COUNT * 9};
+  Matrix4x4 viewProjection = Matrix4x4_CreatePerspectiveFieldOfView(1.2f, 16.0f / 9.0f, 0.1f, 100.0f);
+  TransformBatch_Compose(NULL, &transforms, TRANSFORM_COUNT, &viewProjection, expected);
+
+  SDL_Log("%u empty jobs, %u-element parallel-for in batches of %u, %u-job dependency chain, %u transforms, best of %u runs",
+          jobCount, PARALLEL_FOR_COUNT, PARALLEL_FOR_BATCH, CHAIN_LENGTH, TRANSFORM_COUNT, DEFAULT_REPEATS);
+  bool allOk = true;
+  // 0 workers, then 1, 2, 4, ... and finally maxThreads
+  Uint32 threads = 0;
+  while (true)
+  {
+    JobSystem *jobs = JobSystem_Create(threads);
+    if (jobs == NULL)
+    {
+      SDL_Log("Failed to create a job system with %u workers", threads);
+      return 1;
+    }
+    bool ok = true;
+    double emptyNS = TimeEmptyJobs(jobs, jobCount, &ok);
+    double batchNS = TimeParallelFor(jobs, marks, &ok);
+    double linkNS = TimeChain(jobs, &ok);
+    double transformMS = TimeTransforms(jobs, &transforms, &viewProjection, results);
+    ok = ok && SDL_memcmp(expected, results, sizeof(Matrix4x4) * TRANSFORM_COUNT) == 0;
+    SDL_Log("%2u workers: empty job %7.1f ns, parallel-for batch %7.1f ns, chain link %7.1f ns, transforms %6.3f ms%s",
+            threads, emptyNS, batchNS, linkNS, transformMS, ok ? "" : " FAILED");
+    JobSystem_Destroy(jobs);
+    allOk = allOk && ok;
+    if (threads >= maxThreads)
+    {
+      break;
+    }
+    threads = threads == 0 ? 1 : SDL_min(threads * 2, maxThreads);
+  }
+
+  SDL_free(marks);
+  SDL_free(data);
+  SDL_free(results);
+  SDL_free(expected);
+  return allOk ? 0 : 1;
+}
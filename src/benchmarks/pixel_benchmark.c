@@ -0,0 +1,226 @@
+#include <SDL3/SDL.h>
+#include <stdlib.h>
+#include "pixel_convert.h"
+
+// Converts size x size images from the common BMP layouts to ABGR8888 with SDL_ConvertSurface, as LoadImage does,
+// and row by row with PixelConvert_Row on every kernel this CPU has: plain, premultiplied (BGRA32 against
+// SDL_PremultiplyAlpha) and sRGB to linear. Logs GB/s of ABGR8888 written; every kernel is checked against the scalar
+// reference and the plain conversion against SDL_ConvertSurface.
+//   pixel_benchmark [size] [repeats]   4096 and 8192 without a size
+#define DEFAULT_REPEATS 5
+
+typedef struct SourceLayout
+{
+  PixelLayout layout;
+  const char *name;
+  SDL_PixelFormat format; // the same bytes in memory
+} SourceLayout;
+
+static const SourceLayout SourceLayouts[] = {
+    {PIXEL_LAYOUT_BGR24, "BGR24", SDL_PIXELFORMAT_BGR24},
+    {PIXEL_LAYOUT_BGRA32, "BGRA32", SDL_PIXELFORMAT_ARGB8888},
+    {PIXEL_LAYOUT_BGRX32, "BGRX32", SDL_PIXELFORMAT_XRGB8888}};
+
+typedef struct Variant
+{
+  const char *name;
+  PixelConvertFlags flags;
+} Variant;
+
+static const Variant Variants[] = {
+    {"plain", PIXEL_CONVERT_NONE},
+    {"premultiplied", PIXEL_CONVERT_PREMULTIPLY_ALPHA},
+    {"sRGB to linear", PIXEL_CONVERT_SRGB_TO_LINEAR}};
+
+static double GetGBPerSecond(Uint32 size, Uint64 ns)
+{
+  return (double)size * size * 4 / ns;
+}
+
+static void ConvertImage(const SDL_Surface *source, PixelLayout layout, PixelConvertFlags flags, Uint8 *destination)
+{
+  for (int y = 0; y < source->h; y += 1)
+  {
+    PixelConvert_Row(layout, flags, (const Uint8 *)source->pixels + (size_t)y * source->pitch,
+                     destination + (size_t)y * source->w * 4, source->w);
+  }
+}
+
+// Fastest of the repeats, in nanoseconds
+static Uint64 TimeKernel(const SDL_Surface *source, PixelLayout layout, PixelConvertFlags flags, Uint8 *destination, Uint32 repeats)
+{
+  Uint64 best = ~(Uint64)0;
+  for (Uint32 r = 0; r < repeats; r += 1)
+  {
+    Uint64 start = SDL_GetTicksNS();
+    ConvertImage(source, layout, flags, destination);
+    best = SDL_min(best, SDL_GetTicksNS() - start);
+  }
+  return best;
+}
+
+// Includes allocating the converted surface, which LoadImage pays every time too. 0 if the conversion failed or
+// wrote different pixels than expected.
+static Uint64 TimeConvertSurface(SDL_Surface *source, const Uint8 *expected, Uint32 repeats)
+{
+  Uint64 best = ~(Uint64)0;
+  for (Uint32 r = 0; r < repeats; r += 1)
+  {
+    Uint64 start = SDL_GetTicksNS();
+    SDL_Surface *converted = SDL_ConvertSurface(source, SDL_PIXELFORMAT_ABGR8888);
+    Uint64 ns = SDL_GetTicksNS() - start;
+    if (converted == NULL)
+    {
+      SDL_Log("SDL_ConvertSurface failed: %s", SDL_GetError());
+      return 0;
+    }
+    bool same = true;
+    for (int y = 0; y < converted->h && same && r == 0; y += 1)
+    {
+      size_t rowSize = (size_t)converted->w * 4;
+      same = SDL_memcmp((const Uint8 *)converted->pixels + (size_t)y * converted->pitch, expected + (size_t)y * rowSize, rowSize) == 0;
+    }
+    SDL_DestroySurface(converted);
+    if (!same)
+    {
+      SDL_Log("SDL_ConvertSurface wrote different pixels than the scalar reference");
+      return 0;
+    }
+    best = SDL_min(best, ns);
+  }
+  return best;
+}
+
+static Uint64 TimePremultiplyAlpha(const SDL_Surface *source, Uint8 *destination, Uint32 repeats)
+{
+  Uint64 best = ~(Uint64)0;
+  for (Uint32 r = 0; r < repeats; r += 1)
+  {
+    Uint64 start = SDL_GetTicksNS();
+    if (!SDL_PremultiplyAlpha(source->w, source->h, source->format, source->pixels, source->pitch,
+                              SDL_PIXELFORMAT_ABGR8888, destination, source->w * 4, false))
+    {
+      SDL_Log("SDL_PremultiplyAlpha failed: %s", SDL_GetError());
+      return 0;
+    }
+    best = SDL_min(best, SDL_GetTicksNS() - start);
+  }
+  return best;
+}
+
+// Logs one line per layout and variant, false if any kernel or SDL_ConvertSurface disagreed with the scalar reference
+static bool RunSize(Uint32 size, Uint32 repeats, const PixelConvertPath *paths, Uint32 pathCount)
+{
+  size_t destinationSize = (size_t)size * size * 4;
+  Uint8 *expected = SDL_malloc(destinationSize);
+  Uint8 *destination = SDL_malloc(destinationSize);
+  if (expected == NULL || destination == NULL)
+  {
+    SDL_Log("Failed to allocate two %ux%u images", size, size);
+    SDL_free(expected);
+    SDL_free(destination);
+    return false;
+  }
+
+  bool allMatch = true;
+  for (size_t l = 0; l < SDL_arraysize(SourceLayouts); l += 1)
+  {
+    const SourceLayout *source = &SourceLayouts[l];
+    SDL_Surface *surface = SDL_CreateSurface(size, size, source->format);
+    if (surface == NULL)
+    {
+      SDL_Log("Failed to create a %ux%u surface: %s", size, size, SDL_GetError());
+      allMatch = false;
+      break;
+    }
+    for (Uint32 y = 0; y < size; y += 1)
+    {
+      Uint8 *row = (Uint8 *)surface->pixels + (size_t)y * surface->pitch;
+      for (Uint32 x = 0; x < size * PixelLayout_GetBytesPerPixel(source->layout); x += 1)
+      {
+        row[x] = (Uint8)rand();
+      }
+    }
+
+    for (size_t v = 0; v < SDL_arraysize(Variants); v += 1)
+    {
+      const Variant *variant = &Variants[v];
+      PixelConvert_SetPath(PIXEL_CONVERT_SCALAR);
+      ConvertImage(surface, source->layout, variant->flags, expected);
+
+      char line[512];
+      int length = SDL_snprintf(line, sizeof(line), "%ux%u %-6s %-14s", size, size, source->name, variant->name);
+      Uint64 sdlNS = 0;
+      if (variant->flags == PIXEL_CONVERT_NONE)
+      {
+        sdlNS = TimeConvertSurface(surface, expected, repeats);
+        allMatch = allMatch && sdlNS != 0;
+        length += SDL_snprintf(line + length, sizeof(line) - length, "  SDL_ConvertSurface %6.2f GB/s",
+                               sdlNS != 0 ? GetGBPerSecond(size, sdlNS) : 0.0);
+      }
+      else if (variant->flags == PIXEL_CONVERT_PREMULTIPLY_ALPHA && source->layout == PIXEL_LAYOUT_BGRA32)
+      {
+        sdlNS = TimePremultiplyAlpha(surface, destination, repeats);
+        length += SDL_snprintf(line + length, sizeof(line) - length, "  SDL_PremultiplyAlpha %6.2f GB/s",
+                               sdlNS != 0 ? GetGBPerSecond(size, sdlNS) : 0.0);
+      }
+      for (Uint32 p = 0; p < pathCount; p += 1)
+      {
+        PixelConvert_SetPath(paths[p]);
+        Uint64 ns = TimeKernel(surface, source->layout, variant->flags, destination, repeats);
+        bool match = SDL_memcmp(expected, destination, destinationSize) == 0;
+        allMatch = allMatch && match;
+        length += SDL_snprintf(line + length, sizeof(line) - length, "  %s %6.2f GB/s%s", PixelConvert_GetPathName(paths[p]),
+                               GetGBPerSecond(size, ns), match ? "" : " MISMATCH");
+        if (sdlNS != 0)
+        {
+          length += SDL_snprintf(line + length, sizeof(line) - length, " (%.1fx)", (double)sdlNS / ns);
+        }
+      }
+      SDL_Log("%s", line);
+    }
+    SDL_DestroySurface(surface);
+  }
+  SDL_free(expected);
+  SDL_free(destination);
+  return allMatch;
+}
+
+int main(int argc, char *argv[])
+{
+  Uint32 sizes[] = {4096, 8192};
+  Uint32 sizeCount = SDL_arraysize(sizes);
+  if (argc > 1)
+  {
+    sizes[0] = (Uint32)SDL_strtoul(argv[1], NULL, 10);
+    sizeCount = 1;
+  }
+  Uint32 repeats = argc > 2 ? (Uint32)SDL_strtoul(argv[2], NULL, 10) : DEFAULT_REPEATS;
+  if (sizes[0] == 0 || sizes[0] > 16384 || repeats == 0)
+  {
+    SDL_Log("Usage: %s [size up to 16384] [repeats]", argv[0]);
+    return 1;
+  }
+
+  // Paths this CPU doesn't have are logged once here and skipped
+  const PixelConvertPath allPaths[] = {PIXEL_CONVERT_SCALAR, PIXEL_CONVERT_SSSE3, PIXEL_CONVERT_AVX2, PIXEL_CONVERT_NEON};
+  PixelConvertPath paths[SDL_arraysize(allPaths)];
+  Uint32 pathCount = 0;
+  for (size_t p = 0; p < SDL_arraysize(allPaths); p += 1)
+  {
+    if (PixelConvert_SetPath(allPaths[p]))
+    {
+      paths[pathCount++] = allPaths[p];
+    }
+  }
+
+  SDL_Log("ABGR8888 written per second, best of %u runs", repeats);
+  srand(1);
+  bool allMatch = true;
+  for (Uint32 i = 0; i < sizeCount && allMatch; i += 1)
+  {
+    allMatch = RunSize(sizes[i], repeats, paths, pathCount);
+  }
+  PixelConvert_SetPath(PIXEL_CONVERT_AUTO);
+  return allMatch ? 0 : 1;
+}
@@ -0,0 +1,344 @@
+#include <SDL3/SDL.h>
+#include "buffer_allocator.h"
+
+// The allocator keeps every range of the buffer, free or not, in a list sorted by offset.
+// Neighbouring blocks are adjacent in the list, which makes merging free blocks a matter of looking left and right.
+typedef struct Block
+{
+  Uint32 offset;
+  Uint32 size;
+  bool free;
+} Block;
+
+struct BufferAllocator
+{
+  SDL_GPUDevice *device;
+  SDL_GPUBuffer *buffer;
+  Uint32 capacity;
+  Block *blocks;
+  Uint32 blockCount;
+  Uint32 blockCapacity;
+};
+
+struct MeshPool
+{
+  BufferAllocator *vertices;
+  BufferAllocator *indices;
+  Uint32 vertexStride;
+  SDL_GPUIndexElementSize indexSize;
+  Uint32 indexStride;
+};
+
+BufferAllocator *BufferAllocator_Create(SDL_GPUDevice *device, SDL_GPUBufferUsageFlags usage, Uint32 size)
+{
+  BufferAllocator *allocator = SDL_calloc(1, sizeof(BufferAllocator));
+  if (allocator == NULL)
+  {
+    return NULL;
+  }
+  allocator->device = device;
+  allocator->capacity = size;
+  allocator->blockCapacity = 16;
+  allocator->blocks = SDL_malloc(sizeof(Block) * allocator->blockCapacity);
+  if (allocator->blocks == NULL)
+  {
+    SDL_free(allocator);
+    return NULL;
+  }
+  allocator->blocks[0] = (Block){.offset = 0, .size = size, .free = true};
+  allocator->blockCount = 1;
+
+  allocator->buffer = SDL_CreateGPUBuffer(
+      device,
+      &(SDL_GPUBufferCreateInfo){
+          .usage = usage,
+          .size = size});
+  if (allocator->buffer == NULL)
+  {
+    SDL_Log("Failed to create allocator buffer: %s", SDL_GetError());
+    BufferAllocator_Destroy(allocator);
+    return NULL;
+  }
+  return allocator;
+}
+
+void BufferAllocator_Destroy(BufferAllocator *allocator)
+{
+  if (allocator == NULL)
+  {
+    return;
+  }
+  if (allocator->buffer != NULL)
+  {
+    SDL_ReleaseGPUBuffer(allocator->device, allocator->buffer);
+  }
+  SDL_free(allocator->blocks);
+  SDL_free(allocator);
+}
+
+static bool InsertBlock(BufferAllocator *allocator, Uint32 index, Block block)
+{
+  if (allocator->blockCount == allocator->blockCapacity)
+  {
+    Uint32 newCapacity = allocator->blockCapacity * 2;
+    Block *newBlocks = SDL_realloc(allocator->blocks, sizeof(Block) * newCapacity);
+    if (newBlocks == NULL)
+    {
+      return false;
+    }
+    allocator->blocks = newBlocks;
+    allocator->blockCapacity = newCapacity;
+  }
+  SDL_memmove(&allocator->blocks[index + 1], &allocator->blocks[index], sizeof(Block) * (allocator->blockCount - index));
+  allocator->blocks[index] = block;
+  allocator->blockCount += 1;
+  return true;
+}
+
+static void RemoveBlock(BufferAllocator *allocator, Uint32 index)
+{
+  SDL_memmove(&allocator->blocks[index], &allocator->blocks[index + 1], sizeof(Block) * (allocator->blockCount - index - 1));
+  allocator->blockCount -= 1;
+}
+
+bool BufferAllocator_Allocate(BufferAllocator *allocator, Uint32 size, Uint32 alignment, Uint32 *offset)
+{
+  if (size == 0)
+  {
+    return false;
+  }
+  if (alignment == 0)
+  {
+    alignment = 1;
+  }
+
+  for (Uint32 i = 0; i < allocator->blockCount; i += 1)
+  {
+    Block block = allocator->blocks[i];
+    if (!block.free || block.size < size)
+    {
+      continue;
+    }
+    Uint32 alignedOffset = (block.offset + alignment - 1) / alignment * alignment;
+    Uint32 padding = alignedOffset - block.offset;
+    if (padding > block.size - size)
+    {
+      continue;
+    }
+
+    // Split the block into [padding][allocation][rest], the padding and the rest stay free
+    // so they are merged back as soon as a neighbour is freed
+    Uint32 rest = block.size - padding - size;
+    // Worst case two new blocks, make sure both inserts can succeed before touching the list
+    if (allocator->blockCount + 2 > allocator->blockCapacity)
+    {
+      Uint32 newCapacity = allocator->blockCapacity * 2;
+      Block *newBlocks = SDL_realloc(allocator->blocks, sizeof(Block) * newCapacity);
+      if (newBlocks == NULL)
+      {
+        return false;
+      }
+      allocator->blocks = newBlocks;
+      allocator->blockCapacity = newCapacity;
+    }
+    allocator->blocks[i] = (Block){.offset = alignedOffset, .size = size, .free = false};
+    if (rest > 0)
+    {
+      InsertBlock(allocator, i + 1, (Block){.offset = alignedOffset + size, .size = rest, .free = true});
+    }
+    if (padding > 0)
+    {
+      InsertBlock(allocator, i, (Block){.offset = block.offset, .size = padding, .free = true});
+    }
+    *offset = alignedOffset;
+    return true;
+  }
+  return false;
+}
+
+void BufferAllocator_Free(BufferAllocator *allocator, Uint32 offset)
+{
+  // Binary search, the blocks are sorted by offset
+  Uint32 low = 0;
+  Uint32 high = allocator->blockCount;
+  while (low < high)
+  {
+    Uint32 middle = low + (high - low) / 2;
+    if (allocator->blocks[middle].offset < offset)
+    {
+      low = middle + 1;
+    }
+    else
+    {
+      high = middle;
+    }
+  }
+  if (low == allocator->blockCount || allocator->blocks[low].offset != offset || allocator->blocks[low].free)
+  {
+    SDL_Log("BufferAllocator_Free: no allocation at offset %u!", offset);
+    return;
+  }
+
+  Uint32 index = low;
+  allocator->blocks[index].free = true;
+  if (index + 1 < allocator->blockCount && allocator->blocks[index + 1].free)
+  {
+    allocator->blocks[index].size += allocator->blocks[index + 1].size;
+    RemoveBlock(allocator, index + 1);
+  }
+  if (index > 0 && allocator->blocks[index - 1].free)
+  {
+    allocator->blocks[index - 1].size += allocator->blocks[index].size;
+    RemoveBlock(allocator, index);
+  }
+}
+
+SDL_GPUBuffer *BufferAllocator_GetBuffer(BufferAllocator *allocator)
+{
+  return allocator->buffer;
+}
+
+BufferAllocatorReport BufferAllocator_GetReport(BufferAllocator *allocator)
+{
+  BufferAllocatorReport report = {.capacity = allocator->capacity};
+  for (Uint32 i = 0; i < allocator->blockCount; i += 1)
+  {
+    Block *block = &allocator->blocks[i];
+    if (block->free)
+    {
+      report.freeBytes += block->size;
+      report.freeBlocks += 1;
+      report.largestFreeBlock = SDL_max(report.largestFreeBlock, block->size);
+    }
+    else
+    {
+      report.used += block->size;
+      report.allocations += 1;
+    }
+  }
+  if (report.freeBytes > 0)
+  {
+    report.fragmentation = 1.0f - (float)report.largestFreeBlock / (float)report.freeBytes;
+  }
+  return report;
+}
+
+void BufferAllocator_LogReport(BufferAllocator *allocator, const char *name)
+{
+  BufferAllocatorReport report = BufferAllocator_GetReport(allocator);
+  SDL_Log("%s: %u/%u bytes used in %u allocations, %u bytes free in %u blocks (largest %u), fragmentation %.1f%%",
+          name,
+          report.used,
+          report.capacity,
+          report.allocations,
+          report.freeBytes,
+          report.freeBlocks,
+          report.largestFreeBlock,
+          report.fragmentation * 100.0f);
+}
+
+MeshPool *MeshPool_Create(SDL_GPUDevice *device, Uint32 vertexStride, Uint32 vertexCapacity, SDL_GPUIndexElementSize indexSize, Uint32 indexCapacity)
+{
+  MeshPool *pool = SDL_calloc(1, sizeof(MeshPool));
+  if (pool == NULL)
+  {
+    return NULL;
+  }
+  pool->vertexStride = vertexStride;
+  pool->indexSize = indexSize;
+  pool->indexStride = indexSize == SDL_GPU_INDEXELEMENTSIZE_16BIT ? sizeof(Uint16) : sizeof(Uint32);
+
+  pool->vertices = BufferAllocator_Create(device, SDL_GPU_BUFFERUSAGE_VERTEX, vertexStride * vertexCapacity);
+  pool->indices = BufferAllocator_Create(device, SDL_GPU_BUFFERUSAGE_INDEX, pool->indexStride * indexCapacity);
+  if (pool->vertices == NULL || pool->indices == NULL)
+  {
+    MeshPool_Destroy(pool);
+    return NULL;
+  }
+  return pool;
+}
+
+void MeshPool_Destroy(MeshPool *pool)
+{
+  if (pool == NULL)
+  {
+    return;
+  }
+  BufferAllocator_Destroy(pool->vertices);
+  BufferAllocator_Destroy(pool->indices);
+  SDL_free(pool);
+}
+
+bool MeshPool_Allocate(MeshPool *pool, Uint32 vertexCount, Uint32 indexCount, MeshAllocation *mesh)
+{
+  Uint32 vertexByteOffset, indexByteOffset;
+  if (vertexCount > SDL_MAX_UINT32 / pool->vertexStride || indexCount > SDL_MAX_UINT32 / pool->indexStride)
+  {
+    SDL_Log("Mesh of %u vertices and %u indices is too large for a mesh pool!", vertexCount, indexCount);
+    return false;
+  }
+  // Aligning to the stride keeps every mesh on a whole vertex, so it can be addressed with vertex_offset
+  if (!BufferAllocator_Allocate(pool->vertices, vertexCount * pool->vertexStride, pool->vertexStride, &vertexByteOffset))
+  {
+    SDL_Log("Mesh pool is out of vertex space for %u vertices!", vertexCount);
+    return false;
+  }
+  if (!BufferAllocator_Allocate(pool->indices, indexCount * pool->indexStride, pool->indexStride, &indexByteOffset))
+  {
+    SDL_Log("Mesh pool is out of index space for %u indices!", indexCount);
+    BufferAllocator_Free(pool->vertices, vertexByteOffset);
+    return false;
+  }
+
+  *mesh = (MeshAllocation){
+      .vertexOffset = vertexByteOffset / pool->vertexStride,
+      .firstIndex = indexByteOffset / pool->indexStride,
+      .vertexCount = vertexCount,
+      .indexCount = indexCount,
+      .vertexByteOffset = vertexByteOffset,
+      .indexByteOffset = indexByteOffset};
+  return true;
+}
+
+void MeshPool_Free(MeshPool *pool, const MeshAllocation *mesh)
+{
+  BufferAllocator_Free(pool->vertices, mesh->vertexByteOffset);
+  BufferAllocator_Free(pool->indices, mesh->indexByteOffset);
+}
+
+SDL_GPUBuffer *MeshPool_GetVertexBuffer(MeshPool *pool)
+{
+  return BufferAllocator_GetBuffer(pool->vertices);
+}
+
+SDL_GPUBuffer *MeshPool_GetIndexBuffer(MeshPool *pool)
+{
+  return BufferAllocator_GetBuffer(pool->indices);
+}
+
+Uint32 MeshPool_GetVertexStride(MeshPool *pool)
+{
+  return pool->vertexStride;
+}
+
+SDL_GPUIndexElementSize MeshPool_GetIndexSize(MeshPool *pool)
+{
+  return pool->indexSize;
+}
+
+void MeshPool_Bind(MeshPool *pool, SDL_GPURenderPass *renderPass)
+{
+  SDL_BindGPUVertexBuffers(renderPass, 0, &(SDL_GPUBufferBinding){.buffer = MeshPool_GetVertexBuffer(pool), .offset = 0}, 1);
+  SDL_BindGPUIndexBuffer(renderPass, &(SDL_GPUBufferBinding){.buffer = MeshPool_GetIndexBuffer(pool), .offset = 0}, pool->indexSize);
+}
+
+void MeshPool_Draw(SDL_GPURenderPass *renderPass, const MeshAllocation *mesh, Uint32 instanceCount)
+{
+  SDL_DrawGPUIndexedPrimitives(renderPass, mesh->indexCount, instanceCount, mesh->firstIndex, mesh->vertexOffset, 0);
+}
+
+void MeshPool_LogReport(MeshPool *pool)
+{
+  BufferAllocator_LogReport(pool->vertices, "Mesh pool vertices");
+  BufferAllocator_LogReport(pool->indices, "Mesh pool indices");
+}
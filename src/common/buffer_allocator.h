@@ -0,0 +1,61 @@
+#ifndef BUFFER_ALLOCATOR_H_
+#define BUFFER_ALLOCATOR_H_
+#include <SDL3/SDL.h>
+
+// Suballocates ranges out of one large SDL_GPUBuffer with a first-fit free list.
+// Freed ranges are merged with their free neighbours so the buffer doesn't splinter over time.
+typedef struct BufferAllocator BufferAllocator;
+
+typedef struct BufferAllocatorReport
+{
+  Uint32 capacity;
+  Uint32 used;        // bytes handed out, including alignment padding
+  Uint32 allocations;
+  Uint32 freeBytes;
+  Uint32 freeBlocks;
+  Uint32 largestFreeBlock;
+  float fragmentation; // 0 when all free space is one block, approaches 1 as it splits into small pieces
+} BufferAllocatorReport;
+
+BufferAllocator *BufferAllocator_Create(SDL_GPUDevice *device, SDL_GPUBufferUsageFlags usage, Uint32 size);
+void BufferAllocator_Destroy(BufferAllocator *allocator);
+
+// alignment does not need to be a power of two, vertex ranges are aligned to the vertex stride.
+// Returns false when no free block is large enough.
+bool BufferAllocator_Allocate(BufferAllocator *allocator, Uint32 size, Uint32 alignment, Uint32 *offset);
+void BufferAllocator_Free(BufferAllocator *allocator, Uint32 offset);
+
+SDL_GPUBuffer *BufferAllocator_GetBuffer(BufferAllocator *allocator);
+BufferAllocatorReport BufferAllocator_GetReport(BufferAllocator *allocator);
+void BufferAllocator_LogReport(BufferAllocator *allocator, const char *name);
+
+// Meshes that share a vertex layout live in one vertex buffer and one index buffer, so any number of them
+// draw with a single SDL_BindGPUVertexBuffers / SDL_BindGPUIndexBuffer pair and MeshPool_Draw per mesh.
+typedef struct MeshPool MeshPool;
+
+typedef struct MeshAllocation
+{
+  Uint32 vertexOffset; // in vertices, the vertex_offset of SDL_DrawGPUIndexedPrimitives
+  Uint32 firstIndex;   // in indices, the first_index of SDL_DrawGPUIndexedPrimitives
+  Uint32 vertexCount;
+  Uint32 indexCount;
+  Uint32 vertexByteOffset; // where to upload the vertices
+  Uint32 indexByteOffset;  // where to upload the indices
+} MeshAllocation;
+
+MeshPool *MeshPool_Create(SDL_GPUDevice *device, Uint32 vertexStride, Uint32 vertexCapacity, SDL_GPUIndexElementSize indexSize, Uint32 indexCapacity);
+void MeshPool_Destroy(MeshPool *pool);
+
+bool MeshPool_Allocate(MeshPool *pool, Uint32 vertexCount, Uint32 indexCount, MeshAllocation *mesh);
+void MeshPool_Free(MeshPool *pool, const MeshAllocation *mesh);
+
+SDL_GPUBuffer *MeshPool_GetVertexBuffer(MeshPool *pool);
+SDL_GPUBuffer *MeshPool_GetIndexBuffer(MeshPool *pool);
+Uint32 MeshPool_GetVertexStride(MeshPool *pool);
+SDL_GPUIndexElementSize MeshPool_GetIndexSize(MeshPool *pool);
+
+// Binds the shared vertex buffer to slot 0 and the shared index buffer
+void MeshPool_Bind(MeshPool *pool, SDL_GPURenderPass *renderPass);
+void MeshPool_Draw(SDL_GPURenderPass *renderPass, const MeshAllocation *mesh, Uint32 instanceCount);
+void MeshPool_LogReport(MeshPool *pool);
+#endif // BUFFER_ALLOCATOR_H_
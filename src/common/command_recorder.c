@@ -0,0 +1,227 @@
+#include <SDL3/SDL.h>
+#include "command_recorder.h"
+#include "trace.h"
+
+typedef struct RecorderWorker
+{
+  CommandRecorder *recorder;
+  SDL_Thread *thread;
+  SDL_Semaphore *start;
+  Uint32 slice;
+} RecorderWorker;
+
+struct CommandRecorder
+{
+  SDL_GPUDevice *device;
+  RecorderWorker *workers;
+  Uint32 workerCount;
+  SDL_Semaphore *done;
+  bool quit;
+
+  // Slices submit in order: each one waits until nextSubmit is its own index
+  SDL_Mutex *submitLock;
+  SDL_Condition *submitTurn;
+  Uint32 nextSubmit;
+
+  // The frame being recorded, set before the workers are woken
+  CommandRecorderCallback callback;
+  void *userdata;
+  Uint64 startNS;
+  Uint64 *recordedNS; // per slice, when it finished recording
+  Uint64 *sliceNS;    // per slice, how long it took
+  Uint64 submittedNS;
+  SDL_AtomicInt failed;
+};
+
+static Uint32 GetSliceCount(CommandRecorder *recorder)
+{
+  return recorder->workerCount + 1;
+}
+
+static void RecordSlice(CommandRecorder *recorder, Uint32 slice)
+{
+  TRACE_BEGIN("record slice");
+  Uint64 sliceStartNS = SDL_GetTicksNS();
+  SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(recorder->device);
+  bool recorded = false;
+  if (cmdbuf == NULL)
+  {
+    SDL_Log("AcquireGPUCommandBuffer failed for slice %u: %s", slice, SDL_GetError());
+  }
+  else
+  {
+    recorded = recorder->callback(recorder->userdata, slice, GetSliceCount(recorder), cmdbuf);
+  }
+  Uint64 recordedNS = SDL_GetTicksNS();
+  recorder->recordedNS[slice] = recordedNS;
+  recorder->sliceNS[slice] = recordedNS - sliceStartNS;
+  TRACE_END();
+
+  TRACE_BEGIN("wait to submit");
+  SDL_LockMutex(recorder->submitLock);
+  while (recorder->nextSubmit != slice)
+  {
+    SDL_WaitCondition(recorder->submitTurn, recorder->submitLock);
+  }
+  SDL_UnlockMutex(recorder->submitLock);
+  TRACE_END();
+
+  // Nobody else submits until nextSubmit moves on, so the submit itself doesn't need the lock
+  if (cmdbuf != NULL)
+  {
+    if (recorded)
+    {
+      recorded = SDL_SubmitGPUCommandBuffer(cmdbuf);
+    }
+    else
+    {
+      SDL_CancelGPUCommandBuffer(cmdbuf);
+    }
+  }
+  if (!recorded)
+  {
+    SDL_SetAtomicInt(&recorder->failed, 1);
+  }
+
+  SDL_LockMutex(recorder->submitLock);
+  recorder->nextSubmit += 1;
+  recorder->submittedNS = SDL_GetTicksNS();
+  SDL_BroadcastCondition(recorder->submitTurn);
+  SDL_UnlockMutex(recorder->submitLock);
+}
+
+static int SDLCALL WorkerThread(void *data)
+{
+  RecorderWorker *worker = data;
+  CommandRecorder *recorder = worker->recorder;
+  TRACE_THREAD("command recorder");
+  while (true)
+  {
+    SDL_WaitSemaphore(worker->start);
+    if (recorder->quit)
+    {
+      break;
+    }
+    RecordSlice(recorder, worker->slice);
+    SDL_SignalSemaphore(recorder->done);
+  }
+  return 0;
+}
+
+CommandRecorder *CommandRecorder_Create(SDL_GPUDevice *device, Uint32 threadCount)
+{
+  CommandRecorder *recorder = SDL_calloc(1, sizeof(CommandRecorder));
+  if (recorder == NULL)
+  {
+    return NULL;
+  }
+  recorder->device = device;
+  threadCount = SDL_max(threadCount, 1);
+  recorder->done = SDL_CreateSemaphore(0);
+  recorder->submitLock = SDL_CreateMutex();
+  recorder->submitTurn = SDL_CreateCondition();
+  recorder->recordedNS = SDL_calloc(threadCount, sizeof(Uint64));
+  recorder->sliceNS = SDL_calloc(threadCount, sizeof(Uint64));
+  recorder->workers = SDL_calloc(threadCount, sizeof(RecorderWorker));
+  if (recorder->done == NULL || recorder->submitLock == NULL || recorder->submitTurn == NULL ||
+      recorder->recordedNS == NULL || recorder->sliceNS == NULL || recorder->workers == NULL)
+  {
+    CommandRecorder_Destroy(recorder);
+    return NULL;
+  }
+  for (Uint32 i = 0; i < threadCount - 1; i += 1)
+  {
+    RecorderWorker *worker = &recorder->workers[i];
+    worker->recorder = recorder;
+    worker->slice = i + 1;
+    worker->start = SDL_CreateSemaphore(0);
+    if (worker->start == NULL)
+    {
+      break;
+    }
+    worker->thread = SDL_CreateThread(WorkerThread, "CommandRecorder", worker);
+    if (worker->thread == NULL)
+    {
+      SDL_DestroySemaphore(worker->start);
+      worker->start = NULL;
+      break;
+    }
+    recorder->workerCount += 1;
+  }
+  // The frame is still recorded, just in fewer slices
+  if (recorder->workerCount < threadCount - 1)
+  {
+    SDL_Log("Only started %u of %u command recorder threads: %s", recorder->workerCount, threadCount - 1, SDL_GetError());
+  }
+  return recorder;
+}
+
+void CommandRecorder_Destroy(CommandRecorder *recorder)
+{
+  if (recorder == NULL)
+  {
+    return;
+  }
+  recorder->quit = true;
+  for (Uint32 i = 0; i < recorder->workerCount; i += 1)
+  {
+    SDL_SignalSemaphore(recorder->workers[i].start);
+  }
+  for (Uint32 i = 0; i < recorder->workerCount; i += 1)
+  {
+    SDL_WaitThread(recorder->workers[i].thread, NULL);
+    SDL_DestroySemaphore(recorder->workers[i].start);
+  }
+  SDL_free(recorder->workers);
+  SDL_free(recorder->recordedNS);
+  SDL_free(recorder->sliceNS);
+  if (recorder->submitTurn != NULL)
+  {
+    SDL_DestroyCondition(recorder->submitTurn);
+  }
+  if (recorder->submitLock != NULL)
+  {
+    SDL_DestroyMutex(recorder->submitLock);
+  }
+  if (recorder->done != NULL)
+  {
+    SDL_DestroySemaphore(recorder->done);
+  }
+  SDL_free(recorder);
+}
+
+Uint32 CommandRecorder_GetThreadCount(CommandRecorder *recorder)
+{
+  return GetSliceCount(recorder);
+}
+
+bool CommandRecorder_Record(CommandRecorder *recorder, CommandRecorderCallback callback, void *userdata, CommandRecorderFrameStats *stats)
+{
+  recorder->callback = callback;
+  recorder->userdata = userdata;
+  recorder->nextSubmit = 0;
+  SDL_SetAtomicInt(&recorder->failed, 0);
+  recorder->startNS = SDL_GetTicksNS();
+
+  for (Uint32 i = 0; i < recorder->workerCount; i += 1)
+  {
+    SDL_SignalSemaphore(recorder->workers[i].start);
+  }
+  RecordSlice(recorder, 0);
+  for (Uint32 i = 0; i < recorder->workerCount; i += 1)
+  {
+    SDL_WaitSemaphore(recorder->done);
+  }
+
+  if (stats != NULL)
+  {
+    SDL_zerop(stats);
+    for (Uint32 slice = 0; slice < GetSliceCount(recorder); slice += 1)
+    {
+      stats->recordNS = SDL_max(stats->recordNS, recorder->recordedNS[slice] - recorder->startNS);
+      stats->slowestSliceNS = SDL_max(stats->slowestSliceNS, recorder->sliceNS[slice]);
+    }
+    stats->submitNS = recorder->submittedNS - recorder->startNS;
+  }
+  return SDL_GetAtomicInt(&recorder->failed) == 0;
+}
@@ -0,0 +1,32 @@
+#ifndef COMMAND_RECORDER_H_
+#define COMMAND_RECORDER_H_
+#include <SDL3/SDL.h>
+
+// Records one frame as several command buffers in parallel, one slice of the scene per thread.
+// Every slice acquires its own command buffer on its own thread, since SDL command buffers belong to the thread that acquired them,
+// and submits it there too, but only after every earlier slice was submitted: slice 0 always reaches the GPU first, then slice 1 and so on.
+// The recording itself overlaps, only the submits are serialized.
+//
+// The slices can't use the swapchain texture (it belongs to the command buffer that acquired it), render into your own textures
+// and copy them to the swapchain on the main command buffer, which is submitted after CommandRecorder_Record returns.
+typedef struct CommandRecorder CommandRecorder;
+
+// Called once per slice per frame, slice 0 on the thread calling CommandRecorder_Record. Record into cmdbuf, don't submit it.
+// Returning false cancels the command buffer and makes CommandRecorder_Record return false, the other slices are still submitted.
+typedef bool(SDLCALL *CommandRecorderCallback)(void *userdata, Uint32 slice, Uint32 sliceCount, SDL_GPUCommandBuffer *cmdbuf);
+
+typedef struct CommandRecorderFrameStats
+{
+  Uint64 recordNS;       // from the start of the frame until the last slice was recorded
+  Uint64 slowestSliceNS; // the longest single slice, acquire included
+  Uint64 submitNS;       // from the start of the frame until the last slice was submitted
+} CommandRecorderFrameStats;
+
+// threadCount slices per frame: threadCount - 1 worker threads are started now, the calling thread records slice 0
+CommandRecorder *CommandRecorder_Create(SDL_GPUDevice *device, Uint32 threadCount);
+void CommandRecorder_Destroy(CommandRecorder *recorder);
+Uint32 CommandRecorder_GetThreadCount(CommandRecorder *recorder);
+
+// Records and submits every slice, returns once all of them are submitted. stats can be NULL.
+bool CommandRecorder_Record(CommandRecorder *recorder, CommandRecorderCallback callback, void *userdata, CommandRecorderFrameStats *stats);
+#endif // COMMAND_RECORDER_H_
@@ -0,0 +1,359 @@
+#include <SDL3/SDL.h>
+#include "culling.h"
+
+static Plane NormalizePlane(float x, float y, float z, float w)
+{
+  float length = SDL_sqrtf(x * x + y * y + z * z);
+  return (Plane){{x / length, y / length, z / length}, w / length};
+}
+
+// With row vectors clip = v * M, so each plane is a sum or difference of the matrix columns:
+// -w <= x <= w, -w <= y <= w and 0 <= z <= w
+Frustum Frustum_FromMatrix(const Matrix4x4 *viewProjection)
+{
+  const Matrix4x4 *m = viewProjection;
+  Frustum frustum;
+  frustum.planes[FRUSTUM_LEFT] = NormalizePlane(m->m14 + m->m11, m->m24 + m->m21, m->m34 + m->m31, m->m44 + m->m41);
+  frustum.planes[FRUSTUM_RIGHT] = NormalizePlane(m->m14 - m->m11, m->m24 - m->m21, m->m34 - m->m31, m->m44 - m->m41);
+  frustum.planes[FRUSTUM_BOTTOM] = NormalizePlane(m->m14 + m->m12, m->m24 + m->m22, m->m34 + m->m32, m->m44 + m->m42);
+  frustum.planes[FRUSTUM_TOP] = NormalizePlane(m->m14 - m->m12, m->m24 - m->m22, m->m34 - m->m32, m->m44 - m->m42);
+  frustum.planes[FRUSTUM_NEAR] = NormalizePlane(m->m13, m->m23, m->m33, m->m43);
+  frustum.planes[FRUSTUM_FAR] = NormalizePlane(m->m14 - m->m13, m->m24 - m->m23, m->m34 - m->m33, m->m44 - m->m43);
+  return frustum;
+}
+
+// Scalar reference. A volume is culled when it is entirely behind one plane, the SIMD kernels below
+// compute the same distances in the same order and use "not less than" so they also agree on NaNs.
+
+static bool SphereInside(const Frustum *frustum, float x, float y, float z, float radius)
+{
+  for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+  {
+    const Plane *plane = &frustum->planes[p];
+    float distance = ((x * plane->normal.x + y * plane->normal.y) + z * plane->normal.z) + plane->distance;
+    if (distance < -radius)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool BoxInside(const Frustum *frustum, float x, float y, float z, float extentX, float extentY, float extentZ)
+{
+  for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+  {
+    const Plane *plane = &frustum->planes[p];
+    float distance = ((x * plane->normal.x + y * plane->normal.y) + z * plane->normal.z) + plane->distance;
+    // How far the box reaches towards the plane's normal
+    float radius = (extentX * SDL_fabsf(plane->normal.x) + extentY * SDL_fabsf(plane->normal.y)) + extentZ * SDL_fabsf(plane->normal.z);
+    if (distance < -radius)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Frustum_TestSphere(const Frustum *frustum, Vector3 center, float radius)
+{
+  return SphereInside(frustum, center.x, center.y, center.z, radius);
+}
+
+bool Frustum_TestBox(const Frustum *frustum, Vector3 center, Vector3 extent)
+{
+  return BoxInside(frustum, center.x, center.y, center.z, extent.x, extent.y, extent.z);
+}
+
+// The kernels append without branching on the result: every index is written and the count only moves past the visible ones
+static Uint32 ScalarCullSpheres(const Frustum *frustum, const BoundingSpheres *spheres, Uint32 first, Uint32 end, Uint32 *visible, Uint32 visibleCount)
+{
+  for (Uint32 i = first; i < end; i += 1)
+  {
+    visible[visibleCount] = i;
+    visibleCount += SphereInside(frustum, spheres->centerX[i], spheres->centerY[i], spheres->centerZ[i], spheres->radius[i]);
+  }
+  return visibleCount;
+}
+
+static Uint32 ScalarCullBoxes(const Frustum *frustum, const BoundingBoxes *boxes, Uint32 first, Uint32 end, Uint32 *visible, Uint32 visibleCount)
+{
+  for (Uint32 i = first; i < end; i += 1)
+  {
+    visible[visibleCount] = i;
+    visibleCount += BoxInside(frustum, boxes->centerX[i], boxes->centerY[i], boxes->centerZ[i], boxes->extentX[i], boxes->extentY[i], boxes->extentZ[i]);
+  }
+  return visibleCount;
+}
+
+// mask has one bit per lane, set for the visible ones
+static Uint32 AppendVisible(Uint32 *visible, Uint32 visibleCount, Uint32 first, int mask, int lanes)
+{
+  if (mask == 0)
+  {
+    return visibleCount;
+  }
+  for (int lane = 0; lane < lanes; lane += 1)
+  {
+    visible[visibleCount] = first + lane;
+    visibleCount += (mask >> lane) & 1;
+  }
+  return visibleCount;
+}
+
+#ifdef SDL_SSE2_INTRINSICS
+static Uint32 SDL_TARGETING("sse2") SSE2_CullSpheres(const Frustum *frustum, const BoundingSpheres *spheres, Uint32 count, Uint32 *visible)
+{
+  __m128 planeX[FRUSTUM_PLANE_COUNT], planeY[FRUSTUM_PLANE_COUNT], planeZ[FRUSTUM_PLANE_COUNT], planeW[FRUSTUM_PLANE_COUNT];
+  for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+  {
+    planeX[p] = _mm_set1_ps(frustum->planes[p].normal.x);
+    planeY[p] = _mm_set1_ps(frustum->planes[p].normal.y);
+    planeZ[p] = _mm_set1_ps(frustum->planes[p].normal.z);
+    planeW[p] = _mm_set1_ps(frustum->planes[p].distance);
+  }
+  const __m128 signBit = _mm_set1_ps(-0.0f);
+  Uint32 visibleCount = 0;
+  Uint32 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 x = _mm_loadu_ps(spheres->centerX + i);
+    __m128 y = _mm_loadu_ps(spheres->centerY + i);
+    __m128 z = _mm_loadu_ps(spheres->centerZ + i);
+    __m128 negRadius = _mm_xor_ps(_mm_loadu_ps(spheres->radius + i), signBit);
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+    {
+      __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, planeX[p]), _mm_mul_ps(y, planeY[p])), _mm_mul_ps(z, planeZ[p])), planeW[p]);
+      inside = _mm_and_ps(inside, _mm_cmpnlt_ps(distance, negRadius));
+    }
+    visibleCount = AppendVisible(visible, visibleCount, i, _mm_movemask_ps(inside), 4);
+  }
+  return ScalarCullSpheres(frustum, spheres, i, count, visible, visibleCount);
+}
+
+static Uint32 SDL_TARGETING("sse2") SSE2_CullBoxes(const Frustum *frustum, const BoundingBoxes *boxes, Uint32 count, Uint32 *visible)
+{
+  __m128 planeX[FRUSTUM_PLANE_COUNT], planeY[FRUSTUM_PLANE_COUNT], planeZ[FRUSTUM_PLANE_COUNT], planeW[FRUSTUM_PLANE_COUNT];
+  __m128 absX[FRUSTUM_PLANE_COUNT], absY[FRUSTUM_PLANE_COUNT], absZ[FRUSTUM_PLANE_COUNT];
+  for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+  {
+    planeX[p] = _mm_set1_ps(frustum->planes[p].normal.x);
+    planeY[p] = _mm_set1_ps(frustum->planes[p].normal.y);
+    planeZ[p] = _mm_set1_ps(frustum->planes[p].normal.z);
+    planeW[p] = _mm_set1_ps(frustum->planes[p].distance);
+    absX[p] = _mm_set1_ps(SDL_fabsf(frustum->planes[p].normal.x));
+    absY[p] = _mm_set1_ps(SDL_fabsf(frustum->planes[p].normal.y));
+    absZ[p] = _mm_set1_ps(SDL_fabsf(frustum->planes[p].normal.z));
+  }
+  const __m128 signBit = _mm_set1_ps(-0.0f);
+  Uint32 visibleCount = 0;
+  Uint32 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 x = _mm_loadu_ps(boxes->centerX + i);
+    __m128 y = _mm_loadu_ps(boxes->centerY + i);
+    __m128 z = _mm_loadu_ps(boxes->centerZ + i);
+    __m128 extentX = _mm_loadu_ps(boxes->extentX + i);
+    __m128 extentY = _mm_loadu_ps(boxes->extentY + i);
+    __m128 extentZ = _mm_loadu_ps(boxes->extentZ + i);
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+    {
+      __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, planeX[p]), _mm_mul_ps(y, planeY[p])), _mm_mul_ps(z, planeZ[p])), planeW[p]);
+      __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(extentX, absX[p]), _mm_mul_ps(extentY, absY[p])), _mm_mul_ps(extentZ, absZ[p]));
+      inside = _mm_and_ps(inside, _mm_cmpnlt_ps(distance, _mm_xor_ps(radius, signBit)));
+    }
+    visibleCount = AppendVisible(visible, visibleCount, i, _mm_movemask_ps(inside), 4);
+  }
+  return ScalarCullBoxes(frustum, boxes, i, count, visible, visibleCount);
+}
+#endif
+
+#ifdef SDL_AVX_INTRINSICS
+static Uint32 SDL_TARGETING("avx") AVX_CullSpheres(const Frustum *frustum, const BoundingSpheres *spheres, Uint32 count, Uint32 *visible)
+{
+  __m256 planeX[FRUSTUM_PLANE_COUNT], planeY[FRUSTUM_PLANE_COUNT], planeZ[FRUSTUM_PLANE_COUNT], planeW[FRUSTUM_PLANE_COUNT];
+  for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+  {
+    planeX[p] = _mm256_set1_ps(frustum->planes[p].normal.x);
+    planeY[p] = _mm256_set1_ps(frustum->planes[p].normal.y);
+    planeZ[p] = _mm256_set1_ps(frustum->planes[p].normal.z);
+    planeW[p] = _mm256_set1_ps(frustum->planes[p].distance);
+  }
+  const __m256 signBit = _mm256_set1_ps(-0.0f);
+  Uint32 visibleCount = 0;
+  Uint32 i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 x = _mm256_loadu_ps(spheres->centerX + i);
+    __m256 y = _mm256_loadu_ps(spheres->centerY + i);
+    __m256 z = _mm256_loadu_ps(spheres->centerZ + i);
+    __m256 negRadius = _mm256_xor_ps(_mm256_loadu_ps(spheres->radius + i), signBit);
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+    {
+      __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, planeX[p]), _mm256_mul_ps(y, planeY[p])), _mm256_mul_ps(z, planeZ[p])), planeW[p]);
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_NLT_UQ));
+    }
+    visibleCount = AppendVisible(visible, visibleCount, i, _mm256_movemask_ps(inside), 8);
+  }
+  return ScalarCullSpheres(frustum, spheres, i, count, visible, visibleCount);
+}
+
+static Uint32 SDL_TARGETING("avx") AVX_CullBoxes(const Frustum *frustum, const BoundingBoxes *boxes, Uint32 count, Uint32 *visible)
+{
+  __m256 planeX[FRUSTUM_PLANE_COUNT], planeY[FRUSTUM_PLANE_COUNT], planeZ[FRUSTUM_PLANE_COUNT], planeW[FRUSTUM_PLANE_COUNT];
+  __m256 absX[FRUSTUM_PLANE_COUNT], absY[FRUSTUM_PLANE_COUNT], absZ[FRUSTUM_PLANE_COUNT];
+  for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+  {
+    planeX[p] = _mm256_set1_ps(frustum->planes[p].normal.x);
+    planeY[p] = _mm256_set1_ps(frustum->planes[p].normal.y);
+    planeZ[p] = _mm256_set1_ps(frustum->planes[p].normal.z);
+    planeW[p] = _mm256_set1_ps(frustum->planes[p].distance);
+    absX[p] = _mm256_set1_ps(SDL_fabsf(frustum->planes[p].normal.x));
+    absY[p] = _mm256_set1_ps(SDL_fabsf(frustum->planes[p].normal.y));
+    absZ[p] = _mm256_set1_ps(SDL_fabsf(frustum->planes[p].normal.z));
+  }
+  const __m256 signBit = _mm256_set1_ps(-0.0f);
+  Uint32 visibleCount = 0;
+  Uint32 i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 x = _mm256_loadu_ps(boxes->centerX + i);
+    __m256 y = _mm256_loadu_ps(boxes->centerY + i);
+    __m256 z = _mm256_loadu_ps(boxes->centerZ + i);
+    __m256 extentX = _mm256_loadu_ps(boxes->extentX + i);
+    __m256 extentY = _mm256_loadu_ps(boxes->extentY + i);
+    __m256 extentZ = _mm256_loadu_ps(boxes->extentZ + i);
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+    {
+      __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, planeX[p]), _mm256_mul_ps(y, planeY[p])), _mm256_mul_ps(z, planeZ[p])), planeW[p]);
+      __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(extentX, absX[p]), _mm256_mul_ps(extentY, absY[p])), _mm256_mul_ps(extentZ, absZ[p]));
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_xor_ps(radius, signBit), _CMP_NLT_UQ));
+    }
+    visibleCount = AppendVisible(visible, visibleCount, i, _mm256_movemask_ps(inside), 8);
+  }
+  return ScalarCullBoxes(frustum, boxes, i, count, visible, visibleCount);
+}
+#endif
+
+#ifdef SDL_NEON_INTRINSICS
+// NEON has no movemask, weight each lane with its bit and add them up
+static int NEON_MoveMask(uint32x4_t inside)
+{
+  static const Uint32 laneBits[4] = {1, 2, 4, 8};
+  uint32x4_t bits = vandq_u32(inside, vld1q_u32(laneBits));
+  uint32x2_t sum = vpadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+  sum = vpadd_u32(sum, sum);
+  return (int)vget_lane_u32(sum, 0);
+}
+
+static Uint32 NEON_CullSpheres(const Frustum *frustum, const BoundingSpheres *spheres, Uint32 count, Uint32 *visible)
+{
+  float32x4_t planeX[FRUSTUM_PLANE_COUNT], planeY[FRUSTUM_PLANE_COUNT], planeZ[FRUSTUM_PLANE_COUNT], planeW[FRUSTUM_PLANE_COUNT];
+  for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+  {
+    planeX[p] = vdupq_n_f32(frustum->planes[p].normal.x);
+    planeY[p] = vdupq_n_f32(frustum->planes[p].normal.y);
+    planeZ[p] = vdupq_n_f32(frustum->planes[p].normal.z);
+    planeW[p] = vdupq_n_f32(frustum->planes[p].distance);
+  }
+  Uint32 visibleCount = 0;
+  Uint32 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    float32x4_t x = vld1q_f32(spheres->centerX + i);
+    float32x4_t y = vld1q_f32(spheres->centerY + i);
+    float32x4_t z = vld1q_f32(spheres->centerZ + i);
+    float32x4_t negRadius = vnegq_f32(vld1q_f32(spheres->radius + i));
+    uint32x4_t inside = vdupq_n_u32(0xFFFFFFFF);
+    for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+    {
+      float32x4_t distance = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(x, planeX[p]), vmulq_f32(y, planeY[p])), vmulq_f32(z, planeZ[p])), planeW[p]);
+      inside = vandq_u32(inside, vmvnq_u32(vcltq_f32(distance, negRadius)));
+    }
+    visibleCount = AppendVisible(visible, visibleCount, i, NEON_MoveMask(inside), 4);
+  }
+  return ScalarCullSpheres(frustum, spheres, i, count, visible, visibleCount);
+}
+
+static Uint32 NEON_CullBoxes(const Frustum *frustum, const BoundingBoxes *boxes, Uint32 count, Uint32 *visible)
+{
+  float32x4_t planeX[FRUSTUM_PLANE_COUNT], planeY[FRUSTUM_PLANE_COUNT], planeZ[FRUSTUM_PLANE_COUNT], planeW[FRUSTUM_PLANE_COUNT];
+  float32x4_t absX[FRUSTUM_PLANE_COUNT], absY[FRUSTUM_PLANE_COUNT], absZ[FRUSTUM_PLANE_COUNT];
+  for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+  {
+    planeX[p] = vdupq_n_f32(frustum->planes[p].normal.x);
+    planeY[p] = vdupq_n_f32(frustum->planes[p].normal.y);
+    planeZ[p] = vdupq_n_f32(frustum->planes[p].normal.z);
+    planeW[p] = vdupq_n_f32(frustum->planes[p].distance);
+    absX[p] = vdupq_n_f32(SDL_fabsf(frustum->planes[p].normal.x));
+    absY[p] = vdupq_n_f32(SDL_fabsf(frustum->planes[p].normal.y));
+    absZ[p] = vdupq_n_f32(SDL_fabsf(frustum->planes[p].normal.z));
+  }
+  Uint32 visibleCount = 0;
+  Uint32 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    float32x4_t x = vld1q_f32(boxes->centerX + i);
+    float32x4_t y = vld1q_f32(boxes->centerY + i);
+    float32x4_t z = vld1q_f32(boxes->centerZ + i);
+    float32x4_t extentX = vld1q_f32(boxes->extentX + i);
+    float32x4_t extentY = vld1q_f32(boxes->extentY + i);
+    float32x4_t extentZ = vld1q_f32(boxes->extentZ + i);
+    uint32x4_t inside = vdupq_n_u32(0xFFFFFFFF);
+    for (int p = 0; p < FRUSTUM_PLANE_COUNT; p += 1)
+    {
+      float32x4_t distance = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(x, planeX[p]), vmulq_f32(y, planeY[p])), vmulq_f32(z, planeZ[p])), planeW[p]);
+      float32x4_t radius = vaddq_f32(vaddq_f32(vmulq_f32(extentX, absX[p]), vmulq_f32(extentY, absY[p])), vmulq_f32(extentZ, absZ[p]));
+      inside = vandq_u32(inside, vmvnq_u32(vcltq_f32(distance, vnegq_f32(radius))));
+    }
+    visibleCount = AppendVisible(visible, visibleCount, i, NEON_MoveMask(inside), 4);
+  }
+  return ScalarCullBoxes(frustum, boxes, i, count, visible, visibleCount);
+}
+#endif
+
+Uint32 Frustum_CullSpheres(const Frustum *frustum, const BoundingSpheres *spheres, Uint32 count, Uint32 *visible)
+{
+  switch (LinearAlgebra_GetPath())
+  {
+#ifdef SDL_AVX_INTRINSICS
+  case LINEAR_ALGEBRA_AVX:
+    return AVX_CullSpheres(frustum, spheres, count, visible);
+#endif
+#ifdef SDL_SSE2_INTRINSICS
+  case LINEAR_ALGEBRA_SSE2:
+    return SSE2_CullSpheres(frustum, spheres, count, visible);
+#endif
+#ifdef SDL_NEON_INTRINSICS
+  case LINEAR_ALGEBRA_NEON:
+    return NEON_CullSpheres(frustum, spheres, count, visible);
+#endif
+  default:
+    return ScalarCullSpheres(frustum, spheres, 0, count, visible, 0);
+  }
+}
+
+Uint32 Frustum_CullBoxes(const Frustum *frustum, const BoundingBoxes *boxes, Uint32 count, Uint32 *visible)
+{
+  switch (LinearAlgebra_GetPath())
+  {
+#ifdef SDL_AVX_INTRINSICS
+  case LINEAR_ALGEBRA_AVX:
+    return AVX_CullBoxes(frustum, boxes, count, visible);
+#endif
+#ifdef SDL_SSE2_INTRINSICS
+  case LINEAR_ALGEBRA_SSE2:
+    return SSE2_CullBoxes(frustum, boxes, count, visible);
+#endif
+#ifdef SDL_NEON_INTRINSICS
+  case LINEAR_ALGEBRA_NEON:
+    return NEON_CullBoxes(frustum, boxes, count, visible);
+#endif
+  default:
+    return ScalarCullBoxes(frustum, boxes, 0, count, visible, 0);
+  }
+}
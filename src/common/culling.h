@@ -0,0 +1,64 @@
+#ifndef CULLING_H_
+#define CULLING_H_
+#include <SDL3/SDL.h>
+#include "linear_algebra.h"
+
+// Frustum culling of many bounding volumes at once.
+// The six planes come straight from a view-projection matrix (row vectors, 0..1 depth like Matrix4x4_CreatePerspectiveFieldOfView),
+// the volumes are structure-of-arrays so 4 (SSE2, NEON) or 8 (AVX) of them are tested per iteration.
+// The output is the compact list of the indices that are at least partly inside, in increasing order,
+// which can be written straight into a mapped transfer buffer and used as the instance list of one draw.
+//
+// The kernel follows LinearAlgebra_GetPath, so LinearAlgebra_SetPath(LINEAR_ALGEBRA_SCALAR) also forces the scalar reference here.
+typedef struct Plane
+{
+  // Points with x * normal.x + y * normal.y + z * normal.z + distance >= 0 are on the inside
+  Vector3 normal;
+  float distance;
+} Plane;
+
+typedef enum FrustumPlane
+{
+  FRUSTUM_LEFT,
+  FRUSTUM_RIGHT,
+  FRUSTUM_BOTTOM,
+  FRUSTUM_TOP,
+  FRUSTUM_NEAR,
+  FRUSTUM_FAR,
+  FRUSTUM_PLANE_COUNT
+} FrustumPlane;
+
+typedef struct Frustum
+{
+  Plane planes[FRUSTUM_PLANE_COUNT];
+} Frustum;
+
+typedef struct BoundingSpheres
+{
+  const float *centerX;
+  const float *centerY;
+  const float *centerZ;
+  const float *radius;
+} BoundingSpheres;
+
+// Axis aligned boxes as center and half size
+typedef struct BoundingBoxes
+{
+  const float *centerX;
+  const float *centerY;
+  const float *centerZ;
+  const float *extentX;
+  const float *extentY;
+  const float *extentZ;
+} BoundingBoxes;
+
+// Planes in the space the matrix transforms from, so a view-projection gives world space planes, normalized
+Frustum Frustum_FromMatrix(const Matrix4x4 *viewProjection);
+bool Frustum_TestSphere(const Frustum *frustum, Vector3 center, float radius);
+bool Frustum_TestBox(const Frustum *frustum, Vector3 center, Vector3 extent);
+
+// Write the indices of the visible volumes to visible and return how many there are.
+// visible needs room for count indices, entries past the returned count may be overwritten with junk.
+Uint32 Frustum_CullSpheres(const Frustum *frustum, const BoundingSpheres *spheres, Uint32 count, Uint32 *visible);
+Uint32 Frustum_CullBoxes(const Frustum *frustum, const BoundingBoxes *boxes, Uint32 count, Uint32 *visible);
+#endif // CULLING_H_
@@ -0,0 +1,163 @@
+#include <SDL3/SDL.h>
+#include "fence_tracker.h"
+
+typedef struct TrackedFrame
+{
+  SDL_GPUFence *fence;
+  Uint64 submitNS;
+  Uint64 frameIndex;
+  bool shared; // the fence belongs to whoever called FenceTracker_SubmitAndAcquireFence
+} TrackedFrame;
+
+struct FenceTracker
+{
+  SDL_GPUDevice *device;
+  FrameTiming *timing;
+  // Ring of the queued frames, oldest at first
+  TrackedFrame *frames;
+  Uint32 capacity;
+  Uint32 first;
+  Uint32 count;
+
+  Uint32 maxInFlight;
+  Uint64 depthTotal;
+  Uint64 submitted;
+  Uint64 completed;
+  Uint32 waits;
+  Uint64 waitNS;
+  Uint64 latencyTotalNS;
+  Uint64 latencyMaxNS;
+};
+
+FenceTracker *FenceTracker_Create(SDL_GPUDevice *device, Uint32 maxFramesInFlight, FrameTiming *timing)
+{
+  FenceTracker *tracker = SDL_calloc(1, sizeof(FenceTracker));
+  if (tracker == NULL)
+  {
+    return NULL;
+  }
+  tracker->device = device;
+  tracker->timing = timing;
+  tracker->capacity = SDL_max(maxFramesInFlight, 1);
+  tracker->frames = SDL_calloc(tracker->capacity, sizeof(TrackedFrame));
+  if (tracker->frames == NULL)
+  {
+    SDL_free(tracker);
+    return NULL;
+  }
+  return tracker;
+}
+
+void FenceTracker_Destroy(FenceTracker *tracker)
+{
+  if (tracker == NULL)
+  {
+    return;
+  }
+  FenceTracker_WaitIdle(tracker);
+  SDL_free(tracker->frames);
+  SDL_free(tracker);
+}
+
+static void RetireOldest(FenceTracker *tracker, Uint64 signaledNS)
+{
+  TrackedFrame *frame = &tracker->frames[tracker->first];
+  Uint64 latency = signaledNS - frame->submitNS;
+  tracker->completed += 1;
+  tracker->latencyTotalNS += latency;
+  tracker->latencyMaxNS = SDL_max(tracker->latencyMaxNS, latency);
+  if (tracker->timing != NULL)
+  {
+    FrameTiming_RecordFrame(tracker->timing, frame->frameIndex, FRAME_TIMING_GPU_LATENCY, latency);
+  }
+  if (!frame->shared)
+  {
+    SDL_ReleaseGPUFence(tracker->device, frame->fence);
+  }
+  tracker->first = (tracker->first + 1) % tracker->capacity;
+  tracker->count -= 1;
+}
+
+static void WaitOldest(FenceTracker *tracker)
+{
+  SDL_WaitForGPUFences(tracker->device, true, &tracker->frames[tracker->first].fence, 1);
+  RetireOldest(tracker, SDL_GetTicksNS());
+}
+
+Uint32 FenceTracker_Poll(FenceTracker *tracker)
+{
+  while (tracker->count > 0 && SDL_QueryGPUFence(tracker->device, tracker->frames[tracker->first].fence))
+  {
+    RetireOldest(tracker, SDL_GetTicksNS());
+  }
+  return tracker->count;
+}
+
+void FenceTracker_WaitIdle(FenceTracker *tracker)
+{
+  while (tracker->count > 0)
+  {
+    WaitOldest(tracker);
+  }
+}
+
+static SDL_GPUFence *SubmitFrame(FenceTracker *tracker, SDL_GPUCommandBuffer *cmdbuf, bool shared)
+{
+  FenceTracker_Poll(tracker);
+  if (tracker->count == tracker->capacity)
+  {
+    Uint64 waitStartNS = SDL_GetTicksNS();
+    WaitOldest(tracker);
+    tracker->waits += 1;
+    tracker->waitNS += SDL_GetTicksNS() - waitStartNS;
+  }
+
+  Uint64 submitNS = SDL_GetTicksNS();
+  SDL_GPUFence *fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cmdbuf);
+  if (fence == NULL)
+  {
+    return NULL;
+  }
+  Uint32 index = (tracker->first + tracker->count) % tracker->capacity;
+  tracker->frames[index] = (TrackedFrame){
+      .fence = fence,
+      .submitNS = submitNS,
+      .frameIndex = tracker->timing != NULL ? FrameTiming_GetFrameIndex(tracker->timing) : 0,
+      .shared = shared};
+  tracker->count += 1;
+  tracker->submitted += 1;
+  tracker->depthTotal += tracker->count;
+  tracker->maxInFlight = SDL_max(tracker->maxInFlight, tracker->count);
+  return fence;
+}
+
+bool FenceTracker_Submit(FenceTracker *tracker, SDL_GPUCommandBuffer *cmdbuf)
+{
+  return SubmitFrame(tracker, cmdbuf, false) != NULL;
+}
+
+SDL_GPUFence *FenceTracker_SubmitAndAcquireFence(FenceTracker *tracker, SDL_GPUCommandBuffer *cmdbuf)
+{
+  return SubmitFrame(tracker, cmdbuf, true);
+}
+
+FenceTrackerStats FenceTracker_GetStats(FenceTracker *tracker)
+{
+  FenceTrackerStats stats = {
+      .inFlight = tracker->count,
+      .maxInFlight = tracker->maxInFlight,
+      .submitted = tracker->submitted,
+      .completed = tracker->completed,
+      .waits = tracker->waits,
+      .waitNS = tracker->waitNS,
+      .maxLatencyMS = tracker->latencyMaxNS / 1e6};
+  if (tracker->submitted > 0)
+  {
+    stats.meanInFlight = (double)tracker->depthTotal / tracker->submitted;
+  }
+  if (tracker->completed > 0)
+  {
+    stats.meanLatencyMS = tracker->latencyTotalNS / 1e6 / tracker->completed;
+  }
+  return stats;
+}
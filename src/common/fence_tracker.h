@@ -0,0 +1,42 @@
+#ifndef FENCE_TRACKER_H_
+#define FENCE_TRACKER_H_
+#include <SDL3/SDL.h>
+#include "frame_timing.h"
+
+// Submits command buffers with a fence and polls the fences without blocking, to see how long the GPU takes per frame
+// and how many frames are queued. The SDL GPU API has no timestamp queries, so submit-to-signal is as close to GPU time as it gets.
+// The latency is taken when a poll sees the fence signaled, so poll often (FrameTarget polls on every acquire and submit).
+//
+//   FenceTracker_Submit(tracker, cmdbuf); // instead of SDL_SubmitGPUCommandBuffer
+// A submit only gets one fence, FenceTracker_SubmitAndAcquireFence shares it with the caller when something else needs it too.
+typedef struct FenceTracker FenceTracker;
+
+typedef struct FenceTrackerStats
+{
+  Uint32 inFlight; // frames submitted whose fence hasn't signaled yet
+  Uint32 maxInFlight;
+  double meanInFlight; // depth of the queue right after each submit
+  Uint64 submitted;
+  Uint64 completed;
+  Uint32 waits; // submits that blocked because maxFramesInFlight frames were queued
+  Uint64 waitNS;
+  double meanLatencyMS;
+  double maxLatencyMS;
+} FenceTrackerStats;
+
+// Submit blocks on the oldest fence once maxFramesInFlight frames are queued.
+// timing can be NULL, otherwise each frame's latency is recorded as FRAME_TIMING_GPU_LATENCY of the frame that was current at submit.
+FenceTracker *FenceTracker_Create(SDL_GPUDevice *device, Uint32 maxFramesInFlight, FrameTiming *timing);
+// Waits for every queued frame
+void FenceTracker_Destroy(FenceTracker *tracker);
+
+bool FenceTracker_Submit(FenceTracker *tracker, SDL_GPUCommandBuffer *cmdbuf);
+// Like FenceTracker_Submit, but the caller owns the fence. The tracker keeps polling it and never releases it, so release it
+// only after it signaled and the tracker polled (or waited on) it since, or after FenceTracker_Destroy.
+SDL_GPUFence *FenceTracker_SubmitAndAcquireFence(FenceTracker *tracker, SDL_GPUCommandBuffer *cmdbuf);
+// Retires every frame whose fence has signaled, never blocks. Returns how many frames are still in flight.
+Uint32 FenceTracker_Poll(FenceTracker *tracker);
+void FenceTracker_WaitIdle(FenceTracker *tracker);
+
+FenceTrackerStats FenceTracker_GetStats(FenceTracker *tracker);
+#endif // FENCE_TRACKER_H_
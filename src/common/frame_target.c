@@ -0,0 +1,481 @@
+#include <SDL3/SDL.h>
+#include <stdio.h>
+#include "frame_target.h"
+#include "frame_timing.h"
+#include "fence_tracker.h"
+#include "trace.h"
+
+#define OFFSCREEN_FORMAT SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM
+// How many frames may be queued before Submit waits for the oldest one, offscreen this plays the part of the swapchain
+#define MAX_FRAMES_IN_FLIGHT 3
+// Percentiles cover this many of the most recent frames
+#define TIMING_WINDOW_FRAMES 4096
+
+struct FrameTarget
+{
+  SDL_GPUDevice *device;
+  SDL_Window *window;
+  SDL_GPUTexture *texture; // offscreen only
+  int width;
+  int height;
+  const char *title;
+  FrameTargetOptions options;
+
+  Uint32 frameCount;
+  Uint64 startNS;
+  Uint64 acquireStartNS;
+  Uint64 acquireEndNS;
+  Uint64 lastSubmitNS;
+  FrameTiming *timing;
+  FenceTracker *fences; // NULL when windowed without --gpu-latency
+};
+
+static void LogUsage(const char *exampleName, const FrameTargetArg *extraArgs, Uint32 extraArgCount)
+{
+  char extra[256] = "";
+  for (Uint32 i = 0; i < extraArgCount; i += 1)
+  {
+    const FrameTargetArg *arg = &extraArgs[i];
+    size_t length = SDL_strlen(extra);
+    if (arg->value != NULL || arg->text != NULL)
+    {
+      SDL_snprintf(extra + length, sizeof(extra) - length, " [%s %s]", arg->name, arg->valueName);
+    }
+    else
+    {
+      SDL_snprintf(extra + length, sizeof(extra) - length, " [%s]", arg->name);
+    }
+  }
+  SDL_Log("Usage: %s [--offscreen] [--gpu-latency] [--frames N] [--size WxH] [--driver NAME] [--report PATH] [--timing-csv PATH] [--trace PATH]%s", exampleName, extra);
+}
+
+// Returns 0 if arg isn't one of the example's options, otherwise how many arguments it used up (-1 if its value is missing)
+static int ParseExtraArg(const char *arg, const char *value, const FrameTargetArg *extraArgs, Uint32 extraArgCount)
+{
+  for (Uint32 i = 0; i < extraArgCount; i += 1)
+  {
+    if (SDL_strcmp(arg, extraArgs[i].name) != 0)
+    {
+      continue;
+    }
+    if (extraArgs[i].flag != NULL)
+    {
+      *extraArgs[i].flag = true;
+      return 1;
+    }
+    if (value == NULL)
+    {
+      return -1;
+    }
+    if (extraArgs[i].text != NULL)
+    {
+      *extraArgs[i].text = value;
+    }
+    else
+    {
+      *extraArgs[i].value = (Uint32)SDL_strtoul(value, NULL, 10);
+    }
+    return 2;
+  }
+  return 0;
+}
+
+bool FrameTarget_ParseArgs(int argc, char *argv[], const char *exampleName, FrameTargetOptions *options)
+{
+  return FrameTarget_ParseArgsEx(argc, argv, exampleName, options, NULL, 0);
+}
+
+bool FrameTarget_ParseArgsEx(int argc, char *argv[], const char *exampleName, FrameTargetOptions *options, const FrameTargetArg *extraArgs, Uint32 extraArgCount)
+{
+  SDL_zerop(options);
+  for (int i = 1; i < argc; i += 1)
+  {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (SDL_strcmp(arg, "--offscreen") == 0)
+    {
+      options->offscreen = true;
+    }
+    else if (SDL_strcmp(arg, "--gpu-latency") == 0)
+    {
+      options->gpuLatency = true;
+    }
+    else if (SDL_strcmp(arg, "--frames") == 0 && value != NULL)
+    {
+      options->frames = (Uint32)SDL_strtoul(value, NULL, 10);
+      i += 1;
+    }
+    else if (SDL_strcmp(arg, "--size") == 0 && value != NULL)
+    {
+      if (SDL_sscanf(value, "%dx%d", &options->width, &options->height) != 2 || options->width <= 0 || options->height <= 0)
+      {
+        SDL_Log("Invalid --size '%s', expected WxH", value);
+        LogUsage(exampleName, extraArgs, extraArgCount);
+        return false;
+      }
+      i += 1;
+    }
+    else if (SDL_strcmp(arg, "--driver") == 0 && value != NULL)
+    {
+      options->driver = value;
+      i += 1;
+    }
+    else if (SDL_strcmp(arg, "--report") == 0 && value != NULL)
+    {
+      options->reportPath = value;
+      i += 1;
+    }
+    else if (SDL_strcmp(arg, "--timing-csv") == 0 && value != NULL)
+    {
+      options->timingPath = value;
+      i += 1;
+    }
+    else if (SDL_strcmp(arg, "--trace") == 0 && value != NULL)
+    {
+      options->tracePath = value;
+      i += 1;
+    }
+    else
+    {
+      int used = ParseExtraArg(arg, value, extraArgs, extraArgCount);
+      if (used <= 0)
+      {
+        SDL_Log(used < 0 ? "Missing value for '%s'" : "Unknown argument '%s'", arg);
+        LogUsage(exampleName, extraArgs, extraArgCount);
+        return false;
+      }
+      i += used - 1;
+    }
+  }
+  return true;
+}
+
+SDL_InitFlags FrameTarget_GetInitFlags(const FrameTargetOptions *options)
+{
+  // SDL_CreateGPUDevice needs the video subsystem even without a window; offscreen picks a video driver that needs no display.
+  // A plain hint, so SDL_VIDEO_DRIVER in the environment still wins.
+  if (options->offscreen)
+  {
+    SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen,dummy");
+  }
+  return SDL_INIT_VIDEO;
+}
+
+FrameTarget *FrameTarget_Create(SDL_GPUDevice *device, const char *title, int width, int height, SDL_WindowFlags windowFlags, const FrameTargetOptions *options)
+{
+  FrameTarget *target = SDL_calloc(1, sizeof(FrameTarget));
+  if (target == NULL)
+  {
+    return NULL;
+  }
+  target->device = device;
+  target->title = title;
+  target->options = *options;
+  target->width = options->width > 0 ? options->width : width;
+  target->height = options->height > 0 ? options->height : height;
+  target->timing = FrameTiming_Create(TIMING_WINDOW_FRAMES);
+  if (target->timing == NULL)
+  {
+    SDL_free(target);
+    return NULL;
+  }
+  if (options->offscreen || options->gpuLatency)
+  {
+    target->fences = FenceTracker_Create(device, MAX_FRAMES_IN_FLIGHT, target->timing);
+    if (target->fences == NULL)
+    {
+      FrameTiming_Destroy(target->timing);
+      SDL_free(target);
+      return NULL;
+    }
+  }
+
+#ifdef ENABLE_TRACE
+  TRACE_INIT(options->tracePath != NULL ? options->tracePath : "trace.json");
+  TRACE_THREAD("main");
+#else
+  if (options->tracePath != NULL)
+  {
+    SDL_Log("--trace ignored, this build has no tracing (rebuild with make TRACE=true)");
+  }
+#endif
+
+  if (options->offscreen)
+  {
+    target->texture = SDL_CreateGPUTexture(
+        device,
+        &(SDL_GPUTextureCreateInfo){
+            .type = SDL_GPU_TEXTURETYPE_2D,
+            .format = OFFSCREEN_FORMAT,
+            .width = target->width,
+            .height = target->height,
+            .layer_count_or_depth = 1,
+            .num_levels = 1,
+            .usage = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET | SDL_GPU_TEXTUREUSAGE_SAMPLER});
+    if (target->texture == NULL)
+    {
+      SDL_Log("Failed to create offscreen target: %s", SDL_GetError());
+      FenceTracker_Destroy(target->fences);
+      FrameTiming_Destroy(target->timing);
+      SDL_free(target);
+      return NULL;
+    }
+    return target;
+  }
+
+  target->window = SDL_CreateWindow(title, target->width, target->height, windowFlags);
+  if (target->window == NULL)
+  {
+    SDL_Log("CreateWindow failed: %s", SDL_GetError());
+    FenceTracker_Destroy(target->fences);
+    FrameTiming_Destroy(target->timing);
+    SDL_free(target);
+    return NULL;
+  }
+
+  if (!SDL_ClaimWindowForGPUDevice(device, target->window))
+  {
+    SDL_Log("GPUClaimWindow failed");
+    SDL_DestroyWindow(target->window);
+    FenceTracker_Destroy(target->fences);
+    FrameTiming_Destroy(target->timing);
+    SDL_free(target);
+    return NULL;
+  }
+  return target;
+}
+
+static int FormatSummary(char *text, size_t size, FrameTiming *timing, FrameTimingMetric metric)
+{
+  FrameTimingSummary summary = FrameTiming_Summarize(timing, metric);
+  return SDL_snprintf(
+      text,
+      size,
+      "  \"%s_ms\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+      FrameTiming_GetMetricName(metric),
+      summary.meanMS,
+      summary.p50MS,
+      summary.p95MS,
+      summary.p99MS,
+      summary.maxMS);
+}
+
+static void WriteReport(FrameTarget *target, Uint64 wallNS)
+{
+  FenceTrackerStats fenceStats = {0};
+  if (target->fences != NULL)
+  {
+    fenceStats = FenceTracker_GetStats(target->fences);
+  }
+  char summaries[FRAME_TIMING_METRIC_COUNT][256];
+  for (int metric = 0; metric < FRAME_TIMING_METRIC_COUNT; metric += 1)
+  {
+    FormatSummary(summaries[metric], sizeof(summaries[metric]), target->timing, metric);
+  }
+  char report[2048];
+  SDL_snprintf(
+      report,
+      sizeof(report),
+      "{\n"
+      "  \"example\": \"%s\",\n"
+      "  \"driver\": \"%s\",\n"
+      "  \"offscreen\": %s,\n"
+      "  \"width\": %d,\n"
+      "  \"height\": %d,\n"
+      "  \"frames\": %u,\n"
+      "  \"wall_time_ms\": %.3f,\n"
+      "  \"cpu_ms_per_frame\": %.4f,\n"
+      "%s%s%s%s"
+      "  \"fences_measured\": %" SDL_PRIu64 ",\n"
+      "  \"frames_in_flight_mean\": %.3f,\n"
+      "  \"frames_in_flight_max\": %u,\n"
+      "  \"fence_waits\": %u\n"
+      "}\n",
+      target->title,
+      SDL_GetGPUDeviceDriver(target->device),
+      target->options.offscreen ? "true" : "false",
+      target->width,
+      target->height,
+      target->frameCount,
+      wallNS / 1e6,
+      FrameTiming_Summarize(target->timing, FRAME_TIMING_CPU_RECORD).meanMS,
+      summaries[FRAME_TIMING_FRAME],
+      summaries[FRAME_TIMING_CPU_RECORD],
+      summaries[FRAME_TIMING_ACQUIRE_WAIT],
+      summaries[FRAME_TIMING_GPU_LATENCY],
+      fenceStats.completed,
+      fenceStats.meanInFlight,
+      fenceStats.maxInFlight,
+      fenceStats.waits);
+
+  if (target->options.reportPath == NULL)
+  {
+    fputs(report, stdout);
+    fflush(stdout);
+  }
+  else if (!SDL_SaveFile(target->options.reportPath, report, SDL_strlen(report)))
+  {
+    SDL_Log("Failed to write report to '%s': %s", target->options.reportPath, SDL_GetError());
+  }
+}
+
+void FrameTarget_Destroy(FrameTarget *target)
+{
+  if (target == NULL)
+  {
+    return;
+  }
+  // The wall time covers the GPU finishing the last frame, not just the CPU submitting it
+  if (target->fences != NULL)
+  {
+    FenceTracker_WaitIdle(target->fences);
+  }
+  if (target->options.offscreen || target->options.frames > 0)
+  {
+    WriteReport(target, target->startNS != 0 ? SDL_GetTicksNS() - target->startNS : 0);
+  }
+  if (target->frameCount > 0)
+  {
+    FrameTiming_LogSummary(target->timing);
+    if (target->fences != NULL)
+    {
+      FenceTrackerStats stats = FenceTracker_GetStats(target->fences);
+      SDL_Log("frames in flight mean %.2f  max %u  (%u submits waited %.3f ms)", stats.meanInFlight, stats.maxInFlight, stats.waits, stats.waitNS / 1e6);
+    }
+  }
+  if (target->options.timingPath != NULL)
+  {
+    FrameTiming_WriteCSV(target->timing, target->options.timingPath);
+  }
+  FenceTracker_Destroy(target->fences);
+  FrameTiming_Destroy(target->timing);
+
+  if (target->texture != NULL)
+  {
+    SDL_ReleaseGPUTexture(target->device, target->texture);
+  }
+  if (target->window != NULL)
+  {
+    SDL_ReleaseWindowFromGPUDevice(target->device, target->window);
+    SDL_DestroyWindow(target->window);
+  }
+  SDL_free(target);
+  TRACE_SHUTDOWN();
+}
+
+SDL_Window *FrameTarget_GetWindow(FrameTarget *target)
+{
+  return target->window;
+}
+
+SDL_GPUTextureFormat FrameTarget_GetFormat(FrameTarget *target)
+{
+  if (target->window == NULL)
+  {
+    return OFFSCREEN_FORMAT;
+  }
+  return SDL_GetGPUSwapchainTextureFormat(target->device, target->window);
+}
+
+void FrameTarget_GetSize(FrameTarget *target, int *width, int *height)
+{
+  if (target->window == NULL)
+  {
+    *width = target->width;
+    *height = target->height;
+    return;
+  }
+  SDL_GetWindowSizeInPixels(target->window, width, height);
+}
+
+bool FrameTarget_Acquire(FrameTarget *target, SDL_GPUCommandBuffer *cmdbuf, SDL_GPUTexture **texture)
+{
+  // Catch fences that signaled while the example was busy, the latency is taken when the signal is seen
+  if (target->fences != NULL)
+  {
+    FenceTracker_Poll(target->fences);
+  }
+  target->acquireStartNS = SDL_GetTicksNS();
+  if (target->startNS == 0)
+  {
+    target->startNS = target->acquireStartNS;
+  }
+  bool acquired = true;
+  if (target->window == NULL)
+  {
+    *texture = target->texture;
+  }
+  else
+  {
+    TRACE_BEGIN("swapchain wait");
+    acquired = SDL_WaitAndAcquireGPUSwapchainTexture(cmdbuf, target->window, texture, NULL, NULL);
+    TRACE_END();
+  }
+  target->acquireEndNS = SDL_GetTicksNS();
+  return acquired;
+}
+
+// Records the frame's timings once its command buffer went out
+static void EndFrame(FrameTarget *target, bool submitted)
+{
+  Uint64 submittedNS = SDL_GetTicksNS();
+  if (target->acquireStartNS != 0)
+  {
+    FrameTiming_Record(target->timing, FRAME_TIMING_ACQUIRE_WAIT, target->acquireEndNS - target->acquireStartNS);
+    FrameTiming_Record(target->timing, FRAME_TIMING_CPU_RECORD, submittedNS - target->acquireEndNS);
+  }
+  // The first frame has no previous one to measure from, it counts from its acquire
+  Uint64 frameStartNS = target->lastSubmitNS != 0 ? target->lastSubmitNS : target->acquireStartNS;
+  if (frameStartNS != 0)
+  {
+    FrameTiming_Record(target->timing, FRAME_TIMING_FRAME, submittedNS - frameStartNS);
+  }
+  FrameTiming_EndFrame(target->timing);
+  target->lastSubmitNS = submittedNS;
+  target->acquireStartNS = 0;
+  target->frameCount += 1;
+
+  if (!submitted)
+  {
+    SDL_Log("SubmitGPUCommandBuffer failed: %s", SDL_GetError());
+  }
+}
+
+bool FrameTarget_Submit(FrameTarget *target, SDL_GPUCommandBuffer *cmdbuf)
+{
+  TRACE_BEGIN("submit");
+  bool submitted;
+  if (target->fences != NULL)
+  {
+    submitted = FenceTracker_Submit(target->fences, cmdbuf);
+  }
+  else
+  {
+    submitted = SDL_SubmitGPUCommandBuffer(cmdbuf);
+  }
+  TRACE_END();
+  EndFrame(target, submitted);
+  return submitted;
+}
+
+SDL_GPUFence *FrameTarget_SubmitAndAcquireFence(FrameTarget *target, SDL_GPUCommandBuffer *cmdbuf)
+{
+  TRACE_BEGIN("submit");
+  SDL_GPUFence *fence;
+  if (target->fences != NULL)
+  {
+    fence = FenceTracker_SubmitAndAcquireFence(target->fences, cmdbuf);
+  }
+  else
+  {
+    fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cmdbuf);
+  }
+  TRACE_END();
+  EndFrame(target, fence != NULL);
+  return fence;
+}
+
+bool FrameTarget_IsDone(FrameTarget *target)
+{
+  return target->options.frames > 0 && target->frameCount >= target->options.frames;
+}
@@ -0,0 +1,72 @@
+#ifndef FRAME_TARGET_H_
+#define FRAME_TARGET_H_
+#include <SDL3/SDL.h>
+
+// Where an example renders its frames: the window's swapchain, or with --offscreen a plain SDL_GPUTexture and no window at all,
+// so the examples can be benchmarked on machines without a display (e.g. a software Vulkan driver in CI).
+//
+// Command line:
+//   --offscreen        render into a texture instead of a window
+//   --frames N         stop after N frames and print a JSON report
+//   --size WxH         size of the window or offscreen texture
+//   --driver NAME      GPU driver to ask SDL_CreateGPUDevice for (vulkan, direct3d12, metal)
+//   --report PATH      write the JSON report to PATH instead of stdout
+//   --timing-csv PATH  write the per-frame timings of the last frames to PATH at exit
+//   --gpu-latency      submit with fences when windowed too, to measure submit-to-fence latency and queue depth (always on offscreen)
+//   --trace PATH       where builds with TRACE=true write their Chrome trace, trace.json by default
+typedef struct FrameTargetOptions
+{
+  bool offscreen;
+  bool gpuLatency;
+  Uint32 frames; // 0 runs until the window is closed
+  int width;     // 0 keeps the example's own size
+  int height;
+  const char *driver;
+  const char *reportPath;
+  const char *timingPath;
+  const char *tracePath;
+} FrameTargetOptions;
+
+typedef struct FrameTarget FrameTarget;
+
+// An example's own option, parsed along with the ones above: "--name" sets *flag, "--name N" sets *value (exactly one of them is non-NULL)
+typedef struct FrameTargetArg
+{
+  const char *name;
+  const char *valueName; // shown in the usage, e.g. "N"
+  // Exactly one of these is set
+  Uint32 *value;
+  bool *flag;
+  const char **text; // points into argv
+} FrameTargetArg;
+
+// Returns false (after logging the usage) if the arguments don't parse
+bool FrameTarget_ParseArgs(int argc, char *argv[], const char *exampleName, FrameTargetOptions *options);
+// Same, plus the example's own options. Values not given on the command line are left as they are, so set the defaults first.
+bool FrameTarget_ParseArgsEx(int argc, char *argv[], const char *exampleName, FrameTargetOptions *options, const FrameTargetArg *extraArgs, Uint32 extraArgCount);
+// The subsystems SDL_Init needs for these options, call it right before SDL_Init: offscreen it also points
+// SDL_HINT_VIDEO_DRIVER at a driver that runs without a display
+SDL_InitFlags FrameTarget_GetInitFlags(const FrameTargetOptions *options);
+
+// Creates and claims the window, or the offscreen texture. width and height are the defaults used when --size isn't given.
+FrameTarget *FrameTarget_Create(SDL_GPUDevice *device, const char *title, int width, int height, SDL_WindowFlags windowFlags, const FrameTargetOptions *options);
+// Prints the report and the frame timing percentiles, writes the timing CSV if asked for, and destroys the window or the offscreen texture
+void FrameTarget_Destroy(FrameTarget *target);
+
+// NULL when running offscreen
+SDL_Window *FrameTarget_GetWindow(FrameTarget *target);
+// Use instead of SDL_GetGPUSwapchainTextureFormat when creating pipelines
+SDL_GPUTextureFormat FrameTarget_GetFormat(FrameTarget *target);
+void FrameTarget_GetSize(FrameTarget *target, int *width, int *height);
+
+// Drop-in for SDL_WaitAndAcquireGPUSwapchainTexture, *texture can be NULL when the window is minimized
+bool FrameTarget_Acquire(FrameTarget *target, SDL_GPUCommandBuffer *cmdbuf, SDL_GPUTexture **texture);
+// Drop-in for SDL_SubmitGPUCommandBuffer, offscreen or with --gpu-latency it also measures how long the GPU takes to signal the frame's fence
+bool FrameTarget_Submit(FrameTarget *target, SDL_GPUCommandBuffer *cmdbuf);
+// FrameTarget_Submit that hands out the frame's fence, NULL if the submit failed. The caller owns it, but while the target
+// tracks fences it polls this one too: release it only after it signaled and a later FrameTarget_Submit* or FrameTarget_Acquire
+// polled it, or after FrameTarget_Destroy. UploadRing_EndFrame follows that rule.
+SDL_GPUFence *FrameTarget_SubmitAndAcquireFence(FrameTarget *target, SDL_GPUCommandBuffer *cmdbuf);
+// True once --frames frames have been submitted
+bool FrameTarget_IsDone(FrameTarget *target);
+#endif // FRAME_TARGET_H_
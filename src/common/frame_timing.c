@@ -0,0 +1,237 @@
+#include <SDL3/SDL.h>
+#include "frame_timing.h"
+
+// Log-linear buckets: values below 16ns get a bucket each, above that every power of two is split into 16 buckets,
+// so a percentile is off by at most 1/16th (~6%) of its value. Powers of two up to 2^40ns cover over ten minutes.
+#define SUB_BUCKET_BITS 4
+#define SUB_BUCKETS (1 << SUB_BUCKET_BITS)
+#define MAX_EXPONENT 40
+#define BUCKET_COUNT (SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS)
+
+static const char *MetricNames[FRAME_TIMING_METRIC_COUNT] = {
+    "frame",
+    "cpu_record",
+    "acquire_wait",
+    "submit_to_fence",
+};
+
+struct FrameTiming
+{
+  Uint32 windowFrames;
+  // Ring of the last windowFrames frames, samples[frame * FRAME_TIMING_METRIC_COUNT + metric]
+  Uint64 *samples;
+  Uint32 next;
+  Uint32 count;
+  Uint64 frameIndex; // frames ended so far
+  Uint64 current[FRAME_TIMING_METRIC_COUNT];
+  Uint32 histograms[FRAME_TIMING_METRIC_COUNT][BUCKET_COUNT];
+  Uint64 sums[FRAME_TIMING_METRIC_COUNT];
+};
+
+static int MostSignificantBit(Uint64 value)
+{
+  if (value >> 32)
+  {
+    return 32 + SDL_MostSignificantBitIndex32((Uint32)(value >> 32));
+  }
+  return SDL_MostSignificantBitIndex32((Uint32)value);
+}
+
+static Uint32 BucketIndex(Uint64 ns)
+{
+  if (ns < SUB_BUCKETS)
+  {
+    return (Uint32)ns;
+  }
+  int exponent = MostSignificantBit(ns);
+  if (exponent > MAX_EXPONENT)
+  {
+    return BUCKET_COUNT - 1;
+  }
+  Uint32 subBucket = (Uint32)(ns >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+  return SUB_BUCKETS + (exponent - SUB_BUCKET_BITS) * SUB_BUCKETS + subBucket;
+}
+
+// Middle of the range of values that land in this bucket
+static double BucketValue(Uint32 bucket)
+{
+  if (bucket < SUB_BUCKETS)
+  {
+    return (double)bucket;
+  }
+  Uint32 exponent = (bucket - SUB_BUCKETS) / SUB_BUCKETS + SUB_BUCKET_BITS;
+  Uint32 subBucket = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+  double width = (double)((Uint64)1 << (exponent - SUB_BUCKET_BITS));
+  double low = (double)((Uint64)1 << exponent) + subBucket * width;
+  return low + width * 0.5;
+}
+
+FrameTiming *FrameTiming_Create(Uint32 windowFrames)
+{
+  FrameTiming *timing = SDL_calloc(1, sizeof(FrameTiming));
+  if (timing == NULL)
+  {
+    return NULL;
+  }
+  timing->windowFrames = SDL_max(windowFrames, 1);
+  timing->samples = SDL_calloc(timing->windowFrames * FRAME_TIMING_METRIC_COUNT, sizeof(Uint64));
+  if (timing->samples == NULL)
+  {
+    SDL_free(timing);
+    return NULL;
+  }
+  return timing;
+}
+
+void FrameTiming_Destroy(FrameTiming *timing)
+{
+  if (timing == NULL)
+  {
+    return;
+  }
+  SDL_free(timing->samples);
+  SDL_free(timing);
+}
+
+void FrameTiming_Record(FrameTiming *timing, FrameTimingMetric metric, Uint64 ns)
+{
+  timing->current[metric] += ns;
+}
+
+void FrameTiming_EndFrame(FrameTiming *timing)
+{
+  Uint64 *slot = &timing->samples[timing->next * FRAME_TIMING_METRIC_COUNT];
+  for (int metric = 0; metric < FRAME_TIMING_METRIC_COUNT; metric += 1)
+  {
+    // The window is full, the oldest frame drops out of the statistics
+    if (timing->count == timing->windowFrames)
+    {
+      timing->histograms[metric][BucketIndex(slot[metric])] -= 1;
+      timing->sums[metric] -= slot[metric];
+    }
+    slot[metric] = timing->current[metric];
+    timing->histograms[metric][BucketIndex(slot[metric])] += 1;
+    timing->sums[metric] += slot[metric];
+    timing->current[metric] = 0;
+  }
+  timing->next = (timing->next + 1) % timing->windowFrames;
+  timing->count = SDL_min(timing->count + 1, timing->windowFrames);
+  timing->frameIndex += 1;
+}
+
+Uint64 FrameTiming_GetFrameIndex(FrameTiming *timing)
+{
+  return timing->frameIndex;
+}
+
+void FrameTiming_RecordFrame(FrameTiming *timing, Uint64 frameIndex, FrameTimingMetric metric, Uint64 ns)
+{
+  if (frameIndex >= timing->frameIndex)
+  {
+    // Still the current frame
+    timing->current[metric] = ns;
+    return;
+  }
+  Uint64 age = timing->frameIndex - frameIndex;
+  if (age > timing->count)
+  {
+    return;
+  }
+  Uint32 index = (Uint32)((timing->next + timing->windowFrames - age) % timing->windowFrames);
+  Uint64 *sample = &timing->samples[index * FRAME_TIMING_METRIC_COUNT + metric];
+  timing->histograms[metric][BucketIndex(*sample)] -= 1;
+  timing->sums[metric] -= *sample;
+  *sample = ns;
+  timing->histograms[metric][BucketIndex(*sample)] += 1;
+  timing->sums[metric] += *sample;
+}
+
+FrameTimingSummary FrameTiming_Summarize(FrameTiming *timing, FrameTimingMetric metric)
+{
+  FrameTimingSummary summary = {.count = timing->count};
+  if (timing->count == 0)
+  {
+    return summary;
+  }
+
+  // The exact max is cheap to find in the window and keeps the percentiles from overshooting it
+  Uint64 max = 0;
+  for (Uint32 i = 0; i < timing->count; i += 1)
+  {
+    max = SDL_max(max, timing->samples[i * FRAME_TIMING_METRIC_COUNT + metric]);
+  }
+
+  const double percentiles[] = {0.50, 0.95, 0.99};
+  double *results[] = {&summary.p50MS, &summary.p95MS, &summary.p99MS};
+  Uint32 p = 0;
+  Uint32 seen = 0;
+  for (Uint32 bucket = 0; bucket < BUCKET_COUNT && p < SDL_arraysize(percentiles); bucket += 1)
+  {
+    seen += timing->histograms[metric][bucket];
+    while (p < SDL_arraysize(percentiles) && seen >= SDL_ceil(percentiles[p] * timing->count))
+    {
+      *results[p] = SDL_min(BucketValue(bucket), (double)max) / 1e6;
+      p += 1;
+    }
+  }
+
+  summary.meanMS = (double)timing->sums[metric] / timing->count / 1e6;
+  summary.maxMS = max / 1e6;
+  return summary;
+}
+
+const char *FrameTiming_GetMetricName(FrameTimingMetric metric)
+{
+  return MetricNames[metric];
+}
+
+void FrameTiming_LogSummary(FrameTiming *timing)
+{
+  for (int metric = 0; metric < FRAME_TIMING_METRIC_COUNT; metric += 1)
+  {
+    if (timing->sums[metric] == 0)
+    {
+      continue;
+    }
+    FrameTimingSummary summary = FrameTiming_Summarize(timing, metric);
+    SDL_Log("%-15s mean %.3f ms  p50 %.3f ms  p95 %.3f ms  p99 %.3f ms  max %.3f ms  (%u frames)",
+            MetricNames[metric],
+            summary.meanMS,
+            summary.p50MS,
+            summary.p95MS,
+            summary.p99MS,
+            summary.maxMS,
+            summary.count);
+  }
+}
+
+bool FrameTiming_WriteCSV(FrameTiming *timing, const char *path)
+{
+  SDL_IOStream *file = SDL_IOFromFile(path, "w");
+  if (file == NULL)
+  {
+    SDL_Log("Failed to open '%s': %s", path, SDL_GetError());
+    return false;
+  }
+
+  SDL_IOprintf(file, "frame");
+  for (int metric = 0; metric < FRAME_TIMING_METRIC_COUNT; metric += 1)
+  {
+    SDL_IOprintf(file, ",%s_ms", MetricNames[metric]);
+  }
+  SDL_IOprintf(file, "\n");
+
+  // Oldest frame first
+  Uint32 first = timing->count == timing->windowFrames ? timing->next : 0;
+  for (Uint32 i = 0; i < timing->count; i += 1)
+  {
+    Uint64 *slot = &timing->samples[((first + i) % timing->windowFrames) * FRAME_TIMING_METRIC_COUNT];
+    SDL_IOprintf(file, "%u", i);
+    for (int metric = 0; metric < FRAME_TIMING_METRIC_COUNT; metric += 1)
+    {
+      SDL_IOprintf(file, ",%.6f", slot[metric] / 1e6);
+    }
+    SDL_IOprintf(file, "\n");
+  }
+  return SDL_CloseIO(file);
+}
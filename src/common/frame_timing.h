@@ -0,0 +1,46 @@
+#ifndef FRAME_TIMING_H_
+#define FRAME_TIMING_H_
+#include <SDL3/SDL.h>
+
+// Nanosecond frame timings over a rolling window of frames, kept as log-linear histograms so percentiles are cheap.
+// Every frame: FrameTiming_Record the metrics you measured, then FrameTiming_EndFrame.
+typedef enum FrameTimingMetric
+{
+  FRAME_TIMING_FRAME,        // start of one frame to the start of the next
+  FRAME_TIMING_CPU_RECORD,   // recording and submitting the command buffer
+  FRAME_TIMING_ACQUIRE_WAIT, // blocked waiting for a swapchain texture
+  FRAME_TIMING_GPU_LATENCY,  // submit to the frame's fence signaling, see fence_tracker.h
+  FRAME_TIMING_METRIC_COUNT
+} FrameTimingMetric;
+
+typedef struct FrameTimingSummary
+{
+  Uint32 count; // frames in the window
+  double meanMS;
+  double p50MS;
+  double p95MS;
+  double p99MS;
+  double maxMS;
+} FrameTimingSummary;
+
+typedef struct FrameTiming FrameTiming;
+
+// windowFrames is how many of the most recent frames the statistics cover
+FrameTiming *FrameTiming_Create(Uint32 windowFrames);
+void FrameTiming_Destroy(FrameTiming *timing);
+
+void FrameTiming_Record(FrameTiming *timing, FrameTimingMetric metric, Uint64 ns);
+void FrameTiming_EndFrame(FrameTiming *timing);
+// Number of the frame that FrameTiming_Record currently adds to
+Uint64 FrameTiming_GetFrameIndex(FrameTiming *timing);
+// For measurements that only arrive after their frame has ended, like GPU completion.
+// Replaces the frame's value if it is still in the window, frames that already dropped out are ignored.
+void FrameTiming_RecordFrame(FrameTiming *timing, Uint64 frameIndex, FrameTimingMetric metric, Uint64 ns);
+
+FrameTimingSummary FrameTiming_Summarize(FrameTiming *timing, FrameTimingMetric metric);
+const char *FrameTiming_GetMetricName(FrameTimingMetric metric);
+// Metrics that were never recorded are left out
+void FrameTiming_LogSummary(FrameTiming *timing);
+// One row per frame in the window, with every metric in milliseconds
+bool FrameTiming_WriteCSV(FrameTiming *timing, const char *path);
+#endif // FRAME_TIMING_H_
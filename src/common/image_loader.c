@@ -0,0 +1,294 @@
+#include "image_loader.h"
+
+#define BMP_FILE_HEADER_SIZE 14
+#define BMP_INFO_HEADER_SIZE 40
+// BITMAPV5HEADER, the largest
+#define BMP_MAX_INFO_HEADER_SIZE 124
+#define BMP_RGB 0
+#define BMP_BITFIELDS 3
+#define BMP_ALPHABITFIELDS 6
+
+struct ImageFile
+{
+  SDL_IOStream *stream;
+  ImageFileInfo info;
+  Uint32 dataOffset;
+  Uint32 rowSize; // in the file, padded to 4 bytes
+  bool bottomUp;
+  Uint32 shifts[4];      // of red, green, blue and alpha in a 32 bit pixel
+  Uint8 palette[256][4]; // RGBA
+  PixelLayout layout;    // RGBA32 for palettes and 32 bit masks without a kernel, swizzled before PixelConvert_Row
+  PixelConvertFlags flags;
+};
+
+static Uint32 ReadLE32(const Uint8 *bytes)
+{
+  return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((Uint32)bytes[3] << 24);
+}
+
+static Uint16 ReadLE16(const Uint8 *bytes)
+{
+  return (Uint16)(bytes[0] | (bytes[1] << 8));
+}
+
+// Position of an 8 bit channel mask, -1 if the mask isn't one whole byte of the pixel
+static int GetMaskShift(Uint32 mask)
+{
+  for (int shift = 0; shift < 32; shift += 8)
+  {
+    if (mask == (Uint32)0xFF << shift)
+    {
+      return shift;
+    }
+  }
+  return -1;
+}
+
+// Whether any 32 bit pixel has a nonzero top byte, read a chunk at a time and stopping at the first one
+static bool HasAlphaBytes(ImageFile *file)
+{
+  Uint32 rowsPerChunk = SDL_clamp(IMAGE_READ_CHUNK_SIZE / file->rowSize, 1, file->info.height);
+  Uint8 *chunk = SDL_malloc((size_t)file->rowSize * rowsPerChunk);
+  if (chunk == NULL || SDL_SeekIO(file->stream, file->dataOffset, SDL_IO_SEEK_SET) < 0)
+  {
+    SDL_free(chunk);
+    return true;
+  }
+  bool found = false;
+  for (Uint32 row = 0; row < file->info.height && !found; row += rowsPerChunk)
+  {
+    Uint32 rowCount = SDL_min(rowsPerChunk, file->info.height - row);
+    size_t size = (size_t)file->rowSize * rowCount;
+    if (SDL_ReadIO(file->stream, chunk, size) != size)
+    {
+      break;
+    }
+    for (size_t i = 3; i < size && !found; i += 4)
+    {
+      found = chunk[i] != 0;
+    }
+  }
+  SDL_free(chunk);
+  return found;
+}
+
+void ImageFile_Close(ImageFile *file)
+{
+  if (file == NULL)
+  {
+    return;
+  }
+  SDL_CloseIO(file->stream);
+  SDL_free(file);
+}
+
+ImageFile *ImageFile_Open(const char *path)
+{
+  SDL_IOStream *stream = SDL_IOFromFile(path, "rb");
+  if (stream == NULL)
+  {
+    SDL_Log("Failed to open %s: %s", path, SDL_GetError());
+    return NULL;
+  }
+  ImageFile *file = SDL_calloc(1, sizeof(ImageFile));
+  if (file == NULL)
+  {
+    SDL_CloseIO(stream);
+    return NULL;
+  }
+  file->stream = stream;
+
+  // Fields past the end of a short file read as 0 and fail the checks
+  Uint8 header[BMP_FILE_HEADER_SIZE + BMP_MAX_INFO_HEADER_SIZE] = {0};
+  size_t headerBytes = SDL_ReadIO(stream, header, sizeof(header));
+  Sint64 fileSize = SDL_GetIOSize(stream);
+  const Uint8 *info = header + BMP_FILE_HEADER_SIZE;
+  Uint32 infoSize = ReadLE32(info);
+  Sint32 width = (Sint32)ReadLE32(info + 4);
+  Sint32 height = (Sint32)ReadLE32(info + 8);
+  Uint32 bitsPerPixel = ReadLE16(info + 14);
+  Uint32 compression = ReadLE32(info + 16);
+  if (headerBytes < BMP_FILE_HEADER_SIZE + BMP_INFO_HEADER_SIZE || header[0] != 'B' || header[1] != 'M' ||
+      infoSize < BMP_INFO_HEADER_SIZE || ReadLE16(info + 12) != 1 || width <= 0 || height == 0 || height == SDL_MIN_SINT32)
+  {
+    SDL_Log("%s is not a BMP file", path);
+    ImageFile_Close(file);
+    return NULL;
+  }
+  file->dataOffset = ReadLE32(header + 10);
+  file->bottomUp = height > 0;
+  file->info.width = width;
+  file->info.height = SDL_abs(height);
+  file->info.bitsPerPixel = bitsPerPixel;
+  file->rowSize = (Uint32)(((Uint64)width * bitsPerPixel + 31) / 32 * 4);
+
+  // BI_RGB 32 bit pixels are BGRA, unless every alpha byte is 0 (checked below, as SDL_LoadBMP does). The masks follow
+  // the 40 byte header, which is inside the larger headers.
+  Uint32 masks[4] = {0x00FF0000, 0x0000FF00, 0x000000FF, bitsPerPixel == 32 && compression == BMP_RGB ? 0xFF000000 : 0};
+  bool supported;
+  if (bitsPerPixel == 32 && (compression == BMP_BITFIELDS || compression == BMP_ALPHABITFIELDS))
+  {
+    for (int i = 0; i < 3; i += 1)
+    {
+      masks[i] = ReadLE32(info + BMP_INFO_HEADER_SIZE + i * 4);
+    }
+    // From BITMAPV3INFOHEADER on the alpha mask is part of the header
+    if (infoSize >= BMP_INFO_HEADER_SIZE + 16 || compression == BMP_ALPHABITFIELDS)
+    {
+      masks[3] = ReadLE32(info + BMP_INFO_HEADER_SIZE + 12);
+    }
+    supported = true;
+  }
+  else
+  {
+    supported = compression == BMP_RGB && (bitsPerPixel == 8 || bitsPerPixel == 24 || bitsPerPixel == 32);
+  }
+  for (int i = 0; i < 4 && supported; i += 1)
+  {
+    int shift = masks[i] == 0 && i == 3 ? 0 : GetMaskShift(masks[i]);
+    supported = shift >= 0;
+    file->shifts[i] = shift;
+  }
+  file->info.hasAlpha = masks[3] != 0;
+  if (!supported)
+  {
+    SDL_Log("%s: %u bit BMPs with compression %u aren't supported, LoadImage reads them", path, bitsPerPixel, compression);
+    ImageFile_Close(file);
+    return NULL;
+  }
+
+  if ((Uint64)file->info.width * file->info.height * 4 > SDL_MAX_UINT32 ||
+      file->dataOffset + (Uint64)file->rowSize * file->info.height > (Uint64)fileSize)
+  {
+    SDL_Log("%s is truncated or too large", path);
+    ImageFile_Close(file);
+    return NULL;
+  }
+  // Plenty of writers leave the fourth byte of BI_RGB pixels 0, those are opaque. Costs a read of the pixels up front,
+  // the page cache keeps them for ImageFile_ReadPixels.
+  if (bitsPerPixel == 32 && compression == BMP_RGB)
+  {
+    file->info.hasAlpha = HasAlphaBytes(file);
+  }
+
+  file->layout = PIXEL_LAYOUT_RGBA32;
+  if (bitsPerPixel == 24)
+  {
+    file->layout = PIXEL_LAYOUT_BGR24;
+  }
+  else if (bitsPerPixel == 32 && file->shifts[0] == 16 && file->shifts[1] == 8 && file->shifts[2] == 0)
+  {
+    if (!file->info.hasAlpha)
+    {
+      file->layout = PIXEL_LAYOUT_BGRX32;
+    }
+    else if (file->shifts[3] == 24)
+    {
+      file->layout = PIXEL_LAYOUT_BGRA32;
+    }
+  }
+
+  if (bitsPerPixel == 8)
+  {
+    // BGRX entries right after the info header, missing ones are opaque black
+    Uint32 colorCount = ReadLE32(info + 32);
+    colorCount = colorCount == 0 ? 256 : SDL_min(colorCount, 256);
+    Uint8 colors[256 * 4];
+    if (SDL_SeekIO(stream, BMP_FILE_HEADER_SIZE + infoSize, SDL_IO_SEEK_SET) < 0 ||
+        SDL_ReadIO(stream, colors, colorCount * 4) != colorCount * 4)
+    {
+      SDL_Log("Failed to read the palette of %s", path);
+      ImageFile_Close(file);
+      return NULL;
+    }
+    for (Uint32 i = 0; i < 256; i += 1)
+    {
+      if (i < colorCount)
+      {
+        file->palette[i][0] = colors[i * 4 + 2];
+        file->palette[i][1] = colors[i * 4 + 1];
+        file->palette[i][2] = colors[i * 4];
+      }
+      file->palette[i][3] = 255;
+    }
+  }
+  return file;
+}
+
+const ImageFileInfo *ImageFile_GetInfo(const ImageFile *file)
+{
+  return &file->info;
+}
+
+void ImageFile_SetConversion(ImageFile *file, PixelConvertFlags flags)
+{
+  file->flags = flags;
+}
+
+// Palette entries are already converted and stored with a single 32 bit write each. Other 32 bit masks are swizzled
+// to RGBA in place in the read buffer, then copied like the layouts PixelConvert has kernels for.
+static void ConvertRow(const ImageFile *file, const Uint8 (*palette)[4], Uint8 *source, Uint8 *destination)
+{
+  Uint32 width = file->info.width;
+  if (file->info.bitsPerPixel == 8)
+  {
+    for (Uint32 x = 0; x < width; x += 1)
+    {
+      SDL_memcpy(destination + x * 4, palette[source[x]], 4);
+    }
+    return;
+  }
+  if (file->layout == PIXEL_LAYOUT_RGBA32)
+  {
+    Uint32 alpha = file->info.hasAlpha ? 0 : 0xFF000000u;
+    for (Uint32 x = 0; x < width; x += 1)
+    {
+      Uint32 pixel = ReadLE32(source + x * 4);
+      Uint32 texel = ((pixel >> file->shifts[0]) & 0xFF) | (((pixel >> file->shifts[1]) & 0xFF) << 8) |
+                     (((pixel >> file->shifts[2]) & 0xFF) << 16) | (((pixel >> file->shifts[3]) & 0xFF) << 24) | alpha;
+      texel = SDL_Swap32LE(texel);
+      SDL_memcpy(source + x * 4, &texel, 4);
+    }
+  }
+  PixelConvert_Row(file->layout, file->flags, source, destination, width);
+}
+
+bool ImageFile_ReadPixels(ImageFile *file, void *destination, Uint32 pitch)
+{
+  Uint32 height = file->info.height;
+  Uint8 palette[256][4];
+  if (file->info.bitsPerPixel == 8)
+  {
+    PixelConvert_Row(PIXEL_LAYOUT_RGBA32, file->flags, file->palette, palette, 256);
+  }
+  Uint32 rowsPerChunk = SDL_clamp(IMAGE_READ_CHUNK_SIZE / file->rowSize, 1, height);
+  Uint8 *chunk = SDL_malloc((size_t)file->rowSize * rowsPerChunk);
+  if (chunk == NULL)
+  {
+    return false;
+  }
+  bool ok = SDL_SeekIO(file->stream, file->dataOffset, SDL_IO_SEEK_SET) >= 0;
+  for (Uint32 row = 0; row < height && ok; row += rowsPerChunk)
+  {
+    Uint32 rowCount = SDL_min(rowsPerChunk, height - row);
+    size_t size = (size_t)file->rowSize * rowCount;
+    // Bottom-up files store the last row first, their chunks are read back to front so the destination is still
+    // written front to back
+    if (file->bottomUp)
+    {
+      ok = SDL_SeekIO(file->stream, file->dataOffset + (Sint64)file->rowSize * (height - row - rowCount), SDL_IO_SEEK_SET) >= 0;
+    }
+    ok = ok && SDL_ReadIO(file->stream, chunk, size) == size;
+    for (Uint32 i = 0; i < rowCount && ok; i += 1)
+    {
+      Uint32 sourceRow = file->bottomUp ? rowCount - 1 - i : i;
+      ConvertRow(file, palette, chunk + (size_t)sourceRow * file->rowSize, (Uint8 *)destination + (size_t)(row + i) * pitch);
+    }
+  }
+  if (!ok)
+  {
+    SDL_Log("Failed to read the pixels: %s", SDL_GetError());
+  }
+  SDL_free(chunk);
+  return ok;
+}
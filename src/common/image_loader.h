@@ -0,0 +1,36 @@
+#ifndef IMAGE_LOADER_H_
+#define IMAGE_LOADER_H_
+#include <SDL3/SDL.h>
+#include "pixel_convert.h"
+
+// Uncompressed BMP images read straight into their destination, usually mapped transfer memory from
+// UploadRing_AllocateTextureUpload. LoadImage goes through SDL_LoadBMP's surface, a converted copy of it and a memcpy
+// into the transfer buffer; ImageFile_Open only reads the header, and ImageFile_ReadPixels reads the pixel data once,
+// a few rows at a time into a small buffer, and converts each row into its place in the destination.
+//
+// Reads 8 bit palettized, 24 bit BGR and 32 bit images with 8 bit channel masks (BI_RGB, BI_BITFIELDS or BI_ALPHABITFIELDS),
+// top-down or bottom-up. Others are left to LoadImage. 24 bit, BGRA and BGRX rows go through PixelConvert's SIMD kernels.
+// As with SDL_LoadBMP, BI_RGB 32 bit pixels are BGRA unless every alpha byte is 0, then they are opaque BGRX.
+typedef struct ImageFile ImageFile;
+
+// Rows are read about this many bytes at a time, at least one row: the only memory ImageFile_ReadPixels allocates,
+// small enough to stay in the cache while it's converted
+#define IMAGE_READ_CHUNK_SIZE (64 * 1024)
+
+typedef struct ImageFileInfo
+{
+  Uint32 width;
+  Uint32 height;
+  Uint32 bitsPerPixel; // in the file, the pixels are always written as ABGR8888
+  bool hasAlpha;       // false writes 255
+} ImageFileInfo;
+
+ImageFile *ImageFile_Open(const char *path);
+void ImageFile_Close(ImageFile *file);
+const ImageFileInfo *ImageFile_GetInfo(const ImageFile *file);
+// Premultiplied alpha and sRGB <-> linear applied to the pixels as ImageFile_ReadPixels writes them, none by default
+void ImageFile_SetConversion(ImageFile *file, PixelConvertFlags flags);
+// Writes the image as SDL_PIXELFORMAT_ABGR8888 (R8G8B8A8 in memory) rows pitch bytes apart, top row first.
+// Rows are only ever written front to back, never read, so destination can be write-combined memory.
+bool ImageFile_ReadPixels(ImageFile *file, void *destination, Uint32 pitch);
+#endif // IMAGE_LOADER_H_
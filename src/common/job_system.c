@@ -0,0 +1,499 @@
+#include <SDL3/SDL.h>
+#include "job_system.h"
+#include "trace.h"
+
+// Jobs in flight per thread: both the deque and the pool of jobs it hands out. A thread whose deque or pool is full runs the job itself.
+#define JOB_QUEUE_SIZE 4096
+#define JOB_QUEUE_MASK (JOB_QUEUE_SIZE - 1)
+// A waiting thread that finds nothing to run spins this many times before it starts yielding its core
+#define WAIT_SPINS 64
+
+typedef struct Job
+{
+  JobFunction function;
+  // Set instead of function for JobSystem_ParallelFor ranges
+  JobRangeFunction rangeFunction;
+  void *userdata;
+  Uint32 first;
+  Uint32 count;
+  Uint32 batchSize;
+  JobCounter *counter;
+  // Next continuation of the same counter
+  struct Job *next;
+  // Set from allocation until the job finished, a busy slot isn't handed out again
+  SDL_AtomicInt busy;
+} Job;
+
+// Chase-Lev deque: the owner pushes and pops at bottom, thieves take from top. Indices only grow, slots wrap.
+typedef struct JobQueue
+{
+  SDL_AtomicU32 top;
+  SDL_AtomicU32 bottom;
+  void *slots[JOB_QUEUE_SIZE];
+  Uint32 index;
+  // Only used by the owner
+  Job *pool;
+  Uint32 nextJob;
+} JobQueue;
+
+typedef struct JobWorker
+{
+  JobSystem *system;
+  SDL_Thread *thread;
+  JobQueue *queue;
+} JobWorker;
+
+struct JobSystem
+{
+  // queues[0] belongs to the creating thread, queues[1...] to the workers
+  JobQueue *queues;
+  Uint32 queueCount;
+  JobWorker *workers;
+  Uint32 workerCount;
+  SDL_TLSID queueSlot;
+
+  // Threads without a queue of their own share this one, their owner side operations hold sharedLock
+  JobQueue shared;
+  SDL_Mutex *sharedLock;
+
+  // Workers that found nothing to do wait on wake, submitters only signal it while someone sleeps
+  SDL_Semaphore *wake;
+  SDL_AtomicInt sleeping;
+  SDL_AtomicInt quit;
+};
+
+static bool PushJob(JobQueue *queue, Job *job)
+{
+  Uint32 bottom = SDL_GetAtomicU32(&queue->bottom);
+  Uint32 top = SDL_GetAtomicU32(&queue->top);
+  if ((Sint32)(bottom - top) >= JOB_QUEUE_SIZE)
+  {
+    return false;
+  }
+  SDL_SetAtomicPointer(&queue->slots[bottom & JOB_QUEUE_MASK], job);
+  SDL_SetAtomicU32(&queue->bottom, bottom + 1);
+  return true;
+}
+
+static Job *PopJob(JobQueue *queue)
+{
+  // Claim the bottom slot before looking at top. SDL_SetAtomicU32 is a full barrier, so a thief can't miss the claim.
+  Uint32 bottom = SDL_GetAtomicU32(&queue->bottom) - 1;
+  SDL_SetAtomicU32(&queue->bottom, bottom);
+  Uint32 top = SDL_GetAtomicU32(&queue->top);
+  if ((Sint32)(bottom - top) < 0)
+  {
+    SDL_SetAtomicU32(&queue->bottom, top);
+    return NULL;
+  }
+  Job *job = SDL_GetAtomicPointer(&queue->slots[bottom & JOB_QUEUE_MASK]);
+  if (bottom != top)
+  {
+    return job;
+  }
+  // The last job, a thief may be taking it at the same time
+  if (!SDL_CompareAndSwapAtomicU32(&queue->top, top, top + 1))
+  {
+    job = NULL;
+  }
+  SDL_SetAtomicU32(&queue->bottom, top + 1);
+  return job;
+}
+
+static Job *StealJob(JobQueue *queue)
+{
+  Uint32 top = SDL_GetAtomicU32(&queue->top);
+  Uint32 bottom = SDL_GetAtomicU32(&queue->bottom);
+  if ((Sint32)(bottom - top) <= 0)
+  {
+    return NULL;
+  }
+  Job *job = SDL_GetAtomicPointer(&queue->slots[top & JOB_QUEUE_MASK]);
+  if (!SDL_CompareAndSwapAtomicU32(&queue->top, top, top + 1))
+  {
+    return NULL;
+  }
+  return job;
+}
+
+static bool InitQueue(JobQueue *queue, Uint32 index)
+{
+  queue->index = index;
+  queue->pool = SDL_calloc(JOB_QUEUE_SIZE, sizeof(Job));
+  return queue->pool != NULL;
+}
+
+// The calling thread's queue, locked if it's the shared one
+static JobQueue *LockLocalQueue(JobSystem *system)
+{
+  JobQueue *queue = SDL_GetTLS(&system->queueSlot);
+  if (queue != NULL)
+  {
+    return queue;
+  }
+  SDL_LockMutex(system->sharedLock);
+  return &system->shared;
+}
+
+static void UnlockLocalQueue(JobSystem *system, JobQueue *queue)
+{
+  if (queue == &system->shared)
+  {
+    SDL_UnlockMutex(system->sharedLock);
+  }
+}
+
+// NULL when the calling thread has too many jobs in flight, the caller then runs the work itself
+static Job *NewJob(JobSystem *system)
+{
+  JobQueue *queue = LockLocalQueue(system);
+  Job *job = &queue->pool[queue->nextJob & JOB_QUEUE_MASK];
+  if (SDL_GetAtomicInt(&job->busy))
+  {
+    job = NULL;
+  }
+  else
+  {
+    queue->nextJob += 1;
+    SDL_SetAtomicInt(&job->busy, 1);
+  }
+  UnlockLocalQueue(system, queue);
+  if (job != NULL)
+  {
+    job->function = NULL;
+    job->rangeFunction = NULL;
+    job->counter = NULL;
+    job->next = NULL;
+  }
+  return job;
+}
+
+static void ExecuteJob(JobSystem *system, Job *job);
+
+static void SubmitJob(JobSystem *system, Job *job)
+{
+  JobQueue *queue = LockLocalQueue(system);
+  bool pushed = PushJob(queue, job);
+  UnlockLocalQueue(system, queue);
+  if (!pushed)
+  {
+    ExecuteJob(system, job);
+    return;
+  }
+  if (SDL_GetAtomicInt(&system->sleeping) > 0)
+  {
+    SDL_SignalSemaphore(system->wake);
+  }
+}
+
+static void AddToCounter(JobCounter *counter)
+{
+  if (counter != NULL)
+  {
+    SDL_AddAtomicInt(&counter->pending, 1);
+  }
+}
+
+static void FinishCounter(JobSystem *system, JobCounter *counter)
+{
+  // Decremented under the lock: JobSystem_Wait takes it once more before returning, so the counter outlives this function
+  SDL_LockSpinlock(&counter->lock);
+  Job *ready = NULL;
+  if (SDL_AddAtomicInt(&counter->pending, -1) == 1)
+  {
+    ready = counter->continuations;
+    counter->continuations = NULL;
+  }
+  SDL_UnlockSpinlock(&counter->lock);
+  while (ready != NULL)
+  {
+    Job *next = ready->next;
+    SubmitJob(system, ready);
+    ready = next;
+  }
+}
+
+static void ExecuteJob(JobSystem *system, Job *job)
+{
+  JobCounter *counter = job->counter;
+  if (job->rangeFunction != NULL)
+  {
+    // Keep the lower half and offer the upper half to idle threads, until only one batch is left
+    while (job->count > job->batchSize)
+    {
+      Uint32 half = (job->count + job->batchSize - 1) / job->batchSize / 2 * job->batchSize;
+      Job *split = NewJob(system);
+      if (split == NULL)
+      {
+        break;
+      }
+      split->rangeFunction = job->rangeFunction;
+      split->userdata = job->userdata;
+      split->first = job->first + half;
+      split->count = job->count - half;
+      split->batchSize = job->batchSize;
+      split->counter = counter;
+      AddToCounter(counter);
+      job->count = half;
+      SubmitJob(system, split);
+    }
+    job->rangeFunction(job->userdata, job->first, job->count);
+  }
+  else
+  {
+    job->function(job->userdata);
+  }
+  SDL_SetAtomicInt(&job->busy, 0);
+  if (counter != NULL)
+  {
+    FinishCounter(system, counter);
+  }
+}
+
+// Own jobs newest first, then the oldest job of any other thread
+static Job *FindJob(JobSystem *system, JobQueue *own)
+{
+  if (own != NULL)
+  {
+    Job *job = PopJob(own);
+    if (job != NULL)
+    {
+      return job;
+    }
+  }
+  Uint32 start = own != NULL ? own->index + 1 : 0;
+  for (Uint32 i = 0; i < system->queueCount; i += 1)
+  {
+    JobQueue *victim = &system->queues[(start + i) % system->queueCount];
+    if (victim != own)
+    {
+      Job *job = StealJob(victim);
+      if (job != NULL)
+      {
+        return job;
+      }
+    }
+  }
+  return StealJob(&system->shared);
+}
+
+static int SDLCALL WorkerThread(void *data)
+{
+  JobWorker *worker = data;
+  JobSystem *system = worker->system;
+  SDL_SetTLS(&system->queueSlot, worker->queue, NULL);
+  TRACE_THREAD("job worker");
+  while (!SDL_GetAtomicInt(&system->quit))
+  {
+    Job *job = FindJob(system, worker->queue);
+    if (job == NULL)
+    {
+      // Announce the sleep before the last look, so a job submitted in between either is found or signals wake
+      SDL_AddAtomicInt(&system->sleeping, 1);
+      job = FindJob(system, worker->queue);
+      if (job == NULL && !SDL_GetAtomicInt(&system->quit))
+      {
+        TRACE_BEGIN("sleep");
+        SDL_WaitSemaphore(system->wake);
+        TRACE_END();
+      }
+      SDL_AddAtomicInt(&system->sleeping, -1);
+    }
+    if (job != NULL)
+    {
+      ExecuteJob(system, job);
+    }
+  }
+  return 0;
+}
+
+JobSystem *JobSystem_Create(Uint32 threadCount)
+{
+  JobSystem *system = SDL_calloc(1, sizeof(JobSystem));
+  if (system == NULL)
+  {
+    return NULL;
+  }
+  system->queues = SDL_calloc(threadCount + 1, sizeof(JobQueue));
+  system->workers = SDL_calloc(SDL_max(threadCount, 1), sizeof(JobWorker));
+  system->sharedLock = SDL_CreateMutex();
+  system->wake = SDL_CreateSemaphore(0);
+  if (system->queues == NULL || system->workers == NULL || system->sharedLock == NULL || system->wake == NULL ||
+      !InitQueue(&system->shared, threadCount + 1))
+  {
+    JobSystem_Destroy(system);
+    return NULL;
+  }
+  // Every queue exists before the first worker starts stealing, the queues of workers that fail to start just stay empty
+  system->queueCount = threadCount + 1;
+  for (Uint32 i = 0; i < system->queueCount; i += 1)
+  {
+    if (!InitQueue(&system->queues[i], i))
+    {
+      JobSystem_Destroy(system);
+      return NULL;
+    }
+  }
+  SDL_SetTLS(&system->queueSlot, &system->queues[0], NULL);
+
+  for (Uint32 i = 0; i < threadCount; i += 1)
+  {
+    JobWorker *worker = &system->workers[i];
+    worker->system = system;
+    worker->queue = &system->queues[i + 1];
+    worker->thread = SDL_CreateThread(WorkerThread, "JobWorker", worker);
+    if (worker->thread == NULL)
+    {
+      break;
+    }
+    system->workerCount += 1;
+  }
+  // Fewer workers only means less parallelism
+  if (system->workerCount < threadCount)
+  {
+    SDL_Log("Only started %u of %u job worker threads: %s", system->workerCount, threadCount, SDL_GetError());
+  }
+  return system;
+}
+
+void JobSystem_Destroy(JobSystem *jobs)
+{
+  if (jobs == NULL)
+  {
+    return;
+  }
+  SDL_SetAtomicInt(&jobs->quit, 1);
+  for (Uint32 i = 0; i < jobs->workerCount; i += 1)
+  {
+    SDL_SignalSemaphore(jobs->wake);
+  }
+  for (Uint32 i = 0; i < jobs->workerCount; i += 1)
+  {
+    SDL_WaitThread(jobs->workers[i].thread, NULL);
+  }
+  if (jobs->queues != NULL)
+  {
+    for (Uint32 i = 0; i < jobs->queueCount; i += 1)
+    {
+      SDL_free(jobs->queues[i].pool);
+    }
+    // The creating thread keeps no pointer into freed memory
+    if (SDL_GetTLS(&jobs->queueSlot) == &jobs->queues[0])
+    {
+      SDL_SetTLS(&jobs->queueSlot, NULL, NULL);
+    }
+  }
+  SDL_free(jobs->shared.pool);
+  SDL_free(jobs->queues);
+  SDL_free(jobs->workers);
+  if (jobs->wake != NULL)
+  {
+    SDL_DestroySemaphore(jobs->wake);
+  }
+  if (jobs->sharedLock != NULL)
+  {
+    SDL_DestroyMutex(jobs->sharedLock);
+  }
+  SDL_free(jobs);
+}
+
+Uint32 JobSystem_GetThreadCount(JobSystem *jobs)
+{
+  return jobs->workerCount + 1;
+}
+
+void JobSystem_Run(JobSystem *jobs, JobFunction function, void *userdata, JobCounter *counter)
+{
+  Job *job = jobs != NULL ? NewJob(jobs) : NULL;
+  if (job == NULL)
+  {
+    function(userdata);
+    return;
+  }
+  job->function = function;
+  job->userdata = userdata;
+  job->counter = counter;
+  AddToCounter(counter);
+  SubmitJob(jobs, job);
+}
+
+void JobSystem_RunAfter(JobSystem *jobs, JobCounter *dependency, JobFunction function, void *userdata, JobCounter *counter)
+{
+  Job *job = jobs != NULL ? NewJob(jobs) : NULL;
+  if (job == NULL)
+  {
+    JobSystem_Wait(jobs, dependency);
+    function(userdata);
+    return;
+  }
+  job->function = function;
+  job->userdata = userdata;
+  job->counter = counter;
+  AddToCounter(counter);
+
+  SDL_LockSpinlock(&dependency->lock);
+  if (SDL_GetAtomicInt(&dependency->pending) != 0)
+  {
+    job->next = dependency->continuations;
+    dependency->continuations = job;
+    SDL_UnlockSpinlock(&dependency->lock);
+    return;
+  }
+  SDL_UnlockSpinlock(&dependency->lock);
+  SubmitJob(jobs, job);
+}
+
+void JobSystem_ParallelFor(JobSystem *jobs, Uint32 count, Uint32 batchSize, JobRangeFunction function, void *userdata, JobCounter *counter)
+{
+  if (count == 0)
+  {
+    return;
+  }
+  Job *job = jobs != NULL ? NewJob(jobs) : NULL;
+  if (job == NULL)
+  {
+    function(userdata, 0, count);
+    return;
+  }
+  // One job for the whole range, whoever runs it splits it
+  job->rangeFunction = function;
+  job->userdata = userdata;
+  job->first = 0;
+  job->count = count;
+  job->batchSize = SDL_max(batchSize, 1);
+  job->counter = counter;
+  AddToCounter(counter);
+  SubmitJob(jobs, job);
+}
+
+void JobSystem_Wait(JobSystem *jobs, JobCounter *counter)
+{
+  if (jobs == NULL || counter == NULL)
+  {
+    return;
+  }
+  JobQueue *own = SDL_GetTLS(&jobs->queueSlot);
+  Uint32 idleSpins = 0;
+  while (SDL_GetAtomicInt(&counter->pending) != 0)
+  {
+    Job *job = FindJob(jobs, own);
+    if (job != NULL)
+    {
+      ExecuteJob(jobs, job);
+      idleSpins = 0;
+    }
+    else if (idleSpins < WAIT_SPINS)
+    {
+      SDL_CPUPauseInstruction();
+      idleSpins += 1;
+    }
+    else
+    {
+      // The remaining jobs are running elsewhere
+      SDL_DelayNS(0);
+    }
+  }
+  // The last FinishCounter may still hold the lock
+  SDL_LockSpinlock(&counter->lock);
+  SDL_UnlockSpinlock(&counter->lock);
+}
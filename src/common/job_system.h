@@ -0,0 +1,42 @@
+#ifndef JOB_SYSTEM_H_
+#define JOB_SYSTEM_H_
+#include <SDL3/SDL.h>
+
+// A small work-stealing job scheduler. Every thread that runs jobs owns a Chase-Lev deque: it pushes and pops its own jobs at the
+// bottom without locks while idle threads steal from the top of the others. The thread that created the system is one of them,
+// it runs jobs while it waits in JobSystem_Wait. Other threads may submit too, their jobs go through one shared locked queue.
+//
+// Jobs are tracked with counters: every job started with a counter adds one to it and subtracts one once it finished,
+// JobSystem_Wait runs jobs until the counter is back to zero and JobSystem_RunAfter starts a job once a counter reaches zero.
+typedef struct JobSystem JobSystem;
+
+typedef void(SDLCALL *JobFunction)(void *userdata);
+// Called with a subrange of a JobSystem_ParallelFor range
+typedef void(SDLCALL *JobRangeFunction)(void *userdata, Uint32 first, Uint32 count);
+
+struct Job;
+// Zero initialize, then pass to as many jobs as should be waited on together. Must outlive its jobs.
+typedef struct JobCounter
+{
+  SDL_AtomicInt pending;
+  // Jobs started by JobSystem_RunAfter once pending reaches zero
+  SDL_SpinLock lock;
+  struct Job *continuations;
+} JobCounter;
+
+// threadCount worker threads are started now and sleep while there is nothing to do, 0 runs every job on the thread that waits for it
+JobSystem *JobSystem_Create(Uint32 threadCount);
+// Stops the workers, wait for every job first
+void JobSystem_Destroy(JobSystem *jobs);
+// The workers plus the creating thread
+Uint32 JobSystem_GetThreadCount(JobSystem *jobs);
+
+// counter can be NULL for a job nobody waits for. jobs can be NULL, the job then runs right away on the calling thread.
+void JobSystem_Run(JobSystem *jobs, JobFunction function, void *userdata, JobCounter *counter);
+// Runs function once dependency reaches zero, right away if it already is. counter tracks the new job from now on.
+void JobSystem_RunAfter(JobSystem *jobs, JobCounter *dependency, JobFunction function, void *userdata, JobCounter *counter);
+// Calls function over [0, count) in ranges of batchSize (the last one shorter), ranges are split off as threads go idle
+void JobSystem_ParallelFor(JobSystem *jobs, Uint32 count, Uint32 batchSize, JobRangeFunction function, void *userdata, JobCounter *counter);
+// Runs jobs until counter is zero
+void JobSystem_Wait(JobSystem *jobs, JobCounter *counter);
+#endif // JOB_SYSTEM_H_
@@ -0,0 +1,574 @@
+#include "linear_algebra.h"
+#include <SDL3/SDL.h>
+// Matrix Math
+
+// One set of kernels per instruction set, the public functions go through the selected one
+typedef struct MatrixKernels
+{
+  LinearAlgebraPath path;
+  void (*multiply)(Matrix4x4 *result, const Matrix4x4 *matrix1, const Matrix4x4 *matrix2);
+  void (*transform)(const Matrix4x4 *matrix, const Vector4 *vectors, Vector4 *results, Uint32 count);
+  void (*lookAt)(Matrix4x4 *result, const Vector3 *cameraPosition, const Vector3 *cameraTarget, const Vector3 *cameraUpVector);
+} MatrixKernels;
+
+// Scalar reference, the SIMD kernels do the same operations in the same order so on x86 they match it bit for bit
+
+static Matrix4x4 ScalarMultiplyValues(Matrix4x4 matrix1, Matrix4x4 matrix2)
+{
+  Matrix4x4 result;
+
+  result.m11 = ((matrix1.m11 * matrix2.m11) +
+                (matrix1.m12 * matrix2.m21) +
+                (matrix1.m13 * matrix2.m31) +
+                (matrix1.m14 * matrix2.m41));
+  result.m12 = ((matrix1.m11 * matrix2.m12) +
+                (matrix1.m12 * matrix2.m22) +
+                (matrix1.m13 * matrix2.m32) +
+                (matrix1.m14 * matrix2.m42));
+  result.m13 = ((matrix1.m11 * matrix2.m13) +
+                (matrix1.m12 * matrix2.m23) +
+                (matrix1.m13 * matrix2.m33) +
+                (matrix1.m14 * matrix2.m43));
+  result.m14 = ((matrix1.m11 * matrix2.m14) +
+                (matrix1.m12 * matrix2.m24) +
+                (matrix1.m13 * matrix2.m34) +
+                (matrix1.m14 * matrix2.m44));
+  result.m21 = ((matrix1.m21 * matrix2.m11) +
+                (matrix1.m22 * matrix2.m21) +
+                (matrix1.m23 * matrix2.m31) +
+                (matrix1.m24 * matrix2.m41));
+  result.m22 = ((matrix1.m21 * matrix2.m12) +
+                (matrix1.m22 * matrix2.m22) +
+                (matrix1.m23 * matrix2.m32) +
+                (matrix1.m24 * matrix2.m42));
+  result.m23 = ((matrix1.m21 * matrix2.m13) +
+                (matrix1.m22 * matrix2.m23) +
+                (matrix1.m23 * matrix2.m33) +
+                (matrix1.m24 * matrix2.m43));
+  result.m24 = ((matrix1.m21 * matrix2.m14) +
+                (matrix1.m22 * matrix2.m24) +
+                (matrix1.m23 * matrix2.m34) +
+                (matrix1.m24 * matrix2.m44));
+  result.m31 = ((matrix1.m31 * matrix2.m11) +
+                (matrix1.m32 * matrix2.m21) +
+                (matrix1.m33 * matrix2.m31) +
+                (matrix1.m34 * matrix2.m41));
+  result.m32 = ((matrix1.m31 * matrix2.m12) +
+                (matrix1.m32 * matrix2.m22) +
+                (matrix1.m33 * matrix2.m32) +
+                (matrix1.m34 * matrix2.m42));
+  result.m33 = ((matrix1.m31 * matrix2.m13) +
+                (matrix1.m32 * matrix2.m23) +
+                (matrix1.m33 * matrix2.m33) +
+                (matrix1.m34 * matrix2.m43));
+  result.m34 = ((matrix1.m31 * matrix2.m14) +
+                (matrix1.m32 * matrix2.m24) +
+                (matrix1.m33 * matrix2.m34) +
+                (matrix1.m34 * matrix2.m44));
+  result.m41 = ((matrix1.m41 * matrix2.m11) +
+                (matrix1.m42 * matrix2.m21) +
+                (matrix1.m43 * matrix2.m31) +
+                (matrix1.m44 * matrix2.m41));
+  result.m42 = ((matrix1.m41 * matrix2.m12) +
+                (matrix1.m42 * matrix2.m22) +
+                (matrix1.m43 * matrix2.m32) +
+                (matrix1.m44 * matrix2.m42));
+  result.m43 = ((matrix1.m41 * matrix2.m13) +
+                (matrix1.m42 * matrix2.m23) +
+                (matrix1.m43 * matrix2.m33) +
+                (matrix1.m44 * matrix2.m43));
+  result.m44 = ((matrix1.m41 * matrix2.m14) +
+                (matrix1.m42 * matrix2.m24) +
+                (matrix1.m43 * matrix2.m34) +
+                (matrix1.m44 * matrix2.m44));
+
+  return result;
+}
+
+static void ScalarMultiply(Matrix4x4 *result, const Matrix4x4 *matrix1, const Matrix4x4 *matrix2)
+{
+  *result = ScalarMultiplyValues(*matrix1, *matrix2);
+}
+
+static void ScalarTransform(const Matrix4x4 *matrix, const Vector4 *vectors, Vector4 *results, Uint32 count)
+{
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    Vector4 vec = vectors[i];
+    results[i] = (Vector4){
+        (vec.x * matrix->m11) + (vec.y * matrix->m21) + (vec.z * matrix->m31) + (vec.w * matrix->m41),
+        (vec.x * matrix->m12) + (vec.y * matrix->m22) + (vec.z * matrix->m32) + (vec.w * matrix->m42),
+        (vec.x * matrix->m13) + (vec.y * matrix->m23) + (vec.z * matrix->m33) + (vec.w * matrix->m43),
+        (vec.x * matrix->m14) + (vec.y * matrix->m24) + (vec.z * matrix->m34) + (vec.w * matrix->m44)};
+  }
+}
+
+static void ScalarLookAt(Matrix4x4 *result, const Vector3 *cameraPosition, const Vector3 *cameraTarget, const Vector3 *cameraUpVector)
+{
+  Vector3 targetToPosition = {
+      cameraPosition->x - cameraTarget->x,
+      cameraPosition->y - cameraTarget->y,
+      cameraPosition->z - cameraTarget->z};
+  Vector3 vectorA = Vector3_Normalize(targetToPosition);
+  Vector3 vectorB = Vector3_Normalize(Vector3_Cross(*cameraUpVector, vectorA));
+  Vector3 vectorC = Vector3_Cross(vectorA, vectorB);
+
+  *result = (Matrix4x4){
+      vectorB.x, vectorC.x, vectorA.x, 0,
+      vectorB.y, vectorC.y, vectorA.y, 0,
+      vectorB.z, vectorC.z, vectorA.z, 0,
+      -Vector3_Dot(vectorB, *cameraPosition), -Vector3_Dot(vectorC, *cameraPosition), -Vector3_Dot(vectorA, *cameraPosition), 1};
+}
+
+static const MatrixKernels ScalarKernels = {LINEAR_ALGEBRA_SCALAR, ScalarMultiply, ScalarTransform, ScalarLookAt};
+
+// The matrices are 16 packed floats, each row of the result is the rows of matrix2 weighted by one row of matrix1.
+// All inputs are loaded before anything is stored, so the result can alias them.
+
+#ifdef SDL_SSE2_INTRINSICS
+static __m128 SDL_TARGETING("sse2") SSE2_CombineRows(__m128 weights, __m128 row0, __m128 row1, __m128 row2, __m128 row3)
+{
+  __m128 result = _mm_mul_ps(_mm_shuffle_ps(weights, weights, _MM_SHUFFLE(0, 0, 0, 0)), row0);
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(weights, weights, _MM_SHUFFLE(1, 1, 1, 1)), row1));
+  result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(weights, weights, _MM_SHUFFLE(2, 2, 2, 2)), row2));
+  return _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(weights, weights, _MM_SHUFFLE(3, 3, 3, 3)), row3));
+}
+
+static void SDL_TARGETING("sse2") SSE2_Multiply(Matrix4x4 *result, const Matrix4x4 *matrix1, const Matrix4x4 *matrix2)
+{
+  const float *a = &matrix1->m11;
+  const float *b = &matrix2->m11;
+  __m128 b0 = _mm_loadu_ps(b);
+  __m128 b1 = _mm_loadu_ps(b + 4);
+  __m128 b2 = _mm_loadu_ps(b + 8);
+  __m128 b3 = _mm_loadu_ps(b + 12);
+  __m128 r0 = SSE2_CombineRows(_mm_loadu_ps(a), b0, b1, b2, b3);
+  __m128 r1 = SSE2_CombineRows(_mm_loadu_ps(a + 4), b0, b1, b2, b3);
+  __m128 r2 = SSE2_CombineRows(_mm_loadu_ps(a + 8), b0, b1, b2, b3);
+  __m128 r3 = SSE2_CombineRows(_mm_loadu_ps(a + 12), b0, b1, b2, b3);
+  float *out = &result->m11;
+  _mm_storeu_ps(out, r0);
+  _mm_storeu_ps(out + 4, r1);
+  _mm_storeu_ps(out + 8, r2);
+  _mm_storeu_ps(out + 12, r3);
+}
+
+static void SDL_TARGETING("sse2") SSE2_Transform(const Matrix4x4 *matrix, const Vector4 *vectors, Vector4 *results, Uint32 count)
+{
+  const float *m = &matrix->m11;
+  __m128 m0 = _mm_loadu_ps(m);
+  __m128 m1 = _mm_loadu_ps(m + 4);
+  __m128 m2 = _mm_loadu_ps(m + 8);
+  __m128 m3 = _mm_loadu_ps(m + 12);
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    _mm_storeu_ps(&results[i].x, SSE2_CombineRows(_mm_loadu_ps(&vectors[i].x), m0, m1, m2, m3));
+  }
+}
+
+// x, y, z in the low lanes, w is 0
+static __m128 SDL_TARGETING("sse2") SSE2_LoadVector3(const Vector3 *vec)
+{
+  return _mm_set_ps(0.0f, vec->z, vec->y, vec->x);
+}
+
+// Summed in the same order as Vector3_Dot, broadcast to every lane
+static __m128 SDL_TARGETING("sse2") SSE2_Dot3(__m128 vecA, __m128 vecB)
+{
+  __m128 products = _mm_mul_ps(vecA, vecB);
+  __m128 sum = _mm_add_ss(products, _mm_shuffle_ps(products, products, _MM_SHUFFLE(1, 1, 1, 1)));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(products, products, _MM_SHUFFLE(2, 2, 2, 2)));
+  return _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+static __m128 SDL_TARGETING("sse2") SSE2_Normalize3(__m128 vec)
+{
+  return _mm_div_ps(vec, _mm_sqrt_ps(SSE2_Dot3(vec, vec)));
+}
+
+static __m128 SDL_TARGETING("sse2") SSE2_Cross3(__m128 vecA, __m128 vecB)
+{
+  __m128 aYZX = _mm_shuffle_ps(vecA, vecA, _MM_SHUFFLE(3, 0, 2, 1));
+  __m128 aZXY = _mm_shuffle_ps(vecA, vecA, _MM_SHUFFLE(3, 1, 0, 2));
+  __m128 bYZX = _mm_shuffle_ps(vecB, vecB, _MM_SHUFFLE(3, 0, 2, 1));
+  __m128 bZXY = _mm_shuffle_ps(vecB, vecB, _MM_SHUFFLE(3, 1, 0, 2));
+  return _mm_sub_ps(_mm_mul_ps(aYZX, bZXY), _mm_mul_ps(aZXY, bYZX));
+}
+
+static void SDL_TARGETING("sse2") SSE2_LookAt(Matrix4x4 *result, const Vector3 *cameraPosition, const Vector3 *cameraTarget, const Vector3 *cameraUpVector)
+{
+  __m128 position = SSE2_LoadVector3(cameraPosition);
+  __m128 vectorA = SSE2_Normalize3(_mm_sub_ps(position, SSE2_LoadVector3(cameraTarget)));
+  __m128 vectorB = SSE2_Normalize3(SSE2_Cross3(SSE2_LoadVector3(cameraUpVector), vectorA));
+  __m128 vectorC = SSE2_Cross3(vectorA, vectorB);
+  __m128 translation = _mm_set_ps(
+      1.0f,
+      -_mm_cvtss_f32(SSE2_Dot3(vectorA, position)),
+      -_mm_cvtss_f32(SSE2_Dot3(vectorC, position)),
+      -_mm_cvtss_f32(SSE2_Dot3(vectorB, position)));
+  // B, C and A are the columns of the rotation
+  __m128 row3 = _mm_setzero_ps();
+  _MM_TRANSPOSE4_PS(vectorB, vectorC, vectorA, row3);
+  float *out = &result->m11;
+  _mm_storeu_ps(out, vectorB);
+  _mm_storeu_ps(out + 4, vectorC);
+  _mm_storeu_ps(out + 8, vectorA);
+  _mm_storeu_ps(out + 12, translation);
+}
+
+static const MatrixKernels SSE2Kernels = {LINEAR_ALGEBRA_SSE2, SSE2_Multiply, SSE2_Transform, SSE2_LookAt};
+#endif
+
+#if defined(SDL_AVX_INTRINSICS) && defined(SDL_SSE2_INTRINSICS)
+// Two rows per 256 bit register, _mm256_permute_ps broadcasts a weight within each 128 bit half
+static __m256 SDL_TARGETING("avx") AVX_CombineRows(__m256 weights, __m256 row0, __m256 row1, __m256 row2, __m256 row3)
+{
+  __m256 result = _mm256_mul_ps(_mm256_permute_ps(weights, _MM_SHUFFLE(0, 0, 0, 0)), row0);
+  result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(weights, _MM_SHUFFLE(1, 1, 1, 1)), row1));
+  result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(weights, _MM_SHUFFLE(2, 2, 2, 2)), row2));
+  return _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(weights, _MM_SHUFFLE(3, 3, 3, 3)), row3));
+}
+
+static __m256 SDL_TARGETING("avx") AVX_LoadRowTwice(const float *row)
+{
+  __m128 half = _mm_loadu_ps(row);
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(half), half, 1);
+}
+
+static void SDL_TARGETING("avx") AVX_Multiply(Matrix4x4 *result, const Matrix4x4 *matrix1, const Matrix4x4 *matrix2)
+{
+  const float *a = &matrix1->m11;
+  const float *b = &matrix2->m11;
+  __m256 b0 = AVX_LoadRowTwice(b);
+  __m256 b1 = AVX_LoadRowTwice(b + 4);
+  __m256 b2 = AVX_LoadRowTwice(b + 8);
+  __m256 b3 = AVX_LoadRowTwice(b + 12);
+  __m256 r01 = AVX_CombineRows(_mm256_loadu_ps(a), b0, b1, b2, b3);
+  __m256 r23 = AVX_CombineRows(_mm256_loadu_ps(a + 8), b0, b1, b2, b3);
+  _mm256_storeu_ps(&result->m11, r01);
+  _mm256_storeu_ps(&result->m31, r23);
+}
+
+static void SDL_TARGETING("avx") AVX_Transform(const Matrix4x4 *matrix, const Vector4 *vectors, Vector4 *results, Uint32 count)
+{
+  const float *m = &matrix->m11;
+  __m256 m0 = AVX_LoadRowTwice(m);
+  __m256 m1 = AVX_LoadRowTwice(m + 4);
+  __m256 m2 = AVX_LoadRowTwice(m + 8);
+  __m256 m3 = AVX_LoadRowTwice(m + 12);
+  Uint32 i = 0;
+  for (; i + 2 <= count; i += 2)
+  {
+    _mm256_storeu_ps(&results[i].x, AVX_CombineRows(_mm256_loadu_ps(&vectors[i].x), m0, m1, m2, m3));
+  }
+  if (i < count)
+  {
+    SSE2_Transform(matrix, vectors + i, results + i, count - i);
+  }
+}
+
+// Look-at works on single 3 component vectors, 256 bit registers don't help it
+static const MatrixKernels AVXKernels = {LINEAR_ALGEBRA_AVX, AVX_Multiply, AVX_Transform, SSE2_LookAt};
+#endif
+
+#ifdef SDL_NEON_INTRINSICS
+static float32x4_t NEON_CombineRows(float32x4_t weights, float32x4_t row0, float32x4_t row1, float32x4_t row2, float32x4_t row3)
+{
+  // Separate multiply and add, vmlaq/vfmaq could fuse them and drift from the scalar reference
+  float32x4_t result = vmulq_n_f32(row0, vgetq_lane_f32(weights, 0));
+  result = vaddq_f32(result, vmulq_n_f32(row1, vgetq_lane_f32(weights, 1)));
+  result = vaddq_f32(result, vmulq_n_f32(row2, vgetq_lane_f32(weights, 2)));
+  return vaddq_f32(result, vmulq_n_f32(row3, vgetq_lane_f32(weights, 3)));
+}
+
+static void NEON_Multiply(Matrix4x4 *result, const Matrix4x4 *matrix1, const Matrix4x4 *matrix2)
+{
+  const float *a = &matrix1->m11;
+  const float *b = &matrix2->m11;
+  float32x4_t b0 = vld1q_f32(b);
+  float32x4_t b1 = vld1q_f32(b + 4);
+  float32x4_t b2 = vld1q_f32(b + 8);
+  float32x4_t b3 = vld1q_f32(b + 12);
+  float32x4_t r0 = NEON_CombineRows(vld1q_f32(a), b0, b1, b2, b3);
+  float32x4_t r1 = NEON_CombineRows(vld1q_f32(a + 4), b0, b1, b2, b3);
+  float32x4_t r2 = NEON_CombineRows(vld1q_f32(a + 8), b0, b1, b2, b3);
+  float32x4_t r3 = NEON_CombineRows(vld1q_f32(a + 12), b0, b1, b2, b3);
+  float *out = &result->m11;
+  vst1q_f32(out, r0);
+  vst1q_f32(out + 4, r1);
+  vst1q_f32(out + 8, r2);
+  vst1q_f32(out + 12, r3);
+}
+
+static void NEON_Transform(const Matrix4x4 *matrix, const Vector4 *vectors, Vector4 *results, Uint32 count)
+{
+  const float *m = &matrix->m11;
+  float32x4_t m0 = vld1q_f32(m);
+  float32x4_t m1 = vld1q_f32(m + 4);
+  float32x4_t m2 = vld1q_f32(m + 8);
+  float32x4_t m3 = vld1q_f32(m + 12);
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    vst1q_f32(&results[i].x, NEON_CombineRows(vld1q_f32(&vectors[i].x), m0, m1, m2, m3));
+  }
+}
+
+// NEON has no cheap 3 lane shuffle for the cross products, look-at stays on the scalar code
+static const MatrixKernels NEONKernels = {LINEAR_ALGEBRA_NEON, NEON_Multiply, NEON_Transform, ScalarLookAt};
+#endif
+
+// Picked on first use, racing threads pick the same table
+static void *Kernels;
+
+static const MatrixKernels *GetKernels(void)
+{
+  const MatrixKernels *kernels = SDL_GetAtomicPointer(&Kernels);
+  if (kernels == NULL)
+  {
+    LinearAlgebra_SetPath(LINEAR_ALGEBRA_AUTO);
+    kernels = SDL_GetAtomicPointer(&Kernels);
+  }
+  return kernels;
+}
+
+static const MatrixKernels *FindKernels(LinearAlgebraPath path)
+{
+  switch (path)
+  {
+  case LINEAR_ALGEBRA_AUTO:
+  {
+    const MatrixKernels *kernels = FindKernels(LINEAR_ALGEBRA_AVX);
+    if (kernels == NULL)
+    {
+      kernels = FindKernels(LINEAR_ALGEBRA_SSE2);
+    }
+    if (kernels == NULL)
+    {
+      kernels = FindKernels(LINEAR_ALGEBRA_NEON);
+    }
+    return kernels != NULL ? kernels : &ScalarKernels;
+  }
+  case LINEAR_ALGEBRA_SCALAR:
+    return &ScalarKernels;
+#if defined(SDL_AVX_INTRINSICS) && defined(SDL_SSE2_INTRINSICS)
+  case LINEAR_ALGEBRA_AVX:
+    return SDL_HasAVX() ? &AVXKernels : NULL;
+#endif
+#ifdef SDL_SSE2_INTRINSICS
+  case LINEAR_ALGEBRA_SSE2:
+    return SDL_HasSSE2() ? &SSE2Kernels : NULL;
+#endif
+#ifdef SDL_NEON_INTRINSICS
+  case LINEAR_ALGEBRA_NEON:
+    return SDL_HasNEON() ? &NEONKernels : NULL;
+#endif
+  default:
+    return NULL;
+  }
+}
+
+bool LinearAlgebra_SetPath(LinearAlgebraPath path)
+{
+  const MatrixKernels *kernels = FindKernels(path);
+  if (kernels == NULL)
+  {
+    SDL_Log("%s matrix kernels aren't available on this CPU or build", LinearAlgebra_GetPathName(path));
+    return false;
+  }
+  SDL_SetAtomicPointer(&Kernels, (void *)kernels);
+  return true;
+}
+
+LinearAlgebraPath LinearAlgebra_GetPath(void)
+{
+  return GetKernels()->path;
+}
+
+const char *LinearAlgebra_GetPathName(LinearAlgebraPath path)
+{
+  switch (path)
+  {
+  case LINEAR_ALGEBRA_AUTO:
+    return "auto";
+  case LINEAR_ALGEBRA_SCALAR:
+    return "scalar";
+  case LINEAR_ALGEBRA_SSE2:
+    return "SSE2";
+  case LINEAR_ALGEBRA_AVX:
+    return "AVX";
+  case LINEAR_ALGEBRA_NEON:
+    return "NEON";
+  }
+  return "unknown";
+}
+
+// Relative to the value, absolute below 1. The ops match the reference, the slack is for compilers that fuse the scalar multiply-adds.
+#define VALIDATE_TOLERANCE 1e-5f
+
+static float RandomFloat(Uint32 *state, float range)
+{
+  *state = *state * 1664525u + 1013904223u;
+  return ((float)(*state >> 8) / (float)(1 << 24) * 2.0f - 1.0f) * range;
+}
+
+static float CompareFloats(const float *values, const float *reference, Uint32 count, float maxError)
+{
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    float error = SDL_fabsf(values[i] - reference[i]) / SDL_max(SDL_fabsf(reference[i]), 1.0f);
+    maxError = SDL_max(maxError, error);
+  }
+  return maxError;
+}
+
+bool LinearAlgebra_Validate(void)
+{
+  const MatrixKernels *kernels = GetKernels();
+  Uint32 state = 12345;
+  float maxError = 0.0f;
+  for (int round = 0; round < 256; round += 1)
+  {
+    Matrix4x4 matrix1;
+    Matrix4x4 matrix2;
+    float *a = &matrix1.m11;
+    float *b = &matrix2.m11;
+    for (int i = 0; i < 16; i += 1)
+    {
+      a[i] = RandomFloat(&state, 1.0f);
+      b[i] = RandomFloat(&state, 1.0f);
+    }
+    Matrix4x4 result;
+    Matrix4x4 reference;
+    kernels->multiply(&result, &matrix1, &matrix2);
+    ScalarMultiply(&reference, &matrix1, &matrix2);
+    maxError = CompareFloats(&result.m11, &reference.m11, 16, maxError);
+
+    // Odd count so the AVX path runs its tail too
+    Vector4 vectors[7];
+    Vector4 transformed[7];
+    Vector4 transformedReference[7];
+    for (int i = 0; i < 7; i += 1)
+    {
+      vectors[i] = (Vector4){RandomFloat(&state, 10.0f), RandomFloat(&state, 10.0f), RandomFloat(&state, 10.0f), 1.0f};
+    }
+    kernels->transform(&matrix1, vectors, transformed, 7);
+    ScalarTransform(&matrix1, vectors, transformedReference, 7);
+    maxError = CompareFloats(&transformed[0].x, &transformedReference[0].x, 7 * 4, maxError);
+
+    Vector3 position = {RandomFloat(&state, 50.0f), RandomFloat(&state, 50.0f), RandomFloat(&state, 50.0f)};
+    Vector3 target = {RandomFloat(&state, 1.0f), RandomFloat(&state, 1.0f), RandomFloat(&state, 1.0f)};
+    Vector3 up = {0, 1, 0};
+    kernels->lookAt(&result, &position, &target, &up);
+    ScalarLookAt(&reference, &position, &target, &up);
+    maxError = CompareFloats(&result.m11, &reference.m11, 16, maxError);
+  }
+
+  bool valid = maxError <= VALIDATE_TOLERANCE;
+  SDL_Log("%s matrix kernels: largest relative difference from the scalar reference %g%s",
+          LinearAlgebra_GetPathName(kernels->path),
+          maxError,
+          valid ? "" : ", too large");
+  return valid;
+}
+
+Matrix4x4 Matrix4x4_Multiply(Matrix4x4 matrix1, Matrix4x4 matrix2)
+{
+  Matrix4x4 result;
+  GetKernels()->multiply(&result, &matrix1, &matrix2);
+  return result;
+}
+
+void Matrix4x4_MultiplyTo(Matrix4x4 *result, const Matrix4x4 *matrix1, const Matrix4x4 *matrix2)
+{
+  GetKernels()->multiply(result, matrix1, matrix2);
+}
+
+Vector4 Matrix4x4_Transform(const Matrix4x4 *matrix, Vector4 vec)
+{
+  GetKernels()->transform(matrix, &vec, &vec, 1);
+  return vec;
+}
+
+void Matrix4x4_TransformVectors(const Matrix4x4 *matrix, const Vector4 *vectors, Vector4 *results, Uint32 count)
+{
+  GetKernels()->transform(matrix, vectors, results, count);
+}
+
+Matrix4x4 Matrix4x4_CreateRotationZ(float radians)
+{
+  return (Matrix4x4){
+      SDL_cosf(radians), SDL_sinf(radians), 0, 0,
+      -SDL_sinf(radians), SDL_cosf(radians), 0, 0,
+      0, 0, 1, 0,
+      0, 0, 0, 1};
+}
+
+Matrix4x4 Matrix4x4_CreateTranslation(float x, float y, float z)
+{
+  return (Matrix4x4){
+      1, 0, 0, 0,
+      0, 1, 0, 0,
+      0, 0, 1, 0,
+      x, y, z, 1};
+}
+
+Matrix4x4 Matrix4x4_CreateOrthographicOffCenter(
+    float left,
+    float right,
+    float bottom,
+    float top,
+    float zNearPlane,
+    float zFarPlane)
+{
+  return (Matrix4x4){
+      2.0f / (right - left), 0, 0, 0,
+      0, 2.0f / (top - bottom), 0, 0,
+      0, 0, 1.0f / (zNearPlane - zFarPlane), 0,
+      (left + right) / (left - right), (top + bottom) / (bottom - top), zNearPlane / (zNearPlane - zFarPlane), 1};
+}
+
+Matrix4x4 Matrix4x4_CreatePerspectiveFieldOfView(
+    float fieldOfView,
+    float aspectRatio,
+    float nearPlaneDistance,
+    float farPlaneDistance)
+{
+  float num = 1.0f / ((float)SDL_tanf(fieldOfView * 0.5f));
+  return (Matrix4x4){
+      num / aspectRatio, 0, 0, 0,
+      0, num, 0, 0,
+      0, 0, farPlaneDistance / (nearPlaneDistance - farPlaneDistance), -1,
+      0, 0, (nearPlaneDistance * farPlaneDistance) / (nearPlaneDistance - farPlaneDistance), 0};
+}
+
+Matrix4x4 Matrix4x4_CreateLookAt(
+    Vector3 cameraPosition,
+    Vector3 cameraTarget,
+    Vector3 cameraUpVector)
+{
+  Matrix4x4 result;
+  GetKernels()->lookAt(&result, &cameraPosition, &cameraTarget, &cameraUpVector);
+  return result;
+}
+
+Vector3 Vector3_Normalize(Vector3 vec)
+{
+  float magnitude = SDL_sqrtf((vec.x * vec.x) + (vec.y * vec.y) + (vec.z * vec.z));
+  return (Vector3){
+      vec.x / magnitude,
+      vec.y / magnitude,
+      vec.z / magnitude};
+}
+
+float Vector3_Dot(Vector3 vecA, Vector3 vecB)
+{
+  return (vecA.x * vecB.x) + (vecA.y * vecB.y) + (vecA.z * vecB.z);
+}
+
+Vector3 Vector3_Cross(Vector3 vecA, Vector3 vecB)
+{
+  return (Vector3){
+      vecA.y * vecB.z - vecB.y * vecA.z,
+      -(vecA.x * vecB.z - vecB.x * vecA.z),
+      vecA.x * vecB.y - vecB.x * vecA.y};
+}
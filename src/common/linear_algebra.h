@@ -0,0 +1,60 @@
+#ifndef LINEAR_ALGEBRA_H_
+#define LINEAR_ALGEBRA_H_
+#include <SDL3/SDL.h>
+
+// Matrix Math
+// Row-major matrices used with row vectors (v * M), so Matrix4x4_Multiply(model, viewproj) applies model first.
+//
+// Multiply, the vector transforms and look-at have SSE2, AVX and NEON versions next to the scalar one.
+// The fastest path the CPU supports is picked on first use, the scalar code stays the reference: LinearAlgebra_Validate
+// checks the selected path against it and LinearAlgebra_SetPath(LINEAR_ALGEBRA_SCALAR) forces it.
+typedef struct Matrix4x4
+{
+  float m11, m12, m13, m14;
+  float m21, m22, m23, m24;
+  float m31, m32, m33, m34;
+  float m41, m42, m43, m44;
+} Matrix4x4;
+
+typedef struct Vector3
+{
+  float x, y, z;
+} Vector3;
+
+typedef struct Vector4
+{
+  float x, y, z, w;
+} Vector4;
+
+typedef enum LinearAlgebraPath
+{
+  LINEAR_ALGEBRA_AUTO,
+  LINEAR_ALGEBRA_SCALAR,
+  LINEAR_ALGEBRA_SSE2,
+  LINEAR_ALGEBRA_AVX,
+  LINEAR_ALGEBRA_NEON
+} LinearAlgebraPath;
+
+Matrix4x4 Matrix4x4_Multiply(Matrix4x4 matrix1, Matrix4x4 matrix2);
+// Same as Matrix4x4_Multiply without copying 64 byte structs around, result may alias either input
+void Matrix4x4_MultiplyTo(Matrix4x4 *result, const Matrix4x4 *matrix1, const Matrix4x4 *matrix2);
+Matrix4x4 Matrix4x4_CreateRotationZ(float radians);
+Matrix4x4 Matrix4x4_CreateTranslation(float x, float y, float z);
+Matrix4x4 Matrix4x4_CreateOrthographicOffCenter(float left, float right, float bottom, float top, float zNearPlane, float zFarPlane);
+Matrix4x4 Matrix4x4_CreatePerspectiveFieldOfView(float fieldOfView, float aspectRatio, float nearPlaneDistance, float farPlaneDistance);
+Matrix4x4 Matrix4x4_CreateLookAt(Vector3 cameraPosition, Vector3 cameraTarget, Vector3 cameraUpVector);
+Vector4 Matrix4x4_Transform(const Matrix4x4 *matrix, Vector4 vec);
+// results[i] = vectors[i] * matrix, results may alias vectors
+void Matrix4x4_TransformVectors(const Matrix4x4 *matrix, const Vector4 *vectors, Vector4 *results, Uint32 count);
+Vector3 Vector3_Normalize(Vector3 vec);
+float Vector3_Dot(Vector3 vecA, Vector3 vecB);
+Vector3 Vector3_Cross(Vector3 vecA, Vector3 vecB);
+
+// Returns false, and keeps the current path, if the CPU or the build doesn't have it
+bool LinearAlgebra_SetPath(LinearAlgebraPath path);
+LinearAlgebraPath LinearAlgebra_GetPath(void);
+const char *LinearAlgebra_GetPathName(LinearAlgebraPath path);
+// Runs the selected path and the scalar reference on the same pseudo-random inputs, logs the largest difference
+// and returns false if any result is further than a few ulps from the reference
+bool LinearAlgebra_Validate(void);
+#endif // LINEAR_ALGEBRA_H_
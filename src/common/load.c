@@ -0,0 +1,306 @@
+#include <SDL3/SDL.h>
+#include "load.h"
+#include <stdio.h>
+
+typedef struct ShaderCacheEntry
+{
+  SDL_GPUDevice *device;
+  Uint32 nameHash;
+  char name[128];
+  SDL_GPUShaderStage stage;
+  SDL_GPUShaderFormat format;
+  Uint32 samplerCount;
+  Uint32 uniformBufferCount;
+  Uint32 storageBufferCount;
+  Uint32 storageTextureCount;
+  SDL_GPUShader *shader;
+} ShaderCacheEntry;
+
+static ShaderCacheEntry *ShaderCache;
+static Uint32 ShaderCacheCount;
+static Uint32 ShaderCacheCapacity;
+static ShaderCacheStats ShaderCacheCounters;
+// LoadShader may be called from worker threads, so every access to the cache goes through this lock.
+// It is never held while reading the file or creating the shader.
+static SDL_SpinLock ShaderCacheLock;
+
+static ShaderCacheEntry *FindCachedShader(SDL_GPUDevice *device, Uint32 nameHash, const char *name, SDL_GPUShaderStage stage, SDL_GPUShaderFormat format)
+{
+  for (Uint32 i = 0; i < ShaderCacheCount; i += 1)
+  {
+    ShaderCacheEntry *entry = &ShaderCache[i];
+    if (entry->device == device && entry->nameHash == nameHash && entry->stage == stage && entry->format == format && SDL_strcmp(entry->name, name) == 0)
+    {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+static SDL_GPUShader *UseCachedShader(ShaderCacheEntry *entry, Uint32 samplerCount, Uint32 uniformBufferCount, Uint32 storageBufferCount, Uint32 storageTextureCount)
+{
+  // The same binary with different resource counts would be a bug in the caller, the cached shader was created with the first set
+  if (entry->samplerCount != samplerCount || entry->uniformBufferCount != uniformBufferCount ||
+      entry->storageBufferCount != storageBufferCount || entry->storageTextureCount != storageTextureCount)
+  {
+    SDL_Log("Shader %s was requested with different resource counts than it was cached with!", entry->name);
+  }
+  ShaderCacheCounters.hits += 1;
+  return entry->shader;
+}
+
+// Picks the binary format the device takes and where that binary lives
+static bool FindShaderBinary(SDL_GPUDevice *device, const char *shaderFilename, char *fullPath, size_t fullPathSize, SDL_GPUShaderFormat *format, const char **entrypoint)
+{
+  const char *ShaderBinaryBasePath = "./shader-binaries";
+  SDL_GPUShaderFormat backendFormats = SDL_GetGPUShaderFormats(device);
+
+  if (backendFormats & SDL_GPU_SHADERFORMAT_SPIRV)
+  {
+    SDL_snprintf(fullPath, fullPathSize, "%s/spv/%s.spv", ShaderBinaryBasePath, shaderFilename);
+    *format = SDL_GPU_SHADERFORMAT_SPIRV;
+    *entrypoint = "main";
+  }
+  else if (backendFormats & SDL_GPU_SHADERFORMAT_MSL)
+  {
+    SDL_snprintf(fullPath, fullPathSize, "%s/msl/%s.msl", ShaderBinaryBasePath, shaderFilename);
+    *format = SDL_GPU_SHADERFORMAT_MSL;
+    *entrypoint = "main0";
+  }
+  else if (backendFormats & SDL_GPU_SHADERFORMAT_DXIL)
+  {
+    SDL_snprintf(fullPath, fullPathSize, "%s/dxil/%s.dxil", ShaderBinaryBasePath, shaderFilename);
+    *format = SDL_GPU_SHADERFORMAT_DXIL;
+    *entrypoint = "main";
+  }
+  else
+  {
+    SDL_Log("%s", "Unrecognized backend shader format!");
+    return false;
+  }
+  return true;
+}
+
+SDL_GPUShader *LoadShader(
+    SDL_GPUDevice *device,
+    const char *shaderFilename,
+    Uint32 samplerCount,
+    Uint32 uniformBufferCount,
+    Uint32 storageBufferCount,
+    Uint32 storageTextureCount)
+{
+  // Auto-detect the shader stage from the file name for convenience
+  SDL_GPUShaderStage stage;
+  if (SDL_strstr(shaderFilename, ".vert"))
+  {
+    stage = SDL_GPU_SHADERSTAGE_VERTEX;
+  }
+  else if (SDL_strstr(shaderFilename, ".frag"))
+  {
+    stage = SDL_GPU_SHADERSTAGE_FRAGMENT;
+  }
+  else
+  {
+    SDL_Log("Invalid shader stage!");
+    return NULL;
+  }
+
+  char fullPath[1024];
+  SDL_GPUShaderFormat format;
+  const char *entrypoint;
+  if (!FindShaderBinary(device, shaderFilename, fullPath, sizeof(fullPath), &format, &entrypoint))
+  {
+    return NULL;
+  }
+
+  if (SDL_strlen(shaderFilename) >= sizeof(((ShaderCacheEntry *)NULL)->name))
+  {
+    SDL_Log("Shader name is too long to be cached! %s", shaderFilename);
+    return NULL;
+  }
+
+  Uint32 nameHash = SDL_murmur3_32(shaderFilename, SDL_strlen(shaderFilename), 0);
+  SDL_LockSpinlock(&ShaderCacheLock);
+  ShaderCacheEntry *cached = FindCachedShader(device, nameHash, shaderFilename, stage, format);
+  if (cached != NULL)
+  {
+    SDL_GPUShader *shader = UseCachedShader(cached, samplerCount, uniformBufferCount, storageBufferCount, storageTextureCount);
+    SDL_UnlockSpinlock(&ShaderCacheLock);
+    return shader;
+  }
+  SDL_UnlockSpinlock(&ShaderCacheLock);
+
+  size_t codeSize;
+  void *code = SDL_LoadFile(fullPath, &codeSize);
+  if (code == NULL)
+  {
+    SDL_Log("Failed to load shader from disk! %s", fullPath);
+    return NULL;
+  }
+
+  SDL_GPUShaderCreateInfo shaderInfo = {
+      .code = code,
+      .code_size = codeSize,
+      .entrypoint = entrypoint,
+      .format = format,
+      .stage = stage,
+      .num_samplers = samplerCount,
+      .num_uniform_buffers = uniformBufferCount,
+      .num_storage_buffers = storageBufferCount,
+      .num_storage_textures = storageTextureCount};
+  SDL_GPUShader *shader = SDL_CreateGPUShader(device, &shaderInfo);
+  if (shader == NULL)
+  {
+    SDL_Log("Failed to create shader!");
+    SDL_free(code);
+    return NULL;
+  }
+  SDL_free(code);
+
+  SDL_LockSpinlock(&ShaderCacheLock);
+  // Another thread may have created the same shader while we were loading it, keep theirs
+  cached = FindCachedShader(device, nameHash, shaderFilename, stage, format);
+  if (cached != NULL)
+  {
+    SDL_GPUShader *existing = UseCachedShader(cached, samplerCount, uniformBufferCount, storageBufferCount, storageTextureCount);
+    SDL_UnlockSpinlock(&ShaderCacheLock);
+    SDL_ReleaseGPUShader(device, shader);
+    return existing;
+  }
+
+  if (ShaderCacheCount == ShaderCacheCapacity)
+  {
+    Uint32 newCapacity = ShaderCacheCapacity == 0 ? 16 : ShaderCacheCapacity * 2;
+    ShaderCacheEntry *newCache = SDL_realloc(ShaderCache, sizeof(ShaderCacheEntry) * newCapacity);
+    if (newCache == NULL)
+    {
+      // Callers never release the shaders they get, only ReleaseShaderCache does, so one left out of the cache would leak
+      SDL_UnlockSpinlock(&ShaderCacheLock);
+      SDL_Log("Failed to grow the shader cache!");
+      SDL_ReleaseGPUShader(device, shader);
+      return NULL;
+    }
+    ShaderCache = newCache;
+    ShaderCacheCapacity = newCapacity;
+  }
+
+  ShaderCacheEntry *entry = &ShaderCache[ShaderCacheCount];
+  ShaderCacheCount += 1;
+  entry->device = device;
+  entry->nameHash = nameHash;
+  SDL_strlcpy(entry->name, shaderFilename, sizeof(entry->name));
+  entry->stage = stage;
+  entry->format = format;
+  entry->samplerCount = samplerCount;
+  entry->uniformBufferCount = uniformBufferCount;
+  entry->storageBufferCount = storageBufferCount;
+  entry->storageTextureCount = storageTextureCount;
+  entry->shader = shader;
+  ShaderCacheCounters.misses += 1;
+  SDL_UnlockSpinlock(&ShaderCacheLock);
+
+  return shader;
+}
+
+SDL_GPUComputePipeline *LoadComputePipeline(SDL_GPUDevice *device, const char *shaderFilename, const SDL_GPUComputePipelineCreateInfo *createInfo)
+{
+  char fullPath[1024];
+  SDL_GPUShaderFormat format;
+  const char *entrypoint;
+  if (!FindShaderBinary(device, shaderFilename, fullPath, sizeof(fullPath), &format, &entrypoint))
+  {
+    return NULL;
+  }
+
+  size_t codeSize;
+  void *code = SDL_LoadFile(fullPath, &codeSize);
+  if (code == NULL)
+  {
+    SDL_Log("Failed to load compute shader from disk! %s", fullPath);
+    return NULL;
+  }
+
+  SDL_GPUComputePipelineCreateInfo pipelineInfo = *createInfo;
+  pipelineInfo.code = code;
+  pipelineInfo.code_size = codeSize;
+  pipelineInfo.entrypoint = entrypoint;
+  pipelineInfo.format = format;
+  SDL_GPUComputePipeline *pipeline = SDL_CreateGPUComputePipeline(device, &pipelineInfo);
+  if (pipeline == NULL)
+  {
+    SDL_Log("Failed to create compute pipeline! %s", SDL_GetError());
+  }
+  SDL_free(code);
+  return pipeline;
+}
+
+ShaderCacheStats GetShaderCacheStats(void)
+{
+  SDL_LockSpinlock(&ShaderCacheLock);
+  ShaderCacheStats stats = ShaderCacheCounters;
+  stats.count = ShaderCacheCount;
+  SDL_UnlockSpinlock(&ShaderCacheLock);
+  return stats;
+}
+
+void ReleaseShaderCache(SDL_GPUDevice *device)
+{
+  SDL_LockSpinlock(&ShaderCacheLock);
+  Uint32 kept = 0;
+  for (Uint32 i = 0; i < ShaderCacheCount; i += 1)
+  {
+    if (ShaderCache[i].device == device)
+    {
+      SDL_ReleaseGPUShader(device, ShaderCache[i].shader);
+    }
+    else
+    {
+      ShaderCache[kept] = ShaderCache[i];
+      kept += 1;
+    }
+  }
+  ShaderCacheCount = kept;
+  if (ShaderCacheCount == 0)
+  {
+    SDL_free(ShaderCache);
+    ShaderCache = NULL;
+    ShaderCacheCapacity = 0;
+  }
+  SDL_UnlockSpinlock(&ShaderCacheLock);
+}
+
+SDL_Surface *LoadImage(const char *imageFilename, int desiredChannels)
+{
+  const char *BasePath = "images";
+  char fullPath[256];
+  SDL_Surface *result;
+  SDL_PixelFormat format;
+
+  SDL_snprintf(fullPath, sizeof(fullPath), "%s/%s", BasePath, imageFilename);
+
+  result = SDL_LoadBMP(fullPath);
+  if (result == NULL)
+  {
+    SDL_Log("Failed to load BMP: %s", SDL_GetError());
+    return NULL;
+  }
+
+  if (desiredChannels == 4)
+  {
+    format = SDL_PIXELFORMAT_ABGR8888;
+  }
+  else
+  {
+    SDL_assert(!"Unexpected desiredChannels");
+    SDL_DestroySurface(result);
+    return NULL;
+  }
+  if (result->format != format)
+  {
+    SDL_Surface *next = SDL_ConvertSurface(result, format);
+    SDL_DestroySurface(result);
+    result = next;
+  }
+
+  return result;
+}
\ No newline at end of file
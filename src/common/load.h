@@ -0,0 +1,30 @@
+#ifndef LOAD_SHADER_H_
+#define LOAD_SHADER_H_
+#include <SDL3/SDL.h>
+
+typedef struct ShaderCacheStats
+{
+  Uint32 hits;
+  Uint32 misses;
+  Uint32 count; // unique shaders currently held by the cache
+} ShaderCacheStats;
+
+// Shaders are cached by name, stage and format, so asking for the same shader twice hands back the same SDL_GPUShader.
+// The cache owns every shader it returns: do not call SDL_ReleaseGPUShader on them, call ReleaseShaderCache at shutdown instead.
+SDL_GPUShader *LoadShader(
+    SDL_GPUDevice *device,
+    const char *shaderFilename,
+    Uint32 samplerCount,
+    Uint32 uniformBufferCount,
+    Uint32 storageBufferCount,
+    Uint32 storageTextureCount);
+
+// Compute shaders come with their pipeline, so they are loaded as one. createInfo has the resource counts and thread counts,
+// the code, entry point and format are filled in here. Not cached, release it with SDL_ReleaseGPUComputePipeline.
+SDL_GPUComputePipeline *LoadComputePipeline(SDL_GPUDevice *device, const char *shaderFilename, const SDL_GPUComputePipelineCreateInfo *createInfo);
+
+ShaderCacheStats GetShaderCacheStats(void);
+void ReleaseShaderCache(SDL_GPUDevice *device);
+
+SDL_Surface *LoadImage(const char *imageFilename, int desiredChannels);
+#endif // LOAD_SHADER_H_
@@ -0,0 +1,1403 @@
+#include <SDL3/SDL.h>
+#include <string.h>
+#include "mesh_loader.h"
+
+#if defined(SDL_PLATFORM_WINDOWS)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(SDL_PLATFORM_UNIX) || defined(SDL_PLATFORM_APPLE)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MESH_LOADER_MMAP
+#endif
+
+// Vertices are converted to the layout this many at a time, through a PositionTextureVertex array on the stack
+#define CONVERT_BATCH 256
+// Deeper than any glTF file goes, keeps the recursive JSON parser off the end of the stack
+#define JSON_MAX_DEPTH 64
+
+#define GLB_MAGIC 0x46546C67      // "glTF"
+#define GLB_CHUNK_JSON 0x4E4F534A // "JSON"
+#define GLB_CHUNK_BIN 0x004E4942  // "BIN\0"
+
+#define GLTF_BYTE 5121
+#define GLTF_SHORT 5123
+#define GLTF_UINT 5125
+#define GLTF_FLOAT 5126
+#define GLTF_TRIANGLES 4
+
+typedef struct MappedFile
+{
+  const Uint8 *data;
+  size_t size;
+  void *loaded; // set when the file had to be read instead
+} MappedFile;
+
+// One face corner of an OBJ file: which position and UV it uses, uv is ~0 without one
+typedef struct ObjVertex
+{
+  Uint32 position;
+  Uint32 uv;
+} ObjVertex;
+
+typedef struct GltfBuffer
+{
+  MappedFile file; // empty for the BIN chunk of a .glb, that one is in the .glb's mapping
+  const Uint8 *data;
+  size_t size;
+} GltfBuffer;
+
+// A validated glTF accessor: count elements, stride bytes apart, all inside their buffer
+typedef struct GltfAccessor
+{
+  const Uint8 *data;
+  Uint32 stride;
+  Uint32 count;
+  Uint32 componentType;
+} GltfAccessor;
+
+typedef struct GltfPrimitive
+{
+  GltfAccessor positions;
+  GltfAccessor uvs;     // data is NULL without TEXCOORD_0
+  GltfAccessor indices; // data is NULL for a primitive drawn in vertex order
+  Uint32 baseVertex;
+  Uint32 indexCount;
+} GltfPrimitive;
+
+struct MeshFile
+{
+  MeshFileInfo info;
+  // OBJ files are parsed into these, then unmapped
+  float *positions;
+  float *uvs;
+  ObjVertex *vertices;
+  Uint32 *indices;
+  // glTF vertices and indices are read from the mapped buffers when they are written
+  MappedFile source;
+  GltfBuffer *buffers;
+  Uint32 bufferCount;
+  GltfPrimitive *primitives;
+  Uint32 primitiveCount;
+  // Baked files are used straight from the mapping
+  BakedMeshHeader baked;
+};
+
+static bool MapFile(const char *path, MappedFile *file)
+{
+  SDL_zerop(file);
+#if defined(SDL_PLATFORM_WINDOWS)
+  HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (handle != INVALID_HANDLE_VALUE)
+  {
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(handle, &size) && size.QuadPart > 0)
+    {
+      // The view keeps the mapping alive, neither handle is needed once it exists
+      HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+      if (mapping != NULL)
+      {
+        file->data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        file->size = (size_t)size.QuadPart;
+        CloseHandle(mapping);
+      }
+    }
+    CloseHandle(handle);
+  }
+#elif defined(MESH_LOADER_MMAP)
+  int descriptor = open(path, O_RDONLY);
+  if (descriptor >= 0)
+  {
+    struct stat status;
+    if (fstat(descriptor, &status) == 0 && status.st_size > 0)
+    {
+      void *data = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+      if (data != MAP_FAILED)
+      {
+        // Parsing reads front to back, let the kernel read ahead
+        madvise(data, (size_t)status.st_size, MADV_SEQUENTIAL);
+        file->data = data;
+        file->size = (size_t)status.st_size;
+      }
+    }
+    close(descriptor);
+  }
+#endif
+  if (file->data == NULL)
+  {
+    // Nothing to map with on this platform, or mapping failed
+    file->loaded = SDL_LoadFile(path, &file->size);
+    file->data = file->loaded;
+  }
+  if (file->data == NULL || file->size == 0)
+  {
+    SDL_Log("Failed to open mesh file %s: %s", path, SDL_GetError());
+    SDL_free(file->loaded);
+    SDL_zerop(file);
+    return false;
+  }
+  return true;
+}
+
+static void UnmapFile(MappedFile *file)
+{
+  if (file->loaded != NULL)
+  {
+    SDL_free(file->loaded);
+  }
+#if defined(SDL_PLATFORM_WINDOWS)
+  else if (file->data != NULL)
+  {
+    UnmapViewOfFile(file->data);
+  }
+#elif defined(MESH_LOADER_MMAP)
+  else if (file->data != NULL)
+  {
+    munmap((void *)file->data, file->size);
+  }
+#endif
+  SDL_zerop(file);
+}
+
+static bool IsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+static bool IsDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+static const char *SkipSpaces(const char *cursor, const char *end)
+{
+  while (cursor < end && IsSpace(*cursor))
+  {
+    cursor += 1;
+  }
+  return cursor;
+}
+
+static const char *FindLineEnd(const char *cursor, const char *end)
+{
+  const char *newline = memchr(cursor, '\n', (size_t)(end - cursor));
+  return newline != NULL ? newline : end;
+}
+
+// The line starts with keyword followed by a space
+static bool IsKeyword(const char *line, const char *lineEnd, const char *keyword)
+{
+  size_t length = SDL_strlen(keyword);
+  return (size_t)(lineEnd - line) > length && SDL_memcmp(line, keyword, length) == 0 && IsSpace(line[length]);
+}
+
+static Uint32 CountWords(const char *cursor, const char *end)
+{
+  Uint32 count = 0;
+  while (true)
+  {
+    cursor = SkipSpaces(cursor, end);
+    if (cursor == end)
+    {
+      return count;
+    }
+    count += 1;
+    while (cursor < end && !IsSpace(*cursor))
+    {
+      cursor += 1;
+    }
+  }
+}
+
+// Decimal floats with an optional exponent, without the locale and NUL terminator strtod needs. Returns NULL if there is none.
+static const char *ParseFloat(const char *cursor, const char *end, float *value)
+{
+  static const double PowersOf10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  cursor = SkipSpaces(cursor, end);
+  bool negative = cursor < end && *cursor == '-';
+  if (cursor < end && (*cursor == '-' || *cursor == '+'))
+  {
+    cursor += 1;
+  }
+  Uint64 mantissa = 0;
+  int exponent = 0;
+  bool digits = false;
+  // Digits past what a Uint64 holds only move the exponent, a float keeps far fewer anyway
+  for (; cursor < end && IsDigit(*cursor); cursor += 1)
+  {
+    if (mantissa < 100000000000000000ull)
+    {
+      mantissa = mantissa * 10 + (Uint64)(*cursor - '0');
+    }
+    else
+    {
+      exponent += 1;
+    }
+    digits = true;
+  }
+  if (cursor < end && *cursor == '.')
+  {
+    for (cursor += 1; cursor < end && IsDigit(*cursor); cursor += 1)
+    {
+      if (mantissa < 100000000000000000ull)
+      {
+        mantissa = mantissa * 10 + (Uint64)(*cursor - '0');
+        exponent -= 1;
+      }
+      digits = true;
+    }
+  }
+  if (!digits)
+  {
+    return NULL;
+  }
+  if (cursor < end && (*cursor == 'e' || *cursor == 'E'))
+  {
+    const char *exponentCursor = cursor + 1;
+    bool negativeExponent = exponentCursor < end && *exponentCursor == '-';
+    if (exponentCursor < end && (*exponentCursor == '-' || *exponentCursor == '+'))
+    {
+      exponentCursor += 1;
+    }
+    int written = 0;
+    bool exponentDigits = false;
+    for (; exponentCursor < end && IsDigit(*exponentCursor); exponentCursor += 1)
+    {
+      written = SDL_min(written * 10 + (*exponentCursor - '0'), 1000);
+      exponentDigits = true;
+    }
+    if (exponentDigits)
+    {
+      exponent += negativeExponent ? -written : written;
+      cursor = exponentCursor;
+    }
+  }
+  double result = (double)mantissa;
+  if (exponent < 0)
+  {
+    result = -exponent < (int)SDL_arraysize(PowersOf10) ? result / PowersOf10[-exponent] : result * SDL_pow(10.0, exponent);
+  }
+  else if (exponent > 0)
+  {
+    result = exponent < (int)SDL_arraysize(PowersOf10) ? result * PowersOf10[exponent] : result * SDL_pow(10.0, exponent);
+  }
+  *value = (float)(negative ? -result : result);
+  return cursor;
+}
+
+static const char *ParseInteger(const char *cursor, const char *end, Sint64 *value)
+{
+  bool negative = cursor < end && *cursor == '-';
+  if (negative)
+  {
+    cursor += 1;
+  }
+  if (cursor == end || !IsDigit(*cursor))
+  {
+    return NULL;
+  }
+  Sint64 result = 0;
+  for (; cursor < end && IsDigit(*cursor); cursor += 1)
+  {
+    result = SDL_min(result * 10 + (*cursor - '0'), (Sint64)SDL_MAX_UINT32 + 1);
+  }
+  *value = negative ? -result : result;
+  return cursor;
+}
+
+// 1-based, or negative counting back from the last one read so far. Returns false when it points outside [0, count).
+static bool ResolveObjIndex(Sint64 index, Uint32 readSoFar, Uint32 count, Uint32 *resolved)
+{
+  Sint64 zeroBased = index < 0 ? (Sint64)readSoFar + index : index - 1;
+  if (index == 0 || zeroBased < 0 || zeroBased >= (Sint64)count)
+  {
+    return false;
+  }
+  *resolved = (Uint32)zeroBased;
+  return true;
+}
+
+static Uint32 HashObjVertex(ObjVertex vertex)
+{
+  Uint32 hash = vertex.position * 0x9E3779B1u ^ (vertex.uv + 0x7F4A7C15u) * 0x85EBCA77u;
+  hash ^= hash >> 15;
+  hash *= 0x2C1B3C6Du;
+  hash ^= hash >> 13;
+  return hash;
+}
+
+static void SetBoundsFromPosition(MeshFileInfo *info, const float position[3], bool first)
+{
+  for (int axis = 0; axis < 3; axis += 1)
+  {
+    info->min[axis] = first ? position[axis] : SDL_min(info->min[axis], position[axis]);
+    info->max[axis] = first ? position[axis] : SDL_max(info->max[axis], position[axis]);
+  }
+}
+
+// Two passes over the text: the first counts every array's size, the second parses into them. Corners with the same
+// position and UV become one vertex through an open addressing table of vertex indices, polygons are split into fans.
+static bool OpenObj(MeshFile *file, const char *path, const MappedFile *source)
+{
+  const char *text = (const char *)source->data;
+  const char *end = text + source->size;
+  Uint64 positionCount = 0;
+  Uint64 uvCount = 0;
+  Uint64 cornerCount = 0;
+  Uint64 indexCount = 0;
+  for (const char *line = text; line < end;)
+  {
+    const char *lineEnd = FindLineEnd(line, end);
+    line = SkipSpaces(line, lineEnd);
+    if (IsKeyword(line, lineEnd, "v"))
+    {
+      positionCount += 1;
+    }
+    else if (IsKeyword(line, lineEnd, "vt"))
+    {
+      uvCount += 1;
+    }
+    else if (IsKeyword(line, lineEnd, "f"))
+    {
+      Uint32 corners = CountWords(line + 1, lineEnd);
+      if (corners >= 3)
+      {
+        cornerCount += corners;
+        indexCount += (corners - 2) * 3;
+      }
+    }
+    line = lineEnd < end ? lineEnd + 1 : end;
+  }
+  // The vertex table is twice the corner count, both have to stay well inside 32 bits
+  if (indexCount == 0 || positionCount == 0 || cornerCount > SDL_MAX_UINT32 / 4 || indexCount > SDL_MAX_UINT32 / 4 ||
+      positionCount > SDL_MAX_UINT32 || uvCount > SDL_MAX_UINT32)
+  {
+    SDL_Log("%s: %llu positions and %llu indices is no mesh this loader takes", path, (unsigned long long)positionCount, (unsigned long long)indexCount);
+    return false;
+  }
+
+  Uint32 tableSize = 16;
+  while (tableSize < cornerCount * 2)
+  {
+    tableSize *= 2;
+  }
+  file->positions = SDL_malloc(sizeof(float) * 3 * positionCount);
+  file->uvs = SDL_malloc(sizeof(float) * 2 * SDL_max(uvCount, 1));
+  file->vertices = SDL_malloc(sizeof(ObjVertex) * cornerCount);
+  file->indices = SDL_malloc(sizeof(Uint32) * indexCount);
+  // Vertex index + 1, 0 marks an empty slot
+  Uint32 *table = SDL_calloc(tableSize, sizeof(Uint32));
+  if (file->positions == NULL || file->uvs == NULL || file->vertices == NULL || file->indices == NULL || table == NULL)
+  {
+    SDL_Log("%s: out of memory for %llu indices", path, (unsigned long long)indexCount);
+    SDL_free(table);
+    return false;
+  }
+
+  Uint32 positionsRead = 0;
+  Uint32 uvsRead = 0;
+  Uint32 vertexCount = 0;
+  Uint32 indicesWritten = 0;
+  Uint32 lineNumber = 0;
+  bool ok = true;
+  for (const char *line = text; ok && line < end;)
+  {
+    const char *lineEnd = FindLineEnd(line, end);
+    lineNumber += 1;
+    line = SkipSpaces(line, lineEnd);
+    if (IsKeyword(line, lineEnd, "v"))
+    {
+      float *position = &file->positions[positionsRead * 3];
+      const char *cursor = line + 1;
+      for (int axis = 0; ok && axis < 3; axis += 1)
+      {
+        cursor = ParseFloat(cursor, lineEnd, &position[axis]);
+        ok = cursor != NULL;
+      }
+      positionsRead += 1;
+    }
+    else if (IsKeyword(line, lineEnd, "vt"))
+    {
+      float *uv = &file->uvs[uvsRead * 2];
+      const char *cursor = ParseFloat(line + 2, lineEnd, &uv[0]);
+      // OBJ puts v = 0 at the bottom of the image, the GPU at the top. A missing v is 0.
+      float v = 0.0f;
+      ok = cursor != NULL;
+      if (ok && ParseFloat(cursor, lineEnd, &v) == NULL)
+      {
+        v = 0.0f;
+      }
+      uv[1] = 1.0f - v;
+      uvsRead += 1;
+    }
+    else if (IsKeyword(line, lineEnd, "f") && CountWords(line + 1, lineEnd) >= 3)
+    {
+      const char *cursor = line + 1;
+      Uint32 first = 0;
+      Uint32 previous = 0;
+      for (Uint32 corner = 0; ok; corner += 1)
+      {
+        cursor = SkipSpaces(cursor, lineEnd);
+        if (cursor == lineEnd)
+        {
+          break;
+        }
+        // v, v/vt, v//vn or v/vt/vn. Normals are not read.
+        ObjVertex vertex = {0, ~0u};
+        Sint64 index;
+        cursor = ParseInteger(cursor, lineEnd, &index);
+        ok = cursor != NULL && ResolveObjIndex(index, positionsRead, (Uint32)positionCount, &vertex.position);
+        if (ok && cursor < lineEnd && *cursor == '/')
+        {
+          cursor += 1;
+          if (cursor < lineEnd && *cursor != '/')
+          {
+            cursor = ParseInteger(cursor, lineEnd, &index);
+            ok = cursor != NULL && ResolveObjIndex(index, uvsRead, (Uint32)uvCount, &vertex.uv);
+          }
+          while (ok && cursor < lineEnd && !IsSpace(*cursor))
+          {
+            cursor += 1;
+          }
+        }
+        if (!ok)
+        {
+          break;
+        }
+
+        Uint32 slot = HashObjVertex(vertex) & (tableSize - 1);
+        while (table[slot] != 0)
+        {
+          const ObjVertex *existing = &file->vertices[table[slot] - 1];
+          if (existing->position == vertex.position && existing->uv == vertex.uv)
+          {
+            break;
+          }
+          slot = (slot + 1) & (tableSize - 1);
+        }
+        if (table[slot] == 0)
+        {
+          file->vertices[vertexCount] = vertex;
+          vertexCount += 1;
+          table[slot] = vertexCount;
+        }
+        Uint32 current = table[slot] - 1;
+        if (corner == 0)
+        {
+          first = current;
+        }
+        else if (corner >= 2)
+        {
+          file->indices[indicesWritten] = first;
+          file->indices[indicesWritten + 1] = previous;
+          file->indices[indicesWritten + 2] = current;
+          indicesWritten += 3;
+        }
+        previous = current;
+      }
+    }
+    line = lineEnd < end ? lineEnd + 1 : end;
+  }
+  SDL_free(table);
+  if (!ok)
+  {
+    SDL_Log("%s:%u: malformed line", path, lineNumber);
+    return false;
+  }
+
+  file->info.vertexCount = vertexCount;
+  file->info.indexCount = indicesWritten;
+  file->info.hasUVs = uvCount > 0;
+  for (Uint32 i = 0; i < vertexCount; i += 1)
+  {
+    SetBoundsFromPosition(&file->info, &file->positions[file->vertices[i].position * 3], i == 0);
+  }
+  return true;
+}
+
+typedef enum JsonType
+{
+  JSON_OBJECT,
+  JSON_ARRAY,
+  JSON_STRING,
+  JSON_NUMBER,
+  JSON_LITERAL
+} JsonType;
+
+// A value of the document. Objects have size keys, each key token is followed by its value's tokens.
+// next is the token after this value and everything inside it.
+typedef struct JsonToken
+{
+  JsonType type;
+  Uint32 start;
+  Uint32 end;
+  Uint32 size;
+  Uint32 next;
+} JsonToken;
+
+typedef struct Json
+{
+  const char *text;
+  Uint32 length;
+  Uint32 position;
+  JsonToken *tokens;
+  Uint32 count;
+  Uint32 capacity;
+} Json;
+
+#define JSON_NONE (~0u)
+
+static void JsonSkipSpaces(Json *json)
+{
+  while (json->position < json->length &&
+         (json->text[json->position] == ' ' || json->text[json->position] == '\t' ||
+          json->text[json->position] == '\r' || json->text[json->position] == '\n'))
+  {
+    json->position += 1;
+  }
+}
+
+static Uint32 JsonParseValue(Json *json, int depth)
+{
+  JsonSkipSpaces(json);
+  if (json->position >= json->length || depth > JSON_MAX_DEPTH || json->count == json->capacity)
+  {
+    return JSON_NONE;
+  }
+  Uint32 index = json->count;
+  json->count += 1;
+  JsonToken *token = &json->tokens[index];
+  token->start = json->position;
+  token->size = 0;
+  char c = json->text[json->position];
+  if (c == '{' || c == '[')
+  {
+    bool object = c == '{';
+    char close = object ? '}' : ']';
+    token->type = object ? JSON_OBJECT : JSON_ARRAY;
+    json->position += 1;
+    JsonSkipSpaces(json);
+    if (json->position < json->length && json->text[json->position] == close)
+    {
+      json->position += 1;
+    }
+    else
+    {
+      while (true)
+      {
+        if (object)
+        {
+          Uint32 key = JsonParseValue(json, depth + 1);
+          if (key == JSON_NONE || json->tokens[key].type != JSON_STRING)
+          {
+            return JSON_NONE;
+          }
+          JsonSkipSpaces(json);
+          if (json->position >= json->length || json->text[json->position] != ':')
+          {
+            return JSON_NONE;
+          }
+          json->position += 1;
+        }
+        if (JsonParseValue(json, depth + 1) == JSON_NONE)
+        {
+          return JSON_NONE;
+        }
+        token->size += 1;
+        JsonSkipSpaces(json);
+        if (json->position < json->length && json->text[json->position] == ',')
+        {
+          json->position += 1;
+          continue;
+        }
+        if (json->position < json->length && json->text[json->position] == close)
+        {
+          json->position += 1;
+          break;
+        }
+        return JSON_NONE;
+      }
+    }
+  }
+  else if (c == '"')
+  {
+    // Escapes are skipped over, not decoded: glTF keys and the strings read here never need them
+    token->type = JSON_STRING;
+    json->position += 1;
+    token->start = json->position;
+    while (json->position < json->length && json->text[json->position] != '"')
+    {
+      json->position += json->text[json->position] == '\\' ? 2 : 1;
+    }
+    if (json->position >= json->length)
+    {
+      return JSON_NONE;
+    }
+    token->end = json->position;
+    json->position += 1;
+    token->next = json->count;
+    return index;
+  }
+  else
+  {
+    token->type = c == '-' || IsDigit(c) ? JSON_NUMBER : JSON_LITERAL;
+    while (json->position < json->length && SDL_strchr(",]} \t\r\n", json->text[json->position]) == NULL)
+    {
+      json->position += 1;
+    }
+  }
+  token->end = json->position;
+  token->next = json->count;
+  return index;
+}
+
+static Uint32 JsonFind(const Json *json, Uint32 object, const char *key)
+{
+  if (object == JSON_NONE || json->tokens[object].type != JSON_OBJECT)
+  {
+    return JSON_NONE;
+  }
+  size_t keyLength = SDL_strlen(key);
+  Uint32 child = object + 1;
+  for (Uint32 i = 0; i < json->tokens[object].size; i += 1)
+  {
+    const JsonToken *name = &json->tokens[child];
+    if (name->end - name->start == keyLength && SDL_memcmp(json->text + name->start, key, keyLength) == 0)
+    {
+      return child + 1;
+    }
+    child = json->tokens[child + 1].next;
+  }
+  return JSON_NONE;
+}
+
+static Uint32 JsonAt(const Json *json, Uint32 array, Uint32 index)
+{
+  if (array == JSON_NONE || json->tokens[array].type != JSON_ARRAY || index >= json->tokens[array].size)
+  {
+    return JSON_NONE;
+  }
+  Uint32 child = array + 1;
+  for (Uint32 i = 0; i < index; i += 1)
+  {
+    child = json->tokens[child].next;
+  }
+  return child;
+}
+
+static Uint32 JsonGetSize(const Json *json, Uint32 array)
+{
+  return array != JSON_NONE && json->tokens[array].type == JSON_ARRAY ? json->tokens[array].size : 0;
+}
+
+static bool JsonEquals(const Json *json, Uint32 token, const char *text)
+{
+  size_t length = SDL_strlen(text);
+  return token != JSON_NONE && json->tokens[token].type == JSON_STRING && json->tokens[token].end - json->tokens[token].start == length &&
+         SDL_memcmp(json->text + json->tokens[token].start, text, length) == 0;
+}
+
+// object[key] as an unsigned integer, defaultValue when the key is missing. False when it is there but not one.
+static bool JsonGetUint(const Json *json, Uint32 object, const char *key, Uint32 defaultValue, Uint32 *value)
+{
+  Uint32 token = JsonFind(json, object, key);
+  if (token == JSON_NONE)
+  {
+    *value = defaultValue;
+    return true;
+  }
+  const JsonToken *number = &json->tokens[token];
+  Sint64 parsed;
+  const char *end = json->text + number->end;
+  if (number->type != JSON_NUMBER || ParseInteger(json->text + number->start, end, &parsed) != end || parsed < 0 || parsed > SDL_MAX_UINT32)
+  {
+    return false;
+  }
+  *value = (Uint32)parsed;
+  return true;
+}
+
+static Uint32 GetComponentSize(Uint32 componentType)
+{
+  switch (componentType)
+  {
+  case GLTF_BYTE:
+    return 1;
+  case GLTF_SHORT:
+    return 2;
+  default:
+    return 4;
+  }
+}
+
+// Finds accessor index, checks its type against what the caller can read and that every element is inside its buffer
+static bool ResolveAccessor(
+    const Json *json,
+    Uint32 root,
+    const MeshFile *file,
+    Uint32 index,
+    const char *type,
+    Uint32 componentCount,
+    const Uint32 *componentTypes,
+    Uint32 componentTypeCount,
+    GltfAccessor *accessor)
+{
+  Uint32 token = JsonAt(json, JsonFind(json, root, "accessors"), index);
+  Uint32 viewIndex, accessorOffset, count, componentType;
+  if (token == JSON_NONE || !JsonEquals(json, JsonFind(json, token, "type"), type) || JsonFind(json, token, "sparse") != JSON_NONE ||
+      JsonFind(json, token, "bufferView") == JSON_NONE || !JsonGetUint(json, token, "bufferView", 0, &viewIndex) ||
+      !JsonGetUint(json, token, "byteOffset", 0, &accessorOffset) || !JsonGetUint(json, token, "count", 0, &count) ||
+      !JsonGetUint(json, token, "componentType", 0, &componentType))
+  {
+    SDL_Log("Accessor %u is not a %s this loader reads (sparse and bufferless accessors are not supported)", index, type);
+    return false;
+  }
+  bool known = false;
+  for (Uint32 i = 0; i < componentTypeCount; i += 1)
+  {
+    known = known || componentTypes[i] == componentType;
+  }
+  Uint32 view = JsonAt(json, JsonFind(json, root, "bufferViews"), viewIndex);
+  Uint32 bufferIndex, viewOffset, viewLength, stride;
+  if (!known || view == JSON_NONE || !JsonGetUint(json, view, "buffer", SDL_MAX_UINT32, &bufferIndex) ||
+      !JsonGetUint(json, view, "byteOffset", 0, &viewOffset) || !JsonGetUint(json, view, "byteLength", 0, &viewLength) ||
+      !JsonGetUint(json, view, "byteStride", 0, &stride) || bufferIndex >= file->bufferCount)
+  {
+    SDL_Log("Accessor %u has an unsupported component type %u or a broken buffer view", index, componentType);
+    return false;
+  }
+  Uint32 elementSize = GetComponentSize(componentType) * componentCount;
+  stride = stride == 0 ? elementSize : stride;
+  Uint64 lastByte = count == 0 ? 0 : (Uint64)accessorOffset + (Uint64)stride * (count - 1) + elementSize;
+  if ((Uint64)viewOffset + viewLength > file->buffers[bufferIndex].size || lastByte > viewLength || stride < elementSize)
+  {
+    SDL_Log("Accessor %u reaches outside its buffer", index);
+    return false;
+  }
+  accessor->data = file->buffers[bufferIndex].data + viewOffset + accessorOffset;
+  accessor->stride = stride;
+  accessor->count = count;
+  accessor->componentType = componentType;
+  return true;
+}
+
+// Maps every buffer: the .glb's BIN chunk, or files next to the .gltf. Embedded base64 data URIs are not supported.
+static bool OpenGltfBuffers(MeshFile *file, const Json *json, Uint32 root, const char *path, const Uint8 *binData, size_t binSize)
+{
+  Uint32 buffers = JsonFind(json, root, "buffers");
+  file->bufferCount = JsonGetSize(json, buffers);
+  file->buffers = SDL_calloc(SDL_max(file->bufferCount, 1), sizeof(GltfBuffer));
+  if (file->buffers == NULL)
+  {
+    return false;
+  }
+  const char *slash = SDL_strrchr(path, '/');
+  const char *backslash = SDL_strrchr(path, '\\');
+  const char *separator = slash == NULL || (backslash != NULL && backslash > slash) ? backslash : slash;
+  size_t directoryLength = separator != NULL ? (size_t)(separator - path) + 1 : 0;
+  for (Uint32 i = 0; i < file->bufferCount; i += 1)
+  {
+    Uint32 buffer = JsonAt(json, buffers, i);
+    Uint32 uri = JsonFind(json, buffer, "uri");
+    Uint32 byteLength;
+    if (!JsonGetUint(json, buffer, "byteLength", 0, &byteLength))
+    {
+      SDL_Log("%s: buffer %u has no valid byteLength", path, i);
+      return false;
+    }
+    if (uri == JSON_NONE)
+    {
+      if (i != 0 || binData == NULL)
+      {
+        SDL_Log("%s: buffer %u has no uri and there is no BIN chunk", path, i);
+        return false;
+      }
+      file->buffers[i].data = binData;
+      file->buffers[i].size = binSize;
+    }
+    else
+    {
+      const JsonToken *name = &json->tokens[uri];
+      Uint32 nameLength = name->end - name->start;
+      char bufferPath[1024];
+      if (nameLength >= 5 && SDL_memcmp(json->text + name->start, "data:", 5) == 0)
+      {
+        SDL_Log("%s: embedded buffers are not supported, export with a separate .bin or as .glb", path);
+        return false;
+      }
+      if (directoryLength + nameLength >= sizeof(bufferPath))
+      {
+        SDL_Log("%s: buffer %u's path is too long", path, i);
+        return false;
+      }
+      SDL_memcpy(bufferPath, path, directoryLength);
+      SDL_memcpy(bufferPath + directoryLength, json->text + name->start, nameLength);
+      bufferPath[directoryLength + nameLength] = '\0';
+      if (!MapFile(bufferPath, &file->buffers[i].file))
+      {
+        return false;
+      }
+      file->buffers[i].data = file->buffers[i].file.data;
+      file->buffers[i].size = file->buffers[i].file.size;
+    }
+    if (file->buffers[i].size < byteLength)
+    {
+      SDL_Log("%s: buffer %u is shorter than its byteLength", path, i);
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool OpenGltf(MeshFile *file, const char *path, bool binary)
+{
+  const char *jsonText = (const char *)file->source.data;
+  size_t jsonLength = file->source.size;
+  const Uint8 *binData = NULL;
+  size_t binSize = 0;
+  if (binary)
+  {
+    // 12 byte header, then chunks of a length, a type and the data, the JSON chunk first
+    Uint32 header[5];
+    if (file->source.size < sizeof(header))
+    {
+      SDL_Log("%s: too short for a .glb", path);
+      return false;
+    }
+    SDL_memcpy(header, file->source.data, sizeof(header));
+    Uint32 chunkLength = SDL_Swap32LE(header[3]);
+    if (SDL_Swap32LE(header[0]) != GLB_MAGIC || SDL_Swap32LE(header[1]) != 2 || SDL_Swap32LE(header[4]) != GLB_CHUNK_JSON ||
+        chunkLength > file->source.size - sizeof(header))
+    {
+      SDL_Log("%s: not a glTF 2 binary", path);
+      return false;
+    }
+    jsonText = (const char *)file->source.data + sizeof(header);
+    jsonLength = chunkLength;
+    size_t binOffset = sizeof(header) + chunkLength;
+    if (file->source.size - binOffset >= 8)
+    {
+      Uint32 chunk[2];
+      SDL_memcpy(chunk, file->source.data + binOffset, sizeof(chunk));
+      if (SDL_Swap32LE(chunk[1]) == GLB_CHUNK_BIN && SDL_Swap32LE(chunk[0]) <= file->source.size - binOffset - 8)
+      {
+        binData = file->source.data + binOffset + 8;
+        binSize = SDL_Swap32LE(chunk[0]);
+      }
+    }
+  }
+  if (jsonLength > SDL_MAX_UINT32 / 2)
+  {
+    SDL_Log("%s: JSON too large", path);
+    return false;
+  }
+
+  // Every token takes at least one character and a separator, so half the text bounds them
+  Json json = {jsonText, (Uint32)jsonLength, 0, NULL, 0, (Uint32)jsonLength / 2 + 2};
+  json.tokens = SDL_malloc(sizeof(JsonToken) * json.capacity);
+  if (json.tokens == NULL)
+  {
+    return false;
+  }
+  Uint32 root = JsonParseValue(&json, 0);
+  bool ok = root != JSON_NONE && json.tokens[root].type == JSON_OBJECT;
+  if (!ok)
+  {
+    SDL_Log("%s: malformed JSON", path);
+  }
+  ok = ok && OpenGltfBuffers(file, &json, root, path, binData, binSize);
+
+  // Triangle primitives of every mesh
+  Uint32 meshes = JsonFind(&json, root, "meshes");
+  Uint32 primitiveCount = 0;
+  for (Uint32 m = 0; ok && m < JsonGetSize(&json, meshes); m += 1)
+  {
+    primitiveCount += JsonGetSize(&json, JsonFind(&json, JsonAt(&json, meshes, m), "primitives"));
+  }
+  file->primitives = ok ? SDL_calloc(SDL_max(primitiveCount, 1), sizeof(GltfPrimitive)) : NULL;
+  ok = ok && file->primitives != NULL;
+  static const Uint32 PositionTypes[] = {GLTF_FLOAT};
+  static const Uint32 UVTypes[] = {GLTF_FLOAT, GLTF_BYTE, GLTF_SHORT};
+  static const Uint32 IndexTypes[] = {GLTF_BYTE, GLTF_SHORT, GLTF_UINT};
+  Uint64 vertexCount = 0;
+  Uint64 indexCount = 0;
+  bool hasUVs = false;
+  for (Uint32 m = 0; ok && m < JsonGetSize(&json, meshes); m += 1)
+  {
+    Uint32 primitives = JsonFind(&json, JsonAt(&json, meshes, m), "primitives");
+    for (Uint32 p = 0; ok && p < JsonGetSize(&json, primitives); p += 1)
+    {
+      Uint32 primitiveToken = JsonAt(&json, primitives, p);
+      Uint32 attributes = JsonFind(&json, primitiveToken, "attributes");
+      Uint32 mode, positionIndex, uvIndex, indicesIndex;
+      ok = JsonGetUint(&json, primitiveToken, "mode", GLTF_TRIANGLES, &mode) &&
+           JsonGetUint(&json, attributes, "POSITION", SDL_MAX_UINT32, &positionIndex) &&
+           JsonGetUint(&json, attributes, "TEXCOORD_0", SDL_MAX_UINT32, &uvIndex) &&
+           JsonGetUint(&json, primitiveToken, "indices", SDL_MAX_UINT32, &indicesIndex);
+      if (!ok)
+      {
+        SDL_Log("%s: primitive %u of mesh %u is malformed", path, p, m);
+        break;
+      }
+      if (mode != GLTF_TRIANGLES || positionIndex == SDL_MAX_UINT32)
+      {
+        SDL_Log("%s: skipping primitive %u of mesh %u, only triangle lists with positions are read", path, p, m);
+        continue;
+      }
+      GltfPrimitive *primitive = &file->primitives[file->primitiveCount];
+      ok = ResolveAccessor(&json, root, file, positionIndex, "VEC3", 3, PositionTypes, SDL_arraysize(PositionTypes), &primitive->positions);
+      ok = ok && (uvIndex == SDL_MAX_UINT32 ||
+                  ResolveAccessor(&json, root, file, uvIndex, "VEC2", 2, UVTypes, SDL_arraysize(UVTypes), &primitive->uvs));
+      ok = ok && (indicesIndex == SDL_MAX_UINT32 ||
+                  ResolveAccessor(&json, root, file, indicesIndex, "SCALAR", 1, IndexTypes, SDL_arraysize(IndexTypes), &primitive->indices));
+      if (!ok)
+      {
+        break;
+      }
+      if (primitive->uvs.data != NULL && primitive->uvs.count < primitive->positions.count)
+      {
+        SDL_Log("%s: primitive %u of mesh %u has fewer UVs than positions", path, p, m);
+        ok = false;
+        break;
+      }
+      Uint32 count = primitive->indices.data != NULL ? primitive->indices.count : primitive->positions.count;
+      primitive->indexCount = count - count % 3;
+      primitive->baseVertex = (Uint32)SDL_min(vertexCount, SDL_MAX_UINT32);
+      vertexCount += primitive->positions.count;
+      indexCount += primitive->indexCount;
+      hasUVs = hasUVs || primitive->uvs.data != NULL;
+      file->primitiveCount += 1;
+    }
+  }
+  SDL_free(json.tokens);
+  if (!ok)
+  {
+    return false;
+  }
+  if (vertexCount == 0 || indexCount == 0 || vertexCount > SDL_MAX_UINT32 / 4 || indexCount > SDL_MAX_UINT32 / 4)
+  {
+    SDL_Log("%s: %llu vertices and %llu indices is no mesh this loader takes", path, (unsigned long long)vertexCount, (unsigned long long)indexCount);
+    return false;
+  }
+
+  // Indices are checked here so writing them never has to
+  bool first = true;
+  for (Uint32 p = 0; p < file->primitiveCount; p += 1)
+  {
+    const GltfPrimitive *primitive = &file->primitives[p];
+    for (Uint32 i = 0; i < primitive->positions.count; i += 1)
+    {
+      float position[3];
+      SDL_memcpy(position, primitive->positions.data + (size_t)primitive->positions.stride * i, sizeof(position));
+      SetBoundsFromPosition(&file->info, position, first);
+      first = false;
+    }
+    for (Uint32 i = 0; primitive->indices.data != NULL && i < primitive->indexCount; i += 1)
+    {
+      const Uint8 *element = primitive->indices.data + (size_t)primitive->indices.stride * i;
+      Uint32 index = primitive->indices.componentType == GLTF_BYTE ? element[0] : 0;
+      if (primitive->indices.componentType == GLTF_SHORT)
+      {
+        Uint16 value;
+        SDL_memcpy(&value, element, sizeof(value));
+        index = SDL_Swap16LE(value);
+      }
+      else if (primitive->indices.componentType == GLTF_UINT)
+      {
+        SDL_memcpy(&index, element, sizeof(index));
+        index = SDL_Swap32LE(index);
+      }
+      if (index >= primitive->positions.count)
+      {
+        SDL_Log("%s: primitive %u uses vertex %u of %u", path, p, index, primitive->positions.count);
+        return false;
+      }
+    }
+  }
+  file->info.vertexCount = (Uint32)vertexCount;
+  file->info.indexCount = (Uint32)indexCount;
+  file->info.hasUVs = hasUVs;
+  return true;
+}
+
+// Everything is checked against the file size, nothing inside the blocks is read
+static bool OpenBaked(MeshFile *file, const char *path)
+{
+  BakedMeshHeader *header = &file->baked;
+  if (file->source.size < sizeof(BakedMeshHeader))
+  {
+    SDL_Log("%s: too short for a baked mesh", path);
+    return false;
+  }
+  SDL_memcpy(header, file->source.data, sizeof(BakedMeshHeader));
+  if (header->magic != BAKED_MESH_MAGIC || header->version != BAKED_MESH_VERSION || header->headerSize < sizeof(BakedMeshHeader))
+  {
+    SDL_Log("%s: not a version %u baked mesh, cook it again", path, BAKED_MESH_VERSION);
+    return false;
+  }
+  if (header->positionFormat >= VERTEX_POSITION_FORMAT_COUNT || header->uvFormat >= VERTEX_UV_FORMAT_COUNT ||
+      (header->indexSize != sizeof(Uint16) && header->indexSize != sizeof(Uint32)))
+  {
+    SDL_Log("%s: unknown vertex layout or index size", path);
+    return false;
+  }
+  VertexLayout layout = VertexFormat_GetPositionTextureLayout((VertexPositionFormat)header->positionFormat, (VertexUVFormat)header->uvFormat);
+  Uint64 vertexBytes = (Uint64)header->stride * header->vertexCount;
+  Uint64 indexBytes = (Uint64)header->indexSize * header->indexCount;
+  // The vertex block on its own first, so the sums below can't wrap around with a huge vertexOffset
+  if (header->vertexOffset < header->headerSize || vertexBytes > file->source.size ||
+      header->vertexOffset > file->source.size - vertexBytes)
+  {
+    SDL_Log("%s: vertex block outside of the file", path);
+    return false;
+  }
+  if (header->stride != layout.stride || header->indexOffset != header->vertexOffset + vertexBytes ||
+      header->boundsOffset < header->indexOffset + indexBytes || header->boundsOffset > file->source.size ||
+      file->source.size - header->boundsOffset < sizeof(BakedMeshBounds) || vertexBytes + indexBytes > SDL_MAX_UINT32 ||
+      header->vertexCount == 0 || header->indexCount == 0)
+  {
+    SDL_Log("%s: blocks don't match the header or the file is truncated", path);
+    return false;
+  }
+  BakedMeshBounds bounds;
+  SDL_memcpy(&bounds, file->source.data + header->boundsOffset, sizeof(bounds));
+  file->info.vertexCount = header->vertexCount;
+  file->info.indexCount = header->indexCount;
+  file->info.hasUVs = true;
+  SDL_memcpy(file->info.min, bounds.min, sizeof(bounds.min));
+  SDL_memcpy(file->info.max, bounds.max, sizeof(bounds.max));
+  file->info.baked = true;
+  file->info.bakedLayout = layout;
+  return true;
+}
+
+MeshFile *MeshFile_Open(const char *path)
+{
+  const char *extension = SDL_strrchr(path, '.');
+  bool obj = extension != NULL && SDL_strcasecmp(extension, ".obj") == 0;
+  bool gltf = extension != NULL && SDL_strcasecmp(extension, ".gltf") == 0;
+  bool glb = extension != NULL && SDL_strcasecmp(extension, ".glb") == 0;
+  bool baked = extension != NULL && SDL_strcasecmp(extension, ".mesh") == 0;
+  if (!obj && !gltf && !glb && !baked)
+  {
+    SDL_Log("%s: unknown mesh format, expected .obj, .gltf, .glb or a baked .mesh", path);
+    return NULL;
+  }
+  MeshFile *file = SDL_calloc(1, sizeof(MeshFile));
+  if (file == NULL)
+  {
+    return NULL;
+  }
+  if (!MapFile(path, &file->source))
+  {
+    SDL_free(file);
+    return NULL;
+  }
+  Uint64 start = SDL_GetTicksNS();
+  bool ok = baked ? OpenBaked(file, path) : obj ? OpenObj(file, path, &file->source) : OpenGltf(file, path, glb);
+  if (!ok)
+  {
+    MeshFile_Close(file);
+    return NULL;
+  }
+  if (obj)
+  {
+    // Everything needed was parsed out of it
+    UnmapFile(&file->source);
+  }
+  // Baked files keep the index size they were cooked with
+  bool small = baked ? file->baked.indexSize == sizeof(Uint16) : file->info.vertexCount <= SDL_MAX_UINT16;
+  file->info.indexElementSize = small ? SDL_GPU_INDEXELEMENTSIZE_16BIT : SDL_GPU_INDEXELEMENTSIZE_32BIT;
+  file->info.indexSize = small ? sizeof(Uint16) : sizeof(Uint32);
+  SDL_Log("%s: %u vertices, %u triangles, %u bit indices, scanned in %.1f ms",
+          path, file->info.vertexCount, file->info.indexCount / 3, file->info.indexSize * 8, (SDL_GetTicksNS() - start) / 1e6);
+  return file;
+}
+
+void MeshFile_Close(MeshFile *file)
+{
+  if (file == NULL)
+  {
+    return;
+  }
+  for (Uint32 i = 0; i < file->bufferCount; i += 1)
+  {
+    UnmapFile(&file->buffers[i].file);
+  }
+  UnmapFile(&file->source);
+  SDL_free(file->buffers);
+  SDL_free(file->primitives);
+  SDL_free(file->positions);
+  SDL_free(file->uvs);
+  SDL_free(file->vertices);
+  SDL_free(file->indices);
+  SDL_free(file);
+}
+
+const MeshFileInfo *MeshFile_GetInfo(const MeshFile *file)
+{
+  return &file->info;
+}
+
+static float ReadGltfUV(const GltfAccessor *uvs, Uint32 vertex, int axis)
+{
+  const Uint8 *element = uvs->data + (size_t)uvs->stride * vertex;
+  if (uvs->componentType == GLTF_BYTE)
+  {
+    return element[axis] / 255.0f;
+  }
+  if (uvs->componentType == GLTF_SHORT)
+  {
+    Uint16 value;
+    SDL_memcpy(&value, element + sizeof(Uint16) * axis, sizeof(value));
+    return SDL_Swap16LE(value) / 65535.0f;
+  }
+  float value;
+  SDL_memcpy(&value, element + sizeof(float) * axis, sizeof(value));
+  return value;
+}
+
+void MeshFile_WriteVertices(const MeshFile *file, const VertexLayout *layout, const VertexDequantization *dequantization, void *destination)
+{
+  PositionTextureVertex batch[CONVERT_BATCH];
+  Uint8 *output = destination;
+  if (file->info.baked)
+  {
+    if (layout->positionFormat != file->info.bakedLayout.positionFormat || layout->uvFormat != file->info.bakedLayout.uvFormat)
+    {
+      SDL_Log("A baked mesh can't be converted to another layout, cook it again in that one");
+      return;
+    }
+    SDL_memcpy(destination, file->source.data + file->baked.vertexOffset, (size_t)file->baked.stride * file->baked.vertexCount);
+    return;
+  }
+  if (file->vertices != NULL)
+  {
+    for (Uint32 first = 0; first < file->info.vertexCount; first += CONVERT_BATCH)
+    {
+      Uint32 count = SDL_min(file->info.vertexCount - first, CONVERT_BATCH);
+      for (Uint32 i = 0; i < count; i += 1)
+      {
+        const ObjVertex *vertex = &file->vertices[first + i];
+        const float *position = &file->positions[vertex->position * 3];
+        const float *uv = vertex->uv != ~0u ? &file->uvs[vertex->uv * 2] : NULL;
+        batch[i] = (PositionTextureVertex){position[0], position[1], position[2], uv != NULL ? uv[0] : 0.0f, uv != NULL ? uv[1] : 0.0f};
+      }
+      VertexFormat_ConvertPositionTexture(batch, count, layout, dequantization, output);
+      output += (size_t)layout->stride * count;
+    }
+    return;
+  }
+  for (Uint32 p = 0; p < file->primitiveCount; p += 1)
+  {
+    const GltfPrimitive *primitive = &file->primitives[p];
+    for (Uint32 first = 0; first < primitive->positions.count; first += CONVERT_BATCH)
+    {
+      Uint32 count = SDL_min(primitive->positions.count - first, CONVERT_BATCH);
+      for (Uint32 i = 0; i < count; i += 1)
+      {
+        PositionTextureVertex *vertex = &batch[i];
+        SDL_memcpy(&vertex->x, primitive->positions.data + (size_t)primitive->positions.stride * (first + i), sizeof(float) * 3);
+        vertex->u = primitive->uvs.data != NULL ? ReadGltfUV(&primitive->uvs, first + i, 0) : 0.0f;
+        vertex->v = primitive->uvs.data != NULL ? ReadGltfUV(&primitive->uvs, first + i, 1) : 0.0f;
+      }
+      VertexFormat_ConvertPositionTexture(batch, count, layout, dequantization, output);
+      output += (size_t)layout->stride * count;
+    }
+  }
+}
+
+static void WriteIndex(void *destination, Uint32 position, SDL_GPUIndexElementSize indexElementSize, Uint32 index)
+{
+  if (indexElementSize == SDL_GPU_INDEXELEMENTSIZE_16BIT)
+  {
+    ((Uint16 *)destination)[position] = (Uint16)index;
+  }
+  else
+  {
+    ((Uint32 *)destination)[position] = index;
+  }
+}
+
+void MeshFile_WriteIndices(const MeshFile *file, SDL_GPUIndexElementSize indexElementSize, void *destination)
+{
+  if (file->info.baked)
+  {
+    const Uint8 *indices = file->source.data + file->baked.indexOffset;
+    if (indexElementSize == file->info.indexElementSize)
+    {
+      SDL_memcpy(destination, indices, (size_t)file->info.indexSize * file->info.indexCount);
+      return;
+    }
+    for (Uint32 i = 0; i < file->info.indexCount; i += 1)
+    {
+      Uint32 index;
+      if (file->info.indexSize == sizeof(Uint16))
+      {
+        Uint16 value;
+        SDL_memcpy(&value, indices + sizeof(Uint16) * i, sizeof(value));
+        index = value;
+      }
+      else
+      {
+        SDL_memcpy(&index, indices + sizeof(Uint32) * i, sizeof(index));
+      }
+      WriteIndex(destination, i, indexElementSize, index);
+    }
+    return;
+  }
+  if (file->indices != NULL)
+  {
+    if (indexElementSize == SDL_GPU_INDEXELEMENTSIZE_32BIT)
+    {
+      SDL_memcpy(destination, file->indices, sizeof(Uint32) * file->info.indexCount);
+      return;
+    }
+    for (Uint32 i = 0; i < file->info.indexCount; i += 1)
+    {
+      WriteIndex(destination, i, indexElementSize, file->indices[i]);
+    }
+    return;
+  }
+  Uint32 written = 0;
+  for (Uint32 p = 0; p < file->primitiveCount; p += 1)
+  {
+    const GltfPrimitive *primitive = &file->primitives[p];
+    const GltfAccessor *indices = &primitive->indices;
+    for (Uint32 i = 0; i < primitive->indexCount; i += 1)
+    {
+      Uint32 index = i;
+      if (indices->data != NULL)
+      {
+        const Uint8 *element = indices->data + (size_t)indices->stride * i;
+        if (indices->componentType == GLTF_BYTE)
+        {
+          index = element[0];
+        }
+        else if (indices->componentType == GLTF_SHORT)
+        {
+          Uint16 value;
+          SDL_memcpy(&value, element, sizeof(value));
+          index = SDL_Swap16LE(value);
+        }
+        else
+        {
+          SDL_memcpy(&index, element, sizeof(index));
+          index = SDL_Swap32LE(index);
+        }
+      }
+      WriteIndex(destination, written, indexElementSize, primitive->baseVertex + index);
+      written += 1;
+    }
+  }
+}
+
+Uint32 MeshFile_GetUploadSize(const MeshFile *file, const VertexLayout *layout)
+{
+  // The indices are a second upload, which the ring starts on a 16 byte boundary
+  Uint64 size = (Uint64)layout->stride * file->info.vertexCount + 16 + (Uint64)file->info.indexSize * file->info.indexCount;
+  return size <= SDL_MAX_UINT32 ? (Uint32)size : 0;
+}
+
+bool LoadMesh(MeshPool *pool, UploadRing *uploads, const MeshFile *file, const VertexLayout *layout, LoadedMesh *mesh)
+{
+  SDL_zerop(mesh);
+  const MeshFileInfo *info = &file->info;
+  Uint32 size = MeshFile_GetUploadSize(file, layout);
+  if (size == 0)
+  {
+    SDL_Log("Mesh of %u vertices is too large for one upload", info->vertexCount);
+    return false;
+  }
+  if (info->baked && (layout->positionFormat != info->bakedLayout.positionFormat || layout->uvFormat != info->bakedLayout.uvFormat))
+  {
+    SDL_Log("The baked mesh is %s + %s, it can't be loaded as %s + %s",
+            VertexFormat_GetPositionFormatName(info->bakedLayout.positionFormat), VertexFormat_GetUVFormatName(info->bakedLayout.uvFormat),
+            VertexFormat_GetPositionFormatName(layout->positionFormat), VertexFormat_GetUVFormatName(layout->uvFormat));
+    return false;
+  }
+  SDL_GPUIndexElementSize indexElementSize = MeshPool_GetIndexSize(pool);
+  if (MeshPool_GetVertexStride(pool) != layout->stride ||
+      (indexElementSize == SDL_GPU_INDEXELEMENTSIZE_16BIT && info->indexElementSize != SDL_GPU_INDEXELEMENTSIZE_16BIT) ||
+      (info->baked && indexElementSize != info->indexElementSize))
+  {
+    SDL_Log("The mesh pool's vertex stride or index size doesn't fit the mesh");
+    return false;
+  }
+  mesh->layout = *layout;
+  mesh->dequantization = info->baked ? file->baked.dequantization : VertexFormat_GetDequantization(info->min, info->max, layout->positionFormat);
+  SDL_memcpy(mesh->min, info->min, sizeof(mesh->min));
+  SDL_memcpy(mesh->max, info->max, sizeof(mesh->max));
+
+  if (!MeshPool_Allocate(pool, info->vertexCount, info->indexCount, &mesh->allocation))
+  {
+    return false;
+  }
+  Uint32 indexBytes = (indexElementSize == SDL_GPU_INDEXELEMENTSIZE_16BIT ? sizeof(Uint16) : sizeof(Uint32)) * info->indexCount;
+  Uint8 *vertices = UploadRing_AllocateBufferUpload(
+      uploads, layout->stride * info->vertexCount, MeshPool_GetVertexBuffer(pool), mesh->allocation.vertexByteOffset);
+  Uint8 *indices = vertices == NULL ? NULL : UploadRing_AllocateBufferUpload(uploads, indexBytes, MeshPool_GetIndexBuffer(pool), mesh->allocation.indexByteOffset);
+  if (indices == NULL)
+  {
+    // A vertex copy may be queued already, it only writes into the range freed here
+    SDL_Log("The upload ring has no room for a mesh of %u bytes", size);
+    ReleaseMesh(pool, mesh);
+    return false;
+  }
+  if (info->baked)
+  {
+    // The file's vertex and index blocks are these uploads already
+    SDL_memcpy(vertices, file->source.data + file->baked.vertexOffset, layout->stride * info->vertexCount);
+    SDL_memcpy(indices, file->source.data + file->baked.indexOffset, indexBytes);
+    return true;
+  }
+  MeshFile_WriteVertices(file, layout, &mesh->dequantization, vertices);
+  MeshFile_WriteIndices(file, indexElementSize, indices);
+  return true;
+}
+
+void ReleaseMesh(MeshPool *pool, LoadedMesh *mesh)
+{
+  if (mesh->allocation.indexCount > 0)
+  {
+    MeshPool_Free(pool, &mesh->allocation);
+  }
+  SDL_zero(mesh->allocation);
+}
+
+bool SaveBakedMesh(const char *path, const BakedMeshHeader *header, const void *vertices, const void *indices, const BakedMeshBounds *bounds)
+{
+  static const Uint8 Padding[16] = {0};
+  BakedMeshHeader written = *header;
+  written.magic = BAKED_MESH_MAGIC;
+  written.version = BAKED_MESH_VERSION;
+  written.headerSize = sizeof(BakedMeshHeader);
+  written.vertexOffset = (sizeof(BakedMeshHeader) + 15) & ~(Uint64)15;
+  written.indexOffset = written.vertexOffset + (Uint64)header->stride * header->vertexCount;
+  Uint64 indexEnd = written.indexOffset + (Uint64)header->indexSize * header->indexCount;
+  written.boundsOffset = (indexEnd + 15) & ~(Uint64)15;
+
+  SDL_IOStream *stream = SDL_IOFromFile(path, "wb");
+  if (stream == NULL)
+  {
+    SDL_Log("Failed to create %s: %s", path, SDL_GetError());
+    return false;
+  }
+  size_t vertexBytes = (size_t)(written.indexOffset - written.vertexOffset);
+  size_t indexBytes = (size_t)(indexEnd - written.indexOffset);
+  bool ok = SDL_WriteIO(stream, &written, sizeof(written)) == sizeof(written) &&
+            SDL_WriteIO(stream, Padding, (size_t)(written.vertexOffset - sizeof(written))) == written.vertexOffset - sizeof(written) &&
+            SDL_WriteIO(stream, vertices, vertexBytes) == vertexBytes &&
+            SDL_WriteIO(stream, indices, indexBytes) == indexBytes &&
+            SDL_WriteIO(stream, Padding, (size_t)(written.boundsOffset - indexEnd)) == written.boundsOffset - indexEnd &&
+            SDL_WriteIO(stream, bounds, sizeof(BakedMeshBounds)) == sizeof(BakedMeshBounds);
+  ok = SDL_CloseIO(stream) && ok;
+  if (!ok)
+  {
+    SDL_Log("Failed to write %s: %s", path, SDL_GetError());
+  }
+  return ok;
+}
@@ -0,0 +1,98 @@
+#ifndef MESH_LOADER_H_
+#define MESH_LOADER_H_
+#include <SDL3/SDL.h>
+#include "upload_ring.h"
+#include "vertex_format.h"
+#include "buffer_allocator.h"
+
+// Triangle meshes from Wavefront OBJ (.obj) and glTF 2.0 (.gltf with .bin buffers next to it, or .glb) files.
+// Files are memory-mapped and parsed in place. MeshFile_Open scans the file once into a few flat arrays sized up front,
+// nothing is allocated per vertex, and the vertices and indices are then written straight into the caller's memory,
+// usually mapped transfer memory from UploadRing_AllocateBufferUpload.
+//
+// Positions and the first UV set are read, OBJ groups and every triangle primitive of every glTF mesh are merged into one mesh.
+// glTF node transforms are not applied.
+//
+// Baked meshes (.mesh, written by src/tools/mesh_cook) are laid out the way the GPU reads them: a BakedMeshHeader,
+// the vertices in their final layout, the indices right after them and BakedMeshBounds at the end. Opening one only checks
+// the header against the file size, loading it is a copy of each block from the mapping into transfer memory.
+typedef struct MeshFile MeshFile;
+
+#define BAKED_MESH_MAGIC 0x4853454D // "MESH"
+#define BAKED_MESH_VERSION 1
+// The indices were reordered by mesh_optimizer
+#define BAKED_MESH_OPTIMIZED 0x1
+
+// Little endian, offsets from the start of the file
+typedef struct BakedMeshHeader
+{
+  Uint32 magic;
+  Uint32 version;
+  Uint32 headerSize;
+  Uint32 positionFormat; // VertexPositionFormat
+  Uint32 uvFormat;       // VertexUVFormat
+  Uint32 stride;
+  Uint32 vertexCount;
+  Uint32 indexCount;
+  Uint32 indexSize; // 2 or 4
+  Uint32 flags;
+  Uint64 vertexOffset; // 16 byte aligned
+  Uint64 indexOffset;  // vertexOffset + stride * vertexCount
+  Uint64 boundsOffset;
+  VertexDequantization dequantization;
+} BakedMeshHeader;
+
+typedef struct BakedMeshBounds
+{
+  float min[3];
+  float max[3];
+  float center[3];
+  float radius; // of a sphere around center holding every vertex
+} BakedMeshBounds;
+
+typedef struct MeshFileInfo
+{
+  Uint32 vertexCount;
+  Uint32 indexCount;
+  // 16 bit when every vertex fits, else 32 bit
+  SDL_GPUIndexElementSize indexElementSize;
+  Uint32 indexSize;
+  // Bounding box of the positions
+  float min[3];
+  float max[3];
+  bool hasUVs; // else every UV is 0
+  // Baked files only load in the layout they were cooked with
+  bool baked;
+  VertexLayout bakedLayout;
+} MeshFileInfo;
+
+MeshFile *MeshFile_Open(const char *path);
+void MeshFile_Close(MeshFile *file);
+const MeshFileInfo *MeshFile_GetInfo(const MeshFile *file);
+// layout->stride bytes per vertex. dequantization is the one the vertex shader will get, from the bounding box.
+// A baked file's vertices can only be written in its bakedLayout.
+void MeshFile_WriteVertices(const MeshFile *file, const VertexLayout *layout, const VertexDequantization *dequantization, void *destination);
+// 2 or 4 bytes per index, any mesh can be written with 32 bit indices
+void MeshFile_WriteIndices(const MeshFile *file, SDL_GPUIndexElementSize indexElementSize, void *destination);
+// The transfer memory LoadMesh needs with indices of info's size, 0 if the mesh is too large for one upload
+Uint32 MeshFile_GetUploadSize(const MeshFile *file, const VertexLayout *layout);
+
+// The vertices and indices live in a MeshPool, draw it with MeshPool_Bind and MeshPool_Draw(renderPass, &mesh.allocation, 1)
+typedef struct LoadedMesh
+{
+  MeshAllocation allocation;
+  VertexLayout layout;
+  VertexDequantization dequantization;
+  float min[3];
+  float max[3];
+} LoadedMesh;
+
+// Allocates the mesh from pool and writes it into uploads, call it between UploadRing_BeginFrame and UploadRing_Submit.
+// The pool's vertex stride has to be layout->stride. Its index size has to fit the mesh: 16 bit indices only for meshes whose
+// info has them, and baked meshes only in the size they were cooked with. The file can be closed once it returns.
+bool LoadMesh(MeshPool *pool, UploadRing *uploads, const MeshFile *file, const VertexLayout *layout, LoadedMesh *mesh);
+void ReleaseMesh(MeshPool *pool, LoadedMesh *mesh);
+
+// Writes a baked mesh. header has the layout, counts, flags and dequantization filled in, the rest is filled in here.
+bool SaveBakedMesh(const char *path, const BakedMeshHeader *header, const void *vertices, const void *indices, const BakedMeshBounds *bounds);
+#endif // MESH_LOADER_H_
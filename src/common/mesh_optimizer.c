@@ -0,0 +1,480 @@
+#include <SDL3/SDL.h>
+#include "mesh_optimizer.h"
+
+MeshCacheStats MeshOptimizer_AnalyzeVertexCache(const Uint32 *indices, Uint32 indexCount, Uint32 vertexCount, Uint32 cacheSize)
+{
+  MeshCacheStats stats = {0};
+  // The cache as the time each vertex entered it, a vertex is in it while fewer than cacheSize misses came after
+  Uint32 *cacheTime = SDL_calloc(vertexCount, sizeof(Uint32));
+  bool *referenced = SDL_calloc(vertexCount, sizeof(bool));
+  if (cacheTime == NULL || referenced == NULL || indexCount < 3)
+  {
+    SDL_free(cacheTime);
+    SDL_free(referenced);
+    return stats;
+  }
+  Uint32 misses = 0;
+  Uint32 uniqueVertices = 0;
+  for (Uint32 i = 0; i < indexCount; i += 1)
+  {
+    Uint32 index = indices[i];
+    // Times start at cacheSize + 1 so a vertex never seen is always out
+    if (misses + cacheSize + 1 - cacheTime[index] > cacheSize)
+    {
+      cacheTime[index] = misses + cacheSize + 1;
+      misses += 1;
+    }
+    if (!referenced[index])
+    {
+      referenced[index] = true;
+      uniqueVertices += 1;
+    }
+  }
+  stats.acmr = (float)misses / (indexCount / 3);
+  stats.atvr = (float)misses / uniqueVertices;
+  SDL_free(cacheTime);
+  SDL_free(referenced);
+  return stats;
+}
+
+// Triangles that use each vertex: triangles[offsets[v]] to triangles[offsets[v] + counts[v]]
+typedef struct Adjacency
+{
+  Uint32 *counts;
+  Uint32 *offsets;
+  Uint32 *triangles;
+} Adjacency;
+
+static bool CreateAdjacency(Adjacency *adjacency, const Uint32 *indices, Uint32 indexCount, Uint32 vertexCount)
+{
+  adjacency->counts = SDL_calloc(vertexCount, sizeof(Uint32));
+  adjacency->offsets = SDL_malloc(sizeof(Uint32) * vertexCount);
+  adjacency->triangles = SDL_malloc(sizeof(Uint32) * indexCount);
+  if (adjacency->counts == NULL || adjacency->offsets == NULL || adjacency->triangles == NULL)
+  {
+    return false;
+  }
+  for (Uint32 i = 0; i < indexCount; i += 1)
+  {
+    adjacency->counts[indices[i]] += 1;
+  }
+  Uint32 offset = 0;
+  for (Uint32 v = 0; v < vertexCount; v += 1)
+  {
+    adjacency->offsets[v] = offset;
+    offset += adjacency->counts[v];
+  }
+  // Filled by moving the offsets forward, then moved back
+  for (Uint32 i = 0; i < indexCount; i += 1)
+  {
+    adjacency->triangles[adjacency->offsets[indices[i]]] = i / 3;
+    adjacency->offsets[indices[i]] += 1;
+  }
+  for (Uint32 v = 0; v < vertexCount; v += 1)
+  {
+    adjacency->offsets[v] -= adjacency->counts[v];
+  }
+  return true;
+}
+
+static void DestroyAdjacency(Adjacency *adjacency)
+{
+  SDL_free(adjacency->counts);
+  SDL_free(adjacency->offsets);
+  SDL_free(adjacency->triangles);
+}
+
+// A vertex with triangles left that was used last: from the stack of recent vertices, else the next one in index order
+static Uint32 SkipDeadEnd(const Uint32 *live, Uint32 *deadEnds, Uint32 *deadEndCount, Uint32 *cursor, Uint32 vertexCount)
+{
+  while (*deadEndCount > 0)
+  {
+    *deadEndCount -= 1;
+    Uint32 vertex = deadEnds[*deadEndCount];
+    if (live[vertex] > 0)
+    {
+      return vertex;
+    }
+  }
+  while (*cursor < vertexCount)
+  {
+    if (live[*cursor] > 0)
+    {
+      return *cursor;
+    }
+    *cursor += 1;
+  }
+  return ~0u;
+}
+
+bool MeshOptimizer_OptimizeVertexCache(Uint32 *destination, const Uint32 *indices, Uint32 indexCount, Uint32 vertexCount, Uint32 cacheSize)
+{
+  // A trailing partial triangle stays out of the adjacency, otherwise its missing corners get emitted past the end
+  Uint32 totalIndexCount = indexCount;
+  indexCount -= indexCount % 3;
+  Adjacency adjacency = {0};
+  Uint32 *live = SDL_malloc(sizeof(Uint32) * vertexCount);
+  Uint32 *cacheTime = SDL_calloc(vertexCount, sizeof(Uint32));
+  bool *emitted = SDL_calloc(indexCount / 3 + 1, sizeof(bool));
+  // Every emitted index is pushed once, so the stack never holds more than indexCount
+  Uint32 *deadEnds = SDL_malloc(sizeof(Uint32) * (indexCount + 1));
+  Uint32 *candidates = SDL_malloc(sizeof(Uint32) * (indexCount + 1));
+  bool ok = live != NULL && cacheTime != NULL && emitted != NULL && deadEnds != NULL && candidates != NULL &&
+            CreateAdjacency(&adjacency, indices, indexCount, vertexCount);
+  if (!ok)
+  {
+    SDL_Log("Out of memory optimizing %u indices for the vertex cache", indexCount);
+  }
+  else
+  {
+    SDL_memcpy(live, adjacency.counts, sizeof(Uint32) * vertexCount);
+    Uint32 deadEndCount = 0;
+    Uint32 cursor = 0;
+    Uint32 time = cacheSize + 1;
+    Uint32 output = 0;
+    Uint32 fan = SkipDeadEnd(live, deadEnds, &deadEndCount, &cursor, vertexCount);
+    while (fan != ~0u)
+    {
+      // Emit every triangle left around the fan vertex, its vertices become the candidates for the next one
+      Uint32 candidateCount = 0;
+      const Uint32 *triangles = &adjacency.triangles[adjacency.offsets[fan]];
+      for (Uint32 t = 0; t < adjacency.counts[fan]; t += 1)
+      {
+        Uint32 triangle = triangles[t];
+        if (emitted[triangle])
+        {
+          continue;
+        }
+        emitted[triangle] = true;
+        for (Uint32 corner = 0; corner < 3; corner += 1)
+        {
+          Uint32 vertex = indices[triangle * 3 + corner];
+          destination[output] = vertex;
+          output += 1;
+          deadEnds[deadEndCount] = vertex;
+          deadEndCount += 1;
+          candidates[candidateCount] = vertex;
+          candidateCount += 1;
+          live[vertex] -= 1;
+          if (time - cacheTime[vertex] > cacheSize)
+          {
+            cacheTime[vertex] = time;
+            time += 1;
+          }
+        }
+      }
+
+      // The candidate that stays in the cache while its remaining triangles are emitted, and entered it earliest
+      Uint32 best = ~0u;
+      Uint32 bestPriority = 0;
+      for (Uint32 c = 0; c < candidateCount; c += 1)
+      {
+        Uint32 vertex = candidates[c];
+        if (live[vertex] == 0)
+        {
+          continue;
+        }
+        Uint32 priority = 1;
+        Uint32 age = time - cacheTime[vertex];
+        if (age + 2 * live[vertex] <= cacheSize)
+        {
+          priority += age;
+        }
+        if (priority > bestPriority)
+        {
+          best = vertex;
+          bestPriority = priority;
+        }
+      }
+      fan = best != ~0u ? best : SkipDeadEnd(live, deadEnds, &deadEndCount, &cursor, vertexCount);
+    }
+    // The partial triangle is copied through as is
+    for (; output < totalIndexCount; output += 1)
+    {
+      destination[output] = indices[output];
+    }
+  }
+  DestroyAdjacency(&adjacency);
+  SDL_free(live);
+  SDL_free(cacheTime);
+  SDL_free(emitted);
+  SDL_free(deadEnds);
+  SDL_free(candidates);
+  return ok;
+}
+
+typedef struct Cluster
+{
+  Uint32 firstTriangle;
+  Uint32 triangleCount;
+  float sortKey;
+} Cluster;
+
+static const float *GetPosition(const float *positions, Uint32 positionStride, Uint32 vertex)
+{
+  return (const float *)((const Uint8 *)positions + (size_t)positionStride * vertex);
+}
+
+// Misses of the triangles from first to first + count, starting with an empty cache
+static Uint32 CountMisses(const Uint32 *indices, Uint32 first, Uint32 count, Uint32 *cacheTime, Uint32 *time, Uint32 cacheSize, Uint32 *triangleMisses)
+{
+  // Moving time ahead empties the cache without clearing cacheTime
+  *time += cacheSize + 1;
+  Uint32 misses = 0;
+  for (Uint32 t = first; t < first + count; t += 1)
+  {
+    Uint32 missesBefore = misses;
+    for (Uint32 corner = 0; corner < 3; corner += 1)
+    {
+      Uint32 vertex = indices[t * 3 + corner];
+      if (*time - cacheTime[vertex] > cacheSize)
+      {
+        cacheTime[vertex] = *time;
+        *time += 1;
+        misses += 1;
+      }
+    }
+    if (triangleMisses != NULL)
+    {
+      triangleMisses[t - first] = misses - missesBefore;
+    }
+  }
+  return misses;
+}
+
+static int SDLCALL CompareClusters(const void *a, const void *b)
+{
+  const Cluster *first = a;
+  const Cluster *second = b;
+  if (first->sortKey != second->sortKey)
+  {
+    return first->sortKey > second->sortKey ? -1 : 1;
+  }
+  // Keeps the sort stable, clusters that tie stay in cache order
+  return first->firstTriangle < second->firstTriangle ? -1 : 1;
+}
+
+// Splits the cache-ordered triangles into clusters. Hard boundaries are where the cache order jumped to an unrelated
+// vertex (a triangle with three misses), clusters between them are cut again as soon as the part before the cut
+// is within threshold of the whole cluster's ACMR.
+static Uint32 BuildClusters(Cluster *clusters, const Uint32 *indices, Uint32 triangleCount, Uint32 vertexCount, Uint32 cacheSize, float threshold)
+{
+  Uint32 *cacheTime = SDL_calloc(vertexCount, sizeof(Uint32));
+  Uint32 *triangleMisses = SDL_malloc(sizeof(Uint32) * triangleCount);
+  if (cacheTime == NULL || triangleMisses == NULL)
+  {
+    SDL_free(cacheTime);
+    SDL_free(triangleMisses);
+    return 0;
+  }
+  Uint32 time = 0;
+  CountMisses(indices, 0, triangleCount, cacheTime, &time, cacheSize, triangleMisses);
+  Uint32 clusterCount = 0;
+  Uint32 hardStart = 0;
+  for (Uint32 t = 1; t <= triangleCount; t += 1)
+  {
+    if (t < triangleCount && triangleMisses[t] < 3)
+    {
+      continue;
+    }
+    Uint32 hardCount = t - hardStart;
+    float hardACMR = (float)CountMisses(indices, hardStart, hardCount, cacheTime, &time, cacheSize, NULL) / hardCount;
+    Uint32 softStart = hardStart;
+    Uint32 misses = 0;
+    time += cacheSize + 1;
+    for (Uint32 s = hardStart; s < t; s += 1)
+    {
+      for (Uint32 corner = 0; corner < 3; corner += 1)
+      {
+        Uint32 vertex = indices[s * 3 + corner];
+        if (time - cacheTime[vertex] > cacheSize)
+        {
+          cacheTime[vertex] = time;
+          time += 1;
+          misses += 1;
+        }
+      }
+      Uint32 softCount = s + 1 - softStart;
+      // Cutting restarts the cache, so a cluster stops as soon as it is as cache friendly as the whole
+      if (s + 1 < t && (float)misses / softCount <= hardACMR * threshold)
+      {
+        clusters[clusterCount] = (Cluster){softStart, softCount, 0.0f};
+        clusterCount += 1;
+        softStart = s + 1;
+        misses = 0;
+        time += cacheSize + 1;
+      }
+    }
+    clusters[clusterCount] = (Cluster){softStart, t - softStart, 0.0f};
+    clusterCount += 1;
+    hardStart = t;
+  }
+  SDL_free(cacheTime);
+  SDL_free(triangleMisses);
+  return clusterCount;
+}
+
+bool MeshOptimizer_OptimizeOverdraw(
+    Uint32 *destination,
+    const Uint32 *indices,
+    Uint32 indexCount,
+    const float *positions,
+    Uint32 positionStride,
+    Uint32 vertexCount,
+    Uint32 cacheSize,
+    float threshold)
+{
+  Uint32 triangleCount = indexCount / 3;
+  if (triangleCount == 0)
+  {
+    SDL_memcpy(destination, indices, sizeof(Uint32) * indexCount);
+    return true;
+  }
+  Cluster *clusters = SDL_malloc(sizeof(Cluster) * triangleCount);
+  Uint32 clusterCount = clusters != NULL ? BuildClusters(clusters, indices, triangleCount, vertexCount, cacheSize, threshold) : 0;
+  if (clusterCount == 0)
+  {
+    SDL_Log("Out of memory optimizing %u indices for overdraw", indexCount);
+    SDL_free(clusters);
+    return false;
+  }
+
+  // The area weighted centroid of the whole mesh
+  float meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+  float meshArea = 0.0f;
+  for (Uint32 t = 0; t < triangleCount; t += 1)
+  {
+    const float *a = GetPosition(positions, positionStride, indices[t * 3]);
+    const float *b = GetPosition(positions, positionStride, indices[t * 3 + 1]);
+    const float *c = GetPosition(positions, positionStride, indices[t * 3 + 2]);
+    float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    float cross[3] = {ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0]};
+    float area = SDL_sqrtf(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+    for (int axis = 0; axis < 3; axis += 1)
+    {
+      meshCentroid[axis] += (a[axis] + b[axis] + c[axis]) * area;
+    }
+    meshArea += area;
+  }
+  for (int axis = 0; axis < 3; axis += 1)
+  {
+    meshCentroid[axis] = meshArea > 0.0f ? meshCentroid[axis] / (meshArea * 3.0f) : 0.0f;
+  }
+
+  // Clusters facing away from the mesh's center are the likely occluders, they go first
+  for (Uint32 i = 0; i < clusterCount; i += 1)
+  {
+    Cluster *cluster = &clusters[i];
+    float centroid[3] = {0.0f, 0.0f, 0.0f};
+    float normal[3] = {0.0f, 0.0f, 0.0f};
+    float area = 0.0f;
+    for (Uint32 t = cluster->firstTriangle; t < cluster->firstTriangle + cluster->triangleCount; t += 1)
+    {
+      const float *a = GetPosition(positions, positionStride, indices[t * 3]);
+      const float *b = GetPosition(positions, positionStride, indices[t * 3 + 1]);
+      const float *c = GetPosition(positions, positionStride, indices[t * 3 + 2]);
+      float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+      float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+      float cross[3] = {ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0]};
+      float triangleArea = SDL_sqrtf(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+      for (int axis = 0; axis < 3; axis += 1)
+      {
+        centroid[axis] += (a[axis] + b[axis] + c[axis]) * triangleArea;
+        normal[axis] += cross[axis];
+      }
+      area += triangleArea;
+    }
+    float length = SDL_sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    cluster->sortKey = 0.0f;
+    if (area > 0.0f && length > 0.0f)
+    {
+      for (int axis = 0; axis < 3; axis += 1)
+      {
+        cluster->sortKey += (centroid[axis] / (area * 3.0f) - meshCentroid[axis]) * normal[axis] / length;
+      }
+    }
+  }
+  SDL_qsort(clusters, clusterCount, sizeof(Cluster), CompareClusters);
+
+  Uint32 output = 0;
+  for (Uint32 i = 0; i < clusterCount; i += 1)
+  {
+    Uint32 count = clusters[i].triangleCount * 3;
+    SDL_memcpy(&destination[output], &indices[clusters[i].firstTriangle * 3], sizeof(Uint32) * count);
+    output += count;
+  }
+  SDL_memcpy(&destination[output], &indices[output], sizeof(Uint32) * (indexCount - output));
+  SDL_free(clusters);
+  return true;
+}
+
+Uint32 MeshOptimizer_OptimizeVertexFetch(void *destination, Uint32 *indices, Uint32 indexCount, const void *vertices, Uint32 vertexCount, Uint32 vertexSize)
+{
+  Uint32 *remap = SDL_malloc(sizeof(Uint32) * vertexCount);
+  if (remap == NULL)
+  {
+    SDL_Log("Out of memory remapping %u vertices", vertexCount);
+    return 0;
+  }
+  SDL_memset(remap, 0xFF, sizeof(Uint32) * vertexCount);
+  Uint32 next = 0;
+  for (Uint32 i = 0; i < indexCount; i += 1)
+  {
+    Uint32 index = indices[i];
+    if (remap[index] == ~0u)
+    {
+      remap[index] = next;
+      SDL_memcpy((Uint8 *)destination + (size_t)vertexSize * next, (const Uint8 *)vertices + (size_t)vertexSize * index, vertexSize);
+      next += 1;
+    }
+    indices[i] = remap[index];
+  }
+  SDL_free(remap);
+  return next;
+}
+
+void MeshOptimizer_Optimize(MeshOptimizerMesh *mesh)
+{
+  mesh->optimized = false;
+  mesh->before = MeshOptimizer_AnalyzeVertexCache(mesh->indices, mesh->indexCount, mesh->vertexCount, MESH_OPTIMIZER_CACHE_SIZE);
+  mesh->after = mesh->before;
+  Uint32 *scratchIndices = SDL_malloc(sizeof(Uint32) * SDL_max(mesh->indexCount, 1));
+  void *scratchVertices = SDL_malloc((size_t)mesh->vertexSize * SDL_max(mesh->vertexCount, 1));
+  if (scratchIndices == NULL || scratchVertices == NULL)
+  {
+    SDL_Log("Out of memory optimizing a mesh of %u vertices", mesh->vertexCount);
+    SDL_free(scratchIndices);
+    SDL_free(scratchVertices);
+    return;
+  }
+  const float *positions = (const float *)((const Uint8 *)mesh->vertices + mesh->positionOffset);
+  // Cache order into the scratch, overdraw order back into the mesh
+  if (MeshOptimizer_OptimizeVertexCache(scratchIndices, mesh->indices, mesh->indexCount, mesh->vertexCount, MESH_OPTIMIZER_CACHE_SIZE) &&
+      MeshOptimizer_OptimizeOverdraw(mesh->indices, scratchIndices, mesh->indexCount, positions, mesh->vertexSize, mesh->vertexCount, MESH_OPTIMIZER_CACHE_SIZE, MESH_OPTIMIZER_OVERDRAW_THRESHOLD))
+  {
+    Uint32 vertexCount = MeshOptimizer_OptimizeVertexFetch(scratchVertices, mesh->indices, mesh->indexCount, mesh->vertices, mesh->vertexCount, mesh->vertexSize);
+    if (vertexCount > 0)
+    {
+      SDL_memcpy(mesh->vertices, scratchVertices, (size_t)mesh->vertexSize * vertexCount);
+      mesh->vertexCount = vertexCount;
+      mesh->optimized = true;
+    }
+    mesh->after = MeshOptimizer_AnalyzeVertexCache(mesh->indices, mesh->indexCount, mesh->vertexCount, MESH_OPTIMIZER_CACHE_SIZE);
+  }
+  SDL_free(scratchIndices);
+  SDL_free(scratchVertices);
+}
+
+static void SDLCALL OptimizeJob(void *userdata)
+{
+  MeshOptimizer_Optimize(userdata);
+}
+
+void MeshOptimizer_OptimizeMeshes(JobSystem *jobs, MeshOptimizerMesh *meshes, Uint32 count, JobCounter *counter)
+{
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    JobSystem_Run(jobs, OptimizeJob, &meshes[i], counter);
+  }
+}
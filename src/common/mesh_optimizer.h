@@ -0,0 +1,58 @@
+#ifndef MESH_OPTIMIZER_H_
+#define MESH_OPTIMIZER_H_
+#include <SDL3/SDL.h>
+#include "job_system.h"
+
+// Reorders indexed triangle lists for the GPU, in three steps usually run in this order:
+//   vertex cache: Tipsify (Sander et al. 2007), triangles are emitted in fans around vertices still in a FIFO cache of cacheSize
+//   overdraw: the cache-ordered list is cut into clusters which are sorted so outward-facing ones draw first and hide the rest
+//   vertex fetch: vertices are renumbered in the order the indices first use them, so fetches walk the vertex buffer forward
+//
+// Works on 32 bit indices. Positions are three floats at the start of each vertex, or positionStride bytes apart.
+#define MESH_OPTIMIZER_CACHE_SIZE 16
+// How much worse than the cache-optimized order the overdraw step may make ACMR, in exchange for smaller clusters
+#define MESH_OPTIMIZER_OVERDRAW_THRESHOLD 1.05f
+
+typedef struct MeshCacheStats
+{
+  float acmr; // vertex shader invocations per triangle: 3 with no reuse, 0.5 at best on a regular grid
+  float atvr; // vertex shader invocations per referenced vertex: 1 is ideal
+} MeshCacheStats;
+
+// Simulates a FIFO post-transform cache of cacheSize vertices
+MeshCacheStats MeshOptimizer_AnalyzeVertexCache(const Uint32 *indices, Uint32 indexCount, Uint32 vertexCount, Uint32 cacheSize);
+
+// destination must not alias indices. Return false if they run out of memory.
+bool MeshOptimizer_OptimizeVertexCache(Uint32 *destination, const Uint32 *indices, Uint32 indexCount, Uint32 vertexCount, Uint32 cacheSize);
+bool MeshOptimizer_OptimizeOverdraw(
+    Uint32 *destination,
+    const Uint32 *indices,
+    Uint32 indexCount,
+    const float *positions,
+    Uint32 positionStride,
+    Uint32 vertexCount,
+    Uint32 cacheSize,
+    float threshold);
+// Writes the vertices to destination in first use order and rewrites indices in place. Vertices no index uses are dropped.
+// Returns the new vertex count, 0 if it ran out of memory.
+Uint32 MeshOptimizer_OptimizeVertexFetch(void *destination, Uint32 *indices, Uint32 indexCount, const void *vertices, Uint32 vertexCount, Uint32 vertexSize);
+
+// A mesh to optimize in place with all three steps
+typedef struct MeshOptimizerMesh
+{
+  Uint32 *indices;
+  Uint32 indexCount;
+  void *vertices;
+  Uint32 vertexCount; // updated if unused vertices were dropped
+  Uint32 vertexSize;
+  Uint32 positionOffset; // of the float3 position in each vertex
+  // Filled in
+  MeshCacheStats before;
+  MeshCacheStats after;
+  bool optimized;
+} MeshOptimizerMesh;
+
+void MeshOptimizer_Optimize(MeshOptimizerMesh *mesh);
+// One job per mesh, wait on counter before touching them. jobs can be NULL to optimize them all right here.
+void MeshOptimizer_OptimizeMeshes(JobSystem *jobs, MeshOptimizerMesh *meshes, Uint32 count, JobCounter *counter);
+#endif // MESH_OPTIMIZER_H_
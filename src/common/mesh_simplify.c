@@ -0,0 +1,437 @@
+#include <float.h>
+#include "mesh_simplify.h"
+
+// A collapse may turn the normal of a triangle around the moved vertex by at most 60 degrees
+#define MESH_SIMPLIFY_MAX_NORMAL_TURN 0.5f
+
+// Sum of the squared distances to the planes of the triangles around a vertex, weighted by their area:
+// p^T A p + 2 b.p + c, divided by weight it is a squared distance
+typedef struct Quadric
+{
+  double a00, a11, a22, a01, a02, a12;
+  double b0, b1, b2;
+  double c;
+  double weight;
+} Quadric;
+
+typedef struct Collapse
+{
+  Uint32 from;
+  Uint32 to;
+  float error;
+} Collapse;
+
+static const float *GetPosition(const float *positions, Uint32 stride, Uint32 vertex)
+{
+  return (const float *)((const Uint8 *)positions + (size_t)stride * vertex);
+}
+
+// Twice the area, pointing out of the counter-clockwise side
+static void TriangleNormal(const float *a, const float *b, const float *c, double normal[3])
+{
+  double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+  double ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+  normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+  normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+  normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+}
+
+static void Quadric_AddTriangle(Quadric *quadric, const float *a, const float *b, const float *c)
+{
+  double n[3];
+  TriangleNormal(a, b, c, n);
+  double length = SDL_sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+  if (length == 0.0)
+  {
+    return;
+  }
+  double weight = length * 0.5;
+  n[0] /= length;
+  n[1] /= length;
+  n[2] /= length;
+  double d = -(n[0] * a[0] + n[1] * a[1] + n[2] * a[2]);
+  quadric->a00 += weight * n[0] * n[0];
+  quadric->a11 += weight * n[1] * n[1];
+  quadric->a22 += weight * n[2] * n[2];
+  quadric->a01 += weight * n[0] * n[1];
+  quadric->a02 += weight * n[0] * n[2];
+  quadric->a12 += weight * n[1] * n[2];
+  quadric->b0 += weight * n[0] * d;
+  quadric->b1 += weight * n[1] * d;
+  quadric->b2 += weight * n[2] * d;
+  quadric->c += weight * d * d;
+  quadric->weight += weight;
+}
+
+static void Quadric_Add(Quadric *quadric, const Quadric *other)
+{
+  quadric->a00 += other->a00;
+  quadric->a11 += other->a11;
+  quadric->a22 += other->a22;
+  quadric->a01 += other->a01;
+  quadric->a02 += other->a02;
+  quadric->a12 += other->a12;
+  quadric->b0 += other->b0;
+  quadric->b1 += other->b1;
+  quadric->b2 += other->b2;
+  quadric->c += other->c;
+  quadric->weight += other->weight;
+}
+
+// Weighted sum of the squared distances from p to the planes
+static double Quadric_Evaluate(const Quadric *quadric, const float *p)
+{
+  double x = p[0], y = p[1], z = p[2];
+  double error = quadric->a00 * x * x + quadric->a11 * y * y + quadric->a22 * z * z +
+                 2.0 * (quadric->a01 * x * y + quadric->a02 * x * z + quadric->a12 * y * z) +
+                 2.0 * (quadric->b0 * x + quadric->b1 * y + quadric->b2 * z) + quadric->c;
+  return SDL_max(error, 0.0);
+}
+
+// How far from the surfaces of both vertices the merged vertex ends up, at to's position
+static float CollapseError(const Quadric *quadrics, const float *positions, Uint32 stride, Uint32 from, Uint32 to)
+{
+  const float *p = GetPosition(positions, stride, to);
+  double weight = quadrics[from].weight + quadrics[to].weight;
+  if (weight == 0.0)
+  {
+    return 0.0f;
+  }
+  return (float)SDL_sqrt((Quadric_Evaluate(&quadrics[from], p) + Quadric_Evaluate(&quadrics[to], p)) / weight);
+}
+
+static int SDLCALL CompareCollapses(const void *a, const void *b)
+{
+  float errorA = ((const Collapse *)a)->error;
+  float errorB = ((const Collapse *)b)->error;
+  return errorA < errorB ? -1 : errorA > errorB ? 1 : 0;
+}
+
+static Uint32 HashPosition(const float *p)
+{
+  Uint32 bits[3];
+  SDL_memcpy(bits, p, sizeof(bits));
+  return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+}
+
+// Vertices that share their position with another one are seams between attributes, they stay where they are
+static bool LockSeams(const float *positions, Uint32 stride, Uint32 vertexCount, Uint8 *locked)
+{
+  Uint32 tableSize = 1;
+  while (tableSize < vertexCount * 2)
+  {
+    tableSize *= 2;
+  }
+  Uint32 *table = SDL_malloc(sizeof(Uint32) * tableSize);
+  if (table == NULL)
+  {
+    return false;
+  }
+  SDL_memset(table, 0xFF, sizeof(Uint32) * tableSize);
+  for (Uint32 v = 0; v < vertexCount; v += 1)
+  {
+    const float *p = GetPosition(positions, stride, v);
+    Uint32 slot = HashPosition(p) & (tableSize - 1);
+    while (table[slot] != SDL_MAX_UINT32)
+    {
+      const float *other = GetPosition(positions, stride, table[slot]);
+      if (other[0] == p[0] && other[1] == p[1] && other[2] == p[2])
+      {
+        locked[v] = 1;
+        locked[table[slot]] = 1;
+        break;
+      }
+      slot = (slot + 1) & (tableSize - 1);
+    }
+    if (table[slot] == SDL_MAX_UINT32)
+    {
+      table[slot] = v;
+    }
+  }
+  SDL_free(table);
+  return true;
+}
+
+// The triangles around each vertex: offsets[v] to offsets[v + 1] in triangles, offsets has vertexCount + 1 entries
+static void BuildAdjacency(const Uint32 *indices, Uint32 indexCount, Uint32 vertexCount, Uint32 *offsets, Uint32 *triangles)
+{
+  SDL_memset(offsets, 0, sizeof(Uint32) * (vertexCount + 1));
+  for (Uint32 i = 0; i < indexCount; i += 1)
+  {
+    offsets[indices[i] + 1] += 1;
+  }
+  for (Uint32 v = 0; v < vertexCount; v += 1)
+  {
+    offsets[v + 1] += offsets[v];
+  }
+  for (Uint32 i = 0; i < indexCount; i += 1)
+  {
+    triangles[offsets[indices[i]]++] = i / 3;
+  }
+  // Filling moved every offset to the start of the next vertex
+  for (Uint32 v = vertexCount; v > 0; v -= 1)
+  {
+    offsets[v] = offsets[v - 1];
+  }
+  offsets[0] = 0;
+}
+
+// An edge only one triangle uses is an open border, both of its vertices stay where they are.
+// Edges of consistently wound neighbours run the opposite way, so b -> a is looked for around b.
+static void LockBorders(const Uint32 *indices, Uint32 indexCount, const Uint32 *offsets, const Uint32 *triangles, Uint8 *locked)
+{
+  for (Uint32 i = 0; i < indexCount; i += 1)
+  {
+    Uint32 a = indices[i];
+    Uint32 b = indices[i - i % 3 + (i + 1) % 3];
+    bool shared = false;
+    for (Uint32 t = offsets[b]; t < offsets[b + 1] && !shared; t += 1)
+    {
+      const Uint32 *triangle = indices + triangles[t] * 3;
+      for (Uint32 corner = 0; corner < 3; corner += 1)
+      {
+        shared = shared || (triangle[corner] == b && triangle[(corner + 1) % 3] == a);
+      }
+    }
+    if (!shared)
+    {
+      locked[a] = 1;
+      locked[b] = 1;
+    }
+  }
+}
+
+// Whether moving from onto to turns any triangle around from too far, triangles that collapse with the edge don't count
+static bool CollapseFlips(
+    const Uint32 *indices,
+    const Uint32 *offsets,
+    const Uint32 *triangles,
+    const Uint32 *remap,
+    const float *positions,
+    Uint32 stride,
+    Uint32 from,
+    Uint32 to)
+{
+  for (Uint32 t = offsets[from]; t < offsets[from + 1]; t += 1)
+  {
+    const Uint32 *triangle = indices + triangles[t] * 3;
+    Uint32 corners[3] = {remap[triangle[0]], remap[triangle[1]], remap[triangle[2]]};
+    if (corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2] ||
+        corners[0] == to || corners[1] == to || corners[2] == to)
+    {
+      continue;
+    }
+    const float *before[3];
+    const float *after[3];
+    for (Uint32 corner = 0; corner < 3; corner += 1)
+    {
+      before[corner] = GetPosition(positions, stride, corners[corner]);
+      after[corner] = GetPosition(positions, stride, corners[corner] == from ? to : corners[corner]);
+    }
+    double n0[3], n1[3];
+    TriangleNormal(before[0], before[1], before[2], n0);
+    TriangleNormal(after[0], after[1], after[2], n1);
+    double dot = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+    double lengths = SDL_sqrt((n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2]) * (n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2]));
+    if (dot <= MESH_SIMPLIFY_MAX_NORMAL_TURN * lengths)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Remaps the indices in place and drops the triangles that lost an edge, returns the new index count
+static Uint32 ApplyRemap(Uint32 *indices, Uint32 indexCount, const Uint32 *remap)
+{
+  Uint32 count = 0;
+  for (Uint32 i = 0; i < indexCount; i += 3)
+  {
+    Uint32 a = remap[indices[i]];
+    Uint32 b = remap[indices[i + 1]];
+    Uint32 c = remap[indices[i + 2]];
+    if (a != b && b != c && a != c)
+    {
+      indices[count] = a;
+      indices[count + 1] = b;
+      indices[count + 2] = c;
+      count += 3;
+    }
+  }
+  return count;
+}
+
+Uint32 MeshSimplify_Simplify(
+    Uint32 *destination,
+    const Uint32 *indices,
+    Uint32 indexCount,
+    const float *positions,
+    Uint32 positionStride,
+    Uint32 vertexCount,
+    Uint32 targetIndexCount,
+    float maxError,
+    float *error)
+{
+  *error = 0.0f;
+  indexCount -= indexCount % 3;
+  targetIndexCount = SDL_max(targetIndexCount, 3);
+  Uint32 *current = SDL_malloc(sizeof(Uint32) * SDL_max(indexCount, 1));
+  Uint32 *offsets = SDL_malloc(sizeof(Uint32) * (vertexCount + 1));
+  Uint32 *triangles = SDL_malloc(sizeof(Uint32) * SDL_max(indexCount, 1));
+  Uint32 *remap = SDL_malloc(sizeof(Uint32) * SDL_max(vertexCount, 1));
+  Uint8 *locked = SDL_calloc(SDL_max(vertexCount, 1), 1);
+  Uint8 *moved = SDL_malloc(SDL_max(vertexCount, 1));
+  Quadric *quadrics = SDL_calloc(SDL_max(vertexCount, 1), sizeof(Quadric));
+  Collapse *collapses = SDL_malloc(sizeof(Collapse) * SDL_max(indexCount, 1));
+  bool ok = current != NULL && offsets != NULL && triangles != NULL && remap != NULL && locked != NULL &&
+            moved != NULL && quadrics != NULL && collapses != NULL && LockSeams(positions, positionStride, vertexCount, locked);
+  Uint32 count = 0;
+  if (ok)
+  {
+    for (Uint32 v = 0; v < vertexCount; v += 1)
+    {
+      remap[v] = v;
+    }
+    // Triangles that are already degenerate only get in the way
+    SDL_memcpy(current, indices, sizeof(Uint32) * indexCount);
+    count = ApplyRemap(current, indexCount, remap);
+    for (Uint32 i = 0; i < count; i += 3)
+    {
+      const float *a = GetPosition(positions, positionStride, current[i]);
+      const float *b = GetPosition(positions, positionStride, current[i + 1]);
+      const float *c = GetPosition(positions, positionStride, current[i + 2]);
+      for (Uint32 corner = 0; corner < 3; corner += 1)
+      {
+        Quadric_AddTriangle(&quadrics[current[i + corner]], a, b, c);
+      }
+    }
+    BuildAdjacency(current, count, vertexCount, offsets, triangles);
+    LockBorders(current, count, offsets, triangles, locked);
+  }
+
+  // Each pass ranks every edge by its error and collapses the cheapest ones. A vertex is moved or moved onto at most
+  // once per pass, the rest of its edges wait for the next pass and errors that are up to date again.
+  while (ok && count > targetIndexCount)
+  {
+    BuildAdjacency(current, count, vertexCount, offsets, triangles);
+    Uint32 collapseCount = 0;
+    for (Uint32 i = 0; i < count; i += 1)
+    {
+      Uint32 a = current[i];
+      Uint32 b = current[i - i % 3 + (i + 1) % 3];
+      // Both triangles of an edge list it, once each way
+      if (a > b || (locked[a] && locked[b]))
+      {
+        continue;
+      }
+      float errorAB = locked[a] ? FLT_MAX : CollapseError(quadrics, positions, positionStride, a, b);
+      float errorBA = locked[b] ? FLT_MAX : CollapseError(quadrics, positions, positionStride, b, a);
+      collapses[collapseCount++] = errorAB <= errorBA ? (Collapse){a, b, errorAB} : (Collapse){b, a, errorBA};
+    }
+    SDL_qsort(collapses, collapseCount, sizeof(Collapse), CompareCollapses);
+
+    // Most collapses remove two triangles
+    Uint32 goal = SDL_max((count - targetIndexCount) / 6, 1);
+    Uint32 performed = 0;
+    SDL_memset(moved, 0, vertexCount);
+    for (Uint32 i = 0; i < collapseCount && performed < goal; i += 1)
+    {
+      const Collapse *collapse = &collapses[i];
+      if (collapse->error > maxError)
+      {
+        break;
+      }
+      if (moved[collapse->from] || moved[collapse->to] ||
+          CollapseFlips(current, offsets, triangles, remap, positions, positionStride, collapse->from, collapse->to))
+      {
+        continue;
+      }
+      remap[collapse->from] = collapse->to;
+      Quadric_Add(&quadrics[collapse->to], &quadrics[collapse->from]);
+      moved[collapse->from] = 1;
+      moved[collapse->to] = 1;
+      *error = SDL_max(*error, collapse->error);
+      performed += 1;
+    }
+    if (performed == 0)
+    {
+      break;
+    }
+    count = ApplyRemap(current, count, remap);
+  }
+  if (ok)
+  {
+    SDL_memcpy(destination, current, sizeof(Uint32) * count);
+  }
+
+  SDL_free(current);
+  SDL_free(offsets);
+  SDL_free(triangles);
+  SDL_free(remap);
+  SDL_free(locked);
+  SDL_free(moved);
+  SDL_free(quadrics);
+  SDL_free(collapses);
+  return ok ? count : 0;
+}
+
+Uint32 MeshSimplify_BuildLods(
+    Uint32 *destination,
+    const Uint32 *indices,
+    Uint32 indexCount,
+    const float *positions,
+    Uint32 positionStride,
+    Uint32 vertexCount,
+    Uint32 maxLevels,
+    MeshLodChain *chain)
+{
+  maxLevels = SDL_clamp(maxLevels, 1, MESH_LOD_MAX_LEVELS);
+  SDL_memcpy(destination, indices, sizeof(Uint32) * indexCount);
+  chain->levels[0] = (MeshLod){.firstIndex = 0, .indexCount = indexCount, .error = 0.0f};
+  chain->levelCount = 1;
+  Uint32 total = indexCount;
+  // Each level simplifies the one before, so its error adds to theirs
+  while (chain->levelCount < maxLevels)
+  {
+    const MeshLod *previous = &chain->levels[chain->levelCount - 1];
+    Uint32 target = (Uint32)(previous->indexCount / 3 * MESH_LOD_REDUCTION) * 3;
+    float levelError;
+    Uint32 count = MeshSimplify_Simplify(
+        destination + total, destination + previous->firstIndex, previous->indexCount,
+        positions, positionStride, vertexCount, target, FLT_MAX, &levelError);
+    if (count == 0 && previous->indexCount > 0)
+    {
+      return 0;
+    }
+    if (count > previous->indexCount / 4 * 3)
+    {
+      break;
+    }
+    chain->levels[chain->levelCount] = (MeshLod){.firstIndex = total, .indexCount = count, .error = previous->error + levelError};
+    chain->levelCount += 1;
+    total += count;
+  }
+  return total;
+}
+
+float MeshLod_GetProjectionScale(float fieldOfView, float viewportHeight)
+{
+  return viewportHeight / (2.0f * SDL_tanf(fieldOfView * 0.5f));
+}
+
+Uint32 MeshLod_Select(const MeshLodChain *chain, float distance, float scale, float projectionScale, float maxPixelError)
+{
+  if (distance <= 0.0f)
+  {
+    return 0;
+  }
+  // Errors only grow with the level, so the first one from the coarse end that fits is the coarsest
+  for (Uint32 level = chain->levelCount - 1; level > 0; level -= 1)
+  {
+    if (chain->levels[level].error * scale * projectionScale <= maxPixelError * distance)
+    {
+      return level;
+    }
+  }
+  return 0;
+}
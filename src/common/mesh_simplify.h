@@ -0,0 +1,62 @@
+#ifndef MESH_SIMPLIFY_H_
+#define MESH_SIMPLIFY_H_
+#include <SDL3/SDL.h>
+
+// Level of detail for indexed triangle meshes by edge collapse with quadric error metrics (Garland and Heckbert 1997).
+// Every collapse moves a vertex onto one of its neighbours instead of a new position, so only the indices change and every
+// level of a mesh draws from the same vertex buffer. The levels are stored one after the other in one index buffer.
+//
+// Vertices on open borders, and vertices that share their position with another vertex (UV or color seams), never move,
+// so a level never opens cracks. Collapses that would flip a triangle are skipped.
+//
+// Works on 32 bit indices. Positions are three floats at the start of each vertex, or positionStride bytes apart.
+#define MESH_LOD_MAX_LEVELS 5
+// Each level aims for this fraction of the triangles of the level before it
+#define MESH_LOD_REDUCTION 0.5f
+
+// Collapses edges until at most targetIndexCount indices are left or the next collapse would move the surface further
+// than maxError, in mesh units. destination can be indices. Returns the new index count, with the largest error it
+// allowed in *error, or 0 if it ran out of memory.
+Uint32 MeshSimplify_Simplify(
+    Uint32 *destination,
+    const Uint32 *indices,
+    Uint32 indexCount,
+    const float *positions,
+    Uint32 positionStride,
+    Uint32 vertexCount,
+    Uint32 targetIndexCount,
+    float maxError,
+    float *error);
+
+typedef struct MeshLod
+{
+  Uint32 firstIndex;
+  Uint32 indexCount;
+  float error; // how far, in mesh units, the level's surface may be from the full mesh
+} MeshLod;
+
+typedef struct MeshLodChain
+{
+  MeshLod levels[MESH_LOD_MAX_LEVELS]; // levels[0] is the mesh as is
+  Uint32 levelCount;
+} MeshLodChain;
+
+// Writes up to maxLevels levels one after the other into destination, which needs room for indexCount * maxLevels indices.
+// A level that can't get below 3/4 of the triangles of the one before ends the chain. Returns the total index count, 0 if out of memory.
+Uint32 MeshSimplify_BuildLods(
+    Uint32 *destination,
+    const Uint32 *indices,
+    Uint32 indexCount,
+    const float *positions,
+    Uint32 positionStride,
+    Uint32 vertexCount,
+    Uint32 maxLevels,
+    MeshLodChain *chain);
+
+// Pixels per mesh unit at distance 1, for the fieldOfView (in radians, as given to Matrix4x4_CreatePerspectiveFieldOfView)
+// and the viewport's height in pixels
+float MeshLod_GetProjectionScale(float fieldOfView, float viewportHeight);
+// The coarsest level whose error stays under maxPixelError on screen, for an instance scaled by scale whose bounding sphere
+// is distance away from the camera (0 or less when the camera is inside it)
+Uint32 MeshLod_Select(const MeshLodChain *chain, float distance, float scale, float projectionScale, float maxPixelError);
+#endif // MESH_SIMPLIFY_H_
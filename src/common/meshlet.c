@@ -0,0 +1,189 @@
+#include "meshlet.h"
+
+// Normal cones wider than this, dot(axis, normal) below it for some triangle, are never culled
+#define MESHLET_MIN_CONE_DOT 0.1f
+
+static Vector3 GetPosition(const float *positions, Uint32 stride, Uint32 vertex)
+{
+  const float *position = (const float *)((const Uint8 *)positions + (size_t)stride * vertex);
+  return (Vector3){position[0], position[1], position[2]};
+}
+
+static Vector3 Subtract(Vector3 a, Vector3 b)
+{
+  return (Vector3){a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+Uint32 Meshlet_GetMaxCount(Uint32 indexCount, Uint32 maxVertices, Uint32 maxTriangles)
+{
+  // A meshlet is only closed when it has maxTriangles triangles, or maxVertices - 2 vertices and a triangle that brings 3 more
+  Uint32 minTriangles = SDL_max(SDL_min(maxTriangles, (maxVertices - 2) / 3), 1);
+  Uint32 triangleCount = indexCount / 3;
+  return (triangleCount + minTriangles - 1) / minTriangles;
+}
+
+// The bounding sphere and normal cone of the triangles of meshlet, normals has room for all of them
+static void ComputeBounds(Meshlet *meshlet, const Uint32 *indices, const float *positions, Uint32 stride, Vector3 *normals)
+{
+  const Uint32 *triangles = indices + meshlet->firstIndex;
+  Uint32 triangleCount = meshlet->indexCount / 3;
+
+  // Sphere around the center of the box
+  Vector3 min = GetPosition(positions, stride, triangles[0]);
+  Vector3 max = min;
+  for (Uint32 i = 1; i < meshlet->indexCount; i += 1)
+  {
+    Vector3 p = GetPosition(positions, stride, triangles[i]);
+    min = (Vector3){SDL_min(min.x, p.x), SDL_min(min.y, p.y), SDL_min(min.z, p.z)};
+    max = (Vector3){SDL_max(max.x, p.x), SDL_max(max.y, p.y), SDL_max(max.z, p.z)};
+  }
+  Vector3 center = {(min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f};
+  float radiusSquared = 0.0f;
+  for (Uint32 i = 0; i < meshlet->indexCount; i += 1)
+  {
+    Vector3 offset = Subtract(GetPosition(positions, stride, triangles[i]), center);
+    radiusSquared = SDL_max(radiusSquared, Vector3_Dot(offset, offset));
+  }
+  meshlet->center[0] = center.x;
+  meshlet->center[1] = center.y;
+  meshlet->center[2] = center.z;
+  meshlet->radius = SDL_sqrtf(radiusSquared);
+
+  // The cone's axis is the average of the unit normals, its cutoff comes from the normal furthest from it.
+  // Degenerate triangles are never drawn and keep a zero normal.
+  Vector3 axis = {0.0f, 0.0f, 0.0f};
+  for (Uint32 t = 0; t < triangleCount; t += 1)
+  {
+    Vector3 p0 = GetPosition(positions, stride, triangles[t * 3]);
+    Vector3 normal = Vector3_Cross(
+        Subtract(GetPosition(positions, stride, triangles[t * 3 + 1]), p0),
+        Subtract(GetPosition(positions, stride, triangles[t * 3 + 2]), p0));
+    float length = SDL_sqrtf(Vector3_Dot(normal, normal));
+    normals[t] = length > 0.0f ? (Vector3){normal.x / length, normal.y / length, normal.z / length} : (Vector3){0.0f, 0.0f, 0.0f};
+    axis = (Vector3){axis.x + normals[t].x, axis.y + normals[t].y, axis.z + normals[t].z};
+  }
+  SDL_memcpy(meshlet->coneApex, meshlet->center, sizeof(meshlet->coneApex));
+  meshlet->coneAxis[0] = 0.0f;
+  meshlet->coneAxis[1] = 0.0f;
+  meshlet->coneAxis[2] = 1.0f;
+  meshlet->coneCutoff = 1.0f;
+  float axisLength = SDL_sqrtf(Vector3_Dot(axis, axis));
+  if (axisLength < 1e-6f)
+  {
+    return;
+  }
+  axis = (Vector3){axis.x / axisLength, axis.y / axisLength, axis.z / axisLength};
+  float minDot = 1.0f;
+  for (Uint32 t = 0; t < triangleCount; t += 1)
+  {
+    if (Vector3_Dot(normals[t], normals[t]) > 0.0f)
+    {
+      minDot = SDL_min(minDot, Vector3_Dot(axis, normals[t]));
+    }
+  }
+  if (minDot <= MESHLET_MIN_CONE_DOT)
+  {
+    return;
+  }
+
+  // Move the apex back along the axis until it is behind every triangle's plane, then the test holds from any distance
+  float maxT = 0.0f;
+  for (Uint32 t = 0; t < triangleCount; t += 1)
+  {
+    if (Vector3_Dot(normals[t], normals[t]) > 0.0f)
+    {
+      Vector3 p0 = GetPosition(positions, stride, triangles[t * 3]);
+      maxT = SDL_max(maxT, Vector3_Dot(Subtract(center, p0), normals[t]) / Vector3_Dot(axis, normals[t]));
+    }
+  }
+  meshlet->coneApex[0] = center.x - axis.x * maxT;
+  meshlet->coneApex[1] = center.y - axis.y * maxT;
+  meshlet->coneApex[2] = center.z - axis.z * maxT;
+  meshlet->coneAxis[0] = axis.x;
+  meshlet->coneAxis[1] = axis.y;
+  meshlet->coneAxis[2] = axis.z;
+  // The sine of the cone's half angle: the backs of all triangles are seen from within 90 degrees minus it of the axis
+  meshlet->coneCutoff = SDL_sqrtf(1.0f - minDot * minDot);
+}
+
+Uint32 Meshlet_Build(
+    Meshlet *meshlets,
+    const Uint32 *indices,
+    Uint32 indexCount,
+    const float *positions,
+    Uint32 stride,
+    Uint32 vertexCount,
+    Uint32 maxVertices,
+    Uint32 maxTriangles)
+{
+  // The meshlet each vertex was last counted in
+  Uint32 *lastMeshlet = SDL_malloc(sizeof(Uint32) * vertexCount);
+  Vector3 *normals = SDL_malloc(sizeof(Vector3) * maxTriangles);
+  if (lastMeshlet == NULL || normals == NULL)
+  {
+    SDL_free(lastMeshlet);
+    SDL_free(normals);
+    return 0;
+  }
+  SDL_memset(lastMeshlet, 0xFF, sizeof(Uint32) * vertexCount);
+
+  Uint32 meshletCount = 0;
+  Meshlet *current = NULL;
+  for (Uint32 i = 0; i + 2 < indexCount; i += 3)
+  {
+    const Uint32 *triangle = indices + i;
+    Uint32 newVertices = 0;
+    if (current != NULL)
+    {
+      newVertices = (lastMeshlet[triangle[0]] != meshletCount - 1) +
+                    (lastMeshlet[triangle[1]] != meshletCount - 1 && triangle[1] != triangle[0]) +
+                    (lastMeshlet[triangle[2]] != meshletCount - 1 && triangle[2] != triangle[0] && triangle[2] != triangle[1]);
+    }
+    if (current == NULL || current->vertexCount + newVertices > maxVertices || current->indexCount / 3 >= maxTriangles)
+    {
+      if (current != NULL)
+      {
+        ComputeBounds(current, indices, positions, stride, normals);
+      }
+      current = &meshlets[meshletCount];
+      *current = (Meshlet){.firstIndex = i};
+      meshletCount += 1;
+    }
+    for (int corner = 0; corner < 3; corner += 1)
+    {
+      if (lastMeshlet[triangle[corner]] != meshletCount - 1)
+      {
+        lastMeshlet[triangle[corner]] = meshletCount - 1;
+        current->vertexCount += 1;
+      }
+    }
+    current->indexCount += 3;
+  }
+  if (current != NULL)
+  {
+    ComputeBounds(current, indices, positions, stride, normals);
+  }
+
+  SDL_free(lastMeshlet);
+  SDL_free(normals);
+  return meshletCount;
+}
+
+bool Meshlet_IsBackfacing(const Meshlet *meshlet, Vector3 cameraPosition)
+{
+  if (meshlet->coneCutoff >= 1.0f)
+  {
+    return false;
+  }
+  Vector3 apex = {meshlet->coneApex[0], meshlet->coneApex[1], meshlet->coneApex[2]};
+  Vector3 axis = {meshlet->coneAxis[0], meshlet->coneAxis[1], meshlet->coneAxis[2]};
+  Vector3 view = Subtract(apex, cameraPosition);
+  float length = SDL_sqrtf(Vector3_Dot(view, view));
+  return Vector3_Dot(view, axis) >= meshlet->coneCutoff * length;
+}
+
+bool Meshlet_IsVisible(const Meshlet *meshlet, const Frustum *frustum, Vector3 cameraPosition)
+{
+  Vector3 center = {meshlet->center[0], meshlet->center[1], meshlet->center[2]};
+  return Frustum_TestSphere(frustum, center, meshlet->radius) && !Meshlet_IsBackfacing(meshlet, cameraPosition);
+}
@@ -0,0 +1,51 @@
+#ifndef MESHLET_H_
+#define MESHLET_H_
+#include <SDL3/SDL.h>
+#include "linear_algebra.h"
+#include "culling.h"
+
+// Splits an index buffer into meshlets, small clusters of triangles that are culled on their own, each with a bounding sphere
+// against the frustum and a normal cone against the camera direction: a meshlet whose triangles all face away is skipped.
+//
+// Triangles are taken in index order and a meshlet is closed when the next triangle would take it over maxVertices unique
+// vertices or maxTriangles triangles, so every meshlet is one contiguous range of the index buffer and draws as is.
+// Clusters are only as tight as the triangle order: run MeshOptimizer_OptimizeVertexCache (or mesh_optimizer) first.
+//
+// Counter-clockwise triangles, seen from the front, face the way the normal cone points.
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+
+// 64 bytes, laid out as four vec4s so it matches the MeshletBounds of CullMeshlets with std430 and HLSL alike
+typedef struct Meshlet
+{
+  float center[3];
+  float radius;
+  // A camera at apex looking along axis sees the meshlet's backs, so does any camera with
+  // dot(normalize(apex - camera), axis) >= coneCutoff. coneCutoff is 1 when the triangles face too many ways to ever cull.
+  float coneApex[3];
+  float coneCutoff;
+  float coneAxis[3];
+  Uint32 vertexCount; // unique vertices
+  Uint32 firstIndex;
+  Uint32 indexCount;
+  Uint32 padding[2];
+} Meshlet;
+
+// Enough meshlets for any index buffer of indexCount indices
+Uint32 Meshlet_GetMaxCount(Uint32 indexCount, Uint32 maxVertices, Uint32 maxTriangles);
+// Writes the meshlets and returns how many there are, 0 if out of memory. positions are float3s, stride bytes apart.
+// maxVertices is at least 3 and maxTriangles at least 1.
+Uint32 Meshlet_Build(
+    Meshlet *meshlets,
+    const Uint32 *indices,
+    Uint32 indexCount,
+    const float *positions,
+    Uint32 stride,
+    Uint32 vertexCount,
+    Uint32 maxVertices,
+    Uint32 maxTriangles);
+
+// The same tests CullMeshlets runs, for counting on the CPU
+bool Meshlet_IsBackfacing(const Meshlet *meshlet, Vector3 cameraPosition);
+bool Meshlet_IsVisible(const Meshlet *meshlet, const Frustum *frustum, Vector3 cameraPosition);
+#endif // MESHLET_H_
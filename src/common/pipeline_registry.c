@@ -0,0 +1,491 @@
+#include <SDL3/SDL.h>
+#include "pipeline_registry.h"
+#include "trace.h"
+
+// Limits of the SDL GPU API, used to size the copies of the create info arrays
+#define MAX_VERTEX_BUFFERS 16
+#define MAX_VERTEX_ATTRIBUTES 16
+#define MAX_COLOR_TARGETS 4
+#define MAX_PREWARM_THREADS 16
+// Large enough for a create info using all of the limits above
+#define MAX_KEY_WORDS 256
+
+typedef enum PipelineState
+{
+  PIPELINE_STATE_PENDING,
+  PIPELINE_STATE_READY,
+  PIPELINE_STATE_FAILED
+} PipelineState;
+
+// The create info is flattened into a key of 32 bit words, field by field, so struct padding never ends up in the hash.
+// Two create infos describe the same pipeline exactly when their keys are equal.
+typedef struct PipelineKey
+{
+  Uint32 words[MAX_KEY_WORDS];
+  Uint32 count;
+} PipelineKey;
+
+typedef struct PipelineEntry
+{
+  Uint64 hash;
+  PipelineKey key;
+  // Deep copy of the create info, its arrays point into the storage below
+  SDL_GPUGraphicsPipelineCreateInfo createInfo;
+  SDL_GPUVertexBufferDescription vertexBuffers[MAX_VERTEX_BUFFERS];
+  SDL_GPUVertexAttribute vertexAttributes[MAX_VERTEX_ATTRIBUTES];
+  SDL_GPUColorTargetDescription colorTargets[MAX_COLOR_TARGETS];
+  PipelineState state;
+  SDL_GPUGraphicsPipeline *pipeline;
+} PipelineEntry;
+
+struct PipelineRegistry
+{
+  SDL_GPUDevice *device;
+  SDL_Mutex *lock;
+  SDL_Condition *built;
+  // Entries are allocated one by one so pointers stay valid while the array grows
+  PipelineEntry **entries;
+  Uint32 count;
+  Uint32 capacity;
+  Uint32 hits;
+  Uint32 misses;
+
+  SDL_Thread *threads[MAX_PREWARM_THREADS];
+  Uint32 threadCount;
+  PipelineEntry **queue;
+  Uint32 queueCount;
+  SDL_AtomicInt queueNext;
+  SDL_AtomicInt pending;
+};
+
+static void PushWord(PipelineKey *key, Uint32 value)
+{
+  SDL_assert(key->count < MAX_KEY_WORDS);
+  key->words[key->count] = value;
+  key->count += 1;
+}
+
+static void PushFloat(PipelineKey *key, float value)
+{
+  Uint32 bits;
+  SDL_memcpy(&bits, &value, sizeof(bits));
+  PushWord(key, bits);
+}
+
+static void PushPointer(PipelineKey *key, const void *pointer)
+{
+  Uint64 value = (Uint64)(uintptr_t)pointer;
+  PushWord(key, (Uint32)value);
+  PushWord(key, (Uint32)(value >> 32));
+}
+
+static void PushStencilOpState(PipelineKey *key, const SDL_GPUStencilOpState *state)
+{
+  PushWord(key, state->fail_op);
+  PushWord(key, state->pass_op);
+  PushWord(key, state->depth_fail_op);
+  PushWord(key, state->compare_op);
+}
+
+static bool BuildPipelineKey(const SDL_GPUGraphicsPipelineCreateInfo *createInfo, PipelineKey *key)
+{
+  const SDL_GPUVertexInputState *vertexInput = &createInfo->vertex_input_state;
+  const SDL_GPUGraphicsPipelineTargetInfo *targetInfo = &createInfo->target_info;
+
+  if (vertexInput->num_vertex_buffers > MAX_VERTEX_BUFFERS ||
+      vertexInput->num_vertex_attributes > MAX_VERTEX_ATTRIBUTES ||
+      targetInfo->num_color_targets > MAX_COLOR_TARGETS)
+  {
+    SDL_Log("Pipeline create info is over the registry limits!");
+    return false;
+  }
+
+  key->count = 0;
+  PushPointer(key, createInfo->vertex_shader);
+  PushPointer(key, createInfo->fragment_shader);
+
+  PushWord(key, vertexInput->num_vertex_buffers);
+  for (Uint32 i = 0; i < vertexInput->num_vertex_buffers; i += 1)
+  {
+    const SDL_GPUVertexBufferDescription *description = &vertexInput->vertex_buffer_descriptions[i];
+    PushWord(key, description->slot);
+    PushWord(key, description->pitch);
+    PushWord(key, description->input_rate);
+    PushWord(key, description->instance_step_rate);
+  }
+  PushWord(key, vertexInput->num_vertex_attributes);
+  for (Uint32 i = 0; i < vertexInput->num_vertex_attributes; i += 1)
+  {
+    const SDL_GPUVertexAttribute *attribute = &vertexInput->vertex_attributes[i];
+    PushWord(key, attribute->location);
+    PushWord(key, attribute->buffer_slot);
+    PushWord(key, attribute->format);
+    PushWord(key, attribute->offset);
+  }
+
+  PushWord(key, createInfo->primitive_type);
+
+  const SDL_GPURasterizerState *rasterizer = &createInfo->rasterizer_state;
+  PushWord(key, rasterizer->fill_mode);
+  PushWord(key, rasterizer->cull_mode);
+  PushWord(key, rasterizer->front_face);
+  PushFloat(key, rasterizer->depth_bias_constant_factor);
+  PushFloat(key, rasterizer->depth_bias_clamp);
+  PushFloat(key, rasterizer->depth_bias_slope_factor);
+  PushWord(key, rasterizer->enable_depth_bias);
+  PushWord(key, rasterizer->enable_depth_clip);
+
+  const SDL_GPUMultisampleState *multisample = &createInfo->multisample_state;
+  PushWord(key, multisample->sample_count);
+  PushWord(key, multisample->sample_mask);
+  PushWord(key, multisample->enable_mask);
+
+  const SDL_GPUDepthStencilState *depthStencil = &createInfo->depth_stencil_state;
+  PushWord(key, depthStencil->compare_op);
+  PushStencilOpState(key, &depthStencil->back_stencil_state);
+  PushStencilOpState(key, &depthStencil->front_stencil_state);
+  PushWord(key, depthStencil->compare_mask);
+  PushWord(key, depthStencil->write_mask);
+  PushWord(key, depthStencil->enable_depth_test);
+  PushWord(key, depthStencil->enable_depth_write);
+  PushWord(key, depthStencil->enable_stencil_test);
+
+  PushWord(key, targetInfo->num_color_targets);
+  for (Uint32 i = 0; i < targetInfo->num_color_targets; i += 1)
+  {
+    const SDL_GPUColorTargetDescription *target = &targetInfo->color_target_descriptions[i];
+    PushWord(key, target->format);
+    PushWord(key, target->blend_state.src_color_blendfactor);
+    PushWord(key, target->blend_state.dst_color_blendfactor);
+    PushWord(key, target->blend_state.color_blend_op);
+    PushWord(key, target->blend_state.src_alpha_blendfactor);
+    PushWord(key, target->blend_state.dst_alpha_blendfactor);
+    PushWord(key, target->blend_state.alpha_blend_op);
+    PushWord(key, target->blend_state.color_write_mask);
+    PushWord(key, target->blend_state.enable_blend);
+    PushWord(key, target->blend_state.enable_color_write_mask);
+  }
+  PushWord(key, targetInfo->depth_stencil_format);
+  PushWord(key, targetInfo->has_depth_stencil_target);
+
+  PushWord(key, createInfo->props);
+  return true;
+}
+
+// 64 bit FNV-1a
+static Uint64 HashPipelineKey(const PipelineKey *key)
+{
+  Uint64 hash = 0xcbf29ce484222325ULL;
+  const Uint8 *bytes = (const Uint8 *)key->words;
+  for (size_t i = 0; i < key->count * sizeof(Uint32); i += 1)
+  {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+Uint64 PipelineRegistry_Hash(const SDL_GPUGraphicsPipelineCreateInfo *createInfo)
+{
+  PipelineKey key;
+  if (!BuildPipelineKey(createInfo, &key))
+  {
+    return 0;
+  }
+  return HashPipelineKey(&key);
+}
+
+PipelineRegistry *PipelineRegistry_Create(SDL_GPUDevice *device)
+{
+  PipelineRegistry *registry = SDL_calloc(1, sizeof(PipelineRegistry));
+  if (registry == NULL)
+  {
+    return NULL;
+  }
+  registry->device = device;
+  registry->lock = SDL_CreateMutex();
+  registry->built = SDL_CreateCondition();
+  if (registry->lock == NULL || registry->built == NULL)
+  {
+    SDL_Log("Failed to create pipeline registry: %s", SDL_GetError());
+    SDL_DestroyMutex(registry->lock);
+    SDL_DestroyCondition(registry->built);
+    SDL_free(registry);
+    return NULL;
+  }
+  return registry;
+}
+
+void PipelineRegistry_Destroy(PipelineRegistry *registry)
+{
+  if (registry == NULL)
+  {
+    return;
+  }
+  PipelineRegistry_WaitPrewarm(registry);
+  for (Uint32 i = 0; i < registry->count; i += 1)
+  {
+    if (registry->entries[i]->pipeline != NULL)
+    {
+      SDL_ReleaseGPUGraphicsPipeline(registry->device, registry->entries[i]->pipeline);
+    }
+    SDL_free(registry->entries[i]);
+  }
+  SDL_free(registry->entries);
+  SDL_DestroyCondition(registry->built);
+  SDL_DestroyMutex(registry->lock);
+  SDL_free(registry);
+}
+
+// Must be called with the lock held
+static PipelineEntry *FindEntry(PipelineRegistry *registry, Uint64 hash, const PipelineKey *key)
+{
+  for (Uint32 i = 0; i < registry->count; i += 1)
+  {
+    PipelineEntry *entry = registry->entries[i];
+    if (entry->hash == hash && entry->key.count == key->count &&
+        SDL_memcmp(entry->key.words, key->words, key->count * sizeof(Uint32)) == 0)
+    {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+// Must be called with the lock held. The new entry is pending until somebody builds it.
+static PipelineEntry *AddEntry(PipelineRegistry *registry, Uint64 hash, const PipelineKey *key, const SDL_GPUGraphicsPipelineCreateInfo *createInfo)
+{
+  if (registry->count == registry->capacity)
+  {
+    Uint32 newCapacity = registry->capacity == 0 ? 16 : registry->capacity * 2;
+    PipelineEntry **newEntries = SDL_realloc(registry->entries, sizeof(PipelineEntry *) * newCapacity);
+    if (newEntries == NULL)
+    {
+      return NULL;
+    }
+    registry->entries = newEntries;
+    registry->capacity = newCapacity;
+  }
+
+  PipelineEntry *entry = SDL_calloc(1, sizeof(PipelineEntry));
+  if (entry == NULL)
+  {
+    return NULL;
+  }
+  entry->hash = hash;
+  entry->key = *key;
+  entry->state = PIPELINE_STATE_PENDING;
+
+  const SDL_GPUVertexInputState *vertexInput = &createInfo->vertex_input_state;
+  const SDL_GPUGraphicsPipelineTargetInfo *targetInfo = &createInfo->target_info;
+  entry->createInfo = *createInfo;
+  if (vertexInput->num_vertex_buffers > 0)
+  {
+    SDL_memcpy(entry->vertexBuffers, vertexInput->vertex_buffer_descriptions, sizeof(SDL_GPUVertexBufferDescription) * vertexInput->num_vertex_buffers);
+  }
+  if (vertexInput->num_vertex_attributes > 0)
+  {
+    SDL_memcpy(entry->vertexAttributes, vertexInput->vertex_attributes, sizeof(SDL_GPUVertexAttribute) * vertexInput->num_vertex_attributes);
+  }
+  if (targetInfo->num_color_targets > 0)
+  {
+    SDL_memcpy(entry->colorTargets, targetInfo->color_target_descriptions, sizeof(SDL_GPUColorTargetDescription) * targetInfo->num_color_targets);
+  }
+  entry->createInfo.vertex_input_state.vertex_buffer_descriptions = entry->vertexBuffers;
+  entry->createInfo.vertex_input_state.vertex_attributes = entry->vertexAttributes;
+  entry->createInfo.target_info.color_target_descriptions = entry->colorTargets;
+
+  registry->entries[registry->count] = entry;
+  registry->count += 1;
+  return entry;
+}
+
+// Builds a pending entry without holding the lock, then wakes up anybody waiting on it
+static void BuildEntry(PipelineRegistry *registry, PipelineEntry *entry)
+{
+  SDL_GPUGraphicsPipeline *pipeline = SDL_CreateGPUGraphicsPipeline(registry->device, &entry->createInfo);
+  if (pipeline == NULL)
+  {
+    SDL_Log("Failed to create pipeline: %s", SDL_GetError());
+  }
+
+  SDL_LockMutex(registry->lock);
+  entry->pipeline = pipeline;
+  entry->state = pipeline != NULL ? PIPELINE_STATE_READY : PIPELINE_STATE_FAILED;
+  SDL_BroadcastCondition(registry->built);
+  SDL_UnlockMutex(registry->lock);
+}
+
+SDL_GPUGraphicsPipeline *PipelineRegistry_Get(PipelineRegistry *registry, const SDL_GPUGraphicsPipelineCreateInfo *createInfo)
+{
+  PipelineKey key;
+  if (!BuildPipelineKey(createInfo, &key))
+  {
+    return NULL;
+  }
+  Uint64 hash = HashPipelineKey(&key);
+
+  SDL_LockMutex(registry->lock);
+  PipelineEntry *entry = FindEntry(registry, hash, &key);
+  if (entry != NULL)
+  {
+    registry->hits += 1;
+    while (entry->state == PIPELINE_STATE_PENDING)
+    {
+      SDL_WaitCondition(registry->built, registry->lock);
+    }
+    SDL_GPUGraphicsPipeline *pipeline = entry->pipeline;
+    SDL_UnlockMutex(registry->lock);
+    return pipeline;
+  }
+
+  entry = AddEntry(registry, hash, &key, createInfo);
+  if (entry == NULL)
+  {
+    SDL_UnlockMutex(registry->lock);
+    SDL_Log("Failed to add a pipeline to the registry!");
+    return NULL;
+  }
+  registry->misses += 1;
+  SDL_UnlockMutex(registry->lock);
+
+  BuildEntry(registry, entry);
+  return entry->pipeline;
+}
+
+SDL_GPUGraphicsPipeline *PipelineRegistry_Find(PipelineRegistry *registry, Uint64 hash)
+{
+  SDL_GPUGraphicsPipeline *pipeline = NULL;
+  SDL_LockMutex(registry->lock);
+  for (Uint32 i = 0; i < registry->count; i += 1)
+  {
+    if (registry->entries[i]->hash == hash && registry->entries[i]->state == PIPELINE_STATE_READY)
+    {
+      pipeline = registry->entries[i]->pipeline;
+      break;
+    }
+  }
+  SDL_UnlockMutex(registry->lock);
+  return pipeline;
+}
+
+static void BuildQueue(PipelineRegistry *registry)
+{
+  while (true)
+  {
+    int index = SDL_AddAtomicInt(&registry->queueNext, 1);
+    if (index >= (int)registry->queueCount)
+    {
+      break;
+    }
+    TRACE_BEGIN("build pipeline");
+    BuildEntry(registry, registry->queue[index]);
+    TRACE_END();
+    SDL_AddAtomicInt(&registry->pending, -1);
+  }
+}
+
+static int SDLCALL PrewarmThread(void *data)
+{
+  TRACE_THREAD("pipeline prewarm");
+  BuildQueue(data);
+  return 0;
+}
+
+bool PipelineRegistry_Prewarm(PipelineRegistry *registry, const SDL_GPUGraphicsPipelineCreateInfo *createInfos, Uint32 count, Uint32 threadCount)
+{
+  // Only one batch at a time, the queue is owned by the running threads
+  PipelineRegistry_WaitPrewarm(registry);
+
+  registry->queue = SDL_malloc(sizeof(PipelineEntry *) * SDL_max(count, 1));
+  if (registry->queue == NULL)
+  {
+    return false;
+  }
+  registry->queueCount = 0;
+
+  SDL_LockMutex(registry->lock);
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    PipelineKey key;
+    if (!BuildPipelineKey(&createInfos[i], &key))
+    {
+      continue;
+    }
+    Uint64 hash = HashPipelineKey(&key);
+    if (FindEntry(registry, hash, &key) != NULL)
+    {
+      registry->hits += 1;
+      continue;
+    }
+    PipelineEntry *entry = AddEntry(registry, hash, &key, &createInfos[i]);
+    if (entry == NULL)
+    {
+      continue;
+    }
+    registry->misses += 1;
+    registry->queue[registry->queueCount] = entry;
+    registry->queueCount += 1;
+  }
+  SDL_UnlockMutex(registry->lock);
+
+  SDL_SetAtomicInt(&registry->queueNext, 0);
+  SDL_SetAtomicInt(&registry->pending, (int)registry->queueCount);
+
+  threadCount = SDL_clamp(threadCount, 1, MAX_PREWARM_THREADS);
+  threadCount = SDL_min(threadCount, registry->queueCount);
+  registry->threadCount = 0;
+  for (Uint32 i = 0; i < threadCount; i += 1)
+  {
+    SDL_Thread *thread = SDL_CreateThread(PrewarmThread, "PipelinePrewarm", registry);
+    if (thread == NULL)
+    {
+      SDL_Log("Failed to create a pipeline prewarm thread: %s", SDL_GetError());
+      break;
+    }
+    registry->threads[registry->threadCount] = thread;
+    registry->threadCount += 1;
+  }
+
+  // Couldn't get any thread, build everything right here so the entries never stay pending
+  if (registry->threadCount == 0)
+  {
+    BuildQueue(registry);
+  }
+  return true;
+}
+
+bool PipelineRegistry_IsPrewarmDone(PipelineRegistry *registry)
+{
+  return SDL_GetAtomicInt(&registry->pending) == 0;
+}
+
+void PipelineRegistry_WaitPrewarm(PipelineRegistry *registry)
+{
+  for (Uint32 i = 0; i < registry->threadCount; i += 1)
+  {
+    SDL_WaitThread(registry->threads[i], NULL);
+  }
+  registry->threadCount = 0;
+  SDL_free(registry->queue);
+  registry->queue = NULL;
+  registry->queueCount = 0;
+}
+
+PipelineRegistryStats PipelineRegistry_GetStats(PipelineRegistry *registry)
+{
+  PipelineRegistryStats stats;
+  SDL_LockMutex(registry->lock);
+  stats.hits = registry->hits;
+  stats.misses = registry->misses;
+  stats.count = registry->count;
+  SDL_UnlockMutex(registry->lock);
+  stats.pending = (Uint32)SDL_GetAtomicInt(&registry->pending);
+  return stats;
+}
+
+void PipelineRegistry_LogStats(PipelineRegistry *registry)
+{
+  PipelineRegistryStats stats = PipelineRegistry_GetStats(registry);
+  SDL_Log("Pipeline registry: %u pipelines, %u hits, %u misses, %u still pending", stats.count, stats.hits, stats.misses, stats.pending);
+}
@@ -0,0 +1,39 @@
+#ifndef PIPELINE_REGISTRY_H_
+#define PIPELINE_REGISTRY_H_
+#include <SDL3/SDL.h>
+
+// Dedupes graphics pipelines by hashing their full create info (targets, blend state, vertex layout, rasterizer, depth-stencil and shaders).
+// Shaders are hashed by handle, which works because LoadShader hands out one SDL_GPUShader per unique shader.
+typedef struct PipelineRegistry PipelineRegistry;
+
+typedef struct PipelineRegistryStats
+{
+  Uint32 hits;
+  Uint32 misses;
+  Uint32 count;   // unique pipelines, including the ones still being built
+  Uint32 pending; // pipelines queued or being built by the prewarm threads
+} PipelineRegistryStats;
+
+PipelineRegistry *PipelineRegistry_Create(SDL_GPUDevice *device);
+// Waits for any prewarm threads and releases every pipeline the registry created
+void PipelineRegistry_Destroy(PipelineRegistry *registry);
+
+Uint64 PipelineRegistry_Hash(const SDL_GPUGraphicsPipelineCreateInfo *createInfo);
+
+// Returns the pipeline for this create info, creating it on the calling thread if nobody asked for it before.
+// If the pipeline is being built by a prewarm thread this waits for it instead of building it twice.
+SDL_GPUGraphicsPipeline *PipelineRegistry_Get(PipelineRegistry *registry, const SDL_GPUGraphicsPipelineCreateInfo *createInfo);
+
+// Non-blocking lookup by PipelineRegistry_Hash, returns NULL while the pipeline is still being built (or if it failed)
+SDL_GPUGraphicsPipeline *PipelineRegistry_Find(PipelineRegistry *registry, Uint64 hash);
+
+// Builds a declared set of pipelines on threadCount worker threads and returns right away, so the window can keep presenting.
+// The create infos are copied, they don't need to outlive the call. Shaders must stay alive until the pipelines are built.
+bool PipelineRegistry_Prewarm(PipelineRegistry *registry, const SDL_GPUGraphicsPipelineCreateInfo *createInfos, Uint32 count, Uint32 threadCount);
+bool PipelineRegistry_IsPrewarmDone(PipelineRegistry *registry);
+void PipelineRegistry_WaitPrewarm(PipelineRegistry *registry);
+
+PipelineRegistryStats PipelineRegistry_GetStats(PipelineRegistry *registry);
+// One line with the stats, for examples to log at exit
+void PipelineRegistry_LogStats(PipelineRegistry *registry);
+#endif // PIPELINE_REGISTRY_H_
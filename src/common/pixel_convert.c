@@ -0,0 +1,468 @@
+#include "pixel_convert.h"
+#include <SDL3/SDL.h>
+
+// With flags the pixels are converted this many at a time into a buffer on the stack, which stays in L1 while the
+// tables and the premultiply go over it, then copied to the destination
+#define PIXEL_TILE_SIZE 256
+
+typedef void (*RowKernel)(const Uint8 *source, Uint8 *destination, Uint32 count);
+
+// One set of kernels per instruction set, indexed by PixelLayout
+typedef struct PixelKernels
+{
+  PixelConvertPath path;
+  RowKernel convert[PIXEL_LAYOUT_COUNT];
+  void (*premultiply)(Uint8 *pixels, Uint32 count);
+} PixelKernels;
+
+// 8 bit sRGB to linear and back, rounded. A gather per byte isn't faster than these loads, so every path shares them.
+static Uint8 ToLinear[256];
+static Uint8 ToSRGB[256];
+static SDL_InitState TablesInit;
+
+// Only the first call builds them, so a SetPath never rewrites a table another thread is converting with
+static void BuildTables(void)
+{
+  if (!SDL_ShouldInit(&TablesInit))
+  {
+    return;
+  }
+  for (int i = 0; i < 256; i += 1)
+  {
+    float value = i / 255.0f;
+    float linear = value <= 0.04045f ? value / 12.92f : SDL_powf((value + 0.055f) / 1.055f, 2.4f);
+    float srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * SDL_powf(value, 1.0f / 2.4f) - 0.055f;
+    ToLinear[i] = (Uint8)(linear * 255.0f + 0.5f);
+    ToSRGB[i] = (Uint8)(srgb * 255.0f + 0.5f);
+  }
+  SDL_SetInitialized(&TablesInit, true);
+}
+
+static void ApplyTable(Uint8 *pixels, Uint32 count, const Uint8 *table)
+{
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    Uint8 *texel = pixels + i * 4;
+    texel[0] = table[texel[0]];
+    texel[1] = table[texel[1]];
+    texel[2] = table[texel[2]];
+  }
+}
+
+// Scalar reference, the SIMD kernels round the same way and match it byte for byte
+
+static void ScalarConvertBGR24(const Uint8 *source, Uint8 *destination, Uint32 count)
+{
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    const Uint8 *bgr = source + i * 3;
+    Uint8 texel[4] = {bgr[2], bgr[1], bgr[0], 255};
+    SDL_memcpy(destination + i * 4, texel, 4);
+  }
+}
+
+static void ScalarConvertBGRA32(const Uint8 *source, Uint8 *destination, Uint32 count)
+{
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    const Uint8 *bgra = source + i * 4;
+    Uint8 texel[4] = {bgra[2], bgra[1], bgra[0], bgra[3]};
+    SDL_memcpy(destination + i * 4, texel, 4);
+  }
+}
+
+static void ScalarConvertBGRX32(const Uint8 *source, Uint8 *destination, Uint32 count)
+{
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    const Uint8 *bgrx = source + i * 4;
+    Uint8 texel[4] = {bgrx[2], bgrx[1], bgrx[0], 255};
+    SDL_memcpy(destination + i * 4, texel, 4);
+  }
+}
+
+static void CopyRGBA32(const Uint8 *source, Uint8 *destination, Uint32 count)
+{
+  SDL_memcpy(destination, source, (size_t)count * 4);
+}
+
+// color * alpha / 255 rounded to nearest, exact for every pair without a division
+static Uint8 MultiplyAlpha(Uint32 color, Uint32 alpha)
+{
+  Uint32 product = color * alpha + 128;
+  return (Uint8)((product + (product >> 8)) >> 8);
+}
+
+static void ScalarPremultiply(Uint8 *pixels, Uint32 count)
+{
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    Uint8 *texel = pixels + i * 4;
+    texel[0] = MultiplyAlpha(texel[0], texel[3]);
+    texel[1] = MultiplyAlpha(texel[1], texel[3]);
+    texel[2] = MultiplyAlpha(texel[2], texel[3]);
+  }
+}
+
+static const PixelKernels ScalarKernels = {
+    PIXEL_CONVERT_SCALAR,
+    {ScalarConvertBGR24, ScalarConvertBGRA32, ScalarConvertBGRX32, CopyRGBA32},
+    ScalarPremultiply};
+
+// SDL has no SSSE3 check or intrinsics define, SSE4.1 implies it and brings in its header
+#ifdef SDL_SSE4_1_INTRINSICS
+// 16 pixels from three loads: _mm_alignr_epi8 lines up each group of 4 at the start of a register, one shuffle per group
+static void SDL_TARGETING("ssse3") SSSE3_ConvertBGR24(const Uint8 *source, Uint8 *destination, Uint32 count)
+{
+  const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+  const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+  Uint32 i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    const Uint8 *bgr = source + i * 3;
+    __m128i a = _mm_loadu_si128((const __m128i *)bgr);
+    __m128i b = _mm_loadu_si128((const __m128i *)(bgr + 16));
+    __m128i c = _mm_loadu_si128((const __m128i *)(bgr + 32));
+    __m128i *out = (__m128i *)(destination + i * 4);
+    _mm_storeu_si128(out, _mm_or_si128(_mm_shuffle_epi8(a, shuffle), alpha));
+    _mm_storeu_si128(out + 1, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), shuffle), alpha));
+    _mm_storeu_si128(out + 2, _mm_or_si128(_mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), shuffle), alpha));
+    _mm_storeu_si128(out + 3, _mm_or_si128(_mm_shuffle_epi8(_mm_srli_si128(c, 4), shuffle), alpha));
+  }
+  ScalarConvertBGR24(source + i * 3, destination + i * 4, count - i);
+}
+
+static void SDL_TARGETING("ssse3") SSSE3_ConvertBGRA32(const Uint8 *source, Uint8 *destination, Uint32 count)
+{
+  const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  Uint32 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i bgra = _mm_loadu_si128((const __m128i *)(source + i * 4));
+    _mm_storeu_si128((__m128i *)(destination + i * 4), _mm_shuffle_epi8(bgra, shuffle));
+  }
+  ScalarConvertBGRA32(source + i * 4, destination + i * 4, count - i);
+}
+
+static void SDL_TARGETING("ssse3") SSSE3_ConvertBGRX32(const Uint8 *source, Uint8 *destination, Uint32 count)
+{
+  const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1);
+  const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+  Uint32 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i bgrx = _mm_loadu_si128((const __m128i *)(source + i * 4));
+    _mm_storeu_si128((__m128i *)(destination + i * 4), _mm_or_si128(_mm_shuffle_epi8(bgrx, shuffle), alpha));
+  }
+  ScalarConvertBGRX32(source + i * 4, destination + i * 4, count - i);
+}
+
+// Two pixels widened to 16 bits, each channel times its alpha and alpha times 255, divided like MultiplyAlpha
+static __m128i SDL_TARGETING("ssse3") SSSE3_PremultiplyPair(__m128i pixels)
+{
+  const __m128i colorLanes = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+  const __m128i alphaLanes = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+  __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+  alpha = _mm_or_si128(_mm_and_si128(alpha, colorLanes), alphaLanes);
+  __m128i product = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+}
+
+static void SDL_TARGETING("ssse3") SSSE3_Premultiply(Uint8 *pixels, Uint32 count)
+{
+  const __m128i zero = _mm_setzero_si128();
+  Uint32 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128i *texels = (__m128i *)(pixels + i * 4);
+    __m128i rgba = _mm_loadu_si128(texels);
+    __m128i low = SSSE3_PremultiplyPair(_mm_unpacklo_epi8(rgba, zero));
+    __m128i high = SSSE3_PremultiplyPair(_mm_unpackhi_epi8(rgba, zero));
+    _mm_storeu_si128(texels, _mm_packus_epi16(low, high));
+  }
+  ScalarPremultiply(pixels + i * 4, count - i);
+}
+
+static const PixelKernels SSSE3Kernels = {
+    PIXEL_CONVERT_SSSE3,
+    {SSSE3_ConvertBGR24, SSSE3_ConvertBGRA32, SSSE3_ConvertBGRX32, CopyRGBA32},
+    SSSE3_Premultiply};
+#endif
+
+#if defined(SDL_AVX2_INTRINSICS) && defined(SDL_SSE4_1_INTRINSICS)
+// _mm256_shuffle_epi8 doesn't cross the 128 bit halves, so each half is loaded with its own 4 pixels
+static void SDL_TARGETING("avx2") AVX2_ConvertBGR24(const Uint8 *source, Uint8 *destination, Uint32 count)
+{
+  const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+                                           2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+  const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+  Uint32 i = 0;
+  // The last load reads 4 bytes past its 4 pixels, which have to be in the row
+  for (; i + 18 <= count; i += 16)
+  {
+    const Uint8 *bgr = source + i * 3;
+    __m256i first = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)bgr)),
+                                            _mm_loadu_si128((const __m128i *)(bgr + 12)), 1);
+    __m256i second = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(bgr + 24))),
+                                             _mm_loadu_si128((const __m128i *)(bgr + 36)), 1);
+    __m256i *out = (__m256i *)(destination + i * 4);
+    _mm256_storeu_si256(out, _mm256_or_si256(_mm256_shuffle_epi8(first, shuffle), alpha));
+    _mm256_storeu_si256(out + 1, _mm256_or_si256(_mm256_shuffle_epi8(second, shuffle), alpha));
+  }
+  SSSE3_ConvertBGR24(source + i * 3, destination + i * 4, count - i);
+}
+
+static void SDL_TARGETING("avx2") AVX2_ConvertBGRA32(const Uint8 *source, Uint8 *destination, Uint32 count)
+{
+  const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                           2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  Uint32 i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256i bgra = _mm256_loadu_si256((const __m256i *)(source + i * 4));
+    _mm256_storeu_si256((__m256i *)(destination + i * 4), _mm256_shuffle_epi8(bgra, shuffle));
+  }
+  SSSE3_ConvertBGRA32(source + i * 4, destination + i * 4, count - i);
+}
+
+static void SDL_TARGETING("avx2") AVX2_ConvertBGRX32(const Uint8 *source, Uint8 *destination, Uint32 count)
+{
+  const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,
+                                           2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1);
+  const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+  Uint32 i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256i bgrx = _mm256_loadu_si256((const __m256i *)(source + i * 4));
+    _mm256_storeu_si256((__m256i *)(destination + i * 4), _mm256_or_si256(_mm256_shuffle_epi8(bgrx, shuffle), alpha));
+  }
+  SSSE3_ConvertBGRX32(source + i * 4, destination + i * 4, count - i);
+}
+
+// Same as SSSE3_PremultiplyPair on both halves, unpack and pack stay within them so the pixel order is kept
+static __m256i SDL_TARGETING("avx2") AVX2_PremultiplyPairs(__m256i pixels)
+{
+  const __m256i colorLanes = _mm256_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0);
+  const __m256i alphaLanes = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+  __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+  alpha = _mm256_or_si256(_mm256_and_si256(alpha, colorLanes), alphaLanes);
+  __m256i product = _mm256_add_epi16(_mm256_mullo_epi16(pixels, alpha), _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+}
+
+static void SDL_TARGETING("avx2") AVX2_Premultiply(Uint8 *pixels, Uint32 count)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  Uint32 i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256i *texels = (__m256i *)(pixels + i * 4);
+    __m256i rgba = _mm256_loadu_si256(texels);
+    __m256i low = AVX2_PremultiplyPairs(_mm256_unpacklo_epi8(rgba, zero));
+    __m256i high = AVX2_PremultiplyPairs(_mm256_unpackhi_epi8(rgba, zero));
+    _mm256_storeu_si256(texels, _mm256_packus_epi16(low, high));
+  }
+  SSSE3_Premultiply(pixels + i * 4, count - i);
+}
+
+static const PixelKernels AVX2Kernels = {
+    PIXEL_CONVERT_AVX2,
+    {AVX2_ConvertBGR24, AVX2_ConvertBGRA32, AVX2_ConvertBGRX32, CopyRGBA32},
+    AVX2_Premultiply};
+#endif
+
+#ifdef SDL_NEON_INTRINSICS
+// vld3q_u8 and vld4q_u8 deinterleave 16 pixels into one register per channel, vst4q_u8 interleaves them back
+static void NEON_ConvertBGR24(const Uint8 *source, Uint8 *destination, Uint32 count)
+{
+  Uint32 i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    uint8x16x3_t bgr = vld3q_u8(source + i * 3);
+    uint8x16x4_t rgba = {{bgr.val[2], bgr.val[1], bgr.val[0], vdupq_n_u8(255)}};
+    vst4q_u8(destination + i * 4, rgba);
+  }
+  ScalarConvertBGR24(source + i * 3, destination + i * 4, count - i);
+}
+
+static void NEON_ConvertBGRA32(const Uint8 *source, Uint8 *destination, Uint32 count)
+{
+  Uint32 i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    uint8x16x4_t bgra = vld4q_u8(source + i * 4);
+    uint8x16x4_t rgba = {{bgra.val[2], bgra.val[1], bgra.val[0], bgra.val[3]}};
+    vst4q_u8(destination + i * 4, rgba);
+  }
+  ScalarConvertBGRA32(source + i * 4, destination + i * 4, count - i);
+}
+
+static void NEON_ConvertBGRX32(const Uint8 *source, Uint8 *destination, Uint32 count)
+{
+  Uint32 i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    uint8x16x4_t bgrx = vld4q_u8(source + i * 4);
+    uint8x16x4_t rgba = {{bgrx.val[2], bgrx.val[1], bgrx.val[0], vdupq_n_u8(255)}};
+    vst4q_u8(destination + i * 4, rgba);
+  }
+  ScalarConvertBGRX32(source + i * 4, destination + i * 4, count - i);
+}
+
+// vrsraq_n_u16 adds (product + 128) >> 8 and vrshrn_n_u16 rounds the sum down to 8 bits, the division of MultiplyAlpha
+static uint8x16_t NEON_MultiplyAlpha(uint8x16_t color, uint8x16_t alpha)
+{
+  uint16x8_t low = vmull_u8(vget_low_u8(color), vget_low_u8(alpha));
+  uint16x8_t high = vmull_u8(vget_high_u8(color), vget_high_u8(alpha));
+  return vcombine_u8(vrshrn_n_u16(vrsraq_n_u16(low, low, 8), 8), vrshrn_n_u16(vrsraq_n_u16(high, high, 8), 8));
+}
+
+static void NEON_Premultiply(Uint8 *pixels, Uint32 count)
+{
+  Uint32 i = 0;
+  for (; i + 16 <= count; i += 16)
+  {
+    uint8x16x4_t rgba = vld4q_u8(pixels + i * 4);
+    rgba.val[0] = NEON_MultiplyAlpha(rgba.val[0], rgba.val[3]);
+    rgba.val[1] = NEON_MultiplyAlpha(rgba.val[1], rgba.val[3]);
+    rgba.val[2] = NEON_MultiplyAlpha(rgba.val[2], rgba.val[3]);
+    vst4q_u8(pixels + i * 4, rgba);
+  }
+  ScalarPremultiply(pixels + i * 4, count - i);
+}
+
+static const PixelKernels NEONKernels = {
+    PIXEL_CONVERT_NEON,
+    {NEON_ConvertBGR24, NEON_ConvertBGRA32, NEON_ConvertBGRX32, CopyRGBA32},
+    NEON_Premultiply};
+#endif
+
+// Picked on first use, racing threads pick the same kernels. Published after the tables are built.
+static void *Kernels;
+
+static const PixelKernels *GetKernels(void)
+{
+  const PixelKernels *kernels = SDL_GetAtomicPointer(&Kernels);
+  if (kernels == NULL)
+  {
+    PixelConvert_SetPath(PIXEL_CONVERT_AUTO);
+    kernels = SDL_GetAtomicPointer(&Kernels);
+  }
+  return kernels;
+}
+
+static const PixelKernels *FindKernels(PixelConvertPath path)
+{
+  switch (path)
+  {
+  case PIXEL_CONVERT_AUTO:
+  {
+    const PixelKernels *kernels = FindKernels(PIXEL_CONVERT_AVX2);
+    if (kernels == NULL)
+    {
+      kernels = FindKernels(PIXEL_CONVERT_SSSE3);
+    }
+    if (kernels == NULL)
+    {
+      kernels = FindKernels(PIXEL_CONVERT_NEON);
+    }
+    return kernels != NULL ? kernels : &ScalarKernels;
+  }
+  case PIXEL_CONVERT_SCALAR:
+    return &ScalarKernels;
+#if defined(SDL_AVX2_INTRINSICS) && defined(SDL_SSE4_1_INTRINSICS)
+  case PIXEL_CONVERT_AVX2:
+    return SDL_HasAVX2() ? &AVX2Kernels : NULL;
+#endif
+#ifdef SDL_SSE4_1_INTRINSICS
+  case PIXEL_CONVERT_SSSE3:
+    return SDL_HasSSE41() ? &SSSE3Kernels : NULL;
+#endif
+#ifdef SDL_NEON_INTRINSICS
+  case PIXEL_CONVERT_NEON:
+    return SDL_HasNEON() ? &NEONKernels : NULL;
+#endif
+  default:
+    return NULL;
+  }
+}
+
+bool PixelConvert_SetPath(PixelConvertPath path)
+{
+  const PixelKernels *kernels = FindKernels(path);
+  if (kernels == NULL)
+  {
+    SDL_Log("%s pixel conversion kernels aren't available on this CPU or build", PixelConvert_GetPathName(path));
+    return false;
+  }
+  BuildTables();
+  SDL_SetAtomicPointer(&Kernels, (void *)kernels);
+  return true;
+}
+
+PixelConvertPath PixelConvert_GetPath(void)
+{
+  return GetKernels()->path;
+}
+
+const char *PixelConvert_GetPathName(PixelConvertPath path)
+{
+  switch (path)
+  {
+  case PIXEL_CONVERT_AUTO:
+    return "auto";
+  case PIXEL_CONVERT_SCALAR:
+    return "scalar";
+  case PIXEL_CONVERT_SSSE3:
+    return "SSSE3";
+  case PIXEL_CONVERT_AVX2:
+    return "AVX2";
+  case PIXEL_CONVERT_NEON:
+    return "NEON";
+  default:
+    return "unknown";
+  }
+}
+
+Uint32 PixelLayout_GetBytesPerPixel(PixelLayout layout)
+{
+  return layout == PIXEL_LAYOUT_BGR24 ? 3 : 4;
+}
+
+void PixelConvert_Row(PixelLayout layout, PixelConvertFlags flags, const void *source, void *destination, Uint32 count)
+{
+  const PixelKernels *kernels = GetKernels();
+  const Uint8 *in = source;
+  Uint8 *out = destination;
+  if (flags == PIXEL_CONVERT_NONE)
+  {
+    kernels->convert[layout](in, out, count);
+    return;
+  }
+
+  const Uint8 *table = NULL;
+  if (flags & PIXEL_CONVERT_SRGB_TO_LINEAR)
+  {
+    table = ToLinear;
+  }
+  else if (flags & PIXEL_CONVERT_LINEAR_TO_SRGB)
+  {
+    table = ToSRGB;
+  }
+  Uint32 bytesPerPixel = PixelLayout_GetBytesPerPixel(layout);
+  Uint8 tile[PIXEL_TILE_SIZE * 4];
+  for (Uint32 i = 0; i < count; i += PIXEL_TILE_SIZE)
+  {
+    Uint32 tileCount = SDL_min(PIXEL_TILE_SIZE, count - i);
+    kernels->convert[layout](in + (size_t)i * bytesPerPixel, tile, tileCount);
+    if (table != NULL)
+    {
+      ApplyTable(tile, tileCount, table);
+    }
+    if (flags & PIXEL_CONVERT_PREMULTIPLY_ALPHA)
+    {
+      kernels->premultiply(tile, tileCount);
+    }
+    SDL_memcpy(out + (size_t)i * 4, tile, (size_t)tileCount * 4);
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef PIXEL_CONVERT_H_
+#define PIXEL_CONVERT_H_
+#include <SDL3/SDL.h>
+
+// Row conversions from the common BMP pixel layouts to SDL_PIXELFORMAT_ABGR8888 (R8G8B8A8 in memory), what
+// SDL_ConvertSurface does for LoadImage but one row at a time, so ImageFile_ReadPixels can write each row straight into
+// transfer memory. Optionally the color channels also go through the sRGB transfer function (either way) and get
+// multiplied by alpha on the way.
+//
+// The swizzles and the premultiply have SSSE3, AVX2 and NEON versions next to the scalar one, picked on first use like
+// LinearAlgebra's kernels; PixelConvert_SetPath(PIXEL_CONVERT_SCALAR) forces the scalar reference.
+typedef enum PixelLayout
+{
+  PIXEL_LAYOUT_BGR24,  // 24 bit BMPs, SDL_PIXELFORMAT_BGR24
+  PIXEL_LAYOUT_BGRA32, // 32 bit BMPs with an alpha mask, SDL_PIXELFORMAT_ARGB8888 on little endian
+  PIXEL_LAYOUT_BGRX32, // 32 bit BMPs without one, the fourth byte is ignored and alpha written as 255
+  PIXEL_LAYOUT_RGBA32, // already ABGR8888, only the flags do anything
+  PIXEL_LAYOUT_COUNT
+} PixelLayout;
+
+typedef enum PixelConvertFlags
+{
+  PIXEL_CONVERT_NONE = 0,
+  // After the transfer function, so the colors get multiplied in the space they're stored in
+  PIXEL_CONVERT_PREMULTIPLY_ALPHA = 1 << 0,
+  // Through 256 entry tables, alpha is left alone, at most one of the two. 8 bit linear colors lose most of the dark
+  // shades, only worth it when the texture is linear for another reason
+  PIXEL_CONVERT_SRGB_TO_LINEAR = 1 << 1,
+  PIXEL_CONVERT_LINEAR_TO_SRGB = 1 << 2
+} PixelConvertFlags;
+
+typedef enum PixelConvertPath
+{
+  PIXEL_CONVERT_AUTO,
+  PIXEL_CONVERT_SCALAR,
+  PIXEL_CONVERT_SSSE3,
+  PIXEL_CONVERT_AVX2,
+  PIXEL_CONVERT_NEON
+} PixelConvertPath;
+
+Uint32 PixelLayout_GetBytesPerPixel(PixelLayout layout);
+// Converts count pixels. The destination is only written, front to back, so it can be write-combined memory;
+// with flags the pixels go through a small buffer on the stack first.
+void PixelConvert_Row(PixelLayout layout, PixelConvertFlags flags, const void *source, void *destination, Uint32 count);
+
+// Returns false, and keeps the current path, if the CPU or the build doesn't have it
+bool PixelConvert_SetPath(PixelConvertPath path);
+PixelConvertPath PixelConvert_GetPath(void);
+const char *PixelConvert_GetPathName(PixelConvertPath path);
+#endif // PIXEL_CONVERT_H_
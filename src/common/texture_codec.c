@@ -0,0 +1,702 @@
+#include <float.h>
+#include "texture_codec.h"
+
+// Power iterations for the principal axis of a block, plenty for 16 texels
+#define PRINCIPAL_AXIS_ITERATIONS 8
+
+static const char *TextureCodecNames[TEXTURE_CODEC_COUNT] = {"rgba8", "bc1", "bc3", "bc7"};
+static const SDL_GPUTextureFormat TextureCodecFormats[TEXTURE_CODEC_COUNT] = {
+    SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+    SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM,
+    SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM,
+    SDL_GPU_TEXTUREFORMAT_BC7_RGBA_UNORM};
+
+// Weights of the second endpoint in 64ths for BC7's 4 bit indices
+static const int Bc7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+const char *TextureCodec_GetName(TextureCodec codec)
+{
+  return codec < TEXTURE_CODEC_COUNT ? TextureCodecNames[codec] : "unknown";
+}
+
+bool TextureCodec_Parse(const char *name, TextureCodec *codec)
+{
+  for (int i = 0; i < TEXTURE_CODEC_COUNT; i += 1)
+  {
+    if (SDL_strcasecmp(name, TextureCodecNames[i]) == 0)
+    {
+      *codec = (TextureCodec)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+SDL_GPUTextureFormat TextureCodec_GetFormat(TextureCodec codec)
+{
+  return codec < TEXTURE_CODEC_COUNT ? TextureCodecFormats[codec] : SDL_GPU_TEXTUREFORMAT_INVALID;
+}
+
+static Uint32 GetBlockSize(TextureCodec codec)
+{
+  return codec == TEXTURE_CODEC_BC1 ? 8 : 16;
+}
+
+Uint32 TextureCodec_GetLevelSize(TextureCodec codec, Uint32 width, Uint32 height)
+{
+  if (codec == TEXTURE_CODEC_RGBA8)
+  {
+    return width * height * 4;
+  }
+  return ((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(codec);
+}
+
+Uint32 TextureCodec_GetChainSize(TextureCodec codec, Uint32 width, Uint32 height, Uint32 levelCount)
+{
+  Uint32 size = 0;
+  for (Uint32 level = 0; level < levelCount; level += 1)
+  {
+    size += TextureCodec_GetLevelSize(codec, SDL_max(width >> level, 1), SDL_max(height >> level, 1));
+  }
+  return size;
+}
+
+static void GatherBlock(const Uint8 *rgba, Uint32 width, Uint32 height, Uint32 blockX, Uint32 blockY, Uint8 texels[16][4])
+{
+  for (Uint32 y = 0; y < 4; y += 1)
+  {
+    Uint32 sourceY = SDL_min(blockY * 4 + y, height - 1);
+    for (Uint32 x = 0; x < 4; x += 1)
+    {
+      Uint32 sourceX = SDL_min(blockX * 4 + x, width - 1);
+      SDL_memcpy(texels[y * 4 + x], rgba + ((size_t)sourceY * width + sourceX) * 4, 4);
+    }
+  }
+}
+
+// Mean and unit length principal axis of the first channelCount channels. The axis is all zeros if the texels are all equal.
+static void GetPrincipalAxis(const Uint8 texels[16][4], int channelCount, float mean[4], float axis[4])
+{
+  float low[4] = {255.0f, 255.0f, 255.0f, 255.0f};
+  float high[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  for (int channel = 0; channel < 4; channel += 1)
+  {
+    mean[channel] = 0.0f;
+    axis[channel] = 0.0f;
+  }
+  for (int i = 0; i < 16; i += 1)
+  {
+    for (int channel = 0; channel < channelCount; channel += 1)
+    {
+      mean[channel] += texels[i][channel] / 16.0f;
+      low[channel] = SDL_min(low[channel], texels[i][channel]);
+      high[channel] = SDL_max(high[channel], texels[i][channel]);
+    }
+  }
+
+  float covariance[4][4] = {{0.0f}};
+  for (int i = 0; i < 16; i += 1)
+  {
+    float offset[4];
+    for (int channel = 0; channel < channelCount; channel += 1)
+    {
+      offset[channel] = texels[i][channel] - mean[channel];
+    }
+    for (int row = 0; row < channelCount; row += 1)
+    {
+      for (int column = 0; column < channelCount; column += 1)
+      {
+        covariance[row][column] += offset[row] * offset[column];
+      }
+    }
+  }
+
+  // The diagonal of the box the texels span is close to the axis for most blocks
+  float vector[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  for (int channel = 0; channel < channelCount; channel += 1)
+  {
+    vector[channel] = high[channel] - low[channel];
+  }
+  for (int iteration = 0; iteration < PRINCIPAL_AXIS_ITERATIONS; iteration += 1)
+  {
+    float next[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float largest = 0.0f;
+    for (int row = 0; row < channelCount; row += 1)
+    {
+      for (int column = 0; column < channelCount; column += 1)
+      {
+        next[row] += covariance[row][column] * vector[column];
+      }
+      largest = SDL_max(largest, SDL_fabsf(next[row]));
+    }
+    if (largest == 0.0f)
+    {
+      break;
+    }
+    for (int channel = 0; channel < channelCount; channel += 1)
+    {
+      vector[channel] = next[channel] / largest;
+    }
+  }
+
+  float length = 0.0f;
+  for (int channel = 0; channel < channelCount; channel += 1)
+  {
+    length += vector[channel] * vector[channel];
+  }
+  if (length > 0.0f)
+  {
+    length = SDL_sqrtf(length);
+    for (int channel = 0; channel < channelCount; channel += 1)
+    {
+      axis[channel] = vector[channel] / length;
+    }
+  }
+}
+
+// Extent of the texels along the axis, as offsets from the mean
+static void ProjectOntoAxis(const Uint8 texels[16][4], int channelCount, const float mean[4], const float axis[4], float *low, float *high)
+{
+  *low = 0.0f;
+  *high = 0.0f;
+  for (int i = 0; i < 16; i += 1)
+  {
+    float t = 0.0f;
+    for (int channel = 0; channel < channelCount; channel += 1)
+    {
+      t += (texels[i][channel] - mean[channel]) * axis[channel];
+    }
+    *low = SDL_min(*low, t);
+    *high = SDL_max(*high, t);
+  }
+}
+
+// The endpoints that reproduce the texels best in the least squares sense, with weights[i] of endpoint 0 and the rest of
+// endpoint 1 in texel i. Returns false if the weights don't pin both endpoints down, when all texels use the same index.
+static bool SolveEndpoints(const Uint8 texels[16][4], int channelCount, const float weights[16], float endpoints[2][4])
+{
+  float aa = 0.0f;
+  float ab = 0.0f;
+  float bb = 0.0f;
+  float ax[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  float bx[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  for (int i = 0; i < 16; i += 1)
+  {
+    float a = weights[i];
+    float b = 1.0f - weights[i];
+    aa += a * a;
+    ab += a * b;
+    bb += b * b;
+    for (int channel = 0; channel < channelCount; channel += 1)
+    {
+      ax[channel] += a * texels[i][channel];
+      bx[channel] += b * texels[i][channel];
+    }
+  }
+  float determinant = aa * bb - ab * ab;
+  if (SDL_fabsf(determinant) < 1e-6f)
+  {
+    return false;
+  }
+  for (int channel = 0; channel < channelCount; channel += 1)
+  {
+    endpoints[0][channel] = SDL_clamp((ax[channel] * bb - bx[channel] * ab) / determinant, 0.0f, 255.0f);
+    endpoints[1][channel] = SDL_clamp((bx[channel] * aa - ax[channel] * ab) / determinant, 0.0f, 255.0f);
+  }
+  return true;
+}
+
+static Uint16 PackColor565(const float color[4])
+{
+  int r = SDL_clamp((int)(color[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+  int g = SDL_clamp((int)(color[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+  int b = SDL_clamp((int)(color[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+  return (Uint16)((r << 11) | (g << 5) | b);
+}
+
+// The four colors of a BC1 block. threeColor is the mode BC1 decoders switch to when color0 <= color1, with index 3 transparent black.
+static void GetColorPalette(Uint16 color0, Uint16 color1, bool threeColor, int palette[4][4])
+{
+  Uint16 colors[2] = {color0, color1};
+  for (int i = 0; i < 2; i += 1)
+  {
+    int r = (colors[i] >> 11) & 31;
+    int g = (colors[i] >> 5) & 63;
+    int b = colors[i] & 31;
+    palette[i][0] = (r << 3) | (r >> 2);
+    palette[i][1] = (g << 2) | (g >> 4);
+    palette[i][2] = (b << 3) | (b >> 2);
+    palette[i][3] = 255;
+  }
+  for (int channel = 0; channel < 3; channel += 1)
+  {
+    if (threeColor)
+    {
+      palette[2][channel] = (palette[0][channel] + palette[1][channel]) / 2;
+      palette[3][channel] = 0;
+    }
+    else
+    {
+      palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+      palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+    }
+  }
+  palette[2][3] = 255;
+  palette[3][3] = threeColor ? 0 : 255;
+}
+
+// Orders the endpoints for the four color mode and picks the nearest color for each texel. Returns the squared error.
+static Uint32 FitColorIndices(const Uint8 texels[16][4], Uint16 *color0, Uint16 *color1, Uint32 *indices)
+{
+  if (*color0 < *color1)
+  {
+    Uint16 swap = *color0;
+    *color0 = *color1;
+    *color1 = swap;
+  }
+  int palette[4][4];
+  GetColorPalette(*color0, *color1, false, palette);
+  // Equal endpoints decode in the three color mode, where only index 0 is safe
+  int paletteSize = *color0 == *color1 ? 1 : 4;
+
+  Uint32 error = 0;
+  *indices = 0;
+  for (int i = 0; i < 16; i += 1)
+  {
+    Uint32 bestError = SDL_MAX_UINT32;
+    Uint32 bestIndex = 0;
+    for (int entry = 0; entry < paletteSize; entry += 1)
+    {
+      Uint32 entryError = 0;
+      for (int channel = 0; channel < 3; channel += 1)
+      {
+        int difference = texels[i][channel] - palette[entry][channel];
+        entryError += difference * difference;
+      }
+      if (entryError < bestError)
+      {
+        bestError = entryError;
+        bestIndex = entry;
+      }
+    }
+    *indices |= bestIndex << (i * 2);
+    error += bestError;
+  }
+  return error;
+}
+
+// Endpoints from the extent of the colors along their principal axis, then one least squares pass over the indices they give
+static void EncodeColorBlock(const Uint8 texels[16][4], Uint8 *block)
+{
+  float mean[4];
+  float axis[4];
+  float low;
+  float high;
+  GetPrincipalAxis(texels, 3, mean, axis);
+  ProjectOntoAxis(texels, 3, mean, axis, &low, &high);
+  // The extremes are rarely worth an entry of their own, pulling the endpoints in a little spends the palette on the rest
+  float inset = (high - low) / 16.0f;
+  float endpoints[2][4];
+  for (int channel = 0; channel < 3; channel += 1)
+  {
+    endpoints[0][channel] = mean[channel] + axis[channel] * (high - inset);
+    endpoints[1][channel] = mean[channel] + axis[channel] * (low + inset);
+  }
+  Uint16 color0 = PackColor565(endpoints[0]);
+  Uint16 color1 = PackColor565(endpoints[1]);
+  Uint32 indices;
+  Uint32 error = FitColorIndices(texels, &color0, &color1, &indices);
+
+  static const float IndexWeights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+  float weights[16];
+  for (int i = 0; i < 16; i += 1)
+  {
+    weights[i] = IndexWeights[(indices >> (i * 2)) & 3];
+  }
+  if (SolveEndpoints(texels, 3, weights, endpoints))
+  {
+    Uint16 refined0 = PackColor565(endpoints[0]);
+    Uint16 refined1 = PackColor565(endpoints[1]);
+    Uint32 refinedIndices;
+    if (FitColorIndices(texels, &refined0, &refined1, &refinedIndices) < error)
+    {
+      color0 = refined0;
+      color1 = refined1;
+      indices = refinedIndices;
+    }
+  }
+
+  block[0] = (Uint8)color0;
+  block[1] = (Uint8)(color0 >> 8);
+  block[2] = (Uint8)color1;
+  block[3] = (Uint8)(color1 >> 8);
+  for (int i = 0; i < 4; i += 1)
+  {
+    block[4 + i] = (Uint8)(indices >> (i * 8));
+  }
+}
+
+static void DecodeColorBlock(const Uint8 *block, bool allowThreeColor, Uint8 texels[16][4])
+{
+  Uint16 color0 = (Uint16)(block[0] | (block[1] << 8));
+  Uint16 color1 = (Uint16)(block[2] | (block[3] << 8));
+  int palette[4][4];
+  GetColorPalette(color0, color1, allowThreeColor && color0 <= color1, palette);
+  Uint32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((Uint32)block[7] << 24);
+  for (int i = 0; i < 16; i += 1)
+  {
+    const int *color = palette[(indices >> (i * 2)) & 3];
+    for (int channel = 0; channel < 4; channel += 1)
+    {
+      texels[i][channel] = (Uint8)color[channel];
+    }
+  }
+}
+
+// The eight values of a BC3 alpha block: alpha0 > alpha1 interpolates six between them, otherwise four plus 0 and 255
+static void GetAlphaPalette(int alpha0, int alpha1, int palette[8])
+{
+  palette[0] = alpha0;
+  palette[1] = alpha1;
+  if (alpha0 > alpha1)
+  {
+    for (int i = 1; i < 7; i += 1)
+    {
+      palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+    }
+  }
+  else
+  {
+    for (int i = 1; i < 5; i += 1)
+    {
+      palette[i + 1] = ((5 - i) * alpha0 + i * alpha1) / 5;
+    }
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+}
+
+static void EncodeAlphaBlock(const Uint8 texels[16][4], Uint8 *block)
+{
+  int low = 255;
+  int high = 0;
+  for (int i = 0; i < 16; i += 1)
+  {
+    low = SDL_min(low, texels[i][3]);
+    high = SDL_max(high, texels[i][3]);
+  }
+  int palette[8];
+  GetAlphaPalette(high, low, palette);
+
+  // With equal endpoints every index 0 is exact
+  Uint64 indices = 0;
+  for (int i = 0; i < 16 && high > low; i += 1)
+  {
+    int bestError = 256;
+    Uint64 bestIndex = 0;
+    for (int entry = 0; entry < 8; entry += 1)
+    {
+      int entryError = SDL_abs(texels[i][3] - palette[entry]);
+      if (entryError < bestError)
+      {
+        bestError = entryError;
+        bestIndex = entry;
+      }
+    }
+    indices |= bestIndex << (i * 3);
+  }
+
+  block[0] = (Uint8)high;
+  block[1] = (Uint8)low;
+  for (int i = 0; i < 6; i += 1)
+  {
+    block[2 + i] = (Uint8)(indices >> (i * 8));
+  }
+}
+
+static void DecodeAlphaBlock(const Uint8 *block, Uint8 texels[16][4])
+{
+  int palette[8];
+  GetAlphaPalette(block[0], block[1], palette);
+  Uint64 indices = 0;
+  for (int i = 0; i < 6; i += 1)
+  {
+    indices |= (Uint64)block[2 + i] << (i * 8);
+  }
+  for (int i = 0; i < 16; i += 1)
+  {
+    texels[i][3] = (Uint8)palette[(indices >> (i * 3)) & 7];
+  }
+}
+
+// BC7 blocks are one 128 bit little endian field, read and written from the lowest bit up
+static void WriteBits(Uint8 *block, Uint32 *offset, Uint32 value, Uint32 count)
+{
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    Uint32 bit = *offset + i;
+    block[bit / 8] |= (Uint8)(((value >> i) & 1) << (bit % 8));
+  }
+  *offset += count;
+}
+
+static Uint32 ReadBits(const Uint8 *block, Uint32 *offset, Uint32 count)
+{
+  Uint32 value = 0;
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    Uint32 bit = *offset + i;
+    value |= (Uint32)((block[bit / 8] >> (bit % 8)) & 1) << i;
+  }
+  *offset += count;
+  return value;
+}
+
+// Mode 6 endpoints are 7 bits per channel plus a low bit shared by the channels, picked for the smaller rounding error
+static void QuantizeBc7Endpoint(const float endpoint[4], int quantized[4], int *pBit)
+{
+  float bestError = FLT_MAX;
+  for (int p = 0; p < 2; p += 1)
+  {
+    int candidate[4];
+    float error = 0.0f;
+    for (int channel = 0; channel < 4; channel += 1)
+    {
+      candidate[channel] = SDL_clamp((int)((endpoint[channel] - p) / 2.0f + 0.5f), 0, 127);
+      float difference = (candidate[channel] * 2 + p) - endpoint[channel];
+      error += difference * difference;
+    }
+    if (error < bestError)
+    {
+      bestError = error;
+      *pBit = p;
+      SDL_memcpy(quantized, candidate, sizeof(candidate));
+    }
+  }
+}
+
+static void GetBc7Palette(const int quantized[2][4], const int pBits[2], int palette[16][4])
+{
+  for (int channel = 0; channel < 4; channel += 1)
+  {
+    int endpoint0 = (quantized[0][channel] << 1) | pBits[0];
+    int endpoint1 = (quantized[1][channel] << 1) | pBits[1];
+    for (int i = 0; i < 16; i += 1)
+    {
+      palette[i][channel] = ((64 - Bc7Weights[i]) * endpoint0 + Bc7Weights[i] * endpoint1 + 32) >> 6;
+    }
+  }
+}
+
+static Uint32 FitBc7Indices(const Uint8 texels[16][4], const int quantized[2][4], const int pBits[2], Uint8 indices[16])
+{
+  int palette[16][4];
+  GetBc7Palette(quantized, pBits, palette);
+  Uint32 error = 0;
+  for (int i = 0; i < 16; i += 1)
+  {
+    Uint32 bestError = SDL_MAX_UINT32;
+    for (int entry = 0; entry < 16; entry += 1)
+    {
+      Uint32 entryError = 0;
+      for (int channel = 0; channel < 4; channel += 1)
+      {
+        int difference = texels[i][channel] - palette[entry][channel];
+        entryError += difference * difference;
+      }
+      if (entryError < bestError)
+      {
+        bestError = entryError;
+        indices[i] = (Uint8)entry;
+      }
+    }
+    error += bestError;
+  }
+  return error;
+}
+
+static void EncodeBc7Block(const Uint8 texels[16][4], Uint8 *block)
+{
+  float mean[4];
+  float axis[4];
+  float low;
+  float high;
+  GetPrincipalAxis(texels, 4, mean, axis);
+  ProjectOntoAxis(texels, 4, mean, axis, &low, &high);
+  float endpoints[2][4];
+  for (int channel = 0; channel < 4; channel += 1)
+  {
+    endpoints[0][channel] = mean[channel] + axis[channel] * low;
+    endpoints[1][channel] = mean[channel] + axis[channel] * high;
+  }
+  int quantized[2][4];
+  int pBits[2];
+  Uint8 indices[16];
+  QuantizeBc7Endpoint(endpoints[0], quantized[0], &pBits[0]);
+  QuantizeBc7Endpoint(endpoints[1], quantized[1], &pBits[1]);
+  Uint32 error = FitBc7Indices(texels, quantized, pBits, indices);
+
+  float weights[16];
+  for (int i = 0; i < 16; i += 1)
+  {
+    weights[i] = (64 - Bc7Weights[indices[i]]) / 64.0f;
+  }
+  if (SolveEndpoints(texels, 4, weights, endpoints))
+  {
+    int refined[2][4];
+    int refinedPBits[2];
+    Uint8 refinedIndices[16];
+    QuantizeBc7Endpoint(endpoints[0], refined[0], &refinedPBits[0]);
+    QuantizeBc7Endpoint(endpoints[1], refined[1], &refinedPBits[1]);
+    if (FitBc7Indices(texels, refined, refinedPBits, refinedIndices) < error)
+    {
+      SDL_memcpy(quantized, refined, sizeof(refined));
+      SDL_memcpy(pBits, refinedPBits, sizeof(refinedPBits));
+      SDL_memcpy(indices, refinedIndices, sizeof(refinedIndices));
+    }
+  }
+
+  // The first index is stored without its top bit, which has to be 0: swapping the endpoints mirrors the indices
+  if (indices[0] & 8)
+  {
+    for (int channel = 0; channel < 4; channel += 1)
+    {
+      int swap = quantized[0][channel];
+      quantized[0][channel] = quantized[1][channel];
+      quantized[1][channel] = swap;
+    }
+    int swap = pBits[0];
+    pBits[0] = pBits[1];
+    pBits[1] = swap;
+    for (int i = 0; i < 16; i += 1)
+    {
+      indices[i] = 15 - indices[i];
+    }
+  }
+
+  SDL_memset(block, 0, 16);
+  Uint32 offset = 0;
+  WriteBits(block, &offset, 1 << 6, 7);
+  for (int channel = 0; channel < 4; channel += 1)
+  {
+    WriteBits(block, &offset, quantized[0][channel], 7);
+    WriteBits(block, &offset, quantized[1][channel], 7);
+  }
+  WriteBits(block, &offset, pBits[0], 1);
+  WriteBits(block, &offset, pBits[1], 1);
+  for (int i = 0; i < 16; i += 1)
+  {
+    WriteBits(block, &offset, indices[i], i == 0 ? 3 : 4);
+  }
+}
+
+static void DecodeBc7Block(const Uint8 *block, Uint8 texels[16][4])
+{
+  // Mode 6 is the one with six 0 bits before its first 1
+  if ((block[0] & 0x7F) != 0x40)
+  {
+    for (int i = 0; i < 16; i += 1)
+    {
+      texels[i][0] = 255;
+      texels[i][1] = 0;
+      texels[i][2] = 255;
+      texels[i][3] = 255;
+    }
+    return;
+  }
+  Uint32 offset = 7;
+  int quantized[2][4];
+  int pBits[2];
+  for (int channel = 0; channel < 4; channel += 1)
+  {
+    quantized[0][channel] = ReadBits(block, &offset, 7);
+    quantized[1][channel] = ReadBits(block, &offset, 7);
+  }
+  pBits[0] = ReadBits(block, &offset, 1);
+  pBits[1] = ReadBits(block, &offset, 1);
+  int palette[16][4];
+  GetBc7Palette(quantized, pBits, palette);
+  for (int i = 0; i < 16; i += 1)
+  {
+    const int *color = palette[ReadBits(block, &offset, i == 0 ? 3 : 4)];
+    for (int channel = 0; channel < 4; channel += 1)
+    {
+      texels[i][channel] = (Uint8)color[channel];
+    }
+  }
+}
+
+void TextureCodec_Encode(TextureCodec codec, const Uint8 *rgba, Uint32 width, Uint32 height, Uint8 *destination)
+{
+  if (codec == TEXTURE_CODEC_RGBA8)
+  {
+    SDL_memcpy(destination, rgba, (size_t)width * height * 4);
+    return;
+  }
+  Uint32 blockSize = GetBlockSize(codec);
+  for (Uint32 blockY = 0; blockY < (height + 3) / 4; blockY += 1)
+  {
+    for (Uint32 blockX = 0; blockX < (width + 3) / 4; blockX += 1)
+    {
+      Uint8 texels[16][4];
+      GatherBlock(rgba, width, height, blockX, blockY, texels);
+      switch (codec)
+      {
+      case TEXTURE_CODEC_BC1:
+        EncodeColorBlock(texels, destination);
+        break;
+      case TEXTURE_CODEC_BC3:
+        EncodeAlphaBlock(texels, destination);
+        EncodeColorBlock(texels, destination + 8);
+        break;
+      default:
+        EncodeBc7Block(texels, destination);
+        break;
+      }
+      destination += blockSize;
+    }
+  }
+}
+
+void TextureCodec_Decode(TextureCodec codec, const Uint8 *source, Uint32 width, Uint32 height, Uint8 *rgba, Uint32 pitch)
+{
+  if (codec == TEXTURE_CODEC_RGBA8)
+  {
+    for (Uint32 y = 0; y < height; y += 1)
+    {
+      SDL_memcpy(rgba + (size_t)y * pitch, source + (size_t)y * width * 4, (size_t)width * 4);
+    }
+    return;
+  }
+  Uint32 blockSize = GetBlockSize(codec);
+  for (Uint32 blockY = 0; blockY < (height + 3) / 4; blockY += 1)
+  {
+    for (Uint32 blockX = 0; blockX < (width + 3) / 4; blockX += 1)
+    {
+      Uint8 texels[16][4];
+      switch (codec)
+      {
+      case TEXTURE_CODEC_BC1:
+        DecodeColorBlock(source, true, texels);
+        break;
+      case TEXTURE_CODEC_BC3:
+        // The color half of a BC3 block is always in the four color mode
+        DecodeColorBlock(source + 8, false, texels);
+        DecodeAlphaBlock(source, texels);
+        break;
+      default:
+        DecodeBc7Block(source, texels);
+        break;
+      }
+      source += blockSize;
+
+      Uint32 blockWidth = SDL_min(width - blockX * 4, 4);
+      Uint32 blockHeight = SDL_min(height - blockY * 4, 4);
+      for (Uint32 y = 0; y < blockHeight; y += 1)
+      {
+        Uint8 *out = rgba + (size_t)(blockY * 4 + y) * pitch + (size_t)blockX * 16;
+        SDL_memcpy(out, texels[y * 4], blockWidth * 4);
+      }
+    }
+  }
+}
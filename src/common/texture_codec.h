@@ -0,0 +1,33 @@
+#ifndef TEXTURE_CODEC_H_
+#define TEXTURE_CODEC_H_
+#include <SDL3/SDL.h>
+
+// Block compression for sampled textures. The BC formats store each 4x4 texel block in a fixed number of bytes that the
+// GPU decodes as it samples, so a compressed texture takes a quarter to an eighth of the memory and of the bandwidth of
+// RGBA8: BC1 is 8 bytes per block (RGB, encoded opaque), BC3 and BC7 are 16 (RGBA, BC7 with finer endpoints and 16 level indices).
+//
+// Blocks are stored row by row, ceil(width / 4) per row. The texels of a partial block past the edge of the level are
+// encoded as copies of the nearest edge texel and left out when decoding.
+typedef enum TextureCodec
+{
+  TEXTURE_CODEC_RGBA8, // no compression, 4 bytes per texel
+  TEXTURE_CODEC_BC1,
+  TEXTURE_CODEC_BC3,
+  TEXTURE_CODEC_BC7, // only mode 6, a single RGBA line per block with 7 bit endpoints plus a shared low bit
+  TEXTURE_CODEC_COUNT
+} TextureCodec;
+
+const char *TextureCodec_GetName(TextureCodec codec);
+// "rgba8", "bc1", "bc3" or "bc7"
+bool TextureCodec_Parse(const char *name, TextureCodec *codec);
+SDL_GPUTextureFormat TextureCodec_GetFormat(TextureCodec codec);
+// Bytes of one width x height level
+Uint32 TextureCodec_GetLevelSize(TextureCodec codec, Uint32 width, Uint32 height);
+// Bytes of the first levelCount levels, stored back to back
+Uint32 TextureCodec_GetChainSize(TextureCodec codec, Uint32 width, Uint32 height, Uint32 levelCount);
+
+// Encodes an RGBA8 image with tightly packed rows into TextureCodec_GetLevelSize bytes at destination
+void TextureCodec_Encode(TextureCodec codec, const Uint8 *rgba, Uint32 width, Uint32 height, Uint8 *destination);
+// Decodes a level into RGBA8 rows pitch bytes apart. BC7 blocks in other modes than 6 decode to magenta.
+void TextureCodec_Decode(TextureCodec codec, const Uint8 *source, Uint32 width, Uint32 height, Uint8 *rgba, Uint32 pitch);
+#endif // TEXTURE_CODEC_H_
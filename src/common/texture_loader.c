@@ -0,0 +1,509 @@
+#include "texture_loader.h"
+
+// Taps per axis of the Kaiser filter, at -2.5 to 2.5 source texels from the center of the destination texel
+#define KAISER_TAPS 6
+// Window shape: larger is smoother and blurrier, smaller is sharper and rings more
+#define KAISER_BETA 4.0
+// Half the width of the window, in destination texels
+#define KAISER_RADIUS 1.5
+
+static const char *MipFilterNames[MIP_FILTER_COUNT] = {"none", "gpu", "box", "kaiser"};
+
+Uint32 Mipmap_GetLevelCount(Uint32 width, Uint32 height)
+{
+  Uint32 size = SDL_max(width, height);
+  Uint32 levelCount = 1;
+  while (size > 1)
+  {
+    size /= 2;
+    levelCount += 1;
+  }
+  return levelCount;
+}
+
+Uint32 Mipmap_GetChainSize(Uint32 width, Uint32 height, Uint32 levelCount)
+{
+  Uint32 size = 0;
+  for (Uint32 level = 0; level < levelCount; level += 1)
+  {
+    size += SDL_max(width >> level, 1) * SDL_max(height >> level, 1) * 4;
+  }
+  return size;
+}
+
+const char *MipFilter_GetName(MipFilter filter)
+{
+  return filter < MIP_FILTER_COUNT ? MipFilterNames[filter] : "unknown";
+}
+
+bool MipFilter_Parse(const char *name, MipFilter *filter)
+{
+  for (int i = 0; i < MIP_FILTER_COUNT; i += 1)
+  {
+    if (SDL_strcasecmp(name, MipFilterNames[i]) == 0)
+    {
+      *filter = (MipFilter)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void BoxDownsample(const Uint8 *source, Uint32 width, Uint32 height, Uint8 *destination)
+{
+  Uint32 destinationWidth = SDL_max(width / 2, 1);
+  Uint32 destinationHeight = SDL_max(height / 2, 1);
+  for (Uint32 y = 0; y < destinationHeight; y += 1)
+  {
+    // A side of 1 averages the same row or column twice
+    const Uint8 *row0 = source + (size_t)SDL_min(y * 2, height - 1) * width * 4;
+    const Uint8 *row1 = source + (size_t)SDL_min(y * 2 + 1, height - 1) * width * 4;
+    Uint8 *out = destination + (size_t)y * destinationWidth * 4;
+    for (Uint32 x = 0; x < destinationWidth; x += 1)
+    {
+      Uint32 x0 = SDL_min(x * 2, width - 1) * 4;
+      Uint32 x1 = SDL_min(x * 2 + 1, width - 1) * 4;
+      for (Uint32 channel = 0; channel < 4; channel += 1)
+      {
+        out[x * 4 + channel] = (Uint8)((row0[x0 + channel] + row0[x1 + channel] + row1[x0 + channel] + row1[x1 + channel] + 2) / 4);
+      }
+    }
+  }
+}
+
+// Zeroth order modified Bessel function of the first kind, the series converges quickly for the small arguments of the window
+static double BesselI0(double x)
+{
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 20; k += 1)
+  {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+static void GetKaiserWeights(float weights[KAISER_TAPS])
+{
+  double total = 0.0;
+  double values[KAISER_TAPS];
+  for (int i = 0; i < KAISER_TAPS; i += 1)
+  {
+    // Halving moves the cutoff to half the source's Nyquist frequency: a sinc one destination texel wide
+    double x = (i - (KAISER_TAPS - 1) * 0.5) * 0.5;
+    double sinc = SDL_sin(SDL_PI_D * x) / (SDL_PI_D * x);
+    double ratio = x / KAISER_RADIUS;
+    values[i] = sinc * BesselI0(KAISER_BETA * SDL_sqrt(1.0 - ratio * ratio)) / BesselI0(KAISER_BETA);
+    total += values[i];
+  }
+  for (int i = 0; i < KAISER_TAPS; i += 1)
+  {
+    weights[i] = (float)(values[i] / total);
+  }
+}
+
+// Separable: rows into a float image of half the width, then its columns into destination
+static bool KaiserDownsample(const Uint8 *source, Uint32 width, Uint32 height, Uint8 *destination)
+{
+  Uint32 destinationWidth = SDL_max(width / 2, 1);
+  Uint32 destinationHeight = SDL_max(height / 2, 1);
+  float *rows = SDL_malloc(sizeof(float) * 4 * destinationWidth * height);
+  if (rows == NULL)
+  {
+    return false;
+  }
+  float weights[KAISER_TAPS];
+  GetKaiserWeights(weights);
+
+  for (Uint32 y = 0; y < height; y += 1)
+  {
+    const Uint8 *in = source + (size_t)y * width * 4;
+    float *out = rows + (size_t)y * destinationWidth * 4;
+    for (Uint32 x = 0; x < destinationWidth; x += 1)
+    {
+      float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+      for (int tap = 0; tap < KAISER_TAPS; tap += 1)
+      {
+        // The edges are clamped, like the samplers' CLAMP_TO_EDGE
+        int sourceX = SDL_clamp((int)(x * 2) - KAISER_TAPS / 2 + 1 + tap, 0, (int)width - 1);
+        for (int channel = 0; channel < 4; channel += 1)
+        {
+          sum[channel] += weights[tap] * in[sourceX * 4 + channel];
+        }
+      }
+      SDL_memcpy(out + x * 4, sum, sizeof(sum));
+    }
+  }
+
+  for (Uint32 y = 0; y < destinationHeight; y += 1)
+  {
+    Uint8 *out = destination + (size_t)y * destinationWidth * 4;
+    for (Uint32 x = 0; x < destinationWidth * 4; x += 1)
+    {
+      float sum = 0.0f;
+      for (int tap = 0; tap < KAISER_TAPS; tap += 1)
+      {
+        int sourceY = SDL_clamp((int)(y * 2) - KAISER_TAPS / 2 + 1 + tap, 0, (int)height - 1);
+        sum += weights[tap] * rows[(size_t)sourceY * destinationWidth * 4 + x];
+      }
+      // The negative lobes can overshoot
+      out[x] = (Uint8)SDL_clamp(sum + 0.5f, 0.0f, 255.0f);
+    }
+  }
+  SDL_free(rows);
+  return true;
+}
+
+bool Mipmap_Downsample(const Uint8 *source, Uint32 width, Uint32 height, Uint8 *destination, MipFilter filter)
+{
+  if (filter == MIP_FILTER_KAISER)
+  {
+    return KaiserDownsample(source, width, height, destination);
+  }
+  BoxDownsample(source, width, height, destination);
+  return true;
+}
+
+// Writes levels 1 and up of a chain whose level 0 is already in place, with a CPU filter
+static bool BuildChain(Uint8 *chain, Uint32 width, Uint32 height, Uint32 levelCount, MipFilter filter)
+{
+  Uint8 *level = chain;
+  for (Uint32 i = 1; i < levelCount; i += 1)
+  {
+    Uint32 levelWidth = SDL_max(width >> (i - 1), 1);
+    Uint32 levelHeight = SDL_max(height >> (i - 1), 1);
+    Uint8 *next = level + (size_t)levelWidth * levelHeight * 4;
+    if (!Mipmap_Downsample(level, levelWidth, levelHeight, next, filter))
+    {
+      return false;
+    }
+    level = next;
+  }
+  return true;
+}
+
+static SDL_GPUTexture *CreateMippedTexture(SDL_GPUDevice *device, Uint32 width, Uint32 height, Uint32 levelCount, MipFilter filter)
+{
+  SDL_GPUTexture *texture = SDL_CreateGPUTexture(
+      device,
+      &(SDL_GPUTextureCreateInfo){
+          .type = SDL_GPU_TEXTURETYPE_2D,
+          .format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+          .width = width,
+          .height = height,
+          .layer_count_or_depth = 1,
+          .num_levels = levelCount,
+          // The GPU's blits render into the smaller levels
+          .usage = SDL_GPU_TEXTUREUSAGE_SAMPLER | (filter == MIP_FILTER_GPU ? SDL_GPU_TEXTUREUSAGE_COLOR_TARGET : 0)});
+  if (texture == NULL)
+  {
+    SDL_Log("Failed to create a %ux%u texture: %s", width, height, SDL_GetError());
+  }
+  return texture;
+}
+
+// Queues the first uploadCount levels of a tightly packed chain. On failure the texture is released if nothing was queued yet.
+static bool UploadChain(SDL_GPUDevice *device, UploadRing *uploads, SDL_GPUTexture *texture, const Uint8 *chain, Uint32 width, Uint32 height, Uint32 uploadCount)
+{
+  const Uint8 *level = chain;
+  for (Uint32 i = 0; i < uploadCount; i += 1)
+  {
+    Uint32 levelWidth = SDL_max(width >> i, 1);
+    Uint32 levelHeight = SDL_max(height >> i, 1);
+    Uint32 size = levelWidth * levelHeight * 4;
+    if (!UploadRing_UploadToTexture(
+            uploads,
+            level,
+            size,
+            &(SDL_GPUTextureRegion){.texture = texture, .mip_level = i, .w = levelWidth, .h = levelHeight, .d = 1},
+            0))
+    {
+      SDL_Log("The upload ring has no room for level %u of a %ux%u texture", i, width, height);
+      // Levels already queued still point at the texture, it can only be released if there are none
+      if (i == 0)
+      {
+        SDL_ReleaseGPUTexture(device, texture);
+      }
+      return false;
+    }
+    level += size;
+  }
+  return true;
+}
+
+SDL_GPUTexture *LoadTexture(SDL_GPUDevice *device, UploadRing *uploads, SDL_GPUCommandBuffer *cmdbuf, const SDL_Surface *surface, MipFilter filter)
+{
+  if (surface->format != SDL_PIXELFORMAT_ABGR8888 || surface->pitch != surface->w * 4)
+  {
+    SDL_Log("LoadTexture takes tightly packed ABGR8888 surfaces, got %s", SDL_GetPixelFormatName(surface->format));
+    return NULL;
+  }
+  Uint32 width = surface->w;
+  Uint32 height = surface->h;
+  Uint32 levelCount = filter == MIP_FILTER_NONE ? 1 : Mipmap_GetLevelCount(width, height);
+
+  // The CPU filters write every level before anything is queued, so running out of memory leaves no upload behind
+  Uint8 *chain = NULL;
+  if (filter == MIP_FILTER_BOX || filter == MIP_FILTER_KAISER)
+  {
+    chain = SDL_malloc(Mipmap_GetChainSize(width, height, levelCount));
+    if (chain == NULL)
+    {
+      return NULL;
+    }
+    SDL_memcpy(chain, surface->pixels, (size_t)width * height * 4);
+    if (!BuildChain(chain, width, height, levelCount, filter))
+    {
+      SDL_free(chain);
+      return NULL;
+    }
+  }
+
+  SDL_GPUTexture *texture = CreateMippedTexture(device, width, height, levelCount, filter);
+  bool uploaded = texture != NULL &&
+                  UploadChain(device, uploads, texture, chain != NULL ? chain : surface->pixels, width, height, chain != NULL ? levelCount : 1);
+  SDL_free(chain);
+  if (!uploaded)
+  {
+    return NULL;
+  }
+
+  if (filter == MIP_FILTER_GPU && levelCount > 1)
+  {
+    // The blits read level 0, so its copy has to be recorded first
+    UploadRing_Flush(uploads, cmdbuf);
+    SDL_GenerateMipmapsForGPUTexture(cmdbuf, texture);
+  }
+  return texture;
+}
+
+SDL_GPUTexture *LoadImageTexture(SDL_GPUDevice *device, UploadRing *uploads, SDL_GPUCommandBuffer *cmdbuf, ImageFile *file, MipFilter filter, PixelConvertFlags conversion)
+{
+  ImageFile_SetConversion(file, conversion);
+  const ImageFileInfo *info = ImageFile_GetInfo(file);
+  Uint32 width = info->width;
+  Uint32 height = info->height;
+  Uint32 levelCount = filter == MIP_FILTER_NONE ? 1 : Mipmap_GetLevelCount(width, height);
+
+  if (filter == MIP_FILTER_BOX || filter == MIP_FILTER_KAISER)
+  {
+    // The filters read level 0 back, which transfer memory is too slow for, so the chain is built in system memory
+    Uint8 *chain = SDL_malloc(Mipmap_GetChainSize(width, height, levelCount));
+    if (chain == NULL || !ImageFile_ReadPixels(file, chain, width * 4) || !BuildChain(chain, width, height, levelCount, filter))
+    {
+      SDL_free(chain);
+      return NULL;
+    }
+    SDL_GPUTexture *texture = CreateMippedTexture(device, width, height, levelCount, filter);
+    bool uploaded = texture != NULL && UploadChain(device, uploads, texture, chain, width, height, levelCount);
+    SDL_free(chain);
+    return uploaded ? texture : NULL;
+  }
+
+  SDL_GPUTexture *texture = CreateMippedTexture(device, width, height, levelCount, filter);
+  if (texture == NULL)
+  {
+    return NULL;
+  }
+  void *pixels = UploadRing_AllocateTextureUpload(
+      uploads, width * height * 4, &(SDL_GPUTextureRegion){.texture = texture, .mip_level = 0, .w = width, .h = height, .d = 1}, 0);
+  if (pixels == NULL)
+  {
+    SDL_Log("The upload ring has no room for a %ux%u texture", width, height);
+    SDL_ReleaseGPUTexture(device, texture);
+    return NULL;
+  }
+  if (!ImageFile_ReadPixels(file, pixels, width * 4))
+  {
+    // The copy is queued already, drop it before it's flushed into a released texture
+    UploadRing_DiscardTextureUploads(uploads, texture);
+    SDL_ReleaseGPUTexture(device, texture);
+    return NULL;
+  }
+
+  if (filter == MIP_FILTER_GPU && levelCount > 1)
+  {
+    UploadRing_Flush(uploads, cmdbuf);
+    SDL_GenerateMipmapsForGPUTexture(cmdbuf, texture);
+  }
+  return texture;
+}
+
+bool SaveBakedTexture(const char *path, TextureCodec codec, Uint32 width, Uint32 height, Uint32 levelCount, const void *levels)
+{
+  BakedTextureHeader header = {
+      .magic = BAKED_TEXTURE_MAGIC,
+      .version = BAKED_TEXTURE_VERSION,
+      .headerSize = sizeof(BakedTextureHeader),
+      .codec = codec,
+      .width = width,
+      .height = height,
+      .levelCount = levelCount,
+      .dataOffset = sizeof(BakedTextureHeader)};
+  size_t size = TextureCodec_GetChainSize(codec, width, height, levelCount);
+
+  SDL_IOStream *stream = SDL_IOFromFile(path, "wb");
+  if (stream == NULL)
+  {
+    SDL_Log("Failed to create %s: %s", path, SDL_GetError());
+    return false;
+  }
+  bool ok = SDL_WriteIO(stream, &header, sizeof(header)) == sizeof(header) && SDL_WriteIO(stream, levels, size) == size;
+  ok = SDL_CloseIO(stream) && ok;
+  if (!ok)
+  {
+    SDL_Log("Failed to write %s: %s", path, SDL_GetError());
+  }
+  return ok;
+}
+
+// A texture in the codec's format, or in R8G8B8A8 with *decoded set when the device can't sample that format
+// or level 0 isn't a whole number of blocks
+static SDL_GPUTexture *CreateEncodedTexture(SDL_GPUDevice *device, TextureCodec codec, Uint32 width, Uint32 height, Uint32 levelCount, bool *decoded)
+{
+  SDL_GPUTextureFormat format = TextureCodec_GetFormat(codec);
+  *decoded = codec != TEXTURE_CODEC_RGBA8 &&
+             (width % 4 != 0 || height % 4 != 0 ||
+              !SDL_GPUTextureSupportsFormat(device, format, SDL_GPU_TEXTURETYPE_2D, SDL_GPU_TEXTUREUSAGE_SAMPLER));
+  SDL_GPUTexture *texture = SDL_CreateGPUTexture(
+      device,
+      &(SDL_GPUTextureCreateInfo){
+          .type = SDL_GPU_TEXTURETYPE_2D,
+          .format = *decoded ? SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM : format,
+          .width = width,
+          .height = height,
+          .layer_count_or_depth = 1,
+          .num_levels = levelCount,
+          .usage = SDL_GPU_TEXTUREUSAGE_SAMPLER});
+  if (texture == NULL)
+  {
+    SDL_Log("Failed to create a %ux%u %s texture: %s", width, height, TextureCodec_GetName(codec), SDL_GetError());
+  }
+  return texture;
+}
+
+// Queues one level, the blocks as they are or decoded straight into the transfer memory. Returns false if the ring is full.
+static bool UploadEncodedLevel(UploadRing *uploads, SDL_GPUTexture *texture, TextureCodec codec, bool decode, Uint32 level, Uint32 width, Uint32 height, const Uint8 *source)
+{
+  SDL_GPUTextureRegion region = {.texture = texture, .mip_level = level, .w = width, .h = height, .d = 1};
+  if (!decode)
+  {
+    return UploadRing_UploadToTexture(uploads, source, TextureCodec_GetLevelSize(codec, width, height), &region, 0);
+  }
+  Uint8 *rgba = UploadRing_AllocateTextureUpload(uploads, width * height * 4, &region, 0);
+  if (rgba == NULL)
+  {
+    return false;
+  }
+  TextureCodec_Decode(codec, source, width, height, rgba, width * 4);
+  return true;
+}
+
+SDL_GPUTexture *LoadEncodedTexture(
+    SDL_GPUDevice *device,
+    UploadRing *uploads,
+    TextureCodec codec,
+    Uint32 width,
+    Uint32 height,
+    Uint32 levelCount,
+    const void *levels,
+    bool *decoded)
+{
+  SDL_GPUTexture *texture = CreateEncodedTexture(device, codec, width, height, levelCount, decoded);
+  if (texture == NULL)
+  {
+    return NULL;
+  }
+  const Uint8 *level = levels;
+  for (Uint32 i = 0; i < levelCount; i += 1)
+  {
+    Uint32 levelWidth = SDL_max(width >> i, 1);
+    Uint32 levelHeight = SDL_max(height >> i, 1);
+    if (!UploadEncodedLevel(uploads, texture, codec, *decoded, i, levelWidth, levelHeight, level))
+    {
+      SDL_Log("The upload ring has no room for level %u of a %ux%u texture", i, width, height);
+      if (i == 0)
+      {
+        SDL_ReleaseGPUTexture(device, texture);
+      }
+      return NULL;
+    }
+    level += TextureCodec_GetLevelSize(codec, levelWidth, levelHeight);
+  }
+  return texture;
+}
+
+SDL_GPUTexture *LoadBakedTexture(SDL_GPUDevice *device, UploadRing *uploads, const char *path, BakedTextureHeader *header, bool *decoded)
+{
+  SDL_IOStream *stream = SDL_IOFromFile(path, "rb");
+  if (stream == NULL)
+  {
+    SDL_Log("Failed to open %s: %s", path, SDL_GetError());
+    return NULL;
+  }
+  BakedTextureHeader read;
+  Sint64 fileSize = SDL_GetIOSize(stream);
+  if (SDL_ReadIO(stream, &read, sizeof(read)) != sizeof(read) || read.magic != BAKED_TEXTURE_MAGIC ||
+      read.version != BAKED_TEXTURE_VERSION || read.headerSize < sizeof(read) || read.codec >= TEXTURE_CODEC_COUNT ||
+      read.width == 0 || read.height == 0 || read.levelCount == 0 || read.levelCount > Mipmap_GetLevelCount(read.width, read.height) ||
+      read.dataOffset < read.headerSize ||
+      read.dataOffset + (Sint64)TextureCodec_GetChainSize(read.codec, read.width, read.height, read.levelCount) > fileSize ||
+      SDL_SeekIO(stream, read.dataOffset, SDL_IO_SEEK_SET) < 0)
+  {
+    SDL_Log("%s is not a baked texture", path);
+    SDL_CloseIO(stream);
+    return NULL;
+  }
+  if (header != NULL)
+  {
+    *header = read;
+  }
+
+  SDL_GPUTexture *texture = CreateEncodedTexture(device, read.codec, read.width, read.height, read.levelCount, decoded);
+  // Blocks that are decoded are read here first, level 0 is the largest
+  Uint8 *blocks = NULL;
+  if (texture != NULL && *decoded)
+  {
+    blocks = SDL_malloc(TextureCodec_GetLevelSize(read.codec, read.width, read.height));
+    if (blocks == NULL)
+    {
+      SDL_ReleaseGPUTexture(device, texture);
+      texture = NULL;
+    }
+  }
+  for (Uint32 i = 0; texture != NULL && i < read.levelCount; i += 1)
+  {
+    Uint32 levelWidth = SDL_max(read.width >> i, 1);
+    Uint32 levelHeight = SDL_max(read.height >> i, 1);
+    Uint32 size = TextureCodec_GetLevelSize(read.codec, levelWidth, levelHeight);
+    bool queued;
+    bool ok;
+    if (*decoded)
+    {
+      ok = SDL_ReadIO(stream, blocks, size) == size &&
+           UploadEncodedLevel(uploads, texture, read.codec, true, i, levelWidth, levelHeight, blocks);
+      queued = ok;
+    }
+    else
+    {
+      void *mapped = UploadRing_AllocateTextureUpload(
+          uploads, size, &(SDL_GPUTextureRegion){.texture = texture, .mip_level = i, .w = levelWidth, .h = levelHeight, .d = 1}, 0);
+      queued = mapped != NULL;
+      ok = queued && SDL_ReadIO(stream, mapped, size) == size;
+    }
+    if (!ok)
+    {
+      SDL_Log("Failed to load level %u of %s into the upload ring", i, path);
+      // Levels already queued still point at the texture, it can only be released if there are none
+      if (i == 0 && !queued)
+      {
+        SDL_ReleaseGPUTexture(device, texture);
+      }
+      texture = NULL;
+    }
+  }
+  SDL_free(blocks);
+  SDL_CloseIO(stream);
+  return texture;
+}
@@ -0,0 +1,77 @@
+#ifndef TEXTURE_LOADER_H_
+#define TEXTURE_LOADER_H_
+#include <SDL3/SDL.h>
+#include "upload_ring.h"
+#include "texture_codec.h"
+#include "image_loader.h"
+
+// Creates sampled textures from the RGBA8 surfaces LoadImage returns, with the full mip chain so the LINEAR mipmap
+// samplers actually have smaller levels to read when a texture is minified, instead of fetching texels far apart from level 0.
+//
+// The levels follow the usual halving: level n is max(1, width >> n) by max(1, height >> n), down to 1x1.
+// The CPU filters write each level from the one before it, in the stored (not linearized) color space, as the GPU blits do.
+typedef enum MipFilter
+{
+  MIP_FILTER_NONE,   // level 0 only
+  MIP_FILTER_GPU,    // SDL_GenerateMipmapsForGPUTexture, a chain of linear blits recorded after the upload
+  MIP_FILTER_BOX,    // 2x2 average on the CPU
+  MIP_FILTER_KAISER, // Kaiser windowed sinc on the CPU, 6 taps per axis: sharper than the box, may ring slightly
+  MIP_FILTER_COUNT
+} MipFilter;
+
+// Levels in the full chain of a width x height texture
+Uint32 Mipmap_GetLevelCount(Uint32 width, Uint32 height);
+// Bytes of the first levelCount levels of a width x height RGBA8 texture, about what LoadTexture needs from the upload ring
+Uint32 Mipmap_GetChainSize(Uint32 width, Uint32 height, Uint32 levelCount);
+// Writes the max(1, width / 2) x max(1, height / 2) level below an RGBA8 image with tightly packed rows.
+// filter is MIP_FILTER_BOX or MIP_FILTER_KAISER. Returns false if out of memory.
+bool Mipmap_Downsample(const Uint8 *source, Uint32 width, Uint32 height, Uint8 *destination, MipFilter filter);
+
+const char *MipFilter_GetName(MipFilter filter);
+// "none", "gpu", "box" or "kaiser"
+bool MipFilter_Parse(const char *name, MipFilter *filter);
+
+// Creates an R8G8B8A8_UNORM texture from an SDL_PIXELFORMAT_ABGR8888 surface and queues its levels on uploads, call it between
+// UploadRing_BeginFrame and UploadRing_Submit. MIP_FILTER_GPU flushes uploads into cmdbuf and records the blits after the copy,
+// so pass the command buffer the ring is submitted with; the other filters don't touch cmdbuf. The surface can be destroyed once it returns.
+SDL_GPUTexture *LoadTexture(SDL_GPUDevice *device, UploadRing *uploads, SDL_GPUCommandBuffer *cmdbuf, const SDL_Surface *surface, MipFilter filter);
+// Same from an image file without a surface: with MIP_FILTER_NONE or MIP_FILTER_GPU level 0 is decoded straight into transfer memory,
+// the CPU filters decode it into the chain they build. conversion is applied to level 0 as it is decoded (see ImageFile_SetConversion),
+// the smaller levels are filtered from it. The file can be closed once it returns.
+SDL_GPUTexture *LoadImageTexture(SDL_GPUDevice *device, UploadRing *uploads, SDL_GPUCommandBuffer *cmdbuf, ImageFile *file, MipFilter filter, PixelConvertFlags conversion);
+
+// Baked textures (.tex, written by src/tools/texture_cook) hold a mip chain already encoded with a TextureCodec, so loading
+// one is a read straight from the file into transfer memory. Devices that can't sample the codec's format get the blocks
+// decoded into R8G8B8A8 on the CPU instead, as do textures whose size isn't a multiple of 4, which the BC formats need.
+#define BAKED_TEXTURE_MAGIC 0x58455442 // "BTEX"
+#define BAKED_TEXTURE_VERSION 1
+
+// Little endian, the levels follow back to back from dataOffset, largest first, each TextureCodec_GetLevelSize bytes
+typedef struct BakedTextureHeader
+{
+  Uint32 magic;
+  Uint32 version;
+  Uint32 headerSize;
+  Uint32 codec; // TextureCodec
+  Uint32 width;
+  Uint32 height;
+  Uint32 levelCount;
+  Uint32 dataOffset;
+} BakedTextureHeader;
+
+// Writes levelCount levels of a width x height texture, already encoded back to back in levels
+bool SaveBakedTexture(const char *path, TextureCodec codec, Uint32 width, Uint32 height, Uint32 levelCount, const void *levels);
+// Creates a texture from levels encoded as SaveBakedTexture takes them and queues them on uploads, call it between
+// UploadRing_BeginFrame and UploadRing_Submit. *decoded is set if they were decoded into R8G8B8A8 on the way.
+SDL_GPUTexture *LoadEncodedTexture(
+    SDL_GPUDevice *device,
+    UploadRing *uploads,
+    TextureCodec codec,
+    Uint32 width,
+    Uint32 height,
+    Uint32 levelCount,
+    const void *levels,
+    bool *decoded);
+// Same for a baked file. header, if not NULL, gets the file's header.
+SDL_GPUTexture *LoadBakedTexture(SDL_GPUDevice *device, UploadRing *uploads, const char *path, BakedTextureHeader *header, bool *decoded);
+#endif // TEXTURE_LOADER_H_
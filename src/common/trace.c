@@ -0,0 +1,264 @@
+#include <SDL3/SDL.h>
+#include "trace.h"
+
+#define MAX_TRACE_THREADS 64
+// 24 bytes per event, ~6MB per thread: about a minute of a dozen zones per frame at 1000 fps
+#define EVENTS_PER_THREAD (256 * 1024)
+
+typedef struct TraceEvent
+{
+  const char *name; // NULL for the end of a zone
+  Uint64 ns;
+} TraceEvent;
+
+// Only the owning thread writes to a buffer. count is published with an atomic so Trace_Shutdown sees whole events.
+// inUse is set while the owner is inside a Trace_ call, Trace_Shutdown waits for it to clear before freeing events.
+typedef struct TraceBuffer
+{
+  const char *threadName;
+  Uint32 threadIndex;
+  TraceEvent *events;
+  SDL_AtomicInt count;
+  // Slots held back for the ends of the open zones, so a full buffer never leaves a zone without its end
+  Uint32 reserved;
+  // Zones whose begin didn't fit, their ends are dropped as well
+  Uint32 skippedDepth;
+  Uint32 dropped;
+  SDL_AtomicInt inUse;
+} TraceBuffer;
+
+static struct
+{
+  SDL_AtomicInt enabled;
+  char *path;
+  Uint64 startNS;
+  TraceBuffer buffers[MAX_TRACE_THREADS];
+  SDL_AtomicInt bufferCount;
+  SDL_TLSID bufferSlot;
+  // Held while a buffer is created and while Trace_Shutdown frees them
+  SDL_SpinLock bufferLock;
+} Trace;
+
+bool Trace_Init(const char *path)
+{
+  Trace.path = SDL_strdup(path);
+  if (Trace.path == NULL)
+  {
+    return false;
+  }
+  Trace.startNS = SDL_GetTicksNS();
+  SDL_SetAtomicInt(&Trace.enabled, 1);
+  return true;
+}
+
+// Returns the calling thread's buffer marked in use, or NULL once tracing is off. Clear inUse when done with it.
+// Without create a thread that has no buffer yet gets NULL too.
+static TraceBuffer *AcquireThreadBuffer(bool create)
+{
+  TraceBuffer *buffer = SDL_GetTLS(&Trace.bufferSlot);
+  // A buffer without events is left over from before a Trace_Shutdown
+  if (buffer != NULL && buffer->events != NULL)
+  {
+    // Marked before enabled is read again: either Trace_Shutdown sees the mark and waits, or this sees it disabled
+    SDL_SetAtomicInt(&buffer->inUse, 1);
+    if (SDL_GetAtomicInt(&Trace.enabled))
+    {
+      return buffer;
+    }
+    SDL_SetAtomicInt(&buffer->inUse, 0);
+    return NULL;
+  }
+  if (!create)
+  {
+    return NULL;
+  }
+
+  // First zone on this thread
+  buffer = NULL;
+  SDL_LockSpinlock(&Trace.bufferLock);
+  int index = SDL_GetAtomicInt(&Trace.bufferCount);
+  if (SDL_GetAtomicInt(&Trace.enabled) && index < MAX_TRACE_THREADS)
+  {
+    TraceEvent *events = SDL_malloc(sizeof(TraceEvent) * EVENTS_PER_THREAD);
+    if (events != NULL)
+    {
+      buffer = &Trace.buffers[index];
+      buffer->threadIndex = (Uint32)index;
+      buffer->events = events;
+      SDL_SetAtomicInt(&buffer->inUse, 1);
+      SDL_SetAtomicInt(&Trace.bufferCount, index + 1);
+      SDL_SetTLS(&Trace.bufferSlot, buffer, NULL);
+    }
+  }
+  SDL_UnlockSpinlock(&Trace.bufferLock);
+  return buffer;
+}
+
+void Trace_RegisterThread(const char *name)
+{
+  if (!SDL_GetAtomicInt(&Trace.enabled))
+  {
+    return;
+  }
+  TraceBuffer *buffer = AcquireThreadBuffer(true);
+  if (buffer != NULL)
+  {
+    buffer->threadName = name;
+    SDL_SetAtomicInt(&buffer->inUse, 0);
+  }
+}
+
+static void Push(TraceBuffer *buffer, const char *name)
+{
+  int count = SDL_GetAtomicInt(&buffer->count);
+  buffer->events[count] = (TraceEvent){.name = name, .ns = SDL_GetTicksNS()};
+  SDL_SetAtomicInt(&buffer->count, count + 1);
+}
+
+void Trace_Begin(const char *name)
+{
+  if (!SDL_GetAtomicInt(&Trace.enabled))
+  {
+    return;
+  }
+  TraceBuffer *buffer = AcquireThreadBuffer(true);
+  if (buffer == NULL)
+  {
+    return;
+  }
+  // Room for this begin and its end
+  if (buffer->skippedDepth > 0 || (Uint32)SDL_GetAtomicInt(&buffer->count) + buffer->reserved + 2 > EVENTS_PER_THREAD)
+  {
+    buffer->skippedDepth += 1;
+    buffer->dropped += 1;
+  }
+  else
+  {
+    Push(buffer, name);
+    buffer->reserved += 1;
+  }
+  SDL_SetAtomicInt(&buffer->inUse, 0);
+}
+
+void Trace_End(void)
+{
+  if (!SDL_GetAtomicInt(&Trace.enabled))
+  {
+    return;
+  }
+  TraceBuffer *buffer = AcquireThreadBuffer(false);
+  if (buffer == NULL)
+  {
+    return;
+  }
+  if (buffer->skippedDepth > 0)
+  {
+    buffer->skippedDepth -= 1;
+  }
+  // reserved is 0 for a TRACE_END without a TRACE_BEGIN
+  else if (buffer->reserved > 0)
+  {
+    buffer->reserved -= 1;
+    Push(buffer, NULL);
+  }
+  SDL_SetAtomicInt(&buffer->inUse, 0);
+}
+
+// Chrome wants names as JSON strings, zone names are literals so this only has to handle quotes and backslashes
+static void WriteString(SDL_IOStream *file, const char *text)
+{
+  SDL_IOprintf(file, "\"");
+  for (const char *c = text; *c != '\0'; c += 1)
+  {
+    if (*c == '"' || *c == '\\')
+    {
+      SDL_IOprintf(file, "\\");
+    }
+    SDL_IOprintf(file, "%c", *c);
+  }
+  SDL_IOprintf(file, "\"");
+}
+
+void Trace_Shutdown(void)
+{
+  if (!SDL_GetAtomicInt(&Trace.enabled))
+  {
+    return;
+  }
+  SDL_SetAtomicInt(&Trace.enabled, 0);
+  // No buffer is created from here on, and the threads still inside a Trace_ call get to finish it
+  SDL_LockSpinlock(&Trace.bufferLock);
+  for (int i = 0; i < MAX_TRACE_THREADS; i += 1)
+  {
+    while (SDL_GetAtomicInt(&Trace.buffers[i].inUse))
+    {
+      SDL_CPUPauseInstruction();
+    }
+  }
+
+  SDL_IOStream *file = SDL_IOFromFile(Trace.path, "w");
+  if (file == NULL)
+  {
+    SDL_Log("Failed to open trace file '%s': %s", Trace.path, SDL_GetError());
+  }
+  else
+  {
+    SDL_IOprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    bool first = true;
+    int bufferCount = SDL_min(SDL_GetAtomicInt(&Trace.bufferCount), MAX_TRACE_THREADS);
+    for (int i = 0; i < bufferCount; i += 1)
+    {
+      TraceBuffer *buffer = &Trace.buffers[i];
+      if (buffer->events == NULL)
+      {
+        continue;
+      }
+      SDL_IOprintf(file, "%s{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": ", first ? "" : ",\n", buffer->threadIndex);
+      if (buffer->threadName != NULL)
+      {
+        WriteString(file, buffer->threadName);
+      }
+      else
+      {
+        SDL_IOprintf(file, "\"thread %u\"", buffer->threadIndex);
+      }
+      SDL_IOprintf(file, "}}");
+      first = false;
+
+      // Ends carry no name, Chrome pairs them with the innermost open begin of the same thread
+      int count = SDL_GetAtomicInt(&buffer->count);
+      for (int e = 0; e < count; e += 1)
+      {
+        TraceEvent *event = &buffer->events[e];
+        double us = (event->ns - Trace.startNS) / 1000.0;
+        if (event->name != NULL)
+        {
+          SDL_IOprintf(file, ",\n{\"ph\": \"B\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"name\": ", buffer->threadIndex, us);
+          WriteString(file, event->name);
+          SDL_IOprintf(file, "}");
+        }
+        else
+        {
+          SDL_IOprintf(file, ",\n{\"ph\": \"E\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f}", buffer->threadIndex, us);
+        }
+      }
+      if (buffer->dropped > 0)
+      {
+        SDL_Log("Trace buffer of thread %u was full, %u zones were dropped", buffer->threadIndex, buffer->dropped);
+      }
+    }
+    SDL_IOprintf(file, "\n]}\n");
+    SDL_CloseIO(file);
+    SDL_Log("Wrote trace to '%s'", Trace.path);
+  }
+
+  for (int i = 0; i < MAX_TRACE_THREADS; i += 1)
+  {
+    SDL_free(Trace.buffers[i].events);
+  }
+  SDL_zero(Trace.buffers);
+  SDL_SetAtomicInt(&Trace.bufferCount, 0);
+  SDL_free(Trace.path);
+  Trace.path = NULL;
+  SDL_UnlockSpinlock(&Trace.bufferLock);
+}
@@ -0,0 +1,37 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+#include <SDL3/SDL.h>
+
+// Scoped CPU zones written out as a Chrome / Perfetto trace (open it in ui.perfetto.dev or chrome://tracing).
+// Every thread records into its own preallocated buffer, so recording takes no locks and never allocates.
+//
+// The macros compile to nothing unless the build defines ENABLE_TRACE (make TRACE=true).
+// Zone names must be string literals, or at least outlive Trace_Shutdown, only the pointer is stored.
+//
+//   TRACE_BEGIN("render pass");
+//   ...
+//   TRACE_END();
+
+// Starts recording, the trace is written to path by Trace_Shutdown
+bool Trace_Init(const char *path);
+// Other threads may still be recording: it waits for their Trace_Begin / Trace_End calls in progress, later ones are ignored
+void Trace_Shutdown(void);
+// Names the calling thread's track and allocates its buffer up front, threads that don't call it get one on their first zone
+void Trace_RegisterThread(const char *name);
+void Trace_Begin(const char *name);
+void Trace_End(void);
+
+#ifdef ENABLE_TRACE
+#define TRACE_INIT(path) Trace_Init(path)
+#define TRACE_SHUTDOWN() Trace_Shutdown()
+#define TRACE_THREAD(name) Trace_RegisterThread(name)
+#define TRACE_BEGIN(name) Trace_Begin(name)
+#define TRACE_END() Trace_End()
+#else
+#define TRACE_INIT(path) ((void)0)
+#define TRACE_SHUTDOWN() ((void)0)
+#define TRACE_THREAD(name) ((void)0)
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END() ((void)0)
+#endif
+#endif // TRACE_H_
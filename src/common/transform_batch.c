@@ -0,0 +1,333 @@
+#include <SDL3/SDL.h>
+#include "transform_batch.h"
+#include "trace.h"
+
+// Below this many transforms handing a range to another thread costs more than it saves.
+// A multiple of the widest kernel, so only the last range has a scalar tail.
+#define MIN_TRANSFORMS_PER_JOB 4096
+
+// What the jobs of one TransformBatch_Compose share
+typedef struct ComposeJob
+{
+  const TransformArrays *transforms;
+  const Matrix4x4 *viewProjection;
+  Matrix4x4 *results;
+} ComposeJob;
+
+// Scalar reference. The rotation is the transpose of the usual column-vector quaternion matrix, since we multiply row vectors.
+// The SIMD kernels below do the same operations in the same order.
+static void ScalarCompose(const TransformArrays *transforms, Uint32 first, Uint32 count, const Matrix4x4 *viewProjection, Matrix4x4 *results)
+{
+  const float *vp = &viewProjection->m11;
+  for (Uint32 i = first; i < first + count; i += 1)
+  {
+    float qx = transforms->rotationX[i];
+    float qy = transforms->rotationY[i];
+    float qz = transforms->rotationZ[i];
+    float qw = transforms->rotationW[i];
+    float x2 = qx + qx;
+    float y2 = qy + qy;
+    float z2 = qz + qz;
+    float xx = qx * x2;
+    float yy = qy * y2;
+    float zz = qz * z2;
+    float xy = qx * y2;
+    float xz = qx * z2;
+    float yz = qy * z2;
+    float wx = qw * x2;
+    float wy = qw * y2;
+    float wz = qw * z2;
+    float sx = transforms->scaleX[i];
+    float sy = transforms->scaleY[i];
+    float sz = transforms->scaleZ[i];
+    float model[3][3] = {
+        {(1.0f - (yy + zz)) * sx, (xy + wz) * sx, (xz - wy) * sx},
+        {(xy - wz) * sy, (1.0f - (xx + zz)) * sy, (yz + wx) * sy},
+        {(xz + wy) * sz, (yz - wx) * sz, (1.0f - (xx + yy)) * sz}};
+    float px = transforms->positionX[i];
+    float py = transforms->positionY[i];
+    float pz = transforms->positionZ[i];
+
+    float *out = &results[i].m11;
+    for (int j = 0; j < 4; j += 1)
+    {
+      for (int r = 0; r < 3; r += 1)
+      {
+        out[r * 4 + j] = model[r][0] * vp[j] + model[r][1] * vp[4 + j] + model[r][2] * vp[8 + j];
+      }
+      out[12 + j] = px * vp[j] + py * vp[4 + j] + pz * vp[8 + j] + vp[12 + j];
+    }
+  }
+}
+
+#ifdef SDL_SSE2_INTRINSICS
+static void SDL_TARGETING("sse2") SSE2_Compose(const TransformArrays *transforms, Uint32 first, Uint32 count, const Matrix4x4 *viewProjection, Matrix4x4 *results)
+{
+  const float *vp = &viewProjection->m11;
+  const __m128 one = _mm_set1_ps(1.0f);
+  Uint32 end = first + count;
+  Uint32 i = first;
+  for (; i + 4 <= end; i += 4)
+  {
+    __m128 qx = _mm_loadu_ps(transforms->rotationX + i);
+    __m128 qy = _mm_loadu_ps(transforms->rotationY + i);
+    __m128 qz = _mm_loadu_ps(transforms->rotationZ + i);
+    __m128 qw = _mm_loadu_ps(transforms->rotationW + i);
+    __m128 x2 = _mm_add_ps(qx, qx);
+    __m128 y2 = _mm_add_ps(qy, qy);
+    __m128 z2 = _mm_add_ps(qz, qz);
+    __m128 xx = _mm_mul_ps(qx, x2);
+    __m128 yy = _mm_mul_ps(qy, y2);
+    __m128 zz = _mm_mul_ps(qz, z2);
+    __m128 xy = _mm_mul_ps(qx, y2);
+    __m128 xz = _mm_mul_ps(qx, z2);
+    __m128 yz = _mm_mul_ps(qy, z2);
+    __m128 wx = _mm_mul_ps(qw, x2);
+    __m128 wy = _mm_mul_ps(qw, y2);
+    __m128 wz = _mm_mul_ps(qw, z2);
+    __m128 sx = _mm_loadu_ps(transforms->scaleX + i);
+    __m128 sy = _mm_loadu_ps(transforms->scaleY + i);
+    __m128 sz = _mm_loadu_ps(transforms->scaleZ + i);
+    __m128 model[3][3] = {
+        {_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx), _mm_mul_ps(_mm_add_ps(xy, wz), sx), _mm_mul_ps(_mm_sub_ps(xz, wy), sx)},
+        {_mm_mul_ps(_mm_sub_ps(xy, wz), sy), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy), _mm_mul_ps(_mm_add_ps(yz, wx), sy)},
+        {_mm_mul_ps(_mm_add_ps(xz, wy), sz), _mm_mul_ps(_mm_sub_ps(yz, wx), sz), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz)}};
+    __m128 px = _mm_loadu_ps(transforms->positionX + i);
+    __m128 py = _mm_loadu_ps(transforms->positionY + i);
+    __m128 pz = _mm_loadu_ps(transforms->positionZ + i);
+
+    // rows[r][j] is element (r, j) of 4 results, one per lane
+    __m128 rows[4][4];
+    for (int j = 0; j < 4; j += 1)
+    {
+      __m128 vp0 = _mm_set1_ps(vp[j]);
+      __m128 vp1 = _mm_set1_ps(vp[4 + j]);
+      __m128 vp2 = _mm_set1_ps(vp[8 + j]);
+      for (int r = 0; r < 3; r += 1)
+      {
+        rows[r][j] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(model[r][0], vp0), _mm_mul_ps(model[r][1], vp1)), _mm_mul_ps(model[r][2], vp2));
+      }
+      rows[3][j] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, vp0), _mm_mul_ps(py, vp1)), _mm_mul_ps(pz, vp2)), _mm_set1_ps(vp[12 + j]));
+    }
+    // Now rows[r][n] is row r of result n
+    for (int r = 0; r < 4; r += 1)
+    {
+      _MM_TRANSPOSE4_PS(rows[r][0], rows[r][1], rows[r][2], rows[r][3]);
+    }
+    // Whole matrices in order, transfer buffers are often write-combined memory
+    for (int n = 0; n < 4; n += 1)
+    {
+      float *out = &results[i + n].m11;
+      for (int r = 0; r < 4; r += 1)
+      {
+        _mm_storeu_ps(out + r * 4, rows[r][n]);
+      }
+    }
+  }
+  ScalarCompose(transforms, i, end - i, viewProjection, results);
+}
+#endif
+
+#ifdef SDL_AVX_INTRINSICS
+// A 4x4 transpose within each 128 bit half: rows of results 0-3 in the low halves, of results 4-7 in the high ones
+static void SDL_TARGETING("avx") AVX_Transpose4(__m256 *row0, __m256 *row1, __m256 *row2, __m256 *row3)
+{
+  __m256 t0 = _mm256_unpacklo_ps(*row0, *row1);
+  __m256 t1 = _mm256_unpackhi_ps(*row0, *row1);
+  __m256 t2 = _mm256_unpacklo_ps(*row2, *row3);
+  __m256 t3 = _mm256_unpackhi_ps(*row2, *row3);
+  *row0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  *row1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  *row2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  *row3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+static void SDL_TARGETING("avx") AVX_Compose(const TransformArrays *transforms, Uint32 first, Uint32 count, const Matrix4x4 *viewProjection, Matrix4x4 *results)
+{
+  const float *vp = &viewProjection->m11;
+  const __m256 one = _mm256_set1_ps(1.0f);
+  Uint32 end = first + count;
+  Uint32 i = first;
+  for (; i + 8 <= end; i += 8)
+  {
+    __m256 qx = _mm256_loadu_ps(transforms->rotationX + i);
+    __m256 qy = _mm256_loadu_ps(transforms->rotationY + i);
+    __m256 qz = _mm256_loadu_ps(transforms->rotationZ + i);
+    __m256 qw = _mm256_loadu_ps(transforms->rotationW + i);
+    __m256 x2 = _mm256_add_ps(qx, qx);
+    __m256 y2 = _mm256_add_ps(qy, qy);
+    __m256 z2 = _mm256_add_ps(qz, qz);
+    __m256 xx = _mm256_mul_ps(qx, x2);
+    __m256 yy = _mm256_mul_ps(qy, y2);
+    __m256 zz = _mm256_mul_ps(qz, z2);
+    __m256 xy = _mm256_mul_ps(qx, y2);
+    __m256 xz = _mm256_mul_ps(qx, z2);
+    __m256 yz = _mm256_mul_ps(qy, z2);
+    __m256 wx = _mm256_mul_ps(qw, x2);
+    __m256 wy = _mm256_mul_ps(qw, y2);
+    __m256 wz = _mm256_mul_ps(qw, z2);
+    __m256 sx = _mm256_loadu_ps(transforms->scaleX + i);
+    __m256 sy = _mm256_loadu_ps(transforms->scaleY + i);
+    __m256 sz = _mm256_loadu_ps(transforms->scaleZ + i);
+    __m256 model[3][3] = {
+        {_mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx), _mm256_mul_ps(_mm256_add_ps(xy, wz), sx), _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx)},
+        {_mm256_mul_ps(_mm256_sub_ps(xy, wz), sy), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy), _mm256_mul_ps(_mm256_add_ps(yz, wx), sy)},
+        {_mm256_mul_ps(_mm256_add_ps(xz, wy), sz), _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz)}};
+    __m256 px = _mm256_loadu_ps(transforms->positionX + i);
+    __m256 py = _mm256_loadu_ps(transforms->positionY + i);
+    __m256 pz = _mm256_loadu_ps(transforms->positionZ + i);
+
+    __m256 rows[4][4];
+    for (int j = 0; j < 4; j += 1)
+    {
+      __m256 vp0 = _mm256_set1_ps(vp[j]);
+      __m256 vp1 = _mm256_set1_ps(vp[4 + j]);
+      __m256 vp2 = _mm256_set1_ps(vp[8 + j]);
+      for (int r = 0; r < 3; r += 1)
+      {
+        rows[r][j] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(model[r][0], vp0), _mm256_mul_ps(model[r][1], vp1)), _mm256_mul_ps(model[r][2], vp2));
+      }
+      rows[3][j] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, vp0), _mm256_mul_ps(py, vp1)), _mm256_mul_ps(pz, vp2)), _mm256_set1_ps(vp[12 + j]));
+    }
+    for (int r = 0; r < 4; r += 1)
+    {
+      AVX_Transpose4(&rows[r][0], &rows[r][1], &rows[r][2], &rows[r][3]);
+    }
+    for (int n = 0; n < 4; n += 1)
+    {
+      float *out = &results[i + n].m11;
+      for (int r = 0; r < 4; r += 1)
+      {
+        _mm_storeu_ps(out + r * 4, _mm256_castps256_ps128(rows[r][n]));
+      }
+    }
+    for (int n = 0; n < 4; n += 1)
+    {
+      float *out = &results[i + 4 + n].m11;
+      for (int r = 0; r < 4; r += 1)
+      {
+        _mm_storeu_ps(out + r * 4, _mm256_extractf128_ps(rows[r][n], 1));
+      }
+    }
+  }
+  ScalarCompose(transforms, i, end - i, viewProjection, results);
+}
+#endif
+
+#ifdef SDL_NEON_INTRINSICS
+static void NEON_Compose(const TransformArrays *transforms, Uint32 first, Uint32 count, const Matrix4x4 *viewProjection, Matrix4x4 *results)
+{
+  const float *vp = &viewProjection->m11;
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  Uint32 end = first + count;
+  Uint32 i = first;
+  for (; i + 4 <= end; i += 4)
+  {
+    float32x4_t qx = vld1q_f32(transforms->rotationX + i);
+    float32x4_t qy = vld1q_f32(transforms->rotationY + i);
+    float32x4_t qz = vld1q_f32(transforms->rotationZ + i);
+    float32x4_t qw = vld1q_f32(transforms->rotationW + i);
+    float32x4_t x2 = vaddq_f32(qx, qx);
+    float32x4_t y2 = vaddq_f32(qy, qy);
+    float32x4_t z2 = vaddq_f32(qz, qz);
+    float32x4_t xx = vmulq_f32(qx, x2);
+    float32x4_t yy = vmulq_f32(qy, y2);
+    float32x4_t zz = vmulq_f32(qz, z2);
+    float32x4_t xy = vmulq_f32(qx, y2);
+    float32x4_t xz = vmulq_f32(qx, z2);
+    float32x4_t yz = vmulq_f32(qy, z2);
+    float32x4_t wx = vmulq_f32(qw, x2);
+    float32x4_t wy = vmulq_f32(qw, y2);
+    float32x4_t wz = vmulq_f32(qw, z2);
+    float32x4_t sx = vld1q_f32(transforms->scaleX + i);
+    float32x4_t sy = vld1q_f32(transforms->scaleY + i);
+    float32x4_t sz = vld1q_f32(transforms->scaleZ + i);
+    float32x4_t model[3][3] = {
+        {vmulq_f32(vsubq_f32(one, vaddq_f32(yy, zz)), sx), vmulq_f32(vaddq_f32(xy, wz), sx), vmulq_f32(vsubq_f32(xz, wy), sx)},
+        {vmulq_f32(vsubq_f32(xy, wz), sy), vmulq_f32(vsubq_f32(one, vaddq_f32(xx, zz)), sy), vmulq_f32(vaddq_f32(yz, wx), sy)},
+        {vmulq_f32(vaddq_f32(xz, wy), sz), vmulq_f32(vsubq_f32(yz, wx), sz), vmulq_f32(vsubq_f32(one, vaddq_f32(xx, yy)), sz)}};
+    float32x4_t px = vld1q_f32(transforms->positionX + i);
+    float32x4_t py = vld1q_f32(transforms->positionY + i);
+    float32x4_t pz = vld1q_f32(transforms->positionZ + i);
+
+    float32x4_t rows[4][4];
+    for (int j = 0; j < 4; j += 1)
+    {
+      float32x4_t vp0 = vdupq_n_f32(vp[j]);
+      float32x4_t vp1 = vdupq_n_f32(vp[4 + j]);
+      float32x4_t vp2 = vdupq_n_f32(vp[8 + j]);
+      for (int r = 0; r < 3; r += 1)
+      {
+        rows[r][j] = vaddq_f32(vaddq_f32(vmulq_f32(model[r][0], vp0), vmulq_f32(model[r][1], vp1)), vmulq_f32(model[r][2], vp2));
+      }
+      rows[3][j] = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(px, vp0), vmulq_f32(py, vp1)), vmulq_f32(pz, vp2)), vdupq_n_f32(vp[12 + j]));
+    }
+    for (int r = 0; r < 4; r += 1)
+    {
+      float32x4x2_t even = vzipq_f32(rows[r][0], rows[r][2]);
+      float32x4x2_t odd = vzipq_f32(rows[r][1], rows[r][3]);
+      float32x4x2_t low = vzipq_f32(even.val[0], odd.val[0]);
+      float32x4x2_t high = vzipq_f32(even.val[1], odd.val[1]);
+      rows[r][0] = low.val[0];
+      rows[r][1] = low.val[1];
+      rows[r][2] = high.val[0];
+      rows[r][3] = high.val[1];
+    }
+    for (int n = 0; n < 4; n += 1)
+    {
+      float *out = &results[i + n].m11;
+      for (int r = 0; r < 4; r += 1)
+      {
+        vst1q_f32(out + r * 4, rows[r][n]);
+      }
+    }
+  }
+  ScalarCompose(transforms, i, end - i, viewProjection, results);
+}
+#endif
+
+static void ComposeRange(const TransformArrays *transforms, Uint32 first, Uint32 count, const Matrix4x4 *viewProjection, Matrix4x4 *results)
+{
+  switch (LinearAlgebra_GetPath())
+  {
+#ifdef SDL_AVX_INTRINSICS
+  case LINEAR_ALGEBRA_AVX:
+    AVX_Compose(transforms, first, count, viewProjection, results);
+    return;
+#endif
+#ifdef SDL_SSE2_INTRINSICS
+  case LINEAR_ALGEBRA_SSE2:
+    SSE2_Compose(transforms, first, count, viewProjection, results);
+    return;
+#endif
+#ifdef SDL_NEON_INTRINSICS
+  case LINEAR_ALGEBRA_NEON:
+    NEON_Compose(transforms, first, count, viewProjection, results);
+    return;
+#endif
+  default:
+    ScalarCompose(transforms, first, count, viewProjection, results);
+    return;
+  }
+}
+
+static void SDLCALL ComposeJobRange(void *userdata, Uint32 first, Uint32 count)
+{
+  ComposeJob *job = userdata;
+  TRACE_BEGIN("compose transforms");
+  ComposeRange(job->transforms, first, count, job->viewProjection, job->results);
+  TRACE_END();
+}
+
+void TransformBatch_Compose(JobSystem *jobs, const TransformArrays *transforms, Uint32 count, const Matrix4x4 *viewProjection, Matrix4x4 *results)
+{
+  if (jobs == NULL || count < MIN_TRANSFORMS_PER_JOB * 2)
+  {
+    ComposeRange(transforms, 0, count, viewProjection, results);
+    return;
+  }
+  ComposeJob job = {transforms, viewProjection, results};
+  JobCounter counter = {0};
+  JobSystem_ParallelFor(jobs, count, MIN_TRANSFORMS_PER_JOB, ComposeJobRange, &job, &counter);
+  JobSystem_Wait(jobs, &counter);
+}
@@ -0,0 +1,30 @@
+#ifndef TRANSFORM_BATCH_H_
+#define TRANSFORM_BATCH_H_
+#include <SDL3/SDL.h>
+#include "linear_algebra.h"
+#include "job_system.h"
+
+// Builds model-view-projection matrices for many objects at once: Scale * Rotation * Translation * viewProjection,
+// from structure-of-arrays input so 4 (SSE2, NEON) or 8 (AVX) objects are composed per iteration.
+// The results are packed Matrix4x4s, results can point straight into a mapped transfer buffer.
+//
+// The kernel follows LinearAlgebra_GetPath, so LinearAlgebra_SetPath(LINEAR_ALGEBRA_SCALAR) also forces the scalar reference here.
+typedef struct TransformArrays
+{
+  const float *positionX;
+  const float *positionY;
+  const float *positionZ;
+  // Unit quaternions
+  const float *rotationX;
+  const float *rotationY;
+  const float *rotationZ;
+  const float *rotationW;
+  const float *scaleX;
+  const float *scaleY;
+  const float *scaleZ;
+} TransformArrays;
+
+// Splits large batches into ranges for the job system and waits for them, the calling thread composes ranges too.
+// jobs can be NULL to stay on the calling thread.
+void TransformBatch_Compose(JobSystem *jobs, const TransformArrays *transforms, Uint32 count, const Matrix4x4 *viewProjection, Matrix4x4 *results);
+#endif // TRANSFORM_BATCH_H_
@@ -0,0 +1,341 @@
+#include <SDL3/SDL.h>
+#include "upload_ring.h"
+
+#define MAX_FRAMES_IN_FLIGHT 4
+#define BUFFER_UPLOAD_ALIGNMENT 16
+// Texture copies are the pickiest about their source offset (D3D12 wants 512 bytes), aligning every texture upload keeps all backends happy
+#define TEXTURE_UPLOAD_ALIGNMENT 512
+
+typedef enum PendingUploadType
+{
+  PENDING_UPLOAD_BUFFER,
+  PENDING_UPLOAD_TEXTURE
+} PendingUploadType;
+
+typedef struct PendingUpload
+{
+  PendingUploadType type;
+  Uint32 offset; // in the transfer buffer
+  SDL_GPUBufferRegion buffer;
+  SDL_GPUTextureRegion texture;
+  Uint32 pixelsPerRow;
+} PendingUpload;
+
+typedef struct UploadFrame
+{
+  SDL_GPUTransferBuffer *transferBuffer;
+  SDL_GPUFence *fence;
+} UploadFrame;
+
+struct UploadRing
+{
+  SDL_GPUDevice *device;
+  Uint32 size;
+  UploadFrame frames[MAX_FRAMES_IN_FLIGHT];
+  Uint32 frameCount;
+  Uint32 frameIndex;
+  bool inFrame;
+
+  Uint8 *mapped;
+  Uint32 head;
+
+  // Grows to the largest number of uploads seen in a frame and then stays there
+  PendingUpload *pending;
+  Uint32 pendingCount;
+  Uint32 pendingCapacity;
+
+  UploadRingStats stats;
+};
+
+UploadRing *UploadRing_Create(SDL_GPUDevice *device, Uint32 sizePerFrame, Uint32 framesInFlight)
+{
+  UploadRing *ring = SDL_calloc(1, sizeof(UploadRing));
+  if (ring == NULL)
+  {
+    return NULL;
+  }
+  ring->device = device;
+  ring->size = sizePerFrame;
+  ring->frameCount = SDL_clamp(framesInFlight, 1, MAX_FRAMES_IN_FLIGHT);
+  // BeginFrame advances before using a frame, start on the last one so the first frame is frames[0]
+  ring->frameIndex = ring->frameCount - 1;
+
+  for (Uint32 i = 0; i < ring->frameCount; i += 1)
+  {
+    ring->frames[i].transferBuffer = SDL_CreateGPUTransferBuffer(
+        device,
+        &(SDL_GPUTransferBufferCreateInfo){
+            .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+            .size = sizePerFrame});
+    if (ring->frames[i].transferBuffer == NULL)
+    {
+      SDL_Log("Failed to create upload ring transfer buffer: %s", SDL_GetError());
+      UploadRing_Destroy(ring);
+      return NULL;
+    }
+  }
+  return ring;
+}
+
+void UploadRing_Destroy(UploadRing *ring)
+{
+  if (ring == NULL)
+  {
+    return;
+  }
+  if (ring->mapped != NULL)
+  {
+    SDL_UnmapGPUTransferBuffer(ring->device, ring->frames[ring->frameIndex].transferBuffer);
+  }
+  for (Uint32 i = 0; i < ring->frameCount; i += 1)
+  {
+    UploadFrame *frame = &ring->frames[i];
+    if (frame->fence != NULL)
+    {
+      SDL_WaitForGPUFences(ring->device, true, &frame->fence, 1);
+      SDL_ReleaseGPUFence(ring->device, frame->fence);
+    }
+    if (frame->transferBuffer != NULL)
+    {
+      SDL_ReleaseGPUTransferBuffer(ring->device, frame->transferBuffer);
+    }
+  }
+  SDL_free(ring->pending);
+  SDL_free(ring);
+}
+
+bool UploadRing_BeginFrame(UploadRing *ring)
+{
+  if (ring->inFrame)
+  {
+    SDL_Log("UploadRing_BeginFrame called twice without UploadRing_Submit!");
+    return false;
+  }
+
+  ring->frameIndex = (ring->frameIndex + 1) % ring->frameCount;
+  UploadFrame *frame = &ring->frames[ring->frameIndex];
+
+  ring->stats.bytesUploaded = 0;
+  ring->stats.uploads = 0;
+  ring->stats.stalls = 0;
+  ring->stats.stallNS = 0;
+
+  if (frame->fence != NULL)
+  {
+    // The GPU is still reading this transfer buffer, the ring is too small for how far ahead the CPU runs
+    if (!SDL_QueryGPUFence(ring->device, frame->fence))
+    {
+      Uint64 waitStart = SDL_GetTicksNS();
+      SDL_WaitForGPUFences(ring->device, true, &frame->fence, 1);
+      ring->stats.stalls = 1;
+      ring->stats.stallNS = SDL_GetTicksNS() - waitStart;
+      ring->stats.totalStalls += 1;
+    }
+    // Signaled, but only released when this frame's own fence replaces it: a fence from FrameTarget_SubmitAndAcquireFence
+    // may not have been polled by the target's fence tracker yet, its next submit does that
+  }
+
+  ring->head = 0;
+  ring->pendingCount = 0;
+  ring->inFrame = true;
+  return true;
+}
+
+static PendingUpload *AllocateUpload(UploadRing *ring, Uint32 size, Uint32 alignment)
+{
+  if (!ring->inFrame)
+  {
+    SDL_Log("Upload ring used outside of UploadRing_BeginFrame / UploadRing_Submit!");
+    return NULL;
+  }
+
+  Uint32 offset = (ring->head + alignment - 1) & ~(alignment - 1);
+  if (size > ring->size || offset > ring->size - size)
+  {
+    SDL_Log("Upload of %u bytes does not fit in the upload ring (%u of %u bytes used)", size, ring->head, ring->size);
+    ring->stats.overflows += 1;
+    return NULL;
+  }
+
+  if (ring->pendingCount == ring->pendingCapacity)
+  {
+    Uint32 newCapacity = ring->pendingCapacity == 0 ? 16 : ring->pendingCapacity * 2;
+    PendingUpload *newPending = SDL_realloc(ring->pending, sizeof(PendingUpload) * newCapacity);
+    if (newPending == NULL)
+    {
+      return NULL;
+    }
+    ring->pending = newPending;
+    ring->pendingCapacity = newCapacity;
+  }
+
+  // The GPU is done with this buffer (BeginFrame waited on its fence) so there is no need to cycle it
+  if (ring->mapped == NULL)
+  {
+    ring->mapped = SDL_MapGPUTransferBuffer(ring->device, ring->frames[ring->frameIndex].transferBuffer, false);
+    if (ring->mapped == NULL)
+    {
+      SDL_Log("Failed to map upload ring transfer buffer: %s", SDL_GetError());
+      return NULL;
+    }
+  }
+
+  PendingUpload *upload = &ring->pending[ring->pendingCount];
+  ring->pendingCount += 1;
+  SDL_zerop(upload);
+  upload->offset = offset;
+  ring->head = offset + size;
+
+  ring->stats.bytesUploaded += size;
+  ring->stats.uploads += 1;
+  ring->stats.totalBytesUploaded += size;
+  return upload;
+}
+
+void *UploadRing_AllocateBufferUpload(UploadRing *ring, Uint32 size, SDL_GPUBuffer *buffer, Uint32 bufferOffset)
+{
+  PendingUpload *upload = AllocateUpload(ring, size, BUFFER_UPLOAD_ALIGNMENT);
+  if (upload == NULL)
+  {
+    return NULL;
+  }
+  upload->type = PENDING_UPLOAD_BUFFER;
+  upload->buffer = (SDL_GPUBufferRegion){
+      .buffer = buffer,
+      .offset = bufferOffset,
+      .size = size};
+  return ring->mapped + upload->offset;
+}
+
+void *UploadRing_AllocateTextureUpload(UploadRing *ring, Uint32 size, const SDL_GPUTextureRegion *region, Uint32 pixelsPerRow)
+{
+  PendingUpload *upload = AllocateUpload(ring, size, TEXTURE_UPLOAD_ALIGNMENT);
+  if (upload == NULL)
+  {
+    return NULL;
+  }
+  upload->type = PENDING_UPLOAD_TEXTURE;
+  upload->texture = *region;
+  upload->pixelsPerRow = pixelsPerRow;
+  return ring->mapped + upload->offset;
+}
+
+void UploadRing_DiscardTextureUploads(UploadRing *ring, SDL_GPUTexture *texture)
+{
+  Uint32 kept = 0;
+  for (Uint32 i = 0; i < ring->pendingCount; i += 1)
+  {
+    if (ring->pending[i].type != PENDING_UPLOAD_TEXTURE || ring->pending[i].texture.texture != texture)
+    {
+      ring->pending[kept] = ring->pending[i];
+      kept += 1;
+    }
+  }
+  ring->pendingCount = kept;
+}
+
+bool UploadRing_UploadToBuffer(UploadRing *ring, const void *data, Uint32 size, SDL_GPUBuffer *buffer, Uint32 bufferOffset)
+{
+  void *destination = UploadRing_AllocateBufferUpload(ring, size, buffer, bufferOffset);
+  if (destination == NULL)
+  {
+    return false;
+  }
+  SDL_memcpy(destination, data, size);
+  return true;
+}
+
+bool UploadRing_UploadToTexture(UploadRing *ring, const void *data, Uint32 size, const SDL_GPUTextureRegion *region, Uint32 pixelsPerRow)
+{
+  void *destination = UploadRing_AllocateTextureUpload(ring, size, region, pixelsPerRow);
+  if (destination == NULL)
+  {
+    return false;
+  }
+  SDL_memcpy(destination, data, size);
+  return true;
+}
+
+void UploadRing_Flush(UploadRing *ring, SDL_GPUCommandBuffer *cmdbuf)
+{
+  if (ring->mapped != NULL)
+  {
+    SDL_UnmapGPUTransferBuffer(ring->device, ring->frames[ring->frameIndex].transferBuffer);
+    ring->mapped = NULL;
+  }
+  if (ring->pendingCount == 0)
+  {
+    return;
+  }
+
+  SDL_GPUTransferBuffer *transferBuffer = ring->frames[ring->frameIndex].transferBuffer;
+  SDL_GPUCopyPass *copyPass = SDL_BeginGPUCopyPass(cmdbuf);
+  for (Uint32 i = 0; i < ring->pendingCount; i += 1)
+  {
+    PendingUpload *upload = &ring->pending[i];
+    if (upload->type == PENDING_UPLOAD_BUFFER)
+    {
+      SDL_UploadToGPUBuffer(
+          copyPass,
+          &(SDL_GPUTransferBufferLocation){
+              .transfer_buffer = transferBuffer,
+              .offset = upload->offset},
+          &upload->buffer,
+          false);
+    }
+    else
+    {
+      SDL_UploadToGPUTexture(
+          copyPass,
+          &(SDL_GPUTextureTransferInfo){
+              .transfer_buffer = transferBuffer,
+              .offset = upload->offset,
+              .pixels_per_row = upload->pixelsPerRow},
+          &upload->texture,
+          false);
+    }
+  }
+  SDL_EndGPUCopyPass(copyPass);
+  ring->pendingCount = 0;
+}
+
+bool UploadRing_Submit(UploadRing *ring, SDL_GPUCommandBuffer *cmdbuf)
+{
+  if (ring->pendingCount > 0 || ring->mapped != NULL)
+  {
+    UploadRing_Flush(ring, cmdbuf);
+  }
+
+  SDL_GPUFence *fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cmdbuf);
+  if (fence == NULL)
+  {
+    SDL_Log("SubmitGPUCommandBufferAndAcquireFence failed: %s", SDL_GetError());
+  }
+  return UploadRing_EndFrame(ring, fence);
+}
+
+bool UploadRing_EndFrame(UploadRing *ring, SDL_GPUFence *fence)
+{
+  if (ring->pendingCount > 0)
+  {
+    SDL_Log("UploadRing_EndFrame with %u uploads that were not flushed, they land after the frame", ring->pendingCount);
+  }
+  ring->inFrame = false;
+  if (fence == NULL)
+  {
+    // Keep the old fence, it signaled already and BeginFrame won't wait on it again
+    return false;
+  }
+  UploadFrame *frame = &ring->frames[ring->frameIndex];
+  if (frame->fence != NULL)
+  {
+    SDL_ReleaseGPUFence(ring->device, frame->fence);
+  }
+  frame->fence = fence;
+  return true;
+}
+
+UploadRingStats UploadRing_GetStats(UploadRing *ring)
+{
+  return ring->stats;
+}
@@ -0,0 +1,54 @@
+#ifndef UPLOAD_RING_H_
+#define UPLOAD_RING_H_
+#include <SDL3/SDL.h>
+
+// A few large transfer buffers, created once and suballocated linearly, one per frame in flight.
+// A buffer is only reused after the fence of the command buffer that read from it has signaled, so in steady state an upload costs a memcpy and no driver allocations.
+//
+// Usage per frame:
+//   UploadRing_BeginFrame(ring);
+//   UploadRing_UploadToBuffer(ring, ...) / UploadRing_AllocateBufferUpload(ring, ...) and write into the returned pointer
+//   UploadRing_Flush(ring, cmdbuf);  // records one copy pass with every queued upload
+//   UploadRing_Submit(ring, cmdbuf); // instead of SDL_SubmitGPUCommandBuffer
+// When something else submits the frame, flush into its command buffer and hand the fence of that submit to the ring:
+//   UploadRing_EndFrame(ring, FrameTarget_SubmitAndAcquireFence(target, cmdbuf));
+// Destroy the FrameTarget before the ring then, the target's fence tracker polls the ring's fences until it's gone.
+typedef struct UploadRing UploadRing;
+
+typedef struct UploadRingStats
+{
+  Uint64 bytesUploaded; // during the current frame
+  Uint32 uploads;       // during the current frame
+  Uint32 stalls;        // 1 if BeginFrame had to wait for the GPU to release the transfer buffer
+  Uint64 stallNS;       // how long that wait took
+  Uint64 totalBytesUploaded;
+  Uint32 totalStalls;
+  Uint32 overflows; // allocations that did not fit in a frame's transfer buffer
+} UploadRingStats;
+
+UploadRing *UploadRing_Create(SDL_GPUDevice *device, Uint32 sizePerFrame, Uint32 framesInFlight);
+// Waits for the GPU to be done with every transfer buffer before releasing them
+void UploadRing_Destroy(UploadRing *ring);
+
+bool UploadRing_BeginFrame(UploadRing *ring);
+
+// Returns a pointer into mapped transfer memory and queues a copy of it to the destination, fill it before UploadRing_Flush.
+// Returns NULL if the allocation doesn't fit in what's left of this frame's transfer buffer.
+void *UploadRing_AllocateBufferUpload(UploadRing *ring, Uint32 size, SDL_GPUBuffer *buffer, Uint32 bufferOffset);
+// pixelsPerRow is the row pitch of the data in texels, 0 means tightly packed rows
+void *UploadRing_AllocateTextureUpload(UploadRing *ring, Uint32 size, const SDL_GPUTextureRegion *region, Uint32 pixelsPerRow);
+
+// Drops the queued, not yet flushed copies into texture so it can be released, their space stays used until the next frame
+void UploadRing_DiscardTextureUploads(UploadRing *ring, SDL_GPUTexture *texture);
+
+bool UploadRing_UploadToBuffer(UploadRing *ring, const void *data, Uint32 size, SDL_GPUBuffer *buffer, Uint32 bufferOffset);
+bool UploadRing_UploadToTexture(UploadRing *ring, const void *data, Uint32 size, const SDL_GPUTextureRegion *region, Uint32 pixelsPerRow);
+
+void UploadRing_Flush(UploadRing *ring, SDL_GPUCommandBuffer *cmdbuf);
+bool UploadRing_Submit(UploadRing *ring, SDL_GPUCommandBuffer *cmdbuf);
+// Ends a frame whose command buffer was already submitted with the uploads flushed into it, the ring takes ownership of
+// the fence of that submit. It only releases a frame's fence once the same frame's next fence arrives, well after it signaled.
+bool UploadRing_EndFrame(UploadRing *ring, SDL_GPUFence *fence);
+
+UploadRingStats UploadRing_GetStats(UploadRing *ring);
+#endif // UPLOAD_RING_H_
@@ -0,0 +1,302 @@
+#include <SDL3/SDL.h>
+#include "vertex_format.h"
+
+static const char *PositionFormatNames[VERTEX_POSITION_FORMAT_COUNT] = {"float3", "short4", "half4"};
+static const char *UVFormatNames[VERTEX_UV_FORMAT_COUNT] = {"float2", "half2", "ushort2"};
+
+static Uint32 GetPositionSize(VertexPositionFormat format)
+{
+  return format == VERTEX_POSITION_FLOAT3 ? sizeof(float) * 3 : sizeof(Uint16) * 4;
+}
+
+static SDL_GPUVertexElementFormat GetPositionElementFormat(VertexPositionFormat format)
+{
+  switch (format)
+  {
+  case VERTEX_POSITION_SHORT4_NORM:
+    return SDL_GPU_VERTEXELEMENTFORMAT_SHORT4_NORM;
+  case VERTEX_POSITION_HALF4:
+    return SDL_GPU_VERTEXELEMENTFORMAT_HALF4;
+  default:
+    return SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3;
+  }
+}
+
+VertexLayout VertexFormat_GetPositionColorLayout(VertexPositionFormat positionFormat)
+{
+  VertexLayout layout = {0};
+  layout.positionFormat = positionFormat;
+  layout.elementFormats[0] = GetPositionElementFormat(positionFormat);
+  layout.elementFormats[1] = SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM;
+  layout.attributeOffset = GetPositionSize(positionFormat);
+  layout.stride = layout.attributeOffset + sizeof(Uint8) * 4;
+  return layout;
+}
+
+VertexLayout VertexFormat_GetPositionTextureLayout(VertexPositionFormat positionFormat, VertexUVFormat uvFormat)
+{
+  VertexLayout layout = {0};
+  layout.positionFormat = positionFormat;
+  layout.uvFormat = uvFormat;
+  layout.elementFormats[0] = GetPositionElementFormat(positionFormat);
+  layout.attributeOffset = GetPositionSize(positionFormat);
+  switch (uvFormat)
+  {
+  case VERTEX_UV_HALF2:
+    layout.elementFormats[1] = SDL_GPU_VERTEXELEMENTFORMAT_HALF2;
+    layout.stride = layout.attributeOffset + sizeof(Uint16) * 2;
+    break;
+  case VERTEX_UV_USHORT2_NORM:
+    layout.elementFormats[1] = SDL_GPU_VERTEXELEMENTFORMAT_USHORT2_NORM;
+    layout.stride = layout.attributeOffset + sizeof(Uint16) * 2;
+    break;
+  default:
+    layout.elementFormats[1] = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2;
+    layout.stride = layout.attributeOffset + sizeof(float) * 2;
+    break;
+  }
+  return layout;
+}
+
+void VertexFormat_GetAttributes(const VertexLayout *layout, SDL_GPUVertexAttribute attributes[2])
+{
+  attributes[0] = (SDL_GPUVertexAttribute){.location = 0, .buffer_slot = 0, .format = layout->elementFormats[0], .offset = 0};
+  attributes[1] = (SDL_GPUVertexAttribute){.location = 1, .buffer_slot = 0, .format = layout->elementFormats[1], .offset = layout->attributeOffset};
+}
+
+const char *VertexFormat_GetPositionFormatName(VertexPositionFormat format)
+{
+  return format < VERTEX_POSITION_FORMAT_COUNT ? PositionFormatNames[format] : "unknown";
+}
+
+const char *VertexFormat_GetUVFormatName(VertexUVFormat format)
+{
+  return format < VERTEX_UV_FORMAT_COUNT ? UVFormatNames[format] : "unknown";
+}
+
+bool VertexFormat_FindPositionFormat(const char *name, VertexPositionFormat *format)
+{
+  for (int i = 0; i < VERTEX_POSITION_FORMAT_COUNT; i += 1)
+  {
+    if (SDL_strcmp(name, PositionFormatNames[i]) == 0)
+    {
+      *format = (VertexPositionFormat)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool VertexFormat_FindUVFormat(const char *name, VertexUVFormat *format)
+{
+  for (int i = 0; i < VERTEX_UV_FORMAT_COUNT; i += 1)
+  {
+    if (SDL_strcmp(name, UVFormatNames[i]) == 0)
+    {
+      *format = (VertexUVFormat)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+Uint16 VertexFormat_FloatToHalf(float value)
+{
+  Uint32 bits;
+  SDL_memcpy(&bits, &value, sizeof(bits));
+  Uint32 sign = (bits >> 16) & 0x8000;
+  Uint32 exponent = (bits >> 23) & 0xFF;
+  Uint32 mantissa = bits & 0x7FFFFF;
+  if (exponent == 0xFF)
+  {
+    // Infinity stays infinity, NaN stays a quiet NaN
+    return (Uint16)(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+  }
+  int halfExponent = (int)exponent - 127 + 15;
+  if (halfExponent >= 31)
+  {
+    return (Uint16)(sign | 0x7C00);
+  }
+  if (halfExponent <= 0)
+  {
+    // Subnormal half, or zero below half the smallest one
+    if (halfExponent < -10)
+    {
+      return (Uint16)sign;
+    }
+    mantissa |= 0x800000;
+    Uint32 shift = (Uint32)(14 - halfExponent);
+    Uint32 half = mantissa >> shift;
+    Uint32 remainder = mantissa & ((1u << shift) - 1);
+    Uint32 halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (half & 1) != 0))
+    {
+      half += 1;
+    }
+    return (Uint16)(sign | half);
+  }
+  Uint32 half = ((Uint32)halfExponent << 10) | (mantissa >> 13);
+  Uint32 remainder = mantissa & 0x1FFF;
+  // A carry out of the mantissa moves on to the next exponent, up to infinity
+  if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1) != 0))
+  {
+    half += 1;
+  }
+  return (Uint16)(sign | half);
+}
+
+float VertexFormat_HalfToFloat(Uint16 value)
+{
+  Uint32 sign = (Uint32)(value & 0x8000) << 16;
+  Uint32 exponent = (value >> 10) & 0x1F;
+  Uint32 mantissa = value & 0x3FF;
+  if (exponent == 0)
+  {
+    float subnormal = mantissa / 16777216.0f;
+    return sign != 0 ? -subnormal : subnormal;
+  }
+  Uint32 bits = sign | (exponent == 31 ? 0x7F800000 : (exponent + 112) << 23) | (mantissa << 13);
+  float result;
+  SDL_memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+static Sint16 FloatToSnorm16(float value)
+{
+  return (Sint16)SDL_lroundf(SDL_clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+static Uint16 FloatToUnorm16(float value)
+{
+  return (Uint16)SDL_lroundf(SDL_clamp(value, 0.0f, 1.0f) * 65535.0f);
+}
+
+VertexDequantization VertexFormat_GetDequantization(const float min[3], const float max[3], VertexPositionFormat format)
+{
+  VertexDequantization dequantization = {{1.0f, 1.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.0f, 0.0f}};
+  if (format == VERTEX_POSITION_FLOAT3)
+  {
+    return dequantization;
+  }
+  for (int axis = 0; axis < 3; axis += 1)
+  {
+    float halfExtent = (max[axis] - min[axis]) * 0.5f;
+    // A flat axis still needs a scale the shader can multiply by
+    dequantization.scale[axis] = halfExtent > 0.0f ? halfExtent : 1.0f;
+    dequantization.offset[axis] = (min[axis] + max[axis]) * 0.5f;
+  }
+  return dequantization;
+}
+
+VertexDequantization VertexFormat_ComputeDequantization(const float *positions, Uint32 stride, Uint32 count, VertexPositionFormat format)
+{
+  float min[3] = {0.0f, 0.0f, 0.0f};
+  float max[3] = {0.0f, 0.0f, 0.0f};
+  if (format == VERTEX_POSITION_FLOAT3 || count == 0)
+  {
+    return VertexFormat_GetDequantization(min, max, format);
+  }
+  SDL_memcpy(min, positions, sizeof(min));
+  SDL_memcpy(max, positions, sizeof(max));
+  for (Uint32 i = 1; i < count; i += 1)
+  {
+    const float *position = (const float *)((const Uint8 *)positions + (size_t)stride * i);
+    for (int axis = 0; axis < 3; axis += 1)
+    {
+      min[axis] = SDL_min(min[axis], position[axis]);
+      max[axis] = SDL_max(max[axis], position[axis]);
+    }
+  }
+  return VertexFormat_GetDequantization(min, max, format);
+}
+
+// The position of one vertex in layout's position format
+static void WritePosition(Uint8 *destination, float x, float y, float z, const VertexLayout *layout, const VertexDequantization *dequantization)
+{
+  if (layout->positionFormat == VERTEX_POSITION_FLOAT3)
+  {
+    float position[3] = {x, y, z};
+    SDL_memcpy(destination, position, sizeof(position));
+    return;
+  }
+  float normalized[3] = {
+      (x - dequantization->offset[0]) / dequantization->scale[0],
+      (y - dequantization->offset[1]) / dequantization->scale[1],
+      (z - dequantization->offset[2]) / dequantization->scale[2]};
+  Uint16 packed[4];
+  if (layout->positionFormat == VERTEX_POSITION_SHORT4_NORM)
+  {
+    for (int axis = 0; axis < 3; axis += 1)
+    {
+      packed[axis] = (Uint16)FloatToSnorm16(normalized[axis]);
+    }
+    packed[3] = (Uint16)32767;
+  }
+  else
+  {
+    for (int axis = 0; axis < 3; axis += 1)
+    {
+      packed[axis] = VertexFormat_FloatToHalf(normalized[axis]);
+    }
+    packed[3] = VertexFormat_FloatToHalf(1.0f);
+  }
+  SDL_memcpy(destination, packed, sizeof(packed));
+}
+
+void VertexFormat_ConvertPositionColor(const PositionColorVertex *vertices, Uint32 count, const VertexLayout *layout, const VertexDequantization *dequantization, void *destination)
+{
+  Uint8 *output = destination;
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    const PositionColorVertex *vertex = &vertices[i];
+    WritePosition(output, vertex->x, vertex->y, vertex->z, layout, dequantization);
+    Uint8 color[4] = {vertex->r, vertex->g, vertex->b, vertex->a};
+    SDL_memcpy(output + layout->attributeOffset, color, sizeof(color));
+    output += layout->stride;
+  }
+}
+
+void VertexFormat_ConvertPositionTexture(const PositionTextureVertex *vertices, Uint32 count, const VertexLayout *layout, const VertexDequantization *dequantization, void *destination)
+{
+  Uint8 *output = destination;
+  for (Uint32 i = 0; i < count; i += 1)
+  {
+    const PositionTextureVertex *vertex = &vertices[i];
+    WritePosition(output, vertex->x, vertex->y, vertex->z, layout, dequantization);
+    Uint8 *uv = output + layout->attributeOffset;
+    if (layout->uvFormat == VERTEX_UV_HALF2)
+    {
+      Uint16 packed[2] = {VertexFormat_FloatToHalf(vertex->u), VertexFormat_FloatToHalf(vertex->v)};
+      SDL_memcpy(uv, packed, sizeof(packed));
+    }
+    else if (layout->uvFormat == VERTEX_UV_USHORT2_NORM)
+    {
+      Uint16 packed[2] = {FloatToUnorm16(vertex->u), FloatToUnorm16(vertex->v)};
+      SDL_memcpy(uv, packed, sizeof(packed));
+    }
+    else
+    {
+      float packed[2] = {vertex->u, vertex->v};
+      SDL_memcpy(uv, packed, sizeof(packed));
+    }
+    output += layout->stride;
+  }
+}
+
+void VertexFormat_DecodePosition(const void *vertex, const VertexLayout *layout, const VertexDequantization *dequantization, float position[3])
+{
+  if (layout->positionFormat == VERTEX_POSITION_FLOAT3)
+  {
+    SDL_memcpy(position, vertex, sizeof(float) * 3);
+    return;
+  }
+  Uint16 packed[4];
+  SDL_memcpy(packed, vertex, sizeof(packed));
+  for (int axis = 0; axis < 3; axis += 1)
+  {
+    float normalized = layout->positionFormat == VERTEX_POSITION_SHORT4_NORM
+                           ? SDL_max((Sint16)packed[axis] / 32767.0f, -1.0f)
+                           : VertexFormat_HalfToFloat(packed[axis]);
+    position[axis] = normalized * dequantization->scale[axis] + dequantization->offset[axis];
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef VERTEX_FORMAT_H_
+#define VERTEX_FORMAT_H_
+#include <SDL3/SDL.h>
+
+// The examples' vertex structs, 16 and 20 bytes per vertex
+typedef struct PositionColorVertex
+{
+  float x, y, z;
+  Uint8 r, g, b, a;
+} PositionColorVertex;
+
+typedef struct PositionTextureVertex
+{
+  float x, y, z;
+  float u, v;
+} PositionTextureVertex;
+
+// Compressed layouts of the same vertices. Quantized positions are stored relative to the mesh's bounding box,
+// the vertex shader turns them back into mesh space with the mesh's VertexDequantization: vertex_formats' QuantizedMesh
+// for PositionTexture layouts, QuantizedColorMesh for PositionColor ones.
+typedef enum VertexPositionFormat
+{
+  VERTEX_POSITION_FLOAT3,      // 12 bytes, as is
+  VERTEX_POSITION_SHORT4_NORM, // 8 bytes, 16 bit fixed point across the bounding box
+  VERTEX_POSITION_HALF4,       // 8 bytes, half floats across the bounding box, finer near its center
+  VERTEX_POSITION_FORMAT_COUNT
+} VertexPositionFormat;
+
+typedef enum VertexUVFormat
+{
+  VERTEX_UV_FLOAT2,       // 8 bytes, as is
+  VERTEX_UV_HALF2,        // 4 bytes, any range, 11 bits of precision
+  VERTEX_UV_USHORT2_NORM, // 4 bytes, 16 bits but only [0, 1]: UVs outside are clamped
+  VERTEX_UV_FORMAT_COUNT
+} VertexUVFormat;
+
+// position = quantized.xyz * scale.xyz + offset.xyz. Two vec4s so it can be pushed as part of a uniform buffer as is.
+typedef struct VertexDequantization
+{
+  float scale[4];
+  float offset[4];
+} VertexDequantization;
+
+// Where the attributes of a converted vertex are. The position is always at offset 0 and location 0,
+// the color or UV at attributeOffset and location 1.
+typedef struct VertexLayout
+{
+  VertexPositionFormat positionFormat;
+  VertexUVFormat uvFormat; // unused by color layouts
+  SDL_GPUVertexElementFormat elementFormats[2];
+  Uint32 attributeOffset;
+  Uint32 stride;
+} VertexLayout;
+
+VertexLayout VertexFormat_GetPositionColorLayout(VertexPositionFormat positionFormat);
+VertexLayout VertexFormat_GetPositionTextureLayout(VertexPositionFormat positionFormat, VertexUVFormat uvFormat);
+// Fills the two vertex attributes of layout for buffer slot 0
+void VertexFormat_GetAttributes(const VertexLayout *layout, SDL_GPUVertexAttribute attributes[2]);
+const char *VertexFormat_GetPositionFormatName(VertexPositionFormat format);
+const char *VertexFormat_GetUVFormatName(VertexUVFormat format);
+// The format a name above stands for, false for an unknown name
+bool VertexFormat_FindPositionFormat(const char *name, VertexPositionFormat *format);
+bool VertexFormat_FindUVFormat(const char *name, VertexUVFormat *format);
+
+// The bounding box of the mesh for the quantized formats, identity for VERTEX_POSITION_FLOAT3
+VertexDequantization VertexFormat_ComputeDequantization(const float *positions, Uint32 stride, Uint32 count, VertexPositionFormat format);
+// The same from a bounding box already known
+VertexDequantization VertexFormat_GetDequantization(const float min[3], const float max[3], VertexPositionFormat format);
+
+// Write count vertices in layout to destination, layout->stride bytes apart. destination can be mapped transfer memory.
+void VertexFormat_ConvertPositionColor(const PositionColorVertex *vertices, Uint32 count, const VertexLayout *layout, const VertexDequantization *dequantization, void *destination);
+void VertexFormat_ConvertPositionTexture(const PositionTextureVertex *vertices, Uint32 count, const VertexLayout *layout, const VertexDequantization *dequantization, void *destination);
+// Reads back the position of a converted vertex the way the GPU and the vertex shader see it
+void VertexFormat_DecodePosition(const void *vertex, const VertexLayout *layout, const VertexDequantization *dequantization, float position[3]);
+
+// IEEE half floats, rounded to nearest even. Too large values become infinity.
+Uint16 VertexFormat_FloatToHalf(float value);
+float VertexFormat_HalfToFloat(Uint16 value);
+#endif // VERTEX_FORMAT_H_
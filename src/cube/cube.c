@@ -3,11 +3,18 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "load.h"
+#include "pipeline_registry.h"
+#include "frame_target.h"
+#include "trace.h"
+#include "upload_ring.h"
+#include "buffer_allocator.h"
 #include "linear_algebra.h"
+#include "vertex_format.h"
 
 static SDL_GPUGraphicsPipeline *ScenePipeline;
-static SDL_GPUBuffer *SceneVertexBuffer;
-static SDL_GPUBuffer *SceneIndexBuffer;
+static Uint64 ScenePipelineHash;
+static MeshPool *SceneMeshes;
+static MeshAllocation CubeMesh;
 static SDL_GPUTexture *SceneColorTexture;
 static SDL_GPUTexture *SceneDepthTexture;
 
@@ -15,42 +22,24 @@ typedef struct Context
 {
   SDL_GPUDevice *Device;
   SDL_Window *Window;
+  FrameTarget *Target;
   SDL_GPUGraphicsPipeline *Pipeline;
+  PipelineRegistry *Pipelines;
+  UploadRing *Uploads;
 } Context;
 
-typedef struct PositionColorVertex
-{
-  float x, y, z;
-  Uint8 r, g, b, a;
-} PositionColorVertex;
-typedef struct PositionTextureVertex
-{
-  float x, y, z;
-  float u, v;
-} PositionTextureVertex;
-
 int SceneWidth, SceneHeight;
 
 Context context = {0};
-double getCurrentFPS()
+int main(int argc, char *argv[])
 {
-  static Uint64 previousTicks = 0;
-  static double fps = 0;
-
-  Uint64 currentTicks = SDL_GetTicks();
-
-  if (previousTicks != 0)
+  FrameTargetOptions options;
+  if (!FrameTarget_ParseArgs(argc, argv, "cube", &options))
   {
-    fps = 1000.0 / (currentTicks - previousTicks);
+    return 1;
   }
 
-  previousTicks = currentTicks;
-  return fps;
-}
-
-int main()
-{
-  if (SDL_Init(SDL_INIT_VIDEO) == false)
+  if (SDL_Init(FrameTarget_GetInitFlags(&options)) == false)
   {
     SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
     return 1;
@@ -58,7 +47,7 @@ int main()
   context.Device = SDL_CreateGPUDevice(
       SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL,
       false,
-      NULL);
+      options.driver);
 
   if (context.Device == NULL)
   {
@@ -66,16 +55,26 @@ int main()
     return -1;
   }
 
-  context.Window = SDL_CreateWindow("Cube", 640, 480, 0);
-  if (context.Window == NULL)
+  context.Target = FrameTarget_Create(context.Device, "Cube", 640, 480, 0, &options);
+  if (context.Target == NULL)
+  {
+    return -1;
+  }
+  context.Window = FrameTarget_GetWindow(context.Target);
+  // Logs which matrix kernels were picked, and how far they are from the scalar reference
+  LinearAlgebra_Validate();
+
+  context.Pipelines = PipelineRegistry_Create(context.Device);
+  if (context.Pipelines == NULL)
   {
-    SDL_Log("CreateWindow failed: %s", SDL_GetError());
+    SDL_Log("Failed to create pipeline registry!");
     return -1;
   }
 
-  if (!SDL_ClaimWindowForGPUDevice(context.Device, context.Window))
+  context.Uploads = UploadRing_Create(context.Device, 64 * 1024, 3);
+  if (context.Uploads == NULL)
   {
-    SDL_Log("GPUClaimWindow failed");
+    SDL_Log("Failed to create upload ring!");
     return -1;
   }
 
@@ -161,21 +160,19 @@ int main()
         .vertex_shader = sceneVertexShader,
         .fragment_shader = sceneFragmentShader};
 
-    ScenePipeline = SDL_CreateGPUGraphicsPipeline(context.Device, &pipelineCreateInfo);
-    if (ScenePipeline == NULL)
+    // The pipeline is built on a worker thread while the main loop is already presenting, the cube shows up as soon as it's ready
+    ScenePipelineHash = PipelineRegistry_Hash(&pipelineCreateInfo);
+    if (!PipelineRegistry_Prewarm(context.Pipelines, &pipelineCreateInfo, 1, 1))
     {
-      SDL_Log("Failed to create Scene pipeline!");
+      SDL_Log("Failed to start building the Scene pipeline!");
       return -1;
     }
-
-    SDL_ReleaseGPUShader(context.Device, sceneVertexShader);
-    SDL_ReleaseGPUShader(context.Device, sceneFragmentShader);
   }
 
   // Create the Cube
   {
     int w, h;
-    SDL_GetWindowSizeInPixels(context.Window, &w, &h);
+    FrameTarget_GetSize(context.Target, &w, &h);
     SceneWidth = w / 4;
     SceneHeight = h / 4;
 
@@ -205,28 +202,30 @@ int main()
   }
 
   {
-    SceneVertexBuffer = SDL_CreateGPUBuffer(
-        context.Device,
-        &(SDL_GPUBufferCreateInfo){
-            .usage = SDL_GPU_BUFFERUSAGE_VERTEX,
-            .size = sizeof(PositionColorVertex) * 24});
-
-    SceneIndexBuffer = SDL_CreateGPUBuffer(
-        context.Device,
-        &(SDL_GPUBufferCreateInfo){
-            .usage = SDL_GPU_BUFFERUSAGE_INDEX,
-            .size = sizeof(Uint16) * 36});
-
-    SDL_GPUTransferBuffer *bufferTransferBuffer = SDL_CreateGPUTransferBuffer(
-        context.Device,
-        &(SDL_GPUTransferBufferCreateInfo){
-            .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-            .size = (sizeof(PositionColorVertex) * 24) + (sizeof(Uint16) * 36)});
+    // Every mesh of the scene is carved out of these two buffers, so they all draw with one bind
+    SceneMeshes = MeshPool_Create(context.Device, sizeof(PositionColorVertex), 65536, SDL_GPU_INDEXELEMENTSIZE_16BIT, 3 * 65536);
+    if (SceneMeshes == NULL)
+    {
+      SDL_Log("Failed to create the Scene mesh pool!");
+      return -1;
+    }
+    if (!MeshPool_Allocate(SceneMeshes, 24, 36, &CubeMesh))
+    {
+      SDL_Log("Failed to allocate the Cube mesh!");
+      return -1;
+    }
 
-    PositionColorVertex *transferData = SDL_MapGPUTransferBuffer(
-        context.Device,
-        bufferTransferBuffer,
-        false);
+    UploadRing_BeginFrame(context.Uploads);
+    PositionColorVertex *transferData = UploadRing_AllocateBufferUpload(
+        context.Uploads,
+        sizeof(PositionColorVertex) * CubeMesh.vertexCount,
+        MeshPool_GetVertexBuffer(SceneMeshes),
+        CubeMesh.vertexByteOffset);
+    if (transferData == NULL)
+    {
+      SDL_Log("Failed to allocate the Cube vertex upload!");
+      return -1;
+    }
 
     transferData[0] = (PositionColorVertex){-10, -10, -10, 255, 0, 0, 255};
     transferData[1] = (PositionColorVertex){10, -10, -10, 255, 0, 0, 255};
@@ -258,7 +257,6 @@ int main()
     transferData[22] = (PositionColorVertex){10, 10, 10, 0, 0, 255, 255};
     transferData[23] = (PositionColorVertex){10, 10, -10, 0, 0, 255, 255};
 
-    Uint16 *indexData = (Uint16 *)&transferData[24];
     Uint16 indices[] = {
         0, 1, 2, 0, 2, 3,
         4, 5, 6, 4, 6, 7,
@@ -266,53 +264,31 @@ int main()
         12, 13, 14, 12, 14, 15,
         16, 17, 18, 16, 18, 19,
         20, 21, 22, 20, 22, 23};
-    SDL_memcpy(indexData, indices, sizeof(indices));
-
-    SDL_UnmapGPUTransferBuffer(context.Device, bufferTransferBuffer);
+    if (!UploadRing_UploadToBuffer(context.Uploads, indices, sizeof(indices), MeshPool_GetIndexBuffer(SceneMeshes), CubeMesh.indexByteOffset))
+    {
+      SDL_Log("Failed to allocate the Cube index upload!");
+      return -1;
+    }
 
     // Upload the transfer data to the GPU buffers
     SDL_GPUCommandBuffer *uploadCmdBuf = SDL_AcquireGPUCommandBuffer(context.Device);
-    SDL_GPUCopyPass *copyPass = SDL_BeginGPUCopyPass(uploadCmdBuf);
-
-    SDL_UploadToGPUBuffer(
-        copyPass,
-        &(SDL_GPUTransferBufferLocation){
-            .transfer_buffer = bufferTransferBuffer,
-            .offset = 0},
-        &(SDL_GPUBufferRegion){
-            .buffer = SceneVertexBuffer,
-            .offset = 0,
-            .size = sizeof(PositionColorVertex) * 24},
-        false);
-
-    SDL_UploadToGPUBuffer(
-        copyPass,
-        &(SDL_GPUTransferBufferLocation){
-            .transfer_buffer = bufferTransferBuffer,
-            .offset = sizeof(PositionColorVertex) * 24},
-        &(SDL_GPUBufferRegion){
-            .buffer = SceneIndexBuffer,
-            .offset = 0,
-            .size = sizeof(Uint16) * 36},
-        false);
-
-    SDL_EndGPUCopyPass(copyPass);
-    SDL_SubmitGPUCommandBuffer(uploadCmdBuf);
-    SDL_ReleaseGPUTransferBuffer(context.Device, bufferTransferBuffer);
+    UploadRing_Submit(context.Uploads, uploadCmdBuf);
+    MeshPool_LogReport(SceneMeshes);
   }
 
   SDL_Event event;
   int quit = 0;
   float fallDownAmount = 1;
   float rotationSpeed = 1;
-  Uint32 lastTime = SDL_GetTicks(); // Time of the last frame
+  Uint64 lastTime = SDL_GetTicksNS(); // Time of the last frame
 
-  while (!quit)
+  while (!quit && !FrameTarget_IsDone(context.Target))
   {
-    Uint32 currentTime = SDL_GetTicks();
-    float deltaTime = (currentTime - lastTime) / 1000.0f; // Convert to seconds
+    Uint64 currentTime = SDL_GetTicksNS();
+    float deltaTime = (currentTime - lastTime) / 1e9f; // Convert to seconds
     lastTime = currentTime;
 
+    TRACE_BEGIN("poll events");
     while (SDL_PollEvent(&event))
     {
       switch (event.type)
@@ -322,6 +298,7 @@ int main()
         break;
       }
     }
+    TRACE_END();
     static float rotationAngle = 0.0f;          // Cumulative rotation angle
     rotationAngle += rotationSpeed * deltaTime; // Update angle based on delta time
     float radius = 30.0f;                       // Distance from the origin
@@ -333,7 +310,24 @@ int main()
 
     bool changeResolution = false;
 
+    if (ScenePipeline == NULL)
+    {
+      // Check for completion first, so a pipeline finishing in between isn't mistaken for a failure
+      bool prewarmDone = PipelineRegistry_IsPrewarmDone(context.Pipelines);
+      ScenePipeline = PipelineRegistry_Find(context.Pipelines, ScenePipelineHash);
+      if (ScenePipeline == NULL && prewarmDone)
+      {
+        SDL_Log("Failed to create Scene pipeline!");
+        return -1;
+      }
+    }
+
+    // Every frame goes through the ring so its fences track the frames in flight
+    UploadRing_BeginFrame(context.Uploads);
+
+    TRACE_BEGIN("acquire command buffer");
     SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    TRACE_END();
     if (cmdbuf == NULL)
     {
       SDL_Log("AcquireGPUCommandBuffer failed: %s", SDL_GetError());
@@ -341,11 +335,12 @@ int main()
     }
 
     SDL_GPUTexture *swapchainTexture;
-    if (!SDL_WaitAndAcquireGPUSwapchainTexture(cmdbuf, context.Window, &swapchainTexture, NULL, NULL))
+    if (!FrameTarget_Acquire(context.Target, cmdbuf, &swapchainTexture))
     {
       SDL_Log("WaitAndAcquireGPUSwapchainTexture failed: %s", SDL_GetError());
       return -1;
     }
+    UploadRing_Flush(context.Uploads, cmdbuf);
     if (swapchainTexture != NULL)
     {
       // Render the 3D Scene (Color and Depth pass)
@@ -380,24 +375,42 @@ int main()
       depthStencilTargetInfo.stencil_load_op = SDL_GPU_LOADOP_CLEAR;
       depthStencilTargetInfo.stencil_store_op = SDL_GPU_STOREOP_STORE;
 
+      TRACE_BEGIN("uniforms");
       SDL_PushGPUVertexUniformData(cmdbuf, 0, &viewproj, sizeof(viewproj));
       SDL_PushGPUFragmentUniformData(cmdbuf, 0, (float[]){nearPlane, farPlane}, 8);
+      TRACE_END();
 
+      TRACE_BEGIN("render pass");
       SDL_GPURenderPass *renderPass = SDL_BeginGPURenderPass(cmdbuf, &colorTargetInfo, 1, &depthStencilTargetInfo);
-      SDL_BindGPUVertexBuffers(renderPass, 0, &(SDL_GPUBufferBinding){.buffer = SceneVertexBuffer, .offset = 0}, 1);
-      SDL_BindGPUIndexBuffer(renderPass, &(SDL_GPUBufferBinding){.buffer = SceneIndexBuffer, .offset = 0}, SDL_GPU_INDEXELEMENTSIZE_16BIT);
-      SDL_BindGPUGraphicsPipeline(renderPass, ScenePipeline);
-      SDL_DrawGPUIndexedPrimitives(renderPass, 36, 1, 0, 0, 0);
+      // Until the pipeline is ready we only clear the screen
+      if (ScenePipeline != NULL)
+      {
+        MeshPool_Bind(SceneMeshes, renderPass);
+        SDL_BindGPUGraphicsPipeline(renderPass, ScenePipeline);
+        MeshPool_Draw(renderPass, &CubeMesh, 1);
+      }
       SDL_EndGPURenderPass(renderPass);
+      TRACE_END();
+    }
+    UploadRing_EndFrame(context.Uploads, FrameTarget_SubmitAndAcquireFence(context.Target, cmdbuf));
+
+    UploadRingStats uploadStats = UploadRing_GetStats(context.Uploads);
+    if (uploadStats.stalls > 0)
+    {
+      SDL_Log("Upload ring stalled for %.3f ms", uploadStats.stallNS / 1e6);
     }
-    SDL_SubmitGPUCommandBuffer(cmdbuf);
   }
 
   // Cleanup
 
-  SDL_ReleaseGPUGraphicsPipeline(context.Device, ScenePipeline);
+  PipelineRegistry_LogStats(context.Pipelines);
+  PipelineRegistry_Destroy(context.Pipelines);
   SDL_ReleaseGPUTexture(context.Device, SceneColorTexture);
   SDL_ReleaseGPUTexture(context.Device, SceneDepthTexture);
-  SDL_ReleaseGPUBuffer(context.Device, SceneVertexBuffer);
-  SDL_ReleaseGPUBuffer(context.Device, SceneIndexBuffer);
+  MeshPool_Free(SceneMeshes, &CubeMesh);
+  MeshPool_Destroy(SceneMeshes);
+  ReleaseShaderCache(context.Device);
+  // After the target, whose fence tracker still polls the fences the ring owns
+  FrameTarget_Destroy(context.Target);
+  UploadRing_Destroy(context.Uploads);
 }
\ No newline at end of file
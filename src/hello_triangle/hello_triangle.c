@@ -1,93 +1,31 @@
 #include <SDL3/SDL.h>
+#include "load.h"
+#include "pipeline_registry.h"
+#include "frame_target.h"
+#include "trace.h"
 
 typedef struct Context
 {
   SDL_GPUDevice *Device;
   SDL_Window *Window;
+  FrameTarget *Target;
   SDL_GPUGraphicsPipeline *Pipeline;
+  PipelineRegistry *Pipelines;
 } Context;
 Context context = {0};
 
 void Cleanup();
 SDL_GPUGraphicsPipeline *Pipeline;
 
-SDL_GPUShader *LoadShader(
-    SDL_GPUDevice *device,
-    const char *shaderPath,
-    Uint32 samplerCount,
-    Uint32 uniformBufferCount,
-    Uint32 storageBufferCount,
-    Uint32 storageTextureCount)
+int main(int argc, char *argv[])
 {
-  // Auto-detect the shader stage from the file name for convenience
-  SDL_GPUShaderStage stage;
-  if (SDL_strstr(shaderPath, ".vert"))
+  FrameTargetOptions options;
+  if (!FrameTarget_ParseArgs(argc, argv, "hello_triangle", &options))
   {
-    stage = SDL_GPU_SHADERSTAGE_VERTEX;
-  }
-  else if (SDL_strstr(shaderPath, ".frag"))
-  {
-    stage = SDL_GPU_SHADERSTAGE_FRAGMENT;
-  }
-  else
-  {
-    SDL_Log("Invalid shader stage!");
-    return NULL;
-  }
-
-  SDL_GPUShaderFormat format = SDL_GetGPUShaderFormats(device);
-  const char *entrypoint;
-
-  if (format & SDL_GPU_SHADERFORMAT_SPIRV)
-  {
-    entrypoint = "main";
-  }
-  else if (format & SDL_GPU_SHADERFORMAT_MSL)
-  {
-    entrypoint = "main0";
-  }
-  else if (format & SDL_GPU_SHADERFORMAT_DXIL)
-  {
-    entrypoint = "main";
-  }
-  else
-  {
-    SDL_Log("%s", "Unrecognized backend shader format!");
-    return NULL;
-  }
-
-  size_t codeSize;
-  void *code = SDL_LoadFile(shaderPath, &codeSize);
-  if (code == NULL)
-  {
-    SDL_Log("Failed to load shader from disk! %s", shaderPath);
-    return NULL;
-  }
-
-  SDL_GPUShaderCreateInfo shaderInfo = {
-      .code = code,
-      .code_size = codeSize,
-      .entrypoint = entrypoint,
-      .format = format,
-      .stage = stage,
-      .num_samplers = samplerCount,
-      .num_uniform_buffers = uniformBufferCount,
-      .num_storage_buffers = storageBufferCount,
-      .num_storage_textures = storageTextureCount};
-  SDL_GPUShader *shader = SDL_CreateGPUShader(device, &shaderInfo);
-  if (shader == NULL)
-  {
-    SDL_Log("Failed to create shader!");
-    SDL_free(code);
-    return NULL;
+    return 1;
   }
-  SDL_free(code);
-  return shader;
-}
 
-int main()
-{
-  if (SDL_Init(SDL_INIT_VIDEO) == false)
+  if (SDL_Init(FrameTarget_GetInitFlags(&options)) == false)
   {
     SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
     return 1;
@@ -96,7 +34,7 @@ int main()
   context.Device = SDL_CreateGPUDevice(
       SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL,
       false,
-      NULL);
+      options.driver);
 
   if (context.Device == NULL)
   {
@@ -104,21 +42,22 @@ int main()
     return -1;
   }
 
-  context.Window = SDL_CreateWindow("Basic Triangle", 640, 480, 0);
-  if (context.Window == NULL)
+  context.Target = FrameTarget_Create(context.Device, "Basic Triangle", 640, 480, 0, &options);
+  if (context.Target == NULL)
   {
-    SDL_Log("CreateWindow failed: %s", SDL_GetError());
     return -1;
   }
+  context.Window = FrameTarget_GetWindow(context.Target);
 
-  if (!SDL_ClaimWindowForGPUDevice(context.Device, context.Window))
+  context.Pipelines = PipelineRegistry_Create(context.Device);
+  if (context.Pipelines == NULL)
   {
-    SDL_Log("GPUClaimWindow failed");
+    SDL_Log("Failed to create pipeline registry!");
     return -1;
   }
 
-  SDL_GPUShader *vertexShader = LoadShader(context.Device, "shader-binaries/spv/hello_triangle.vert.spv", 0, 0, 0, 0);
-  SDL_GPUShader *fragmentShader = LoadShader(context.Device, "shader-binaries/spv/hello_triangle.frag.spv", 0, 0, 0, 0);
+  SDL_GPUShader *vertexShader = LoadShader(context.Device, "hello_triangle.vert", 0, 0, 0, 0);
+  SDL_GPUShader *fragmentShader = LoadShader(context.Device, "hello_triangle.frag", 0, 0, 0, 0);
 
   if (!vertexShader || !fragmentShader)
   {
@@ -129,29 +68,27 @@ int main()
   SDL_GPUGraphicsPipelineCreateInfo pipelineCreateInfo = {
       .target_info = {
           .num_color_targets = 1,
-          .color_target_descriptions = (SDL_GPUColorTargetDescription[]){{.format = SDL_GetGPUSwapchainTextureFormat(context.Device, context.Window)}},
+          .color_target_descriptions = (SDL_GPUColorTargetDescription[]){{.format = FrameTarget_GetFormat(context.Target)}},
       },
       .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
       .vertex_shader = vertexShader,
       .fragment_shader = fragmentShader,
   };
 
-  Pipeline = SDL_CreateGPUGraphicsPipeline(context.Device, &pipelineCreateInfo);
+  Pipeline = PipelineRegistry_Get(context.Pipelines, &pipelineCreateInfo);
   if (Pipeline == NULL)
   {
     SDL_Log("Failed to create pipeline!");
     return -1;
   }
 
-  SDL_ReleaseGPUShader(context.Device, vertexShader);
-  SDL_ReleaseGPUShader(context.Device, fragmentShader);
-
   // Main loop
   SDL_Event event;
   int quit = 0;
 
-  while (!quit)
+  while (!quit && !FrameTarget_IsDone(context.Target))
   {
+    TRACE_BEGIN("poll events");
     while (SDL_PollEvent(&event))
     {
       if (event.type == SDL_EVENT_QUIT)
@@ -159,13 +96,16 @@ int main()
         quit = 1;
       }
     }
+    TRACE_END();
 
+    TRACE_BEGIN("acquire command buffer");
     SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    TRACE_END();
     if (!cmdbuf)
       continue;
 
     SDL_GPUTexture *swapchainTexture;
-    if (SDL_WaitAndAcquireGPUSwapchainTexture(cmdbuf, context.Window, &swapchainTexture, NULL, NULL))
+    if (FrameTarget_Acquire(context.Target, cmdbuf, &swapchainTexture))
     {
       SDL_GPUColorTargetInfo colorTargetInfo = {
           .texture = swapchainTexture,
@@ -173,17 +113,18 @@ int main()
           .load_op = SDL_GPU_LOADOP_CLEAR,
           .store_op = SDL_GPU_STOREOP_STORE};
 
+      TRACE_BEGIN("render pass");
       SDL_GPURenderPass *renderPass = SDL_BeginGPURenderPass(cmdbuf, &colorTargetInfo, 1, NULL);
       SDL_BindGPUGraphicsPipeline(renderPass, Pipeline);
       SDL_DrawGPUPrimitives(renderPass, 3, 1, 0, 0);
       SDL_EndGPURenderPass(renderPass);
+      TRACE_END();
     }
 
-    SDL_SubmitGPUCommandBuffer(cmdbuf);
+    FrameTarget_Submit(context.Target, cmdbuf);
   }
 
   // Cleanup
-  SDL_ReleaseGPUGraphicsPipeline(context.Device, Pipeline);
   Cleanup();
   SDL_Quit();
 
@@ -191,13 +132,11 @@ int main()
 }
 void Cleanup()
 {
-  if (context.Device != NULL && context.Pipeline != NULL)
-  {
-    SDL_ReleaseGPUGraphicsPipeline(context.Device, context.Pipeline);
-  }
   if (context.Device != NULL)
   {
-    SDL_DestroyWindow(context.Window);
+    PipelineRegistry_Destroy(context.Pipelines);
+    ReleaseShaderCache(context.Device);
+    FrameTarget_Destroy(context.Target);
     SDL_DestroyGPUDevice(context.Device);
   }
 }
@@ -0,0 +1,73 @@
+#version 450
+// Frustum culls every cube against the camera and appends the visible ones to VisibleIndices,
+// counting them straight into the indirect draw arguments. Nothing is read back by the CPU.
+layout(local_size_x = 64) in;
+
+// xyz is the cube's center, w its scale
+layout(std430, set = 0, binding = 0) readonly buffer InstanceBuffer
+{
+    vec4 Instances[];
+};
+
+layout(std430, set = 1, binding = 0) writeonly buffer VisibleBuffer
+{
+    uint VisibleIndices[];
+};
+
+// SDL_GPUIndexedIndirectDrawCommand, NumInstances is reset to 0 before the dispatch
+layout(std430, set = 1, binding = 1) buffer IndirectBuffer
+{
+    uint NumIndices;
+    uint NumInstances;
+    uint FirstIndex;
+    int VertexOffset;
+    uint FirstInstance;
+};
+
+layout(set = 2, binding = 0) uniform UBO
+{
+    vec4 Planes[6]; // normal in xyz, distance in w, inside is positive
+    uint InstanceCount;
+};
+
+shared uint GroupCount;
+shared uint GroupBase;
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (gl_LocalInvocationIndex == 0)
+    {
+        GroupCount = 0;
+    }
+    barrier();
+
+    bool visible = index < InstanceCount;
+    if (visible)
+    {
+        vec4 instance = Instances[index];
+        // Half the diagonal of the scaled unit cube
+        float radius = instance.w * 0.8660254;
+        for (int p = 0; p < 6; p++)
+        {
+            visible = visible && dot(Planes[p].xyz, instance.xyz) + Planes[p].w >= -radius;
+        }
+    }
+
+    // One global atomic per group instead of one per visible cube
+    uint groupSlot = 0;
+    if (visible)
+    {
+        groupSlot = atomicAdd(GroupCount, 1);
+    }
+    barrier();
+    if (gl_LocalInvocationIndex == 0 && GroupCount > 0)
+    {
+        GroupBase = atomicAdd(NumInstances, GroupCount);
+    }
+    barrier();
+    if (visible)
+    {
+        VisibleIndices[GroupBase + groupSlot] = index;
+    }
+}
@@ -0,0 +1,42 @@
+#version 450
+
+#ifdef VERTEX
+layout(set = 1, binding = 0) uniform UBO {
+    mat4 ViewProjection;
+    // The draw's instances are VisibleIndices[VisibleOffset...], indices relative to InstanceOffset
+    uint VisibleOffset;
+    uint InstanceOffset;
+};
+
+// xyz is the cube's center, w its scale
+layout(std430, set = 0, binding = 0) readonly buffer InstanceBuffer
+{
+    vec4 Instances[];
+};
+
+// The cubes that survived culling, one per instance of the draw
+layout(std430, set = 0, binding = 1) readonly buffer VisibleBuffer
+{
+    uint VisibleIndices[];
+};
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    vec4 instance = Instances[InstanceOffset + VisibleIndices[VisibleOffset + gl_InstanceIndex]];
+    outColor = inColor;
+    gl_Position = ViewProjection * vec4(inPosition * instance.w + instance.xyz, 1.0);
+}
+#endif
+
+#ifdef FRAGMENT
+layout(location = 0) in vec4 inColor;
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = inColor;
+}
+#endif
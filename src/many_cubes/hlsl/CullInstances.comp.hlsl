@@ -0,0 +1,57 @@
+// Frustum culls every cube against the camera and appends the visible ones to VisibleIndices,
+// counting them straight into the indirect draw arguments. Nothing is read back by the CPU.
+
+// xyz is the cube's center, w its scale
+StructuredBuffer<float4> Instances : register(t0, space0);
+RWStructuredBuffer<uint> VisibleIndices : register(u0, space1);
+// SDL_GPUIndexedIndirectDrawCommand, [1] is the instance count and is reset to 0 before the dispatch
+RWStructuredBuffer<uint> IndirectArgs : register(u1, space1);
+
+cbuffer UBO : register(b0, space2)
+{
+    float4 Planes[6]; // normal in xyz, distance in w, inside is positive
+    uint InstanceCount;
+};
+
+groupshared uint GroupCount;
+groupshared uint GroupBase;
+
+[numthreads(64, 1, 1)]
+void main(uint3 GlobalInvocationID : SV_DispatchThreadID, uint LocalInvocationIndex : SV_GroupIndex)
+{
+    uint index = GlobalInvocationID.x;
+    if (LocalInvocationIndex == 0)
+    {
+        GroupCount = 0;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    bool visible = index < InstanceCount;
+    if (visible)
+    {
+        float4 instance = Instances[index];
+        // Half the diagonal of the scaled unit cube
+        float radius = instance.w * 0.8660254f;
+        for (int p = 0; p < 6; p++)
+        {
+            visible = visible && dot(Planes[p].xyz, instance.xyz) + Planes[p].w >= -radius;
+        }
+    }
+
+    // One global atomic per group instead of one per visible cube
+    uint groupSlot = 0;
+    if (visible)
+    {
+        InterlockedAdd(GroupCount, 1, groupSlot);
+    }
+    GroupMemoryBarrierWithGroupSync();
+    if (LocalInvocationIndex == 0 && GroupCount > 0)
+    {
+        InterlockedAdd(IndirectArgs[1], GroupCount, GroupBase);
+    }
+    GroupMemoryBarrierWithGroupSync();
+    if (visible)
+    {
+        VisibleIndices[GroupBase + groupSlot] = index;
+    }
+}
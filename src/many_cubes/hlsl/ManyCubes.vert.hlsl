@@ -0,0 +1,34 @@
+cbuffer UBO : register(b0, space1)
+{
+    float4x4 ViewProjection : packoffset(c0);
+    // The draw's instances are VisibleIndices[VisibleOffset...], indices relative to InstanceOffset
+    uint VisibleOffset : packoffset(c4.x);
+    uint InstanceOffset : packoffset(c4.y);
+};
+
+// xyz is the cube's center, w its scale
+StructuredBuffer<float4> Instances : register(t0, space0);
+// The cubes that survived culling, one per instance of the draw
+StructuredBuffer<uint> VisibleIndices : register(t1, space0);
+
+struct Input
+{
+    float3 Position : TEXCOORD0;
+    float4 Color : TEXCOORD1;
+    uint InstanceIndex : SV_InstanceID;
+};
+
+struct Output
+{
+    float4 Color : TEXCOORD0;
+    float4 Position : SV_Position;
+};
+
+Output main(Input input)
+{
+    float4 instance = Instances[InstanceOffset + VisibleIndices[VisibleOffset + input.InstanceIndex]];
+    Output output;
+    output.Color = input.Color;
+    output.Position = mul(ViewProjection, float4(input.Position * instance.w + instance.xyz, 1.0f));
+    return output;
+}
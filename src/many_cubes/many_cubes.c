@@ -0,0 +1,1053 @@
+#include <SDL3/SDL.h>
+#include <stdlib.h>
+#include "load.h"
+#include "pipeline_registry.h"
+#include "frame_target.h"
+#include "trace.h"
+#include "upload_ring.h"
+#include "linear_algebra.h"
+#include "culling.h"
+#include "command_recorder.h"
+#include "mesh_simplify.h"
+#include "buffer_allocator.h"
+#include "vertex_format.h"
+
+// The cube example's cube, copied onto a grid of many cubes. Every frame the cubes are culled against the camera's frustum on the CPU,
+// the visible indices go straight into a mapped transfer buffer and the visible cubes are drawn instanced.
+// The grid is split into one slice per recording thread (--record-threads N): each thread culls its slice and records it into its own command buffer.
+// With --gpu-cull a compute shader does the culling instead and writes the draw's arguments too, the CPU never sees which cubes are visible.
+// With --lod every cube is a 12k triangle rock with a chain of simplified levels: each visible rock is drawn with the coarsest level whose
+// error stays under a pixel at its distance, one instanced draw per level.
+#define DEFAULT_CUBE_COUNT 100000
+#define CUBE_SPACING 4.0f
+// --record-scaling records this many frames with each thread count
+#define SCALING_FRAMES_PER_STEP 200
+// Must match local_size_x / numthreads of CullInstances
+#define CULL_GROUP_SIZE 64
+#define MAX_CULL_GROUPS 65535
+// The rock of --lod is a cube with this many quads per edge of each face, pushed out onto a bumpy sphere
+#define ROCK_DETAIL 32
+#define ROCK_VERTEX_COUNT (6 * ROCK_DETAIL * ROCK_DETAIL + 2)
+#define ROCK_INDEX_COUNT (36 * ROCK_DETAIL * ROCK_DETAIL)
+// --lod picks the coarsest level that moves the surface by at most this many pixels
+#define LOD_MAX_PIXEL_ERROR 1.0f
+#define FIELD_OF_VIEW (70.0f * SDL_PI_F / 180.0f)
+
+typedef struct Context
+{
+  SDL_GPUDevice *Device;
+  SDL_Window *Window;
+  FrameTarget *Target;
+  SDL_GPUGraphicsPipeline *Pipeline;
+  PipelineRegistry *Pipelines;
+  UploadRing *Uploads;
+} Context;
+
+// What the vertex shader reads per cube, xyz is the center and w the scale
+typedef struct CubeInstance
+{
+  float x, y, z, scale;
+} CubeInstance;
+
+// Matches the vertex UBO of ManyCubes, the draw's instances are VisibleIndices[visibleOffset...] of the cubes from instanceOffset on
+typedef struct DrawUniforms
+{
+  Matrix4x4 viewProjection;
+  Uint32 visibleOffset;
+  Uint32 instanceOffset;
+  Uint32 padding[2];
+} DrawUniforms;
+
+// Matches the UBO of CullInstances, std140 pads the block to 16 bytes
+typedef struct CullUniforms
+{
+  Frustum frustum;
+  Uint32 instanceCount;
+  Uint32 padding[3];
+} CullUniforms;
+
+// The bounding spheres of the cubes, kept on the CPU for culling
+typedef struct CubeBounds
+{
+  float *centerX;
+  float *centerY;
+  float *centerZ;
+  float *radius;
+} CubeBounds;
+
+// What one recording thread owns: a contiguous range of the cubes and the buffers for its visible list
+typedef struct CubeSlice
+{
+  Uint32 firstCube;
+  Uint32 cubeCount;
+  SDL_GPUTransferBuffer *visibleTransferBuffer;
+  SDL_GPUBuffer *visibleBuffer;
+  // With --lod the cubes are culled here first, then written to the transfer buffer grouped by the level in levels
+  Uint32 *culled;
+  Uint8 *levels;
+  // Results of the last frame
+  Uint32 visibleCount;
+  Uint32 drawCount;
+  Uint64 triangleCount;
+  Uint64 cullNS;
+} CubeSlice;
+
+// Everything the recording threads share, only written between frames
+typedef struct Scene
+{
+  SDL_GPUDevice *device;
+  SDL_GPUGraphicsPipeline *pipeline;
+  MeshPool *meshes;
+  MeshAllocation mesh; // the cube, or the rock with every level's indices
+  SDL_GPUBuffer *instanceBuffer;
+  SDL_GPUTexture *colorTexture;
+  SDL_GPUTexture *depthTexture;
+  BoundingSpheres spheres;
+  Uint32 cubeCount;
+  Uint32 cubesPerDraw; // 0 draws all the visible cubes of a slice at once
+  CubeSlice *slices;
+  Uint32 sliceCount;
+  // The levels, firstIndex counted from mesh.firstIndex, only the cube itself without --lod
+  MeshLodChain lods;
+  float meshRadius;
+  float projectionScale;
+
+  DrawUniforms uniforms;
+  Frustum frustum;
+  Vector3 cameraPosition;
+} Scene;
+
+Context context = {0};
+static Scene scene = {0};
+
+static void DestroySlices(void)
+{
+  for (Uint32 i = 0; i < scene.sliceCount; i += 1)
+  {
+    SDL_ReleaseGPUTransferBuffer(scene.device, scene.slices[i].visibleTransferBuffer);
+    SDL_ReleaseGPUBuffer(scene.device, scene.slices[i].visibleBuffer);
+    SDL_free(scene.slices[i].culled);
+    SDL_free(scene.slices[i].levels);
+  }
+  SDL_free(scene.slices);
+  scene.slices = NULL;
+  scene.sliceCount = 0;
+}
+
+static bool CreateSlices(Uint32 sliceCount)
+{
+  scene.slices = SDL_calloc(sliceCount, sizeof(CubeSlice));
+  if (scene.slices == NULL)
+  {
+    return false;
+  }
+  scene.sliceCount = sliceCount;
+  for (Uint32 i = 0; i < sliceCount; i += 1)
+  {
+    CubeSlice *slice = &scene.slices[i];
+    slice->firstCube = (Uint32)((Uint64)scene.cubeCount * i / sliceCount);
+    slice->cubeCount = (Uint32)((Uint64)scene.cubeCount * (i + 1) / sliceCount) - slice->firstCube;
+    Uint32 size = sizeof(Uint32) * SDL_max(slice->cubeCount, 1);
+    // Cycled every frame, the culling writes the visible indices straight into it
+    slice->visibleTransferBuffer = SDL_CreateGPUTransferBuffer(
+        scene.device,
+        &(SDL_GPUTransferBufferCreateInfo){.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD, .size = size});
+    slice->visibleBuffer = SDL_CreateGPUBuffer(
+        scene.device,
+        &(SDL_GPUBufferCreateInfo){.usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ, .size = size});
+    if (scene.lods.levelCount > 1)
+    {
+      slice->culled = SDL_malloc(size);
+      slice->levels = SDL_malloc(SDL_max(slice->cubeCount, 1));
+    }
+    if (slice->visibleTransferBuffer == NULL || slice->visibleBuffer == NULL ||
+        (scene.lods.levelCount > 1 && (slice->culled == NULL || slice->levels == NULL)))
+    {
+      SDL_Log("Failed to create the buffers of slice %u: %s", i, SDL_GetError());
+      DestroySlices();
+      return false;
+    }
+  }
+  return true;
+}
+
+// Culls the slice into its culled list, then writes the visible cubes to visible grouped by level.
+// levelStarts[l] to levelStarts[l + 1] are the cubes drawn with level l.
+static Uint32 CullByLevel(const Scene *scene, CubeSlice *slice, const BoundingSpheres *spheres, Uint32 *visible, Uint32 *levelStarts)
+{
+  Uint32 visibleCount = Frustum_CullSpheres(&scene->frustum, spheres, slice->cubeCount, slice->culled);
+  Uint32 counts[MESH_LOD_MAX_LEVELS] = {0};
+  for (Uint32 i = 0; i < visibleCount; i += 1)
+  {
+    Uint32 cube = slice->culled[i];
+    float dx = spheres->centerX[cube] - scene->cameraPosition.x;
+    float dy = spheres->centerY[cube] - scene->cameraPosition.y;
+    float dz = spheres->centerZ[cube] - scene->cameraPosition.z;
+    float radius = spheres->radius[cube];
+    Uint32 level = MeshLod_Select(
+        &scene->lods,
+        SDL_sqrtf(dx * dx + dy * dy + dz * dz) - radius,
+        radius / scene->meshRadius,
+        scene->projectionScale,
+        LOD_MAX_PIXEL_ERROR);
+    slice->levels[i] = (Uint8)level;
+    counts[level] += 1;
+  }
+
+  // A counting sort: the transfer buffer is only written once per cube
+  Uint32 next[MESH_LOD_MAX_LEVELS];
+  levelStarts[0] = 0;
+  for (Uint32 level = 0; level < MESH_LOD_MAX_LEVELS; level += 1)
+  {
+    next[level] = levelStarts[level];
+    levelStarts[level + 1] = levelStarts[level] + counts[level];
+  }
+  for (Uint32 i = 0; i < visibleCount; i += 1)
+  {
+    visible[next[slice->levels[i]]++] = slice->culled[i];
+  }
+  return visibleCount;
+}
+
+// Runs on the recording threads, one call per slice
+static bool SDLCALL RecordSlice(void *userdata, Uint32 sliceIndex, Uint32 sliceCount, SDL_GPUCommandBuffer *cmdbuf)
+{
+  Scene *scene = userdata;
+  CubeSlice *slice = &scene->slices[sliceIndex];
+
+  Uint32 *visible = SDL_MapGPUTransferBuffer(scene->device, slice->visibleTransferBuffer, true);
+  if (visible == NULL)
+  {
+    SDL_Log("MapGPUTransferBuffer failed: %s", SDL_GetError());
+    return false;
+  }
+  TRACE_BEGIN("cull");
+  Uint64 cullStartNS = SDL_GetTicksNS();
+  BoundingSpheres spheres = {
+      scene->spheres.centerX + slice->firstCube,
+      scene->spheres.centerY + slice->firstCube,
+      scene->spheres.centerZ + slice->firstCube,
+      scene->spheres.radius + slice->firstCube};
+  Uint32 levelStarts[MESH_LOD_MAX_LEVELS + 1] = {0};
+  if (scene->lods.levelCount > 1)
+  {
+    slice->visibleCount = CullByLevel(scene, slice, &spheres, visible, levelStarts);
+  }
+  else
+  {
+    slice->visibleCount = Frustum_CullSpheres(&scene->frustum, &spheres, slice->cubeCount, visible);
+    levelStarts[1] = slice->visibleCount;
+  }
+  slice->cullNS = SDL_GetTicksNS() - cullStartNS;
+  TRACE_END();
+  SDL_UnmapGPUTransferBuffer(scene->device, slice->visibleTransferBuffer);
+
+  if (slice->visibleCount > 0)
+  {
+    SDL_GPUCopyPass *copyPass = SDL_BeginGPUCopyPass(cmdbuf);
+    SDL_UploadToGPUBuffer(
+        copyPass,
+        &(SDL_GPUTransferBufferLocation){.transfer_buffer = slice->visibleTransferBuffer, .offset = 0},
+        &(SDL_GPUBufferRegion){.buffer = slice->visibleBuffer, .offset = 0, .size = sizeof(Uint32) * slice->visibleCount},
+        true);
+    SDL_EndGPUCopyPass(copyPass);
+  }
+
+  // The first slice clears, the others draw on top. Nothing cycles: the slices are recorded at the same time,
+  // a texture cycled by one of them could otherwise be seen before or after the cycle by the others.
+  SDL_GPUColorTargetInfo colorTargetInfo = {0};
+  colorTargetInfo.texture = scene->colorTexture;
+  colorTargetInfo.clear_color = (SDL_FColor){0.0f, 0.0f, 0.0f, 1.0f};
+  colorTargetInfo.load_op = sliceIndex == 0 ? SDL_GPU_LOADOP_CLEAR : SDL_GPU_LOADOP_LOAD;
+  colorTargetInfo.store_op = SDL_GPU_STOREOP_STORE;
+
+  SDL_GPUDepthStencilTargetInfo depthStencilTargetInfo = {0};
+  depthStencilTargetInfo.texture = scene->depthTexture;
+  depthStencilTargetInfo.clear_depth = 1;
+  depthStencilTargetInfo.load_op = sliceIndex == 0 ? SDL_GPU_LOADOP_CLEAR : SDL_GPU_LOADOP_LOAD;
+  depthStencilTargetInfo.store_op = sliceIndex + 1 < sliceCount ? SDL_GPU_STOREOP_STORE : SDL_GPU_STOREOP_DONT_CARE;
+  depthStencilTargetInfo.stencil_load_op = SDL_GPU_LOADOP_DONT_CARE;
+  depthStencilTargetInfo.stencil_store_op = SDL_GPU_STOREOP_DONT_CARE;
+
+  SDL_GPURenderPass *renderPass = SDL_BeginGPURenderPass(cmdbuf, &colorTargetInfo, 1, &depthStencilTargetInfo);
+  slice->drawCount = 0;
+  slice->triangleCount = 0;
+  if (slice->visibleCount > 0)
+  {
+    SDL_BindGPUGraphicsPipeline(renderPass, scene->pipeline);
+    MeshPool_Bind(scene->meshes, renderPass);
+    SDL_BindGPUVertexStorageBuffers(renderPass, 0, (SDL_GPUBuffer *[]){scene->instanceBuffer, slice->visibleBuffer}, 2);
+    for (Uint32 level = 0; level < scene->lods.levelCount; level += 1)
+    {
+      const MeshLod *lod = &scene->lods.levels[level];
+      Uint32 levelCount = levelStarts[level + 1] - levelStarts[level];
+      Uint32 cubesPerDraw = scene->cubesPerDraw > 0 ? scene->cubesPerDraw : levelCount;
+      for (Uint32 first = 0; first < levelCount; first += cubesPerDraw)
+      {
+        DrawUniforms uniforms = scene->uniforms;
+        uniforms.visibleOffset = levelStarts[level] + first;
+        uniforms.instanceOffset = slice->firstCube;
+        Uint32 instanceCount = SDL_min(cubesPerDraw, levelCount - first);
+        SDL_PushGPUVertexUniformData(cmdbuf, 0, &uniforms, sizeof(uniforms));
+        SDL_DrawGPUIndexedPrimitives(renderPass, lod->indexCount, instanceCount, scene->mesh.firstIndex + lod->firstIndex, scene->mesh.vertexOffset, 0);
+        slice->drawCount += 1;
+        slice->triangleCount += (Uint64)instanceCount * lod->indexCount / 3;
+      }
+    }
+  }
+  SDL_EndGPURenderPass(renderPass);
+  return true;
+}
+
+// A cube with ROCK_DETAIL quads per edge of each face, its vertices welded and pushed out onto a bumpy sphere of radius about 0.5
+// so the unit cube's scales still fit. Counter-clockwise from the outside. Returns the largest radius, 0 if out of memory.
+static float CreateRock(PositionColorVertex *vertices, Uint32 *indices)
+{
+  // Every face's corners and edges meet the other faces' on the points of a (ROCK_DETAIL + 1)^3 lattice
+  const Uint32 side = ROCK_DETAIL + 1;
+  Uint32 *lattice = SDL_malloc(sizeof(Uint32) * side * side * side);
+  if (lattice == NULL)
+  {
+    return 0.0f;
+  }
+  SDL_memset(lattice, 0xFF, sizeof(Uint32) * side * side * side);
+
+  // Normal, then u and v with cross(u, v) = normal
+  static const int faces[6][3][3] = {
+      {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}},
+      {{-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+      {{0, 1, 0}, {0, 0, 1}, {1, 0, 0}},
+      {{0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
+      {{0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
+      {{0, 0, -1}, {0, 1, 0}, {1, 0, 0}}};
+  const int half = ROCK_DETAIL / 2;
+  Uint32 vertexCount = 0;
+  Uint32 indexCount = 0;
+  float maxRadius = 0.0f;
+  Uint32 corners[ROCK_DETAIL + 1][ROCK_DETAIL + 1];
+  for (int face = 0; face < 6; face += 1)
+  {
+    const int *normal = faces[face][0];
+    const int *u = faces[face][1];
+    const int *v = faces[face][2];
+    for (int t = 0; t <= ROCK_DETAIL; t += 1)
+    {
+      for (int s = 0; s <= ROCK_DETAIL; s += 1)
+      {
+        int p[3];
+        for (int axis = 0; axis < 3; axis += 1)
+        {
+          p[axis] = normal[axis] * half + u[axis] * (s - half) + v[axis] * (t - half);
+        }
+        Uint32 *slot = &lattice[((p[2] + half) * side + p[1] + half) * side + p[0] + half];
+        if (*slot == SDL_MAX_UINT32)
+        {
+          float length = SDL_sqrtf((float)(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]));
+          float x = p[0] / length, y = p[1] / length, z = p[2] / length;
+          float radius = 0.5f * (1.0f + 0.12f * SDL_sinf(5.0f * x + 1.0f) * SDL_sinf(4.0f * y + 2.0f) * SDL_sinf(6.0f * z));
+          maxRadius = SDL_max(maxRadius, radius);
+          vertices[vertexCount] = (PositionColorVertex){
+              x * radius, y * radius, z * radius,
+              (Uint8)(127.5f + x * 127.0f), (Uint8)(127.5f + y * 127.0f), (Uint8)(127.5f + z * 127.0f), 255};
+          *slot = vertexCount;
+          vertexCount += 1;
+        }
+        corners[t][s] = *slot;
+      }
+    }
+    for (int t = 0; t < ROCK_DETAIL; t += 1)
+    {
+      for (int s = 0; s < ROCK_DETAIL; s += 1)
+      {
+        Uint32 quad[6] = {
+            corners[t][s], corners[t][s + 1], corners[t + 1][s + 1],
+            corners[t][s], corners[t + 1][s + 1], corners[t + 1][s]};
+        SDL_memcpy(indices + indexCount, quad, sizeof(quad));
+        indexCount += 6;
+      }
+    }
+  }
+  SDL_free(lattice);
+  return maxRadius;
+}
+
+// 1, 2, 4, ... and finally maxThreads itself, 0 once maxThreads was measured
+static Uint32 NextScalingThreadCount(Uint32 threadCount, Uint32 maxThreads)
+{
+  if (threadCount >= maxThreads)
+  {
+    return 0;
+  }
+  return SDL_min(threadCount * 2, maxThreads);
+}
+
+int main(int argc, char *argv[])
+{
+  FrameTargetOptions options;
+  Uint32 cubeCount = DEFAULT_CUBE_COUNT;
+  bool gpuCull = false;
+  Uint32 threadCount = 1;
+  Uint32 cubesPerDraw = 0;
+  bool recordScaling = false;
+  bool lod = false;
+  FrameTargetArg extraArgs[] = {
+      {.name = "--cubes", .valueName = "N", .value = &cubeCount},
+      {.name = "--gpu-cull", .flag = &gpuCull},
+      {.name = "--record-threads", .valueName = "N", .value = &threadCount},
+      {.name = "--cubes-per-draw", .valueName = "N", .value = &cubesPerDraw},
+      {.name = "--record-scaling", .flag = &recordScaling},
+      {.name = "--lod", .flag = &lod}};
+  if (!FrameTarget_ParseArgsEx(argc, argv, "many_cubes", &options, extraArgs, SDL_arraysize(extraArgs)))
+  {
+    return 1;
+  }
+  if (cubeCount == 0)
+  {
+    SDL_Log("--cubes needs at least one cube");
+    return 1;
+  }
+  if (gpuCull && cubeCount > CULL_GROUP_SIZE * MAX_CULL_GROUPS)
+  {
+    SDL_Log("--gpu-cull handles up to %u cubes", CULL_GROUP_SIZE * MAX_CULL_GROUPS);
+    return 1;
+  }
+  if (gpuCull && (threadCount > 1 || recordScaling))
+  {
+    SDL_Log("--gpu-cull records on one thread, --record-threads and --record-scaling only apply to CPU culling");
+    return 1;
+  }
+  if (gpuCull && lod)
+  {
+    SDL_Log("--lod picks the levels while culling on the CPU, it can't be combined with --gpu-cull");
+    return 1;
+  }
+  threadCount = recordScaling ? 1 : SDL_max(threadCount, 1);
+
+  if (SDL_Init(FrameTarget_GetInitFlags(&options)) == false)
+  {
+    SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
+    return 1;
+  }
+  context.Device = SDL_CreateGPUDevice(
+      SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL,
+      false,
+      options.driver);
+
+  if (context.Device == NULL)
+  {
+    SDL_Log("GPUCreateDevice failed");
+    return -1;
+  }
+
+  context.Target = FrameTarget_Create(context.Device, "Many Cubes", 1280, 720, 0, &options);
+  if (context.Target == NULL)
+  {
+    return -1;
+  }
+  context.Window = FrameTarget_GetWindow(context.Target);
+
+  context.Pipelines = PipelineRegistry_Create(context.Device);
+  if (context.Pipelines == NULL)
+  {
+    SDL_Log("Failed to create pipeline registry!");
+    return -1;
+  }
+
+  Uint64 pipelineHash;
+  {
+    // Instances and the visible list are storage buffers in set 0, the view-projection is the one uniform
+    SDL_GPUShader *vertexShader = LoadShader(context.Device, "ManyCubes.vert", 0, 1, 2, 0);
+    if (vertexShader == NULL)
+    {
+      SDL_Log("Failed to create 'ManyCubes' vertex shader!");
+      return -1;
+    }
+
+    SDL_GPUShader *fragmentShader = LoadShader(context.Device, "ManyCubes.frag", 0, 0, 0, 0);
+    if (fragmentShader == NULL)
+    {
+      SDL_Log("Failed to create 'ManyCubes' fragment shader!");
+      return -1;
+    }
+
+    SDL_GPUGraphicsPipelineCreateInfo pipelineCreateInfo = {
+        .target_info = {
+            .num_color_targets = 1,
+            .color_target_descriptions = (SDL_GPUColorTargetDescription[]){{.format = FrameTarget_GetFormat(context.Target)}},
+            .has_depth_stencil_target = true,
+            .depth_stencil_format = SDL_GPU_TEXTUREFORMAT_D16_UNORM},
+        .depth_stencil_state = (SDL_GPUDepthStencilState){
+            .enable_depth_test = true,
+            .enable_depth_write = true,
+            .compare_op = SDL_GPU_COMPAREOP_LESS},
+        .rasterizer_state = (SDL_GPURasterizerState){
+            .cull_mode = SDL_GPU_CULLMODE_NONE,
+            .fill_mode = SDL_GPU_FILLMODE_FILL,
+            .front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE},
+        .vertex_input_state = (SDL_GPUVertexInputState){
+            .num_vertex_buffers = 1,
+            .vertex_buffer_descriptions = (SDL_GPUVertexBufferDescription[]){{
+                .slot = 0,
+                .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+                .instance_step_rate = 0,
+                .pitch = sizeof(PositionColorVertex)}},
+            .num_vertex_attributes = 2,
+            .vertex_attributes = (SDL_GPUVertexAttribute[]){
+                {.buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, .location = 0, .offset = 0},
+                {.buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM, .location = 1, .offset = sizeof(float) * 3}}},
+        .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+        .vertex_shader = vertexShader,
+        .fragment_shader = fragmentShader};
+
+    // Built on a worker thread while the rock is simplified and the buffers are filled
+    pipelineHash = PipelineRegistry_Hash(&pipelineCreateInfo);
+    if (!PipelineRegistry_Prewarm(context.Pipelines, &pipelineCreateInfo, 1, 1))
+    {
+      SDL_Log("Failed to start building the pipeline!");
+      return -1;
+    }
+  }
+
+  // The cube, or with --lod the rock and its levels one after the other in one mesh pool allocation
+  Uint32 vertexCount = 24;
+  Uint32 indexCount = 36;
+  scene.lods = (MeshLodChain){.levels = {{.firstIndex = 0, .indexCount = 36}}, .levelCount = 1};
+  // Half the diagonal of the unit cube
+  scene.meshRadius = 0.8660254f;
+  PositionColorVertex *rockVertices = NULL;
+  Uint16 *rockIndices = NULL;
+  if (lod)
+  {
+    rockVertices = SDL_malloc(sizeof(PositionColorVertex) * ROCK_VERTEX_COUNT);
+    Uint32 *indices = SDL_malloc(sizeof(Uint32) * ROCK_INDEX_COUNT * (MESH_LOD_MAX_LEVELS + 1));
+    if (rockVertices == NULL || indices == NULL)
+    {
+      SDL_Log("Failed to allocate the rock!");
+      return -1;
+    }
+    scene.meshRadius = CreateRock(rockVertices, indices);
+    Uint64 simplifyStartNS = SDL_GetTicksNS();
+    indexCount = 0;
+    if (scene.meshRadius > 0.0f)
+    {
+      indexCount = MeshSimplify_BuildLods(
+          indices + ROCK_INDEX_COUNT,
+          indices,
+          ROCK_INDEX_COUNT,
+          &rockVertices[0].x,
+          sizeof(PositionColorVertex),
+          ROCK_VERTEX_COUNT,
+          MESH_LOD_MAX_LEVELS,
+          &scene.lods);
+    }
+    rockIndices = SDL_malloc(sizeof(Uint16) * SDL_max(indexCount, 1));
+    if (indexCount == 0 || rockIndices == NULL)
+    {
+      SDL_Log("Failed to build the levels of the rock!");
+      return -1;
+    }
+    for (Uint32 i = 0; i < indexCount; i += 1)
+    {
+      rockIndices[i] = (Uint16)indices[ROCK_INDEX_COUNT + i];
+    }
+    SDL_free(indices);
+    vertexCount = ROCK_VERTEX_COUNT;
+    SDL_Log("Built %u levels of the rock in %.1f ms", scene.lods.levelCount, (SDL_GetTicksNS() - simplifyStartNS) / 1e6);
+    for (Uint32 level = 0; level < scene.lods.levelCount; level += 1)
+    {
+      SDL_Log("  level %u: %5u triangles, error %.5f", level, scene.lods.levels[level].indexCount / 3, scene.lods.levels[level].error);
+    }
+  }
+
+  // Only used once, for the mesh and the instances
+  Uint32 instanceBytes = sizeof(CubeInstance) * cubeCount;
+  Uint32 meshBytes = sizeof(PositionColorVertex) * vertexCount + sizeof(Uint16) * indexCount;
+  context.Uploads = UploadRing_Create(context.Device, instanceBytes + meshBytes + 64 * 1024, 1);
+  if (context.Uploads == NULL)
+  {
+    SDL_Log("Failed to create upload ring!");
+    return -1;
+  }
+
+  SDL_GPUComputePipeline *CullPipeline = NULL;
+  if (gpuCull)
+  {
+    CullPipeline = LoadComputePipeline(
+        context.Device,
+        "CullInstances.comp",
+        &(SDL_GPUComputePipelineCreateInfo){
+            .num_readonly_storage_buffers = 1,
+            .num_readwrite_storage_buffers = 2,
+            .num_uniform_buffers = 1,
+            .threadcount_x = CULL_GROUP_SIZE,
+            .threadcount_y = 1,
+            .threadcount_z = 1});
+    if (CullPipeline == NULL)
+    {
+      SDL_Log("Failed to create the 'CullInstances' compute pipeline!");
+      return -1;
+    }
+  }
+
+  // The cubes are drawn into these and copied to the swapchain, which only the main command buffer can touch
+  int width, height;
+  FrameTarget_GetSize(context.Target, &width, &height);
+  SDL_GPUTexture *ColorTexture = SDL_CreateGPUTexture(
+      context.Device,
+      &(SDL_GPUTextureCreateInfo){
+          .type = SDL_GPU_TEXTURETYPE_2D,
+          .width = width,
+          .height = height,
+          .layer_count_or_depth = 1,
+          .num_levels = 1,
+          .sample_count = SDL_GPU_SAMPLECOUNT_1,
+          .format = FrameTarget_GetFormat(context.Target),
+          .usage = SDL_GPU_TEXTUREUSAGE_SAMPLER | SDL_GPU_TEXTUREUSAGE_COLOR_TARGET});
+  SDL_GPUTexture *DepthTexture = SDL_CreateGPUTexture(
+      context.Device,
+      &(SDL_GPUTextureCreateInfo){
+          .type = SDL_GPU_TEXTURETYPE_2D,
+          .width = width,
+          .height = height,
+          .layer_count_or_depth = 1,
+          .num_levels = 1,
+          .sample_count = SDL_GPU_SAMPLECOUNT_1,
+          .format = SDL_GPU_TEXTUREFORMAT_D16_UNORM,
+          .usage = SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET});
+
+  MeshPool *Meshes = MeshPool_Create(context.Device, sizeof(PositionColorVertex), vertexCount, SDL_GPU_INDEXELEMENTSIZE_16BIT, indexCount);
+  MeshAllocation Mesh;
+  if (Meshes == NULL || !MeshPool_Allocate(Meshes, vertexCount, indexCount, &Mesh))
+  {
+    SDL_Log("Failed to create the mesh pool!");
+    return -1;
+  }
+  SDL_GPUBuffer *InstanceBuffer = SDL_CreateGPUBuffer(
+      context.Device,
+      &(SDL_GPUBufferCreateInfo){
+          .usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ,
+          .size = instanceBytes});
+  if (ColorTexture == NULL || DepthTexture == NULL || InstanceBuffer == NULL)
+  {
+    SDL_Log("Failed to create the GPU resources: %s", SDL_GetError());
+    return -1;
+  }
+
+  // GPU culling: the compute shader appends the visible cubes to VisibleBuffer and counts them into IndirectBuffer,
+  // which is reset from IndirectResetTransferBuffer every frame. CPU culling uses the buffers of the slices instead.
+  SDL_GPUBuffer *VisibleBuffer = NULL;
+  SDL_GPUBuffer *IndirectBuffer = NULL;
+  SDL_GPUTransferBuffer *IndirectResetTransferBuffer = NULL;
+  if (gpuCull)
+  {
+    VisibleBuffer = SDL_CreateGPUBuffer(
+        context.Device,
+        &(SDL_GPUBufferCreateInfo){
+            .usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE,
+            .size = sizeof(Uint32) * cubeCount});
+    IndirectBuffer = SDL_CreateGPUBuffer(
+        context.Device,
+        &(SDL_GPUBufferCreateInfo){
+            .usage = SDL_GPU_BUFFERUSAGE_INDIRECT | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE,
+            .size = sizeof(SDL_GPUIndexedIndirectDrawCommand)});
+    IndirectResetTransferBuffer = SDL_CreateGPUTransferBuffer(
+        context.Device,
+        &(SDL_GPUTransferBufferCreateInfo){
+            .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+            .size = sizeof(SDL_GPUIndexedIndirectDrawCommand)});
+    if (VisibleBuffer == NULL || IndirectBuffer == NULL || IndirectResetTransferBuffer == NULL)
+    {
+      SDL_Log("Failed to create the indirect buffers: %s", SDL_GetError());
+      return -1;
+    }
+    SDL_GPUIndexedIndirectDrawCommand *resetData = SDL_MapGPUTransferBuffer(context.Device, IndirectResetTransferBuffer, false);
+    if (resetData == NULL)
+    {
+      SDL_Log("MapGPUTransferBuffer failed: %s", SDL_GetError());
+      return -1;
+    }
+    *resetData = (SDL_GPUIndexedIndirectDrawCommand){.num_indices = 36, .num_instances = 0, .first_index = Mesh.firstIndex, .vertex_offset = Mesh.vertexOffset};
+    SDL_UnmapGPUTransferBuffer(context.Device, IndirectResetTransferBuffer);
+  }
+
+  // The cubes fill a grid with gridSize cubes per side, centered on the origin, each with its own scale
+  Uint32 gridSize = 1;
+  while (gridSize * gridSize * gridSize < cubeCount)
+  {
+    gridSize += 1;
+  }
+  float gridExtent = gridSize * CUBE_SPACING;
+  CubeBounds bounds = {
+      .centerX = SDL_malloc(sizeof(float) * cubeCount),
+      .centerY = SDL_malloc(sizeof(float) * cubeCount),
+      .centerZ = SDL_malloc(sizeof(float) * cubeCount),
+      .radius = SDL_malloc(sizeof(float) * cubeCount)};
+  if (bounds.centerX == NULL || bounds.centerY == NULL || bounds.centerZ == NULL || bounds.radius == NULL)
+  {
+    SDL_Log("Failed to allocate the cube bounds!");
+    return -1;
+  }
+
+  {
+    UploadRing_BeginFrame(context.Uploads);
+    PositionColorVertex *transferData = UploadRing_AllocateBufferUpload(context.Uploads, sizeof(PositionColorVertex) * vertexCount, MeshPool_GetVertexBuffer(Meshes), Mesh.vertexByteOffset);
+    CubeInstance *instanceData = UploadRing_AllocateBufferUpload(context.Uploads, instanceBytes, InstanceBuffer, 0);
+    if (transferData == NULL || instanceData == NULL)
+    {
+      SDL_Log("Failed to allocate uploads!");
+      return -1;
+    }
+
+    if (lod)
+    {
+      SDL_memcpy(transferData, rockVertices, sizeof(PositionColorVertex) * vertexCount);
+      if (!UploadRing_UploadToBuffer(context.Uploads, rockIndices, sizeof(Uint16) * indexCount, MeshPool_GetIndexBuffer(Meshes), Mesh.indexByteOffset))
+      {
+        SDL_Log("Failed to allocate the index upload!");
+        return -1;
+      }
+      SDL_free(rockVertices);
+      SDL_free(rockIndices);
+    }
+    else
+    {
+      // A unit cube, the instances scale it
+      transferData[0] = (PositionColorVertex){-0.5f, -0.5f, -0.5f, 255, 0, 0, 255};
+      transferData[1] = (PositionColorVertex){0.5f, -0.5f, -0.5f, 255, 0, 0, 255};
+      transferData[2] = (PositionColorVertex){0.5f, 0.5f, -0.5f, 255, 0, 0, 255};
+      transferData[3] = (PositionColorVertex){-0.5f, 0.5f, -0.5f, 255, 0, 0, 255};
+
+      transferData[4] = (PositionColorVertex){-0.5f, -0.5f, 0.5f, 255, 255, 0, 255};
+      transferData[5] = (PositionColorVertex){0.5f, -0.5f, 0.5f, 255, 255, 0, 255};
+      transferData[6] = (PositionColorVertex){0.5f, 0.5f, 0.5f, 255, 255, 0, 255};
+      transferData[7] = (PositionColorVertex){-0.5f, 0.5f, 0.5f, 255, 255, 0, 255};
+
+      transferData[8] = (PositionColorVertex){-0.5f, -0.5f, -0.5f, 255, 0, 255, 255};
+      transferData[9] = (PositionColorVertex){-0.5f, 0.5f, -0.5f, 255, 0, 255, 255};
+      transferData[10] = (PositionColorVertex){-0.5f, 0.5f, 0.5f, 255, 0, 255, 255};
+      transferData[11] = (PositionColorVertex){-0.5f, -0.5f, 0.5f, 255, 0, 255, 255};
+
+      transferData[12] = (PositionColorVertex){0.5f, -0.5f, -0.5f, 0, 255, 0, 255};
+      transferData[13] = (PositionColorVertex){0.5f, 0.5f, -0.5f, 0, 255, 0, 255};
+      transferData[14] = (PositionColorVertex){0.5f, 0.5f, 0.5f, 0, 255, 0, 255};
+      transferData[15] = (PositionColorVertex){0.5f, -0.5f, 0.5f, 0, 255, 0, 255};
+
+      transferData[16] = (PositionColorVertex){-0.5f, -0.5f, -0.5f, 0, 255, 255, 255};
+      transferData[17] = (PositionColorVertex){-0.5f, -0.5f, 0.5f, 0, 255, 255, 255};
+      transferData[18] = (PositionColorVertex){0.5f, -0.5f, 0.5f, 0, 255, 255, 255};
+      transferData[19] = (PositionColorVertex){0.5f, -0.5f, -0.5f, 0, 255, 255, 255};
+
+      transferData[20] = (PositionColorVertex){-0.5f, 0.5f, -0.5f, 0, 0, 255, 255};
+      transferData[21] = (PositionColorVertex){-0.5f, 0.5f, 0.5f, 0, 0, 255, 255};
+      transferData[22] = (PositionColorVertex){0.5f, 0.5f, 0.5f, 0, 0, 255, 255};
+      transferData[23] = (PositionColorVertex){0.5f, 0.5f, -0.5f, 0, 0, 255, 255};
+
+      Uint16 indices[] = {
+          0, 1, 2, 0, 2, 3,
+          4, 5, 6, 4, 6, 7,
+          8, 9, 10, 8, 10, 11,
+          12, 13, 14, 12, 14, 15,
+          16, 17, 18, 16, 18, 19,
+          20, 21, 22, 20, 22, 23};
+      if (!UploadRing_UploadToBuffer(context.Uploads, indices, sizeof(indices), MeshPool_GetIndexBuffer(Meshes), Mesh.indexByteOffset))
+      {
+        SDL_Log("Failed to allocate the index upload!");
+        return -1;
+      }
+    }
+
+    srand(1);
+    for (Uint32 i = 0; i < cubeCount; i += 1)
+    {
+      float x = (i % gridSize + 0.5f) * CUBE_SPACING - gridExtent / 2;
+      float y = (i / gridSize % gridSize + 0.5f) * CUBE_SPACING - gridExtent / 2;
+      float z = (i / (gridSize * gridSize) + 0.5f) * CUBE_SPACING - gridExtent / 2;
+      float scale = 1.0f + 2.0f * rand() / (float)RAND_MAX;
+      instanceData[i] = (CubeInstance){x, y, z, scale};
+      bounds.centerX[i] = x;
+      bounds.centerY[i] = y;
+      bounds.centerZ[i] = z;
+      bounds.radius[i] = scale * scene.meshRadius;
+    }
+
+    SDL_GPUCommandBuffer *uploadCmdBuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    UploadRing_Submit(context.Uploads, uploadCmdBuf);
+  }
+
+  PipelineRegistry_WaitPrewarm(context.Pipelines);
+  context.Pipeline = PipelineRegistry_Find(context.Pipelines, pipelineHash);
+  if (context.Pipeline == NULL)
+  {
+    SDL_Log("Failed to create pipeline!");
+    return -1;
+  }
+
+  scene.device = context.Device;
+  scene.pipeline = context.Pipeline;
+  scene.meshes = Meshes;
+  scene.mesh = Mesh;
+  scene.instanceBuffer = InstanceBuffer;
+  scene.colorTexture = ColorTexture;
+  scene.depthTexture = DepthTexture;
+  scene.spheres = (BoundingSpheres){bounds.centerX, bounds.centerY, bounds.centerZ, bounds.radius};
+  scene.cubeCount = cubeCount;
+  scene.cubesPerDraw = cubesPerDraw;
+  scene.projectionScale = MeshLod_GetProjectionScale(FIELD_OF_VIEW, (float)height);
+
+  CommandRecorder *recorder = NULL;
+  if (gpuCull)
+  {
+    SDL_Log("Culling %u cubes in a compute shader", cubeCount);
+  }
+  else
+  {
+    recorder = CommandRecorder_Create(context.Device, threadCount);
+    if (recorder == NULL || !CreateSlices(CommandRecorder_GetThreadCount(recorder)))
+    {
+      SDL_Log("Failed to create the command recorder!");
+      return -1;
+    }
+    SDL_Log("Culling %u cubes with the %s kernels, recording on %u threads", cubeCount, LinearAlgebra_GetPathName(LinearAlgebra_GetPath()), scene.sliceCount);
+  }
+
+  SDL_Event event;
+  int quit = 0;
+  float rotationSpeed = 0.2f;
+  float rotationAngle = 0.0f;
+  Uint64 lastTime = SDL_GetTicksNS();
+  Uint64 cullFrames = 0;
+  Uint64 cullTotalNS = 0;
+  Uint64 visibleTotal = 0;
+  Uint64 drawTotal = 0;
+  Uint64 triangleTotal = 0;
+  Uint64 recordTotalNS = 0;
+  Uint64 slowestSliceTotalNS = 0;
+  double singleThreadRecordMS = 0;
+  Uint32 maxScalingThreads = SDL_max(SDL_GetNumLogicalCPUCores(), 1);
+
+  while (!quit && !FrameTarget_IsDone(context.Target))
+  {
+    if (recordScaling && cullFrames == SCALING_FRAMES_PER_STEP)
+    {
+      double recordMS = recordTotalNS / 1e6 / cullFrames;
+      if (scene.sliceCount == 1)
+      {
+        singleThreadRecordMS = recordMS;
+      }
+      SDL_Log("%3u threads: record %.3f ms per frame, slowest slice %.3f ms, %.2fx the single thread speed",
+              scene.sliceCount, recordMS, slowestSliceTotalNS / 1e6 / cullFrames, singleThreadRecordMS / recordMS);
+      threadCount = NextScalingThreadCount(scene.sliceCount, maxScalingThreads);
+      if (threadCount == 0)
+      {
+        break;
+      }
+      // The slices' buffers may still be in use by frames in flight
+      SDL_WaitForGPUIdle(context.Device);
+      DestroySlices();
+      CommandRecorder_Destroy(recorder);
+      recorder = CommandRecorder_Create(context.Device, threadCount);
+      if (recorder == NULL || !CreateSlices(CommandRecorder_GetThreadCount(recorder)))
+      {
+        SDL_Log("Failed to create the command recorder!");
+        return -1;
+      }
+      cullFrames = 0;
+      cullTotalNS = 0;
+      visibleTotal = 0;
+      drawTotal = 0;
+      triangleTotal = 0;
+      recordTotalNS = 0;
+      slowestSliceTotalNS = 0;
+    }
+
+    Uint64 currentTime = SDL_GetTicksNS();
+    float deltaTime = (currentTime - lastTime) / 1e9f;
+    lastTime = currentTime;
+
+    TRACE_BEGIN("poll events");
+    while (SDL_PollEvent(&event))
+    {
+      switch (event.type)
+      {
+      case SDL_EVENT_QUIT:
+        quit = true;
+        break;
+      }
+    }
+    TRACE_END();
+
+    TRACE_BEGIN("acquire command buffer");
+    SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    TRACE_END();
+    if (cmdbuf == NULL)
+    {
+      SDL_Log("AcquireGPUCommandBuffer failed: %s", SDL_GetError());
+      return -1;
+    }
+
+    SDL_GPUTexture *swapchainTexture;
+    if (!FrameTarget_Acquire(context.Target, cmdbuf, &swapchainTexture))
+    {
+      SDL_Log("WaitAndAcquireGPUSwapchainTexture failed: %s", SDL_GetError());
+      return -1;
+    }
+    if (swapchainTexture == NULL)
+    {
+      FrameTarget_Submit(context.Target, cmdbuf);
+      continue;
+    }
+
+    // The camera circles inside the grid, so most cubes are behind it or off to the sides
+    rotationAngle += rotationSpeed * deltaTime;
+    float orbitRadius = gridExtent * 0.25f;
+    Vector3 cameraPosition = {SDL_cosf(rotationAngle) * orbitRadius, gridExtent * 0.1f, SDL_sinf(rotationAngle) * orbitRadius};
+    Vector3 cameraTarget = {SDL_cosf(rotationAngle + 0.5f) * orbitRadius * 2.0f, 0.0f, SDL_sinf(rotationAngle + 0.5f) * orbitRadius * 2.0f};
+    Matrix4x4 proj = Matrix4x4_CreatePerspectiveFieldOfView(FIELD_OF_VIEW, width / (float)height, 0.5f, gridExtent);
+    Matrix4x4 view = Matrix4x4_CreateLookAt(cameraPosition, cameraTarget, (Vector3){0, 1, 0});
+    Matrix4x4 viewproj = Matrix4x4_Multiply(view, proj);
+
+    scene.uniforms = (DrawUniforms){.viewProjection = viewproj};
+    scene.frustum = Frustum_FromMatrix(&viewproj);
+    scene.cameraPosition = cameraPosition;
+
+    if (gpuCull)
+    {
+      TRACE_BEGIN("cull");
+      Uint64 cullStartNS = SDL_GetTicksNS();
+      // Cycling gives this frame its own copy of the arguments while earlier frames may still be drawing from theirs
+      SDL_GPUCopyPass *copyPass = SDL_BeginGPUCopyPass(cmdbuf);
+      SDL_UploadToGPUBuffer(
+          copyPass,
+          &(SDL_GPUTransferBufferLocation){.transfer_buffer = IndirectResetTransferBuffer, .offset = 0},
+          &(SDL_GPUBufferRegion){.buffer = IndirectBuffer, .offset = 0, .size = sizeof(SDL_GPUIndexedIndirectDrawCommand)},
+          true);
+      SDL_EndGPUCopyPass(copyPass);
+
+      CullUniforms cullUniforms = {.frustum = scene.frustum, .instanceCount = cubeCount};
+      SDL_PushGPUComputeUniformData(cmdbuf, 0, &cullUniforms, sizeof(cullUniforms));
+      SDL_GPUComputePass *computePass = SDL_BeginGPUComputePass(
+          cmdbuf,
+          NULL,
+          0,
+          (SDL_GPUStorageBufferReadWriteBinding[]){
+              {.buffer = VisibleBuffer, .cycle = true},
+              {.buffer = IndirectBuffer, .cycle = false}},
+          2);
+      SDL_BindGPUComputePipeline(computePass, CullPipeline);
+      SDL_BindGPUComputeStorageBuffers(computePass, 0, &InstanceBuffer, 1);
+      SDL_DispatchGPUCompute(computePass, (cubeCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+      SDL_EndGPUComputePass(computePass);
+      cullTotalNS += SDL_GetTicksNS() - cullStartNS;
+      cullFrames += 1;
+      TRACE_END();
+
+      TRACE_BEGIN("uniforms");
+      SDL_PushGPUVertexUniformData(cmdbuf, 0, &scene.uniforms, sizeof(scene.uniforms));
+      TRACE_END();
+
+      SDL_GPUColorTargetInfo colorTargetInfo = {0};
+      colorTargetInfo.texture = ColorTexture;
+      colorTargetInfo.cycle = true;
+      colorTargetInfo.clear_color = (SDL_FColor){0.0f, 0.0f, 0.0f, 1.0f};
+      colorTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
+      colorTargetInfo.store_op = SDL_GPU_STOREOP_STORE;
+
+      SDL_GPUDepthStencilTargetInfo depthStencilTargetInfo = {0};
+      depthStencilTargetInfo.texture = DepthTexture;
+      depthStencilTargetInfo.cycle = true;
+      depthStencilTargetInfo.clear_depth = 1;
+      depthStencilTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
+      depthStencilTargetInfo.store_op = SDL_GPU_STOREOP_DONT_CARE;
+      depthStencilTargetInfo.stencil_load_op = SDL_GPU_LOADOP_DONT_CARE;
+      depthStencilTargetInfo.stencil_store_op = SDL_GPU_STOREOP_DONT_CARE;
+
+      TRACE_BEGIN("render pass");
+      SDL_GPURenderPass *renderPass = SDL_BeginGPURenderPass(cmdbuf, &colorTargetInfo, 1, &depthStencilTargetInfo);
+      SDL_BindGPUGraphicsPipeline(renderPass, context.Pipeline);
+      MeshPool_Bind(Meshes, renderPass);
+      SDL_BindGPUVertexStorageBuffers(renderPass, 0, (SDL_GPUBuffer *[]){InstanceBuffer, VisibleBuffer}, 2);
+      SDL_DrawGPUIndexedPrimitivesIndirect(renderPass, IndirectBuffer, 0, 1);
+      SDL_EndGPURenderPass(renderPass);
+      TRACE_END();
+    }
+    else
+    {
+      // The slices are submitted in order while this function runs, all of them before cmdbuf
+      CommandRecorderFrameStats recordStats;
+      if (!CommandRecorder_Record(recorder, RecordSlice, &scene, &recordStats))
+      {
+        SDL_Log("Failed to record the cubes!");
+        return -1;
+      }
+      for (Uint32 i = 0; i < scene.sliceCount; i += 1)
+      {
+        cullTotalNS += scene.slices[i].cullNS;
+        visibleTotal += scene.slices[i].visibleCount;
+        drawTotal += scene.slices[i].drawCount;
+        triangleTotal += scene.slices[i].triangleCount;
+      }
+      recordTotalNS += recordStats.recordNS;
+      slowestSliceTotalNS += recordStats.slowestSliceNS;
+      cullFrames += 1;
+    }
+
+    SDL_BlitGPUTexture(
+        cmdbuf,
+        &(SDL_GPUBlitInfo){
+            .source = {.texture = ColorTexture, .w = width, .h = height},
+            .destination = {.texture = swapchainTexture, .w = width, .h = height},
+            .load_op = SDL_GPU_LOADOP_DONT_CARE,
+            .filter = SDL_GPU_FILTER_NEAREST});
+    FrameTarget_Submit(context.Target, cmdbuf);
+  }
+
+  if (cullFrames > 0 && gpuCull)
+  {
+    SDL_Log("Recording the GPU cull of %u cubes took %.3f ms of CPU per frame, the visible count never leaves the GPU",
+            cubeCount, cullTotalNS / 1e6 / cullFrames);
+  }
+  else if (cullFrames > 0 && !recordScaling)
+  {
+    double cullMS = cullTotalNS / 1e6 / cullFrames;
+    SDL_Log("Culled %u cubes in %.3f ms of CPU per frame (%.3f ms per 100k), %.1f%% visible on average",
+            cubeCount, cullMS, cullMS * 100000.0 / cubeCount, 100.0 * visibleTotal / cullFrames / cubeCount);
+    SDL_Log("Recorded %.0f draws per frame on %u threads in %.3f ms, slowest slice %.3f ms",
+            (double)drawTotal / cullFrames, scene.sliceCount, recordTotalNS / 1e6 / cullFrames, slowestSliceTotalNS / 1e6 / cullFrames);
+    if (lod)
+    {
+      double fullTriangles = (double)visibleTotal * (scene.lods.levels[0].indexCount / 3);
+      SDL_Log("Drew %.0f triangles per frame, %.1f%% of the %.0f the visible rocks have at full detail",
+              (double)triangleTotal / cullFrames, 100.0 * triangleTotal / SDL_max(fullTriangles, 1.0), fullTriangles / cullFrames);
+    }
+  }
+
+  // Cleanup
+  SDL_free(bounds.centerX);
+  SDL_free(bounds.centerY);
+  SDL_free(bounds.centerZ);
+  SDL_free(bounds.radius);
+  if (gpuCull)
+  {
+    SDL_ReleaseGPUTransferBuffer(context.Device, IndirectResetTransferBuffer);
+    SDL_ReleaseGPUBuffer(context.Device, IndirectBuffer);
+    SDL_ReleaseGPUBuffer(context.Device, VisibleBuffer);
+    SDL_ReleaseGPUComputePipeline(context.Device, CullPipeline);
+  }
+  else
+  {
+    CommandRecorder_Destroy(recorder);
+    DestroySlices();
+  }
+  SDL_ReleaseGPUBuffer(context.Device, InstanceBuffer);
+  MeshPool_Free(Meshes, &Mesh);
+  MeshPool_Destroy(Meshes);
+  SDL_ReleaseGPUTexture(context.Device, ColorTexture);
+  SDL_ReleaseGPUTexture(context.Device, DepthTexture);
+
+  UploadRing_Destroy(context.Uploads);
+  PipelineRegistry_LogStats(context.Pipelines);
+  PipelineRegistry_Destroy(context.Pipelines);
+  ReleaseShaderCache(context.Device);
+  FrameTarget_Destroy(context.Target);
+  SDL_DestroyGPUDevice(context.Device);
+}
@@ -0,0 +1,25 @@
+#version 450
+// Where each instance goes comes from the storage buffer instead of the instance index
+struct Instance
+{
+    vec2 Position;
+    float Scale;
+    uint Color; // RGBA8, red in the low byte
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer InstanceBuffer
+{
+    Instance Instances[];
+};
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec4 inColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    Instance instance = Instances[gl_InstanceIndex];
+    uvec4 color = (uvec4(instance.Color) >> uvec4(0, 8, 16, 24)) & 0xFFu;
+    outColor = inColor * (vec4(color) / 255.0);
+    gl_Position = vec4(inPosition.xy * instance.Scale + instance.Position, inPosition.z, 1.0);
+}
@@ -0,0 +1,32 @@
+// Where each instance goes comes from the storage buffer instead of the instance index
+struct Instance
+{
+    float2 Position;
+    float Scale;
+    uint Color; // RGBA8, red in the low byte
+};
+
+StructuredBuffer<Instance> Instances : register(t0, space0);
+
+struct Input
+{
+    float3 Position : TEXCOORD0;
+    float4 Color : TEXCOORD1;
+    uint InstanceIndex : SV_InstanceID;
+};
+
+struct Output
+{
+    float4 Color : TEXCOORD0;
+    float4 Position : SV_Position;
+};
+
+Output main(Input input)
+{
+    Instance instance = Instances[input.InstanceIndex];
+    uint4 color = (instance.Color >> uint4(0, 8, 16, 24)) & 0xFF;
+    Output output;
+    output.Color = input.Color * (float4(color) / 255.0f);
+    output.Position = float4(input.Position.xy * instance.Scale + instance.Position, input.Position.z, 1.0f);
+    return output;
+}
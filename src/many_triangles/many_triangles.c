@@ -3,18 +3,31 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "load.h"
+#include "pipeline_registry.h"
+#include "frame_target.h"
+#include "trace.h"
+#include "upload_ring.h"
+#include "vertex_format.h"
 typedef struct Context
 {
   SDL_GPUDevice *Device;
   SDL_Window *Window;
+  FrameTarget *Target;
   SDL_GPUGraphicsPipeline *Pipeline;
+  PipelineRegistry *Pipelines;
+  UploadRing *Uploads;
 } Context;
 
-typedef struct PositionColorVertex
+// Matches Instance in PositionColorStorageInstanced.glsl and its .vert.hlsl
+typedef struct TriangleInstance
 {
-  float x, y, z;
-  Uint8 r, g, b, a;
-} PositionColorVertex;
+  float x, y;
+  float scale;
+  Uint32 color; // RGBA8, red in the low byte
+} TriangleInstance;
+
+// Throughput is logged this often while running with --instances
+#define THROUGHPUT_LOG_INTERVAL_NS SDL_NS_PER_SECOND * 2
 
 float rand255()
 {
@@ -22,9 +35,27 @@ float rand255()
 };
 Context context = {0};
 
-int main()
+int main(int argc, char *argv[])
 {
-  if (SDL_Init(SDL_INIT_VIDEO) == false)
+  FrameTargetOptions options;
+  // 0 draws the 16 instances of the hardcoded 4x4 grid, otherwise the instances come from a storage buffer
+  Uint32 instanceCount = 0;
+  FrameTargetArg extraArgs[] = {
+      {.name = "--instances", .valueName = "N", .value = &instanceCount}};
+  if (!FrameTarget_ParseArgsEx(argc, argv, "many_triangles", &options, extraArgs, SDL_arraysize(extraArgs)))
+  {
+    return 1;
+  }
+  // The instance buffer and the upload ring holding it are sized in Uint32 bytes
+  if (instanceCount > (SDL_MAX_UINT32 - 64 * 1024) / sizeof(TriangleInstance))
+  {
+    SDL_Log("--instances %u is too many, at most %u fit in one buffer", instanceCount, (Uint32)((SDL_MAX_UINT32 - 64 * 1024) / sizeof(TriangleInstance)));
+    return 1;
+  }
+  bool useStorage = instanceCount > 0;
+  Uint32 instanceBytes = sizeof(TriangleInstance) * instanceCount;
+
+  if (SDL_Init(FrameTarget_GetInitFlags(&options)) == false)
   {
     SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
     return 1;
@@ -33,7 +64,7 @@ int main()
   context.Device = SDL_CreateGPUDevice(
       SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL,
       false,
-      NULL);
+      options.driver);
 
   if (context.Device == NULL)
   {
@@ -41,20 +72,31 @@ int main()
     return -1;
   }
 
-  context.Window = SDL_CreateWindow("Many Triangles", 640, 480, 0);
-  if (context.Window == NULL)
+  context.Target = FrameTarget_Create(context.Device, "Many Triangles", 640, 480, 0, &options);
+  if (context.Target == NULL)
   {
-    SDL_Log("CreateWindow failed: %s", SDL_GetError());
     return -1;
   }
+  context.Window = FrameTarget_GetWindow(context.Target);
 
-  if (!SDL_ClaimWindowForGPUDevice(context.Device, context.Window))
+  context.Pipelines = PipelineRegistry_Create(context.Device);
+  if (context.Pipelines == NULL)
   {
-    SDL_Log("GPUClaimWindow failed");
+    SDL_Log("Failed to create pipeline registry!");
     return -1;
   }
 
-  SDL_GPUShader *vertexShader = LoadShader(context.Device, "PositionColorInstanced.vert", 0, 0, 0, 0);
+  // Only used for the uploads before the first frame, so it has to hold every instance at once
+  context.Uploads = UploadRing_Create(context.Device, 64 * 1024 + instanceBytes, 1);
+  if (context.Uploads == NULL)
+  {
+    SDL_Log("Failed to create upload ring!");
+    return -1;
+  }
+
+  SDL_GPUShader *vertexShader = useStorage
+                                    ? LoadShader(context.Device, "PositionColorStorageInstanced.vert", 0, 0, 1, 0)
+                                    : LoadShader(context.Device, "PositionColorInstanced.vert", 0, 0, 0, 0);
   if (vertexShader == NULL)
   {
     SDL_Log("Failed to create vertex shader!");
@@ -75,7 +117,7 @@ int main()
 
           .color_target_descriptions = (SDL_GPUColorTargetDescription[]){{
 
-              .format = SDL_GetGPUSwapchainTextureFormat(context.Device, context.Window)
+              .format = FrameTarget_GetFormat(context.Target)
 
           }},
       },
@@ -124,16 +166,13 @@ int main()
       .vertex_shader = vertexShader,
       .fragment_shader = fragmentShader};
 
-  context.Pipeline = SDL_CreateGPUGraphicsPipeline(context.Device, &pipelineCreateInfo);
+  context.Pipeline = PipelineRegistry_Get(context.Pipelines, &pipelineCreateInfo);
   if (context.Pipeline == NULL)
   {
     SDL_Log("Failed to create pipeline!");
     return -1;
   }
 
-  SDL_ReleaseGPUShader(context.Device, vertexShader);
-  SDL_ReleaseGPUShader(context.Device, fragmentShader);
-
   // Create the vertex and index buffers
   SDL_GPUBuffer *VertexBuffer = SDL_CreateGPUBuffer(
       context.Device,
@@ -147,19 +186,38 @@ int main()
           .usage = SDL_GPU_BUFFERUSAGE_INDEX,
           .size = sizeof(Uint16) * 6});
 
-  // we will create a transfer buffer and write both the data that we want to transfer to the vertex & index buffers. We will just just an offset value.
-  //  Set the buffer data
-  SDL_GPUTransferBuffer *transferBuffer = SDL_CreateGPUTransferBuffer(
-      context.Device,
-      &(SDL_GPUTransferBufferCreateInfo){
-          .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-          .size = (sizeof(PositionColorVertex) * 9) + (sizeof(Uint16) * 6),
-      });
+  SDL_GPUBuffer *InstanceBuffer = NULL;
+  if (useStorage)
+  {
+    InstanceBuffer = SDL_CreateGPUBuffer(
+        context.Device,
+        &(SDL_GPUBufferCreateInfo){
+            .usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ,
+            .size = instanceBytes});
+    if (InstanceBuffer == NULL)
+    {
+      SDL_Log("Failed to create the instance buffer for %u instances: %s", instanceCount, SDL_GetError());
+      return -1;
+    }
+  }
 
-  PositionColorVertex *transferData = SDL_MapGPUTransferBuffer(
-      context.Device,
-      transferBuffer,
-      false);
+  // Both uploads come out of the same upload ring transfer buffer, the ring keeps track of the offsets
+  UploadRing_BeginFrame(context.Uploads);
+  PositionColorVertex *transferData = UploadRing_AllocateBufferUpload(
+      context.Uploads,
+      sizeof(PositionColorVertex) * 9,
+      VertexBuffer,
+      0);
+  Uint16 *indexData = UploadRing_AllocateBufferUpload(
+      context.Uploads,
+      sizeof(Uint16) * 6,
+      IndexBuffer,
+      0);
+  if (transferData == NULL || indexData == NULL)
+  {
+    SDL_Log("Failed to allocate uploads!");
+    return -1;
+  }
 
   transferData[0] = (PositionColorVertex){-1, -1, 0, 255, 0, 0, 255};
   transferData[1] = (PositionColorVertex){1, -1, 0, 0, 255, 0, 255};
@@ -173,49 +231,49 @@ int main()
   transferData[7] = (PositionColorVertex){1, -1, 0, 255, 255, 255, 255};
   transferData[8] = (PositionColorVertex){0, 1, 0, 255, 255, 255, 255};
 
-  Uint16 *indexData = (Uint16 *)&transferData[9];
   for (Uint16 i = 0; i < 6; i += 1)
   {
     indexData[i] = i;
   }
 
-  SDL_UnmapGPUTransferBuffer(context.Device, transferBuffer);
+  if (useStorage)
+  {
+    TriangleInstance *instanceData = UploadRing_AllocateBufferUpload(context.Uploads, instanceBytes, InstanceBuffer, 0);
+    if (instanceData == NULL)
+    {
+      SDL_Log("Failed to allocate the instance upload!");
+      return -1;
+    }
+    // One grid cell per instance across the whole screen, each with a random size and color
+    Uint32 columns = (Uint32)SDL_ceil(SDL_sqrt((double)instanceCount));
+    Uint32 rows = (instanceCount + columns - 1) / columns;
+    float cellWidth = 2.0f / columns;
+    float cellHeight = 2.0f / rows;
+    for (Uint32 i = 0; i < instanceCount; i += 1)
+    {
+      float scale = SDL_min(cellWidth, cellHeight) * (0.25f + rand255() / 255.0f * 0.25f);
+      Uint32 color = (Uint32)rand255() | (Uint32)rand255() << 8 | (Uint32)rand255() << 16 | 0xFF000000u;
+      instanceData[i] = (TriangleInstance){
+          .x = -1.0f + (i % columns + 0.5f) * cellWidth,
+          .y = -1.0f + (i / columns + 0.5f) * cellHeight,
+          .scale = scale,
+          .color = color};
+    }
+  }
 
   SDL_GPUCommandBuffer *uploadCmdBuf = SDL_AcquireGPUCommandBuffer(context.Device);
-  SDL_GPUCopyPass *copyPass = SDL_BeginGPUCopyPass(uploadCmdBuf);
-
-  SDL_UploadToGPUBuffer(
-      copyPass,
-      &(SDL_GPUTransferBufferLocation){
-          .transfer_buffer = transferBuffer,
-          .offset = 0},
-      &(SDL_GPUBufferRegion){
-          .buffer = VertexBuffer,
-          .offset = 0,
-          .size = sizeof(PositionColorVertex) * 9},
-      false);
-
-  SDL_UploadToGPUBuffer(
-      copyPass,
-      &(SDL_GPUTransferBufferLocation){
-          .transfer_buffer = transferBuffer,
-          // the offset that I was talking about
-          .offset = sizeof(PositionColorVertex) * 9},
-      &(SDL_GPUBufferRegion){
-          .buffer = IndexBuffer,
-          .offset = 0,
-          .size = sizeof(Uint16) * 6},
-      false);
-
-  SDL_EndGPUCopyPass(copyPass);
-  SDL_SubmitGPUCommandBuffer(uploadCmdBuf);
-  SDL_ReleaseGPUTransferBuffer(context.Device, transferBuffer);
+  UploadRing_Submit(context.Uploads, uploadCmdBuf);
 
   SDL_Event event;
   int quit = 0;
+  Uint64 startNS = SDL_GetTicksNS();
+  Uint64 lastLogNS = startNS;
+  Uint64 framesDrawn = 0;
+  Uint64 framesSinceLog = 0;
 
-  while (!quit)
+  while (!quit && !FrameTarget_IsDone(context.Target))
   {
+    TRACE_BEGIN("poll events");
     while (SDL_PollEvent(&event))
     {
       switch (event.type)
@@ -225,8 +283,11 @@ int main()
         break;
       }
     }
+    TRACE_END();
 
+    TRACE_BEGIN("acquire command buffer");
     SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    TRACE_END();
     if (cmdbuf == NULL)
     {
       SDL_Log("AcquireGPUCommandBuffer failed: %s", SDL_GetError());
@@ -234,14 +295,14 @@ int main()
     }
 
     SDL_GPUTexture *swapchainTexture;
-    if (!SDL_WaitAndAcquireGPUSwapchainTexture(cmdbuf, context.Window, &swapchainTexture, NULL, NULL))
+    if (!FrameTarget_Acquire(context.Target, cmdbuf, &swapchainTexture))
     {
       SDL_Log("WaitAndAcquireGPUSwapchainTexture failed: %s", SDL_GetError());
       return -1;
     }
     if (swapchainTexture == NULL)
     {
-      SDL_SubmitGPUCommandBuffer(cmdbuf);
+      FrameTarget_Submit(context.Target, cmdbuf);
       continue;
     }
     SDL_GPUColorTargetInfo colorTargetInfo = {0};
@@ -250,6 +311,7 @@ int main()
     colorTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
     colorTargetInfo.store_op = SDL_GPU_STOREOP_STORE;
 
+    TRACE_BEGIN("render pass");
     SDL_GPURenderPass *renderPass = SDL_BeginGPURenderPass(cmdbuf, &colorTargetInfo, 1, NULL);
 
     SDL_BindGPUGraphicsPipeline(renderPass, context.Pipeline);
@@ -257,18 +319,54 @@ int main()
 
     SDL_BindGPUIndexBuffer(renderPass, &(SDL_GPUBufferBinding){.buffer = IndexBuffer, .offset = 0}, SDL_GPU_INDEXELEMENTSIZE_16BIT);
 
-    SDL_DrawGPUIndexedPrimitives(renderPass, 3, 16, 3, 0, 0);
+    if (useStorage)
+    {
+      // The white triangle, so the instance color shows as is. first_instance stays 0, the shader indexes with SV_InstanceID.
+      SDL_BindGPUVertexStorageBuffers(renderPass, 0, &InstanceBuffer, 1);
+      SDL_DrawGPUIndexedPrimitives(renderPass, 3, instanceCount, 0, 6, 0);
+    }
+    else
+    {
+      SDL_DrawGPUIndexedPrimitives(renderPass, 3, 16, 3, 0, 0);
+    }
 
     SDL_EndGPURenderPass(renderPass);
-    SDL_SubmitGPUCommandBuffer(cmdbuf);
+    TRACE_END();
+    FrameTarget_Submit(context.Target, cmdbuf);
+
+    framesDrawn += 1;
+    framesSinceLog += 1;
+    Uint64 nowNS = SDL_GetTicksNS();
+    if (useStorage && nowNS - lastLogNS >= THROUGHPUT_LOG_INTERVAL_NS)
+    {
+      double seconds = (nowNS - lastLogNS) / 1e9;
+      SDL_Log("%.1f frames/s, %.1f M triangles/s", framesSinceLog / seconds, framesSinceLog * (double)instanceCount / seconds / 1e6);
+      lastLogNS = nowNS;
+      framesSinceLog = 0;
+    }
+  }
+
+  if (useStorage && framesDrawn > 0)
+  {
+    // Frames are counted when submitted, wait for the last few so the GPU time is all in
+    SDL_WaitForGPUIdle(context.Device);
+    double seconds = (SDL_GetTicksNS() - startNS) / 1e9;
+    SDL_Log("Drew %u triangles per frame for %llu frames: %.1f frames/s, %.1f M triangles/s",
+            instanceCount, (unsigned long long)framesDrawn, framesDrawn / seconds, framesDrawn * (double)instanceCount / seconds / 1e6);
   }
 
   // cleanup
+  if (InstanceBuffer != NULL)
+  {
+    SDL_ReleaseGPUBuffer(context.Device, InstanceBuffer);
+  }
   SDL_ReleaseGPUBuffer(context.Device, VertexBuffer);
   SDL_ReleaseGPUBuffer(context.Device, IndexBuffer);
 
-  SDL_ReleaseGPUGraphicsPipeline(context.Device, context.Pipeline);
+  UploadRing_Destroy(context.Uploads);
+  PipelineRegistry_Destroy(context.Pipelines);
 
+  ReleaseShaderCache(context.Device);
+  FrameTarget_Destroy(context.Target);
   SDL_DestroyGPUDevice(context.Device);
-  SDL_DestroyWindow(context.Window);
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+#version 450
+
+#ifdef VERTEX
+layout(set = 1, binding = 0) uniform UBO {
+    mat4 ViewProjection;
+    // The mesh's VertexDequantization, identity for float3 positions
+    vec4 PositionScale;
+    vec4 PositionOffset;
+};
+
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+
+layout(location = 0) out vec3 outPosition;
+layout(location = 1) out vec2 outTexCoord;
+
+void main() {
+    vec3 position = inPosition.xyz * PositionScale.xyz + PositionOffset.xyz;
+    outPosition = position;
+    outTexCoord = inTexCoord;
+    gl_Position = ViewProjection * vec4(position, 1.0);
+}
+#endif
+
+#ifdef FRAGMENT
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 0) out vec4 outColor;
+
+// Meshes come without normals here: the face normal from the position's derivatives, lit from both sides
+void main() {
+    vec3 normal = normalize(cross(dFdx(inPosition), dFdy(inPosition)));
+    float light = 0.25 + 0.75 * abs(dot(normal, normalize(vec3(0.4, 1.0, 0.3))));
+    vec2 cell = floor(inTexCoord * 16.0);
+    float checker = mod(cell.x + cell.y, 2.0);
+    outColor = vec4(mix(vec3(0.45, 0.5, 0.55), vec3(0.9, 0.8, 0.6), checker) * light, 1.0);
+}
+#endif
@@ -0,0 +1,9 @@
+// Meshes come without normals here: the face normal from the position's derivatives, lit from both sides
+float4 main(float3 WorldPosition : TEXCOORD0, float2 TexCoord : TEXCOORD1) : SV_Target0
+{
+    float3 normal = normalize(cross(ddx(WorldPosition), ddy(WorldPosition)));
+    float light = 0.25f + 0.75f * abs(dot(normal, normalize(float3(0.4f, 1.0f, 0.3f))));
+    float2 cell = floor(TexCoord * 16.0f);
+    float checker = fmod(cell.x + cell.y, 2.0f);
+    return float4(lerp(float3(0.45f, 0.5f, 0.55f), float3(0.9f, 0.8f, 0.6f), checker) * light, 1.0f);
+}
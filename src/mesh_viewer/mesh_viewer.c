@@ -0,0 +1,299 @@
+#include <SDL3/SDL.h>
+#include "load.h"
+#include "pipeline_registry.h"
+#include "frame_target.h"
+#include "trace.h"
+#include "upload_ring.h"
+#include "linear_algebra.h"
+#include "vertex_format.h"
+#include "mesh_loader.h"
+#include "buffer_allocator.h"
+
+// Loads an OBJ or glTF mesh with mesh_loader, straight into one upload of mapped transfer memory, and orbits it.
+//   --mesh path.obj|.gltf|.glb|.mesh, meshes/torus.obj by default. A .mesh from mesh_cook is copied as it is, with no parsing.
+//   --positions float3|short4|half4 and --uvs float2|half2|ushort2 pick the vertex layout, as in vertex_formats.
+//     A baked mesh comes in the layout it was cooked with.
+#define DEFAULT_MESH "meshes/torus.obj"
+
+typedef struct Context
+{
+  SDL_GPUDevice *Device;
+  SDL_Window *Window;
+  FrameTarget *Target;
+  PipelineRegistry *Pipelines;
+  UploadRing *Uploads;
+} Context;
+
+// Matches the vertex UBO of MeshViewer
+typedef struct MeshUniforms
+{
+  Matrix4x4 viewProjection;
+  VertexDequantization dequantization;
+} MeshUniforms;
+
+Context context = {0};
+
+int main(int argc, char *argv[])
+{
+  FrameTargetOptions options;
+  const char *meshPath = DEFAULT_MESH;
+  const char *positionsName = "float3";
+  const char *uvsName = "float2";
+  FrameTargetArg extraArgs[] = {
+      {.name = "--mesh", .valueName = "path", .text = &meshPath},
+      {.name = "--positions", .valueName = "float3|short4|half4", .text = &positionsName},
+      {.name = "--uvs", .valueName = "float2|half2|ushort2", .text = &uvsName}};
+  if (!FrameTarget_ParseArgsEx(argc, argv, "mesh_viewer", &options, extraArgs, SDL_arraysize(extraArgs)))
+  {
+    return 1;
+  }
+  VertexPositionFormat positionFormat;
+  VertexUVFormat uvFormat;
+  if (!VertexFormat_FindPositionFormat(positionsName, &positionFormat) || !VertexFormat_FindUVFormat(uvsName, &uvFormat))
+  {
+    SDL_Log("Unknown layout '%s' + '%s', positions are float3, short4 or half4 and UVs float2, half2 or ushort2", positionsName, uvsName);
+    return 1;
+  }
+
+  // Parsed before the GPU is up, a broken file fails fast
+  MeshFile *meshFile = MeshFile_Open(meshPath);
+  if (meshFile == NULL)
+  {
+    return 1;
+  }
+  const MeshFileInfo *meshInfo = MeshFile_GetInfo(meshFile);
+  VertexLayout layout = meshInfo->baked ? meshInfo->bakedLayout : VertexFormat_GetPositionTextureLayout(positionFormat, uvFormat);
+  Uint32 uploadSize = MeshFile_GetUploadSize(meshFile, &layout);
+  if (uploadSize == 0)
+  {
+    SDL_Log("%s is too large to upload at once", meshPath);
+    return 1;
+  }
+
+  if (SDL_Init(FrameTarget_GetInitFlags(&options)) == false)
+  {
+    SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
+    return 1;
+  }
+
+  context.Device = SDL_CreateGPUDevice(
+      SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL,
+      false,
+      options.driver);
+  if (context.Device == NULL)
+  {
+    SDL_Log("GPUCreateDevice failed");
+    return -1;
+  }
+
+  context.Target = FrameTarget_Create(context.Device, "Mesh Viewer", 640, 480, 0, &options);
+  if (context.Target == NULL)
+  {
+    return -1;
+  }
+  context.Window = FrameTarget_GetWindow(context.Target);
+
+  context.Pipelines = PipelineRegistry_Create(context.Device);
+  if (context.Pipelines == NULL)
+  {
+    SDL_Log("Failed to create pipeline registry!");
+    return -1;
+  }
+
+  // Sized for the mesh, it is the only upload
+  context.Uploads = UploadRing_Create(context.Device, uploadSize, 1);
+  if (context.Uploads == NULL)
+  {
+    SDL_Log("Failed to create upload ring!");
+    return -1;
+  }
+  // Sized for the mesh too, in the index size the file needs
+  MeshPool *meshes = MeshPool_Create(context.Device, layout.stride, meshInfo->vertexCount, meshInfo->indexElementSize, meshInfo->indexCount);
+  if (meshes == NULL)
+  {
+    SDL_Log("Failed to create the mesh pool!");
+    return -1;
+  }
+  UploadRing_BeginFrame(context.Uploads);
+  LoadedMesh mesh;
+  Uint64 writeStart = SDL_GetTicksNS();
+  TRACE_BEGIN("write mesh");
+  bool loaded = LoadMesh(meshes, context.Uploads, meshFile, &layout, &mesh);
+  TRACE_END();
+  Uint64 writeNS = SDL_GetTicksNS() - writeStart;
+  MeshFile_Close(meshFile);
+  if (!loaded || !UploadRing_Submit(context.Uploads, SDL_AcquireGPUCommandBuffer(context.Device)))
+  {
+    SDL_Log("Failed to upload the mesh: %s", SDL_GetError());
+    return -1;
+  }
+  SDL_Log("%s + %s, %u bytes/vertex: %.1f MB written to transfer memory in %.1f ms",
+          VertexFormat_GetPositionFormatName(layout.positionFormat), VertexFormat_GetUVFormatName(layout.uvFormat),
+          layout.stride, uploadSize / 1e6, writeNS / 1e6);
+
+  SDL_GPUShader *vertexShader = LoadShader(context.Device, "MeshViewer.vert", 0, 1, 0, 0);
+  if (vertexShader == NULL)
+  {
+    SDL_Log("Failed to create vertex shader!");
+    return -1;
+  }
+  SDL_GPUShader *fragmentShader = LoadShader(context.Device, "MeshViewer.frag", 0, 0, 0, 0);
+  if (fragmentShader == NULL)
+  {
+    SDL_Log("Failed to create fragment shader!");
+    return -1;
+  }
+
+  SDL_GPUVertexAttribute attributes[2];
+  VertexFormat_GetAttributes(&layout, attributes);
+  SDL_GPUGraphicsPipelineCreateInfo pipelineCreateInfo = {
+      .target_info = {
+          .num_color_targets = 1,
+          .color_target_descriptions = (SDL_GPUColorTargetDescription[]){{.format = FrameTarget_GetFormat(context.Target)}},
+          .has_depth_stencil_target = true,
+          .depth_stencil_format = SDL_GPU_TEXTUREFORMAT_D16_UNORM},
+      .depth_stencil_state = (SDL_GPUDepthStencilState){
+          .enable_depth_test = true,
+          .enable_depth_write = true,
+          .compare_op = SDL_GPU_COMPAREOP_LESS},
+      // Files wind their triangles either way
+      .rasterizer_state = (SDL_GPURasterizerState){
+          .cull_mode = SDL_GPU_CULLMODE_NONE,
+          .fill_mode = SDL_GPU_FILLMODE_FILL,
+          .front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE},
+      .vertex_input_state = (SDL_GPUVertexInputState){
+          .num_vertex_buffers = 1,
+          .vertex_buffer_descriptions = (SDL_GPUVertexBufferDescription[]){{
+              .slot = 0,
+              .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+              .instance_step_rate = 0,
+              .pitch = layout.stride}},
+          .num_vertex_attributes = 2,
+          .vertex_attributes = attributes},
+      .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+      .vertex_shader = vertexShader,
+      .fragment_shader = fragmentShader};
+  SDL_GPUGraphicsPipeline *pipeline = PipelineRegistry_Get(context.Pipelines, &pipelineCreateInfo);
+  if (pipeline == NULL)
+  {
+    SDL_Log("Failed to create pipeline!");
+    return -1;
+  }
+
+  int width, height;
+  FrameTarget_GetSize(context.Target, &width, &height);
+  SDL_GPUTexture *DepthTexture = SDL_CreateGPUTexture(
+      context.Device,
+      &(SDL_GPUTextureCreateInfo){
+          .type = SDL_GPU_TEXTURETYPE_2D,
+          .width = width,
+          .height = height,
+          .layer_count_or_depth = 1,
+          .num_levels = 1,
+          .sample_count = SDL_GPU_SAMPLECOUNT_1,
+          .format = SDL_GPU_TEXTUREFORMAT_D16_UNORM,
+          .usage = SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET});
+  if (DepthTexture == NULL)
+  {
+    SDL_Log("Failed to create the depth texture: %s", SDL_GetError());
+    return -1;
+  }
+
+  // Orbit the bounding box's center from far enough away to see all of it
+  Vector3 center = {(mesh.min[0] + mesh.max[0]) * 0.5f, (mesh.min[1] + mesh.max[1]) * 0.5f, (mesh.min[2] + mesh.max[2]) * 0.5f};
+  Vector3 extent = {mesh.max[0] - mesh.min[0], mesh.max[1] - mesh.min[1], mesh.max[2] - mesh.min[2]};
+  float radius = SDL_max(SDL_sqrtf(extent.x * extent.x + extent.y * extent.y + extent.z * extent.z) * 0.5f, 0.001f);
+
+  SDL_Event event;
+  int quit = 0;
+  float rotationAngle = 0.0f;
+  float rotationSpeed = 0.5f;
+  Uint64 lastTime = SDL_GetTicksNS();
+
+  while (!quit && !FrameTarget_IsDone(context.Target))
+  {
+    Uint64 currentTime = SDL_GetTicksNS();
+    float deltaTime = (currentTime - lastTime) / 1e9f;
+    lastTime = currentTime;
+
+    TRACE_BEGIN("poll events");
+    while (SDL_PollEvent(&event))
+    {
+      switch (event.type)
+      {
+      case SDL_EVENT_QUIT:
+        quit = true;
+        break;
+      }
+    }
+    TRACE_END();
+
+    TRACE_BEGIN("acquire command buffer");
+    SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    TRACE_END();
+    if (cmdbuf == NULL)
+    {
+      SDL_Log("AcquireGPUCommandBuffer failed: %s", SDL_GetError());
+      return -1;
+    }
+
+    SDL_GPUTexture *swapchainTexture;
+    if (!FrameTarget_Acquire(context.Target, cmdbuf, &swapchainTexture))
+    {
+      SDL_Log("WaitAndAcquireGPUSwapchainTexture failed: %s", SDL_GetError());
+      return -1;
+    }
+    if (swapchainTexture == NULL)
+    {
+      FrameTarget_Submit(context.Target, cmdbuf);
+      continue;
+    }
+
+    rotationAngle += rotationSpeed * deltaTime;
+    Vector3 cameraPosition = {
+        center.x + SDL_cosf(rotationAngle) * radius * 2.5f,
+        center.y + radius,
+        center.z + SDL_sinf(rotationAngle) * radius * 2.5f};
+    Matrix4x4 proj = Matrix4x4_CreatePerspectiveFieldOfView(60.0f * SDL_PI_F / 180.0f, width / (float)height, radius * 0.05f, radius * 10.0f);
+    Matrix4x4 view = Matrix4x4_CreateLookAt(cameraPosition, center, (Vector3){0, 1, 0});
+    MeshUniforms uniforms = {Matrix4x4_Multiply(view, proj), mesh.dequantization};
+    SDL_PushGPUVertexUniformData(cmdbuf, 0, &uniforms, sizeof(uniforms));
+
+    SDL_GPUColorTargetInfo colorTargetInfo = {0};
+    colorTargetInfo.texture = swapchainTexture;
+    colorTargetInfo.clear_color = (SDL_FColor){0.1f, 0.1f, 0.12f, 1.0f};
+    colorTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
+    colorTargetInfo.store_op = SDL_GPU_STOREOP_STORE;
+
+    SDL_GPUDepthStencilTargetInfo depthStencilTargetInfo = {0};
+    depthStencilTargetInfo.texture = DepthTexture;
+    depthStencilTargetInfo.cycle = true;
+    depthStencilTargetInfo.clear_depth = 1;
+    depthStencilTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
+    depthStencilTargetInfo.store_op = SDL_GPU_STOREOP_DONT_CARE;
+    depthStencilTargetInfo.stencil_load_op = SDL_GPU_LOADOP_DONT_CARE;
+    depthStencilTargetInfo.stencil_store_op = SDL_GPU_STOREOP_DONT_CARE;
+
+    TRACE_BEGIN("render pass");
+    SDL_GPURenderPass *renderPass = SDL_BeginGPURenderPass(cmdbuf, &colorTargetInfo, 1, &depthStencilTargetInfo);
+    SDL_BindGPUGraphicsPipeline(renderPass, pipeline);
+    MeshPool_Bind(meshes, renderPass);
+    MeshPool_Draw(renderPass, &mesh.allocation, 1);
+    SDL_EndGPURenderPass(renderPass);
+    TRACE_END();
+    FrameTarget_Submit(context.Target, cmdbuf);
+  }
+
+  // cleanup
+  ReleaseMesh(meshes, &mesh);
+  MeshPool_Destroy(meshes);
+  SDL_ReleaseGPUTexture(context.Device, DepthTexture);
+
+  UploadRing_Destroy(context.Uploads);
+  PipelineRegistry_Destroy(context.Pipelines);
+
+  ReleaseShaderCache(context.Device);
+  FrameTarget_Destroy(context.Target);
+  SDL_DestroyGPUDevice(context.Device);
+  return 0;
+}
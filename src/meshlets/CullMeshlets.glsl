@@ -0,0 +1,70 @@
+#version 450
+// One thread per meshlet: its bounding sphere is tested against the frustum and its normal cone against the camera,
+// then its indirect draw is written with one instance if it is visible and none if it is not.
+// Every draw is written every frame, so nothing has to be reset and the CPU never sees which meshlets are drawn.
+layout(local_size_x = 64) in;
+
+// Meshlet in meshlet.h
+struct MeshletBounds
+{
+    vec4 Sphere;   // center in xyz, radius in w
+    vec4 ConeApex; // apex in xyz, cutoff in w
+    vec4 ConeAxis; // axis in xyz
+    uvec4 Range;   // first index, index count
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer MeshletBuffer
+{
+    MeshletBounds Meshlets[];
+};
+
+// SDL_GPUIndexedIndirectDrawCommand
+struct DrawCommand
+{
+    uint NumIndices;
+    uint NumInstances;
+    uint FirstIndex;
+    int VertexOffset;
+    uint FirstInstance;
+};
+
+layout(std430, set = 1, binding = 0) writeonly buffer DrawBuffer
+{
+    DrawCommand Draws[];
+};
+
+layout(set = 2, binding = 0) uniform UBO
+{
+    vec4 Planes[6]; // normal in xyz, distance in w, inside is positive
+    vec4 CameraPosition;
+    uint MeshletCount;
+};
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= MeshletCount)
+    {
+        return;
+    }
+    MeshletBounds meshlet = Meshlets[index];
+
+    bool visible = true;
+    for (int p = 0; p < 6; p++)
+    {
+        visible = visible && dot(Planes[p].xyz, meshlet.Sphere.xyz) + Planes[p].w >= -meshlet.Sphere.w;
+    }
+    // Every triangle faces away when the camera is inside the cone behind the apex
+    vec3 view = meshlet.ConeApex.xyz - CameraPosition.xyz;
+    float cutoff = meshlet.ConeApex.w;
+    if (cutoff < 1.0 && dot(view, meshlet.ConeAxis.xyz) >= cutoff * length(view))
+    {
+        visible = false;
+    }
+
+    Draws[index].NumIndices = meshlet.Range.y;
+    Draws[index].NumInstances = visible ? 1 : 0;
+    Draws[index].FirstIndex = meshlet.Range.x;
+    Draws[index].VertexOffset = 0;
+    Draws[index].FirstInstance = 0;
+}
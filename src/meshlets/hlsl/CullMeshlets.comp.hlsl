@@ -0,0 +1,64 @@
+// One thread per meshlet: its bounding sphere is tested against the frustum and its normal cone against the camera,
+// then its indirect draw is written with one instance if it is visible and none if it is not.
+// Every draw is written every frame, so nothing has to be reset and the CPU never sees which meshlets are drawn.
+
+// Meshlet in meshlet.h
+struct MeshletBounds
+{
+    float4 Sphere;   // center in xyz, radius in w
+    float4 ConeApex; // apex in xyz, cutoff in w
+    float4 ConeAxis; // axis in xyz
+    uint4 Range;     // first index, index count
+};
+
+// SDL_GPUIndexedIndirectDrawCommand
+struct DrawCommand
+{
+    uint NumIndices;
+    uint NumInstances;
+    uint FirstIndex;
+    int VertexOffset;
+    uint FirstInstance;
+};
+
+StructuredBuffer<MeshletBounds> Meshlets : register(t0, space0);
+RWStructuredBuffer<DrawCommand> Draws : register(u0, space1);
+
+cbuffer UBO : register(b0, space2)
+{
+    float4 Planes[6]; // normal in xyz, distance in w, inside is positive
+    float4 CameraPosition;
+    uint MeshletCount;
+};
+
+[numthreads(64, 1, 1)]
+void main(uint3 GlobalInvocationID : SV_DispatchThreadID)
+{
+    uint index = GlobalInvocationID.x;
+    if (index >= MeshletCount)
+    {
+        return;
+    }
+    MeshletBounds meshlet = Meshlets[index];
+
+    bool visible = true;
+    for (int p = 0; p < 6; p++)
+    {
+        visible = visible && dot(Planes[p].xyz, meshlet.Sphere.xyz) + Planes[p].w >= -meshlet.Sphere.w;
+    }
+    // Every triangle faces away when the camera is inside the cone behind the apex
+    float3 view = meshlet.ConeApex.xyz - CameraPosition.xyz;
+    float cutoff = meshlet.ConeApex.w;
+    if (cutoff < 1.0f && dot(view, meshlet.ConeAxis.xyz) >= cutoff * length(view))
+    {
+        visible = false;
+    }
+
+    DrawCommand draw;
+    draw.NumIndices = meshlet.Range.y;
+    draw.NumInstances = visible ? 1 : 0;
+    draw.FirstIndex = meshlet.Range.x;
+    draw.VertexOffset = 0;
+    draw.FirstInstance = 0;
+    Draws[index] = draw;
+}
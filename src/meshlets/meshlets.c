@@ -0,0 +1,478 @@
+#include <SDL3/SDL.h>
+#include "load.h"
+#include "pipeline_registry.h"
+#include "frame_target.h"
+#include "trace.h"
+#include "upload_ring.h"
+#include "linear_algebra.h"
+#include "culling.h"
+#include "vertex_format.h"
+#include "mesh_optimizer.h"
+#include "meshlet.h"
+
+// A dense torus of about two million triangles drawn with the cube's PositionColorTransform pipeline, split into meshlets of
+// up to MESHLET_MAX_VERTICES vertices and MESHLET_MAX_TRIANGLES triangles. Every frame the CullMeshlets compute shader tests each
+// meshlet's bounding sphere against the frustum and its normal cone against the camera and writes the meshlet's indirect draw,
+// so the CPU records the same single indirect call whatever is visible. The camera flies around the ring close to the tube,
+// most of the torus is behind it or on the far side of the tube.
+//   --segments N quads around the ring, the tube gets N / 4
+//   --no-cull draws the whole mesh with one draw, to compare against
+#define DEFAULT_SEGMENTS 2048
+#define RING_RADIUS 10.0f
+#define TUBE_RADIUS 3.0f
+// Must match local_size_x / numthreads of CullMeshlets
+#define CULL_GROUP_SIZE 64
+#define MAX_CULL_GROUPS 65535
+// The CPU runs the same tests every this many frames to count what the GPU culls
+#define STATS_INTERVAL 16
+
+typedef struct Context
+{
+  SDL_GPUDevice *Device;
+  SDL_Window *Window;
+  FrameTarget *Target;
+  PipelineRegistry *Pipelines;
+  UploadRing *Uploads;
+} Context;
+
+// Matches the UBO of CullMeshlets, std140 pads the block to 16 bytes
+typedef struct CullUniforms
+{
+  Frustum frustum;
+  float cameraPosition[4];
+  Uint32 meshletCount;
+  Uint32 padding[3];
+} CullUniforms;
+
+Context context = {0};
+
+// Counter-clockwise seen from outside, the tube has segments / 4 quads around it and both wrap around without seams
+static PositionColorVertex *BuildTorus(Uint32 segments, Uint32 *vertexCount, Uint32 **indices, Uint32 *indexCount)
+{
+  Uint32 sides = segments / 4;
+  *vertexCount = segments * sides;
+  *indexCount = segments * sides * 6;
+  PositionColorVertex *vertices = SDL_malloc(sizeof(PositionColorVertex) * *vertexCount);
+  *indices = SDL_malloc(sizeof(Uint32) * *indexCount);
+  if (vertices == NULL || *indices == NULL)
+  {
+    SDL_free(vertices);
+    SDL_free(*indices);
+    return NULL;
+  }
+  for (Uint32 i = 0; i < segments; i += 1)
+  {
+    float ring = i * 2.0f * SDL_PI_F / segments;
+    for (Uint32 j = 0; j < sides; j += 1)
+    {
+      float tube = j * 2.0f * SDL_PI_F / sides;
+      // A few bumps so the surface isn't smooth enough to cull perfectly
+      float radius = TUBE_RADIUS * (1.0f + 0.05f * SDL_sinf(ring * 40.0f) * SDL_sinf(tube * 12.0f));
+      Vector3 normal = {SDL_cosf(tube) * SDL_cosf(ring), SDL_sinf(tube), SDL_cosf(tube) * SDL_sinf(ring)};
+      vertices[i * sides + j] = (PositionColorVertex){
+          RING_RADIUS * SDL_cosf(ring) + radius * normal.x,
+          radius * normal.y,
+          RING_RADIUS * SDL_sinf(ring) + radius * normal.z,
+          (Uint8)(127.5f + 127.5f * normal.x),
+          (Uint8)(127.5f + 127.5f * normal.y),
+          (Uint8)(127.5f + 127.5f * normal.z),
+          255};
+    }
+  }
+  for (Uint32 i = 0; i < segments; i += 1)
+  {
+    for (Uint32 j = 0; j < sides; j += 1)
+    {
+      Uint32 next = (i + 1) % segments;
+      Uint32 up = (j + 1) % sides;
+      Uint32 *quad = *indices + (i * sides + j) * 6;
+      quad[0] = i * sides + j;
+      quad[1] = i * sides + up;
+      quad[2] = next * sides + up;
+      quad[3] = i * sides + j;
+      quad[4] = next * sides + up;
+      quad[5] = next * sides + j;
+    }
+  }
+  return vertices;
+}
+
+int main(int argc, char *argv[])
+{
+  FrameTargetOptions options;
+  Uint32 segments = DEFAULT_SEGMENTS;
+  bool noCull = false;
+  FrameTargetArg extraArgs[] = {
+      {.name = "--segments", .valueName = "N", .value = &segments},
+      {.name = "--no-cull", .flag = &noCull}};
+  if (!FrameTarget_ParseArgsEx(argc, argv, "meshlets", &options, extraArgs, SDL_arraysize(extraArgs)))
+  {
+    return 1;
+  }
+  // The whole mesh goes up in one transfer buffer, 4096 is already 100 MB of indices
+  if (segments < 8 || segments > 4096)
+  {
+    SDL_Log("--segments takes 8 to 4096 quads around the ring");
+    return 1;
+  }
+
+  if (SDL_Init(FrameTarget_GetInitFlags(&options)) == false)
+  {
+    SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
+    return 1;
+  }
+
+  context.Device = SDL_CreateGPUDevice(
+      SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL,
+      false,
+      options.driver);
+  if (context.Device == NULL)
+  {
+    SDL_Log("GPUCreateDevice failed");
+    return -1;
+  }
+
+  context.Target = FrameTarget_Create(context.Device, "Meshlets", 640, 480, 0, &options);
+  if (context.Target == NULL)
+  {
+    return -1;
+  }
+  context.Window = FrameTarget_GetWindow(context.Target);
+
+  context.Pipelines = PipelineRegistry_Create(context.Device);
+  if (context.Pipelines == NULL)
+  {
+    SDL_Log("Failed to create pipeline registry!");
+    return -1;
+  }
+
+  // Meshlets are only as tight as the triangle order, the grid's rows would make long thin strips
+  Uint32 vertexCount, indexCount;
+  Uint32 *gridIndices;
+  PositionColorVertex *vertices = BuildTorus(segments, &vertexCount, &gridIndices, &indexCount);
+  Uint32 *indices = SDL_malloc(sizeof(Uint32) * indexCount);
+  Meshlet *meshlets = SDL_malloc(sizeof(Meshlet) * Meshlet_GetMaxCount(indexCount, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES));
+  if (vertices == NULL || indices == NULL || meshlets == NULL)
+  {
+    SDL_Log("Failed to allocate %u vertices", segments * (segments / 4));
+    return -1;
+  }
+  Uint64 buildStart = SDL_GetTicksNS();
+  TRACE_BEGIN("build meshlets");
+  bool optimized = MeshOptimizer_OptimizeVertexCache(indices, gridIndices, indexCount, vertexCount, MESH_OPTIMIZER_CACHE_SIZE);
+  Uint32 meshletCount = Meshlet_Build(meshlets, indices, indexCount, &vertices[0].x, sizeof(PositionColorVertex), vertexCount, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+  TRACE_END();
+  SDL_free(gridIndices);
+  if (!optimized || meshletCount == 0 || meshletCount > CULL_GROUP_SIZE * MAX_CULL_GROUPS)
+  {
+    SDL_Log("Failed to build the meshlets!");
+    return -1;
+  }
+  Uint32 coneCount = 0;
+  for (Uint32 i = 0; i < meshletCount; i += 1)
+  {
+    coneCount += meshlets[i].coneCutoff < 1.0f;
+  }
+  SDL_Log("%u vertices, %u triangles in %u meshlets of %.1f triangles on average, %.1f%% with a normal cone, built in %.1f ms",
+          vertexCount, indexCount / 3, meshletCount, indexCount / 3.0 / meshletCount, 100.0 * coneCount / meshletCount,
+          (SDL_GetTicksNS() - buildStart) / 1e6);
+
+  SDL_GPUShader *vertexShader = LoadShader(context.Device, "PositionColorTransform.vert", 0, 1, 0, 0);
+  if (vertexShader == NULL)
+  {
+    SDL_Log("Failed to create vertex shader!");
+    return -1;
+  }
+  SDL_GPUShader *fragmentShader = LoadShader(context.Device, "SolidColor.frag", 0, 0, 0, 0);
+  if (fragmentShader == NULL)
+  {
+    SDL_Log("Failed to create fragment shader!");
+    return -1;
+  }
+
+  VertexLayout layout = VertexFormat_GetPositionColorLayout(VERTEX_POSITION_FLOAT3);
+  SDL_GPUVertexAttribute attributes[2];
+  VertexFormat_GetAttributes(&layout, attributes);
+  SDL_GPUGraphicsPipelineCreateInfo pipelineCreateInfo = {
+      .target_info = {
+          .num_color_targets = 1,
+          .color_target_descriptions = (SDL_GPUColorTargetDescription[]){{.format = FrameTarget_GetFormat(context.Target)}},
+          .has_depth_stencil_target = true,
+          .depth_stencil_format = SDL_GPU_TEXTUREFORMAT_D16_UNORM},
+      .depth_stencil_state = (SDL_GPUDepthStencilState){
+          .enable_depth_test = true,
+          .enable_depth_write = true,
+          .compare_op = SDL_GPU_COMPAREOP_LESS},
+      .rasterizer_state = (SDL_GPURasterizerState){
+          // The torus is closed and counter-clockwise from outside, the meshlet cone test only removes whole clusters
+          .cull_mode = SDL_GPU_CULLMODE_BACK,
+          .fill_mode = SDL_GPU_FILLMODE_FILL,
+          .front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE},
+      .vertex_input_state = (SDL_GPUVertexInputState){
+          .num_vertex_buffers = 1,
+          .vertex_buffer_descriptions = (SDL_GPUVertexBufferDescription[]){{
+              .slot = 0,
+              .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+              .instance_step_rate = 0,
+              .pitch = layout.stride}},
+          .num_vertex_attributes = 2,
+          .vertex_attributes = attributes},
+      .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+      .vertex_shader = vertexShader,
+      .fragment_shader = fragmentShader};
+  SDL_GPUGraphicsPipeline *pipeline = PipelineRegistry_Get(context.Pipelines, &pipelineCreateInfo);
+  if (pipeline == NULL)
+  {
+    SDL_Log("Failed to create pipeline!");
+    return -1;
+  }
+
+  SDL_GPUComputePipeline *CullPipeline = LoadComputePipeline(
+      context.Device,
+      "CullMeshlets.comp",
+      &(SDL_GPUComputePipelineCreateInfo){
+          .num_readonly_storage_buffers = 1,
+          .num_readwrite_storage_buffers = 1,
+          .num_uniform_buffers = 1,
+          .threadcount_x = CULL_GROUP_SIZE,
+          .threadcount_y = 1,
+          .threadcount_z = 1});
+  if (CullPipeline == NULL)
+  {
+    SDL_Log("Failed to create the 'CullMeshlets' compute pipeline!");
+    return -1;
+  }
+
+  int width, height;
+  FrameTarget_GetSize(context.Target, &width, &height);
+  SDL_GPUTexture *DepthTexture = SDL_CreateGPUTexture(
+      context.Device,
+      &(SDL_GPUTextureCreateInfo){
+          .type = SDL_GPU_TEXTURETYPE_2D,
+          .width = width,
+          .height = height,
+          .layer_count_or_depth = 1,
+          .num_levels = 1,
+          .sample_count = SDL_GPU_SAMPLECOUNT_1,
+          .format = SDL_GPU_TEXTUREFORMAT_D16_UNORM,
+          .usage = SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET});
+  Uint32 vertexBytes = sizeof(PositionColorVertex) * vertexCount;
+  Uint32 indexBytes = sizeof(Uint32) * indexCount;
+  Uint32 meshletBytes = sizeof(Meshlet) * meshletCount;
+  SDL_GPUBuffer *VertexBuffer = SDL_CreateGPUBuffer(
+      context.Device,
+      &(SDL_GPUBufferCreateInfo){.usage = SDL_GPU_BUFFERUSAGE_VERTEX, .size = vertexBytes});
+  SDL_GPUBuffer *IndexBuffer = SDL_CreateGPUBuffer(
+      context.Device,
+      &(SDL_GPUBufferCreateInfo){.usage = SDL_GPU_BUFFERUSAGE_INDEX, .size = indexBytes});
+  SDL_GPUBuffer *MeshletBuffer = SDL_CreateGPUBuffer(
+      context.Device,
+      &(SDL_GPUBufferCreateInfo){.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ, .size = meshletBytes});
+  // One SDL_GPUIndexedIndirectDrawCommand per meshlet, written by CullMeshlets before every draw
+  SDL_GPUBuffer *DrawBuffer = SDL_CreateGPUBuffer(
+      context.Device,
+      &(SDL_GPUBufferCreateInfo){
+          .usage = SDL_GPU_BUFFERUSAGE_INDIRECT | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE,
+          .size = sizeof(SDL_GPUIndexedIndirectDrawCommand) * meshletCount});
+  if (DepthTexture == NULL || VertexBuffer == NULL || IndexBuffer == NULL || MeshletBuffer == NULL || DrawBuffer == NULL)
+  {
+    SDL_Log("Failed to create the GPU resources: %s", SDL_GetError());
+    return -1;
+  }
+
+  // Everything goes up at once, the CPU keeps the meshlets to count what the GPU culls
+  context.Uploads = UploadRing_Create(context.Device, vertexBytes + indexBytes + meshletBytes, 1);
+  if (context.Uploads == NULL)
+  {
+    SDL_Log("Failed to create upload ring!");
+    return -1;
+  }
+  UploadRing_BeginFrame(context.Uploads);
+  if (!UploadRing_UploadToBuffer(context.Uploads, vertices, vertexBytes, VertexBuffer, 0) ||
+      !UploadRing_UploadToBuffer(context.Uploads, indices, indexBytes, IndexBuffer, 0) ||
+      !UploadRing_UploadToBuffer(context.Uploads, meshlets, meshletBytes, MeshletBuffer, 0) ||
+      !UploadRing_Submit(context.Uploads, SDL_AcquireGPUCommandBuffer(context.Device)))
+  {
+    SDL_Log("Failed to upload the mesh: %s", SDL_GetError());
+    return -1;
+  }
+  SDL_free(vertices);
+  SDL_free(indices);
+  if (noCull)
+  {
+    SDL_Log("Drawing all %u triangles with one draw", indexCount / 3);
+  }
+  else
+  {
+    SDL_Log("Culling %u meshlets in a compute shader, drawn with one indirect call", meshletCount);
+  }
+
+  SDL_Event event;
+  int quit = 0;
+  float rotationAngle = 0.0f;
+  float rotationSpeed = 0.3f;
+  Uint64 lastTime = SDL_GetTicksNS();
+  Uint64 frames = 0;
+  Uint64 statsFrames = 0;
+  Uint64 outsideTotal = 0;
+  Uint64 backfacingTotal = 0;
+  Uint64 drawnIndexTotal = 0;
+
+  while (!quit && !FrameTarget_IsDone(context.Target))
+  {
+    Uint64 currentTime = SDL_GetTicksNS();
+    float deltaTime = (currentTime - lastTime) / 1e9f;
+    lastTime = currentTime;
+
+    TRACE_BEGIN("poll events");
+    while (SDL_PollEvent(&event))
+    {
+      switch (event.type)
+      {
+      case SDL_EVENT_QUIT:
+        quit = true;
+        break;
+      }
+    }
+    TRACE_END();
+
+    TRACE_BEGIN("acquire command buffer");
+    SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    TRACE_END();
+    if (cmdbuf == NULL)
+    {
+      SDL_Log("AcquireGPUCommandBuffer failed: %s", SDL_GetError());
+      return -1;
+    }
+
+    SDL_GPUTexture *swapchainTexture;
+    if (!FrameTarget_Acquire(context.Target, cmdbuf, &swapchainTexture))
+    {
+      SDL_Log("WaitAndAcquireGPUSwapchainTexture failed: %s", SDL_GetError());
+      return -1;
+    }
+    if (swapchainTexture == NULL)
+    {
+      FrameTarget_Submit(context.Target, cmdbuf);
+      continue;
+    }
+
+    // Just outside the tube, looking along the ring
+    rotationAngle += rotationSpeed * deltaTime;
+    float orbitRadius = RING_RADIUS + TUBE_RADIUS * 1.6f;
+    Vector3 cameraPosition = {SDL_cosf(rotationAngle) * orbitRadius, TUBE_RADIUS * 0.8f, SDL_sinf(rotationAngle) * orbitRadius};
+    Vector3 cameraTarget = {SDL_cosf(rotationAngle + 0.6f) * RING_RADIUS, 0.0f, SDL_sinf(rotationAngle + 0.6f) * RING_RADIUS};
+    Matrix4x4 proj = Matrix4x4_CreatePerspectiveFieldOfView(70.0f * SDL_PI_F / 180.0f, width / (float)height, 0.1f, RING_RADIUS * 4.0f);
+    Matrix4x4 view = Matrix4x4_CreateLookAt(cameraPosition, cameraTarget, (Vector3){0, 1, 0});
+    Matrix4x4 viewproj = Matrix4x4_Multiply(view, proj);
+    Frustum frustum = Frustum_FromMatrix(&viewproj);
+
+    if (!noCull)
+    {
+      TRACE_BEGIN("cull");
+      CullUniforms cullUniforms = {
+          .frustum = frustum,
+          .cameraPosition = {cameraPosition.x, cameraPosition.y, cameraPosition.z, 1.0f},
+          .meshletCount = meshletCount};
+      SDL_PushGPUComputeUniformData(cmdbuf, 0, &cullUniforms, sizeof(cullUniforms));
+      // Cycling gives this frame its own draws while earlier frames may still be drawing from theirs
+      SDL_GPUComputePass *computePass = SDL_BeginGPUComputePass(
+          cmdbuf,
+          NULL,
+          0,
+          &(SDL_GPUStorageBufferReadWriteBinding){.buffer = DrawBuffer, .cycle = true},
+          1);
+      SDL_BindGPUComputePipeline(computePass, CullPipeline);
+      SDL_BindGPUComputeStorageBuffers(computePass, 0, &MeshletBuffer, 1);
+      SDL_DispatchGPUCompute(computePass, (meshletCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+      SDL_EndGPUComputePass(computePass);
+      TRACE_END();
+    }
+
+    if (frames % STATS_INTERVAL == 0)
+    {
+      TRACE_BEGIN("count culled meshlets");
+      for (Uint32 i = 0; i < meshletCount; i += 1)
+      {
+        Vector3 center = {meshlets[i].center[0], meshlets[i].center[1], meshlets[i].center[2]};
+        if (!Frustum_TestSphere(&frustum, center, meshlets[i].radius))
+        {
+          outsideTotal += 1;
+        }
+        else if (Meshlet_IsBackfacing(&meshlets[i], cameraPosition))
+        {
+          backfacingTotal += 1;
+        }
+        else
+        {
+          drawnIndexTotal += meshlets[i].indexCount;
+        }
+      }
+      statsFrames += 1;
+      TRACE_END();
+    }
+
+    TRACE_BEGIN("uniforms");
+    SDL_PushGPUVertexUniformData(cmdbuf, 0, &viewproj, sizeof(viewproj));
+    TRACE_END();
+
+    SDL_GPUColorTargetInfo colorTargetInfo = {0};
+    colorTargetInfo.texture = swapchainTexture;
+    colorTargetInfo.clear_color = (SDL_FColor){0.0f, 0.0f, 0.0f, 1.0f};
+    colorTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
+    colorTargetInfo.store_op = SDL_GPU_STOREOP_STORE;
+
+    SDL_GPUDepthStencilTargetInfo depthStencilTargetInfo = {0};
+    depthStencilTargetInfo.texture = DepthTexture;
+    depthStencilTargetInfo.cycle = true;
+    depthStencilTargetInfo.clear_depth = 1;
+    depthStencilTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
+    depthStencilTargetInfo.store_op = SDL_GPU_STOREOP_DONT_CARE;
+    depthStencilTargetInfo.stencil_load_op = SDL_GPU_LOADOP_DONT_CARE;
+    depthStencilTargetInfo.stencil_store_op = SDL_GPU_STOREOP_DONT_CARE;
+
+    TRACE_BEGIN("render pass");
+    SDL_GPURenderPass *renderPass = SDL_BeginGPURenderPass(cmdbuf, &colorTargetInfo, 1, &depthStencilTargetInfo);
+    SDL_BindGPUGraphicsPipeline(renderPass, pipeline);
+    SDL_BindGPUVertexBuffers(renderPass, 0, &(SDL_GPUBufferBinding){.buffer = VertexBuffer, .offset = 0}, 1);
+    SDL_BindGPUIndexBuffer(renderPass, &(SDL_GPUBufferBinding){.buffer = IndexBuffer, .offset = 0}, SDL_GPU_INDEXELEMENTSIZE_32BIT);
+    if (noCull)
+    {
+      SDL_DrawGPUIndexedPrimitives(renderPass, indexCount, 1, 0, 0, 0);
+    }
+    else
+    {
+      // Culled meshlets are draws with no instances, cheap for the GPU's front end to skip
+      SDL_DrawGPUIndexedPrimitivesIndirect(renderPass, DrawBuffer, 0, meshletCount);
+    }
+    SDL_EndGPURenderPass(renderPass);
+    TRACE_END();
+    FrameTarget_Submit(context.Target, cmdbuf);
+    frames += 1;
+  }
+
+  if (statsFrames > 0)
+  {
+    double meshletsCounted = (double)statsFrames * meshletCount;
+    SDL_Log("%.1f%% of the meshlets outside the frustum and %.1f%% facing away on average, %.1f%% of the triangles %s",
+            100.0 * outsideTotal / meshletsCounted, 100.0 * backfacingTotal / meshletsCounted,
+            100.0 * drawnIndexTotal / ((double)statsFrames * indexCount), noCull ? "would be drawn with culling" : "drawn");
+  }
+
+  // cleanup
+  SDL_free(meshlets);
+  SDL_ReleaseGPUBuffer(context.Device, DrawBuffer);
+  SDL_ReleaseGPUBuffer(context.Device, MeshletBuffer);
+  SDL_ReleaseGPUBuffer(context.Device, IndexBuffer);
+  SDL_ReleaseGPUBuffer(context.Device, VertexBuffer);
+  SDL_ReleaseGPUTexture(context.Device, DepthTexture);
+  SDL_ReleaseGPUComputePipeline(context.Device, CullPipeline);
+
+  UploadRing_Destroy(context.Uploads);
+  PipelineRegistry_Destroy(context.Pipelines);
+
+  ReleaseShaderCache(context.Device);
+  FrameTarget_Destroy(context.Target);
+  SDL_DestroyGPUDevice(context.Device);
+  return 0;
+}
@@ -1,5 +1,9 @@
 #include <SDL3/SDL.h>
 #include <assert.h>
+#include "load.h"
+#include "pipeline_registry.h"
+#include "frame_target.h"
+#include "trace.h"
 
 typedef struct Resolution
 {
@@ -11,7 +15,9 @@ typedef struct Context
 {
   SDL_GPUDevice *Device;
   SDL_Window *Window;
+  FrameTarget *Target;
   SDL_GPUGraphicsPipeline *Pipeline;
+  PipelineRegistry *Pipelines;
 } Context;
 const Resolution Resolutions[] =
     {
@@ -25,22 +31,19 @@ const Resolution Resolutions[] =
 uint32_t ResolutionCount = SDL_arraysize(Resolutions);
 
 Sint32 ResolutionIndex;
-// This load shader is different from hello_triangle shader in that it accepts only the name of the shader binary and it will fill the rest of the path
-SDL_GPUShader *LoadShader(
-    SDL_GPUDevice *device,
-    const char *shaderFilename,
-    Uint32 samplerCount,
-    Uint32 uniformBufferCount,
-    Uint32 storageBufferCount,
-    Uint32 storageTextureCount);
-
 Context context = {0};
 
 void Cleanup();
 
-int main(int argc, char const *argv[])
+int main(int argc, char *argv[])
 {
-  if (SDL_Init(SDL_INIT_VIDEO) == false)
+  FrameTargetOptions options;
+  if (!FrameTarget_ParseArgs(argc, argv, "resize", &options))
+  {
+    return 1;
+  }
+
+  if (SDL_Init(FrameTarget_GetInitFlags(&options)) == false)
   {
     SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
     return 1;
@@ -49,7 +52,7 @@ int main(int argc, char const *argv[])
   context.Device = SDL_CreateGPUDevice(
       SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL,
       false,
-      NULL);
+      options.driver);
 
   if (context.Device == NULL)
   {
@@ -57,16 +60,17 @@ int main(int argc, char const *argv[])
     return -1;
   }
 
-  context.Window = SDL_CreateWindow("Resize", 640, 480, SDL_WINDOW_RESIZABLE);
-  if (context.Window == NULL)
+  context.Target = FrameTarget_Create(context.Device, "Resize", 640, 480, SDL_WINDOW_RESIZABLE, &options);
+  if (context.Target == NULL)
   {
-    SDL_Log("CreateWindow failed: %s", SDL_GetError());
     return -1;
   }
+  context.Window = FrameTarget_GetWindow(context.Target);
 
-  if (!SDL_ClaimWindowForGPUDevice(context.Device, context.Window))
+  context.Pipelines = PipelineRegistry_Create(context.Device);
+  if (context.Pipelines == NULL)
   {
-    SDL_Log("GPUClaimWindow failed");
+    SDL_Log("Failed to create pipeline registry!");
     return -1;
   }
 
@@ -87,29 +91,27 @@ int main(int argc, char const *argv[])
   SDL_GPUGraphicsPipelineCreateInfo pipelineCreateInfo = {
       .target_info = {
           .num_color_targets = 1,
-          .color_target_descriptions = (SDL_GPUColorTargetDescription[]){{.format = SDL_GetGPUSwapchainTextureFormat(context.Device, context.Window)}},
+          .color_target_descriptions = (SDL_GPUColorTargetDescription[]){{.format = FrameTarget_GetFormat(context.Target)}},
       },
       .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
       .vertex_shader = vertexShader,
       .fragment_shader = fragmentShader,
       .rasterizer_state.fill_mode = SDL_GPU_FILLMODE_FILL};
-  SDL_GPUGraphicsPipeline *Pipeline = SDL_CreateGPUGraphicsPipeline(context.Device, &pipelineCreateInfo);
+  SDL_GPUGraphicsPipeline *Pipeline = PipelineRegistry_Get(context.Pipelines, &pipelineCreateInfo);
   if (Pipeline == NULL)
   {
     SDL_Log("Failed to create pipeline!");
     return -1;
   }
 
-  SDL_ReleaseGPUShader(context.Device, vertexShader);
-  SDL_ReleaseGPUShader(context.Device, fragmentShader);
-
   SDL_Event event;
   int quit = 0;
 
-  while (!quit)
+  while (!quit && !FrameTarget_IsDone(context.Target))
   {
     bool changeResolution = false;
 
+    TRACE_BEGIN("poll events");
     while (SDL_PollEvent(&event))
     {
       switch (event.type)
@@ -144,8 +146,11 @@ int main(int argc, char const *argv[])
         }
       }
     }
+    TRACE_END();
 
+    TRACE_BEGIN("acquire command buffer");
     SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    TRACE_END();
     if (cmdbuf == NULL)
     {
       SDL_Log("Aquire GPU command buffer failed :%s", SDL_GetError());
@@ -153,7 +158,7 @@ int main(int argc, char const *argv[])
     }
 
     SDL_GPUTexture *swapchainTexture;
-    if (!SDL_WaitAndAcquireGPUSwapchainTexture(cmdbuf, context.Window, &swapchainTexture, NULL, NULL))
+    if (!FrameTarget_Acquire(context.Target, cmdbuf, &swapchainTexture))
     {
       SDL_Log("WaitAndAcquireGPUSwapchainTexture failed: %s", SDL_GetError());
       return -1;
@@ -161,7 +166,7 @@ int main(int argc, char const *argv[])
 
     if (swapchainTexture == NULL)
     {
-      SDL_SubmitGPUCommandBuffer(cmdbuf);
+      FrameTarget_Submit(context.Target, cmdbuf);
       continue;
     }
 
@@ -171,108 +176,26 @@ int main(int argc, char const *argv[])
         .load_op = SDL_GPU_LOADOP_CLEAR,
         .store_op = SDL_GPU_STOREOP_STORE};
 
+    TRACE_BEGIN("render pass");
     SDL_GPURenderPass *renderPass = SDL_BeginGPURenderPass(cmdbuf, &colorTargetInfo, 1, NULL);
     SDL_BindGPUGraphicsPipeline(renderPass, Pipeline);
     SDL_DrawGPUPrimitives(renderPass, 3, 1, 0, 0);
     SDL_EndGPURenderPass(renderPass);
+    TRACE_END();
 
-    SDL_SubmitGPUCommandBuffer(cmdbuf);
+    FrameTarget_Submit(context.Target, cmdbuf);
   }
   Cleanup();
   return 0;
 }
 
-SDL_GPUShader *LoadShader(
-    SDL_GPUDevice *device,
-    const char *shaderFilename,
-    Uint32 samplerCount,
-    Uint32 uniformBufferCount,
-    Uint32 storageBufferCount,
-    Uint32 storageTextureCount)
-{
-  const char *ShaderBinaryBasePath = "./shader-binaries";
-  // Auto-detect the shader stage from the file name for convenience
-  SDL_GPUShaderStage stage;
-  if (SDL_strstr(shaderFilename, ".vert"))
-  {
-    stage = SDL_GPU_SHADERSTAGE_VERTEX;
-  }
-  else if (SDL_strstr(shaderFilename, ".frag"))
-  {
-    stage = SDL_GPU_SHADERSTAGE_FRAGMENT;
-  }
-  else
-  {
-    SDL_Log("Invalid shader stage!");
-    return NULL;
-  }
-
-  char fullPath[1024];
-  SDL_GPUShaderFormat backendFormats = SDL_GetGPUShaderFormats(device);
-  SDL_GPUShaderFormat format = SDL_GPU_SHADERFORMAT_INVALID;
-  const char *entrypoint;
-
-  if (backendFormats & SDL_GPU_SHADERFORMAT_SPIRV)
-  {
-    SDL_snprintf(fullPath, sizeof(fullPath), "%s/spv/%s.spv", ShaderBinaryBasePath, shaderFilename);
-    format = SDL_GPU_SHADERFORMAT_SPIRV;
-    entrypoint = "main";
-  }
-  else if (backendFormats & SDL_GPU_SHADERFORMAT_MSL)
-  {
-    SDL_snprintf(fullPath, sizeof(fullPath), "%s/msl/%s.msl", ShaderBinaryBasePath, shaderFilename);
-    format = SDL_GPU_SHADERFORMAT_MSL;
-    entrypoint = "main0";
-  }
-  else if (backendFormats & SDL_GPU_SHADERFORMAT_DXIL)
-  {
-    SDL_snprintf(fullPath, sizeof(fullPath), "%s/dxil/%s.dxil", ShaderBinaryBasePath, shaderFilename);
-    format = SDL_GPU_SHADERFORMAT_DXIL;
-    entrypoint = "main";
-  }
-  else
-  {
-    SDL_Log("%s", "Unrecognized backend shader format!");
-    return NULL;
-  }
-
-  size_t codeSize;
-  void *code = SDL_LoadFile(fullPath, &codeSize);
-  if (code == NULL)
-  {
-    SDL_Log("Failed to load shader from disk! %s", fullPath);
-    return NULL;
-  }
-
-  SDL_GPUShaderCreateInfo shaderInfo = {
-      .code = code,
-      .code_size = codeSize,
-      .entrypoint = entrypoint,
-      .format = format,
-      .stage = stage,
-      .num_samplers = samplerCount,
-      .num_uniform_buffers = uniformBufferCount,
-      .num_storage_buffers = storageBufferCount,
-      .num_storage_textures = storageTextureCount};
-  SDL_GPUShader *shader = SDL_CreateGPUShader(device, &shaderInfo);
-  if (shader == NULL)
-  {
-    SDL_Log("Failed to create shader!");
-    SDL_free(code);
-    return NULL;
-  }
-  SDL_free(code);
-  return shader;
-}
 void Cleanup()
 {
-  if (context.Device != NULL && context.Pipeline != NULL)
-  {
-    SDL_ReleaseGPUGraphicsPipeline(context.Device, context.Pipeline);
-  }
   if (context.Device != NULL)
   {
-    SDL_DestroyWindow(context.Window);
+    PipelineRegistry_Destroy(context.Pipelines);
+    ReleaseShaderCache(context.Device);
+    FrameTarget_Destroy(context.Target);
     SDL_DestroyGPUDevice(context.Device);
   }
 }
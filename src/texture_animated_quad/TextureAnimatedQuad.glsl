@@ -1,36 +1,40 @@
 #version 450
 
 #ifdef VERTEX
-layout(set = 1, binding = 0) uniform UniformBlock
+// One transform and one color per quad, indexed by the instance
+layout(std430, set = 0, binding = 0) readonly buffer TransformBuffer
 {
-    mat4 MatrixTransform; // Transformation matrix
+    mat4 Transforms[];
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer ColorBuffer
+{
+    vec4 MultiplyColors[];
 };
 
 layout(location = 0) in vec4 inPosition; // Vertex position
 layout(location = 1) in vec2 inTexCoord; // Texture coordinates
 
 layout(location = 0) out vec2 outTexCoord;
+layout(location = 1) flat out vec4 outMultiplyColor;
 
 void main()
 {
     outTexCoord = inTexCoord;
-    gl_Position = MatrixTransform * inPosition; // Transform vertex position
+    outMultiplyColor = MultiplyColors[gl_InstanceIndex];
+    gl_Position = Transforms[gl_InstanceIndex] * inPosition; // Transform vertex position
 }
 #endif
 
 #ifdef FRAGMENT
-layout(set = 3, binding = 0) uniform UniformBlock
-{
-    vec4 MultiplyColor; // Color multiplier
-};
-
 layout(location = 0) in vec2 inTexCoord;
+layout(location = 1) flat in vec4 inMultiplyColor; // Color multiplier
 layout(location = 0) out vec4 outColor;
 
 layout(set = 2, binding = 0) uniform sampler2D texSampler;
 
 void main()
 {
-    outColor = MultiplyColor * texture(texSampler, inTexCoord); // Sample texture and apply color multiplier
+    outColor = inMultiplyColor * texture(texSampler, inTexCoord); // Sample texture and apply color multiplier
 }
 #endif
\ No newline at end of file
@@ -1,17 +1,18 @@
-cbuffer UniformBlock : register(b0, space1)
-{
-    float4x4 MatrixTransform : packoffset(c0);
-};
+// One transform and one color per quad, indexed by the instance
+StructuredBuffer<float4x4> Transforms : register(t0, space0);
+StructuredBuffer<float4> MultiplyColors : register(t1, space0);
 
 struct Input
 {
     float4 Position : TEXCOORD0;
     float2 TexCoord : TEXCOORD1;
+    uint InstanceIndex : SV_InstanceID;
 };
 
 struct Output
 {
     float2 TexCoord : TEXCOORD0;
+    nointerpolation float4 MultiplyColor : TEXCOORD1;
     float4 Position : SV_Position;
 };
 
@@ -19,6 +20,7 @@ Output main(Input input)
 {
     Output output;
     output.TexCoord = input.TexCoord;
-    output.Position = mul(MatrixTransform, input.Position);
+    output.MultiplyColor = MultiplyColors[input.InstanceIndex];
+    output.Position = mul(Transforms[input.InstanceIndex], input.Position);
     return output;
 }
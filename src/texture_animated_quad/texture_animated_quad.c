@@ -4,7 +4,14 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "load.h"
+#include "pipeline_registry.h"
+#include "frame_target.h"
+#include "trace.h"
+#include "upload_ring.h"
+#include "texture_loader.h"
 #include "linear_algebra.h"
+#include "transform_batch.h"
+#include "vertex_format.h"
 
 const char *SamplerNames[] =
     {
@@ -21,33 +28,43 @@ typedef struct FragMultiplyUniform
   float r, g, b, a;
 } FragMultiplyUniform;
 
+// The quads are drawn as instances, their transforms and colors are written straight into the upload ring every frame
+#define QUAD_COUNT 4
+
 typedef struct Context
 {
   SDL_GPUDevice *Device;
   SDL_Window *Window;
+  FrameTarget *Target;
   SDL_GPUGraphicsPipeline *Pipeline;
+  PipelineRegistry *Pipelines;
+  UploadRing *Uploads;
 } Context;
 static SDL_GPUSampler *Samplers[SDL_arraysize(SamplerNames)];
 
-typedef struct PositionColorVertex
-{
-  float x, y, z;
-  Uint8 r, g, b, a;
-} PositionColorVertex;
-typedef struct PositionTextureVertex
-{
-  float x, y, z;
-  float u, v;
-} PositionTextureVertex;
 float rand255()
 {
   return (float)rand() / (float)(RAND_MAX) * 255.0f;
 };
 Context context = {0};
 
-int main()
+int main(int argc, char *argv[])
 {
-  if (SDL_Init(SDL_INIT_VIDEO) == false)
+  FrameTargetOptions options;
+  const char *mipFilterName = "gpu";
+  FrameTargetArg extraArgs[] = {{.name = "--mips", .valueName = "none|gpu|box|kaiser", .text = &mipFilterName}};
+  if (!FrameTarget_ParseArgsEx(argc, argv, "texture_animated_quad", &options, extraArgs, SDL_arraysize(extraArgs)))
+  {
+    return 1;
+  }
+  MipFilter mipFilter;
+  if (!MipFilter_Parse(mipFilterName, &mipFilter))
+  {
+    SDL_Log("Unknown --mips filter '%s', expected none, gpu, box or kaiser", mipFilterName);
+    return 1;
+  }
+
+  if (SDL_Init(FrameTarget_GetInitFlags(&options)) == false)
   {
     SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
     return 1;
@@ -55,7 +72,7 @@ int main()
   context.Device = SDL_CreateGPUDevice(
       SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL,
       false,
-      NULL);
+      options.driver);
 
   if (context.Device == NULL)
   {
@@ -63,36 +80,45 @@ int main()
     return -1;
   }
 
-  context.Window = SDL_CreateWindow("Texture Animated Quad", 640, 480, 0);
-  if (context.Window == NULL)
+  context.Target = FrameTarget_Create(context.Device, "Texture Animated Quad", 640, 480, 0, &options);
+  if (context.Target == NULL)
+  {
+    return -1;
+  }
+  context.Window = FrameTarget_GetWindow(context.Target);
+
+  context.Pipelines = PipelineRegistry_Create(context.Device);
+  if (context.Pipelines == NULL)
   {
-    SDL_Log("CreateWindow failed: %s", SDL_GetError());
+    SDL_Log("Failed to create pipeline registry!");
     return -1;
   }
 
-  if (!SDL_ClaimWindowForGPUDevice(context.Device, context.Window))
+  context.Uploads = UploadRing_Create(context.Device, 4 * 1024 * 1024, 2);
+  if (context.Uploads == NULL)
   {
-    SDL_Log("GPUClaimWindow failed");
+    SDL_Log("Failed to create upload ring!");
     return -1;
   }
+
   // Create the shaders
-  SDL_GPUShader *vertexShader = LoadShader(context.Device, "TexturedQuadWithMatrix.vert", 0, 1, 0, 0);
+  SDL_GPUShader *vertexShader = LoadShader(context.Device, "TexturedQuadWithMatrix.vert", 0, 0, 2, 0);
   if (vertexShader == NULL)
   {
     SDL_Log("Failed to create vertex shader!");
     return -1;
   }
 
-  SDL_GPUShader *fragmentShader = LoadShader(context.Device, "TexturedQuadWithMultiplyColor.frag", 1, 1, 0, 0);
+  SDL_GPUShader *fragmentShader = LoadShader(context.Device, "TexturedQuadWithMultiplyColor.frag", 1, 0, 0, 0);
   if (fragmentShader == NULL)
   {
     SDL_Log("Failed to create fragment shader!");
     return -1;
   }
 
-  // Load the image
-  SDL_Surface *imageData = LoadImage("ravioli.bmp", 4);
-  if (imageData == NULL)
+  // Open the image, its pixels are decoded straight into the upload ring further down
+  ImageFile *imageFile = ImageFile_Open("images/ravioli.bmp");
+  if (imageFile == NULL)
   {
     SDL_Log("Could not load image data!");
     return -1;
@@ -106,7 +132,7 @@ int main()
 
           .color_target_descriptions = (SDL_GPUColorTargetDescription[]){
 
-              {.format = SDL_GetGPUSwapchainTextureFormat(context.Device, context.Window),
+              {.format = FrameTarget_GetFormat(context.Target),
 
                .blend_state = {
 
@@ -177,16 +203,13 @@ int main()
       .fragment_shader = fragmentShader,
   };
 
-  context.Pipeline = SDL_CreateGPUGraphicsPipeline(context.Device, &pipelineCreateInfo);
+  context.Pipeline = PipelineRegistry_Get(context.Pipelines, &pipelineCreateInfo);
   if (context.Pipeline == NULL)
   {
     SDL_Log("Failed to create pipeline!");
     return -1;
   }
 
-  SDL_ReleaseGPUShader(context.Device, vertexShader);
-  SDL_ReleaseGPUShader(context.Device, fragmentShader);
-
   // Create the GPU resources
   SDL_GPUBuffer *VertexBuffer = SDL_CreateGPUBuffer(
       context.Device,
@@ -200,14 +223,17 @@ int main()
           .usage = SDL_GPU_BUFFERUSAGE_INDEX,
           .size = sizeof(Uint16) * 6});
 
-  SDL_GPUTexture *Texture = SDL_CreateGPUTexture(context.Device, &(SDL_GPUTextureCreateInfo){
-                                                                     .type = SDL_GPU_TEXTURETYPE_2D,
-                                                                     .format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
-                                                                     .width = imageData->w,
-                                                                     .height = imageData->h,
-                                                                     .layer_count_or_depth = 1,
-                                                                     .num_levels = 1,
-                                                                     .usage = SDL_GPU_TEXTUREUSAGE_SAMPLER});
+  SDL_GPUBuffer *TransformBuffer = SDL_CreateGPUBuffer(
+      context.Device,
+      &(SDL_GPUBufferCreateInfo){
+          .usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ,
+          .size = sizeof(Matrix4x4) * QUAD_COUNT});
+
+  SDL_GPUBuffer *ColorBuffer = SDL_CreateGPUBuffer(
+      context.Device,
+      &(SDL_GPUBufferCreateInfo){
+          .usage = SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ,
+          .size = sizeof(FragMultiplyUniform) * QUAD_COUNT});
 
   SDL_GPUSampler *Sampler = SDL_CreateGPUSampler(context.Device, &(SDL_GPUSamplerCreateInfo){
                                                                      .min_filter = SDL_GPU_FILTER_NEAREST,
@@ -219,23 +245,28 @@ int main()
                                                                  });
 
   // Set up buffer data
-  SDL_GPUTransferBuffer *bufferTransferBuffer = SDL_CreateGPUTransferBuffer(
-      context.Device,
-      &(SDL_GPUTransferBufferCreateInfo){
-          .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-          .size = (sizeof(PositionTextureVertex) * 4) + (sizeof(Uint16) * 6)});
-
-  PositionTextureVertex *transferData = SDL_MapGPUTransferBuffer(
-      context.Device,
-      bufferTransferBuffer,
-      false);
+  UploadRing_BeginFrame(context.Uploads);
+  PositionTextureVertex *transferData = UploadRing_AllocateBufferUpload(
+      context.Uploads,
+      sizeof(PositionTextureVertex) * 4,
+      VertexBuffer,
+      0);
+  Uint16 *indexData = UploadRing_AllocateBufferUpload(
+      context.Uploads,
+      sizeof(Uint16) * 6,
+      IndexBuffer,
+      0);
+  if (transferData == NULL || indexData == NULL)
+  {
+    SDL_Log("Failed to allocate buffer uploads!");
+    return -1;
+  }
 
   transferData[0] = (PositionTextureVertex){-0.5f, -0.5f, 0, 0, 0};
   transferData[1] = (PositionTextureVertex){0.5f, -0.5f, 0, 1, 0};
   transferData[2] = (PositionTextureVertex){0.5f, 0.5f, 0, 1, 1};
   transferData[3] = (PositionTextureVertex){-0.5f, 0.5f, 0, 0, 1};
 
-  Uint16 *indexData = (Uint16 *)&transferData[4];
   indexData[0] = 0;
   indexData[1] = 1;
   indexData[2] = 2;
@@ -243,66 +274,19 @@ int main()
   indexData[4] = 2;
   indexData[5] = 3;
 
-  SDL_UnmapGPUTransferBuffer(context.Device, bufferTransferBuffer);
-
-  // Set up texture data
-  SDL_GPUTransferBuffer *textureTransferBuffer = SDL_CreateGPUTransferBuffer(
-      context.Device,
-      &(SDL_GPUTransferBufferCreateInfo){
-          .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-          .size = imageData->w * imageData->h * 4});
-
-  Uint8 *textureTransferPtr = SDL_MapGPUTransferBuffer(
-      context.Device,
-      textureTransferBuffer,
-      false);
-  SDL_memcpy(textureTransferPtr, imageData->pixels, imageData->w * imageData->h * 4);
-  SDL_UnmapGPUTransferBuffer(context.Device, textureTransferBuffer);
+  // Set up texture data, with every mip level filled
+  SDL_GPUCommandBuffer *uploadCmdBuf = SDL_AcquireGPUCommandBuffer(context.Device);
+  SDL_GPUTexture *Texture = LoadImageTexture(context.Device, context.Uploads, uploadCmdBuf, imageFile, mipFilter, PIXEL_CONVERT_NONE);
+  if (Texture == NULL)
+  {
+    SDL_Log("Failed to create the texture!");
+    return -1;
+  }
+  SDL_Log("Texture has %u mip levels, filled with the %s filter", mipFilter == MIP_FILTER_NONE ? 1 : Mipmap_GetLevelCount(ImageFile_GetInfo(imageFile)->width, ImageFile_GetInfo(imageFile)->height), MipFilter_GetName(mipFilter));
 
   // Upload the transfer data to the GPU resources
-  SDL_GPUCommandBuffer *uploadCmdBuf = SDL_AcquireGPUCommandBuffer(context.Device);
-  SDL_GPUCopyPass *copyPass = SDL_BeginGPUCopyPass(uploadCmdBuf);
-
-  SDL_UploadToGPUBuffer(
-      copyPass,
-      &(SDL_GPUTransferBufferLocation){
-          .transfer_buffer = bufferTransferBuffer,
-          .offset = 0},
-      &(SDL_GPUBufferRegion){
-          .buffer = VertexBuffer,
-          .offset = 0,
-          .size = sizeof(PositionTextureVertex) * 4},
-      false);
-
-  SDL_UploadToGPUBuffer(
-      copyPass,
-      &(SDL_GPUTransferBufferLocation){
-          .transfer_buffer = bufferTransferBuffer,
-          .offset = sizeof(PositionTextureVertex) * 4},
-      &(SDL_GPUBufferRegion){
-          .buffer = IndexBuffer,
-          .offset = 0,
-          .size = sizeof(Uint16) * 6},
-      false);
-
-  SDL_UploadToGPUTexture(
-      copyPass,
-      &(SDL_GPUTextureTransferInfo){
-          .transfer_buffer = textureTransferBuffer,
-          .offset = 0, /* Zeroes out the rest */
-      },
-      &(SDL_GPUTextureRegion){
-          .texture = Texture,
-          .w = imageData->w,
-          .h = imageData->h,
-          .d = 1},
-      false);
-
-  SDL_DestroySurface(imageData);
-  SDL_EndGPUCopyPass(copyPass);
-  SDL_SubmitGPUCommandBuffer(uploadCmdBuf);
-  SDL_ReleaseGPUTransferBuffer(context.Device, bufferTransferBuffer);
-  SDL_ReleaseGPUTransferBuffer(context.Device, textureTransferBuffer);
+  UploadRing_Submit(context.Uploads, uploadCmdBuf);
+  ImageFile_Close(imageFile);
 
   SDL_Event event;
   int quit = 0;
@@ -310,10 +294,35 @@ int main()
 
   float fallDownAmount = 0;
   float direction = 1.0f;
-  while (!quit)
+
+  // Quads from top-left to bottom-right, positionY and rotationZ/W are updated every frame
+  float positionX[QUAD_COUNT] = {-0.5f, 0.5f, -0.5f, 0.5f};
+  float positionY[QUAD_COUNT];
+  float zeros[QUAD_COUNT] = {0};
+  float ones[QUAD_COUNT] = {1.0f, 1.0f, 1.0f, 1.0f};
+  float rotationZ[QUAD_COUNT];
+  float rotationW[QUAD_COUNT];
+  TransformArrays quads = {
+      .positionX = positionX,
+      .positionY = positionY,
+      .positionZ = zeros,
+      .rotationX = zeros,
+      .rotationY = zeros,
+      .rotationZ = rotationZ,
+      .rotationW = rotationW,
+      .scaleX = ones,
+      .scaleY = ones,
+      .scaleZ = ones};
+  const Matrix4x4 identity = {
+      1, 0, 0, 0,
+      0, 1, 0, 0,
+      0, 0, 1, 0,
+      0, 0, 0, 1};
+  while (!quit && !FrameTarget_IsDone(context.Target))
   {
     bool changeResolution = false;
 
+    TRACE_BEGIN("poll events");
     while (SDL_PollEvent(&event))
     {
       switch (event.type)
@@ -323,7 +332,13 @@ int main()
         break;
       }
     }
+    TRACE_END();
+    // The instance data goes through the ring every frame
+    UploadRing_BeginFrame(context.Uploads);
+
+    TRACE_BEGIN("acquire command buffer");
     SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    TRACE_END();
     if (cmdbuf == NULL)
     {
       SDL_Log("AcquireGPUCommandBuffer failed: %s", SDL_GetError());
@@ -331,7 +346,7 @@ int main()
     }
 
     SDL_GPUTexture *swapchainTexture;
-    if (!SDL_WaitAndAcquireGPUSwapchainTexture(cmdbuf, context.Window, &swapchainTexture, NULL, NULL))
+    if (!FrameTarget_Acquire(context.Target, cmdbuf, &swapchainTexture))
     {
       SDL_Log("WaitAndAcquireGPUSwapchainTexture failed: %s", SDL_GetError());
       return -1;
@@ -341,75 +356,79 @@ int main()
 
     if (swapchainTexture != NULL)
     {
+      // We will draw the same image 4x in a row. We just use the transform matrix to put those images in one of the corners.
+      if (fallDownAmount <= -0.5f || fallDownAmount >= 0.5f)
+      {
+        direction *= -1.0f;
+      }
+
+      fallDownAmount += (1 / 144.0f) * direction;
+
+      TRACE_BEGIN("instance data");
+      const float angles[QUAD_COUNT] = {t, (2.0f * SDL_PI_F) - t, t, t};
+      for (int i = 0; i < QUAD_COUNT; i += 1)
+      {
+        positionY[i] = (i < 2 ? -0.5f : 0.5f) + fallDownAmount;
+        // Rotation around Z as a quaternion
+        rotationZ[i] = SDL_sinf(angles[i] * 0.5f);
+        rotationW[i] = SDL_cosf(angles[i] * 0.5f);
+      }
+      Matrix4x4 *transforms = UploadRing_AllocateBufferUpload(context.Uploads, sizeof(Matrix4x4) * QUAD_COUNT, TransformBuffer, 0);
+      FragMultiplyUniform *colors = UploadRing_AllocateBufferUpload(context.Uploads, sizeof(FragMultiplyUniform) * QUAD_COUNT, ColorBuffer, 0);
+      if (transforms == NULL || colors == NULL)
+      {
+        SDL_Log("Failed to allocate instance data from the upload ring");
+        return -1;
+      }
+      TransformBatch_Compose(NULL, &quads, QUAD_COUNT, &identity, transforms);
+      colors[0] = (FragMultiplyUniform){1.0f, 0.5f + SDL_sinf(t) * 0.5f, 1.0f, 1.0f};
+      colors[1] = (FragMultiplyUniform){1.0f, 0.5f + SDL_cosf(t) * 0.5f, 1.0f, 1.0f};
+      colors[2] = (FragMultiplyUniform){1.0f, 0.5f + SDL_sinf(t) * 0.2f, 1.0f, 1.0f};
+      colors[3] = (FragMultiplyUniform){1.0f, 0.5f + SDL_cosf(t) * 1.0f, 1.0f, 1.0f};
+      UploadRing_Flush(context.Uploads, cmdbuf);
+      TRACE_END();
+
       SDL_GPUColorTargetInfo colorTargetInfo = {0};
       colorTargetInfo.texture = swapchainTexture;
       colorTargetInfo.clear_color = (SDL_FColor){0.0f, 0.0f, 0.0f, 1.0f};
       colorTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
       colorTargetInfo.store_op = SDL_GPU_STOREOP_STORE;
 
+      TRACE_BEGIN("render pass");
       SDL_GPURenderPass *renderPass = SDL_BeginGPURenderPass(cmdbuf, &colorTargetInfo, 1, NULL);
 
       SDL_BindGPUGraphicsPipeline(renderPass, context.Pipeline);
       SDL_BindGPUVertexBuffers(renderPass, 0, &(SDL_GPUBufferBinding){.buffer = VertexBuffer, .offset = 0}, 1);
       SDL_BindGPUIndexBuffer(renderPass, &(SDL_GPUBufferBinding){.buffer = IndexBuffer, .offset = 0}, SDL_GPU_INDEXELEMENTSIZE_16BIT);
+      SDL_BindGPUVertexStorageBuffers(renderPass, 0, (SDL_GPUBuffer *[]){TransformBuffer, ColorBuffer}, 2);
       SDL_BindGPUFragmentSamplers(renderPass, 0, &(SDL_GPUTextureSamplerBinding){.texture = Texture, .sampler = Sampler}, 1);
-
-      // We will draw the same image 4x in a row. We just use the transform matrix to put those images in one of the corners.
-
-      // Top-left
-
-      if (fallDownAmount <= -0.5f || fallDownAmount >= 0.5f)
-      {
-        direction *= -1.0f;
-      }
-
-      fallDownAmount += (1 / 144.0f) * direction;
-
-      Matrix4x4 matrixUniform = Matrix4x4_Multiply(
-          Matrix4x4_CreateRotationZ(t),
-          Matrix4x4_CreateTranslation(-0.5f, -0.5f + fallDownAmount, 0));
-      SDL_PushGPUVertexUniformData(cmdbuf, 0, &matrixUniform, sizeof(matrixUniform));
-      SDL_PushGPUFragmentUniformData(cmdbuf, 0, &(FragMultiplyUniform){1.0f, 0.5f + SDL_sinf(t) * 0.5f, 1.0f, 1.0f}, sizeof(FragMultiplyUniform));
-      SDL_DrawGPUIndexedPrimitives(renderPass, 6, 1, 0, 0, 0);
-
-      // Top-right
-      matrixUniform = Matrix4x4_Multiply(
-          Matrix4x4_CreateRotationZ((2.0f * SDL_PI_F) - t),
-          Matrix4x4_CreateTranslation(0.5f, -0.5f + fallDownAmount, 0));
-      SDL_PushGPUVertexUniformData(cmdbuf, 0, &matrixUniform, sizeof(matrixUniform));
-      SDL_PushGPUFragmentUniformData(cmdbuf, 0, &(FragMultiplyUniform){1.0f, 0.5f + SDL_cosf(t) * 0.5f, 1.0f, 1.0f}, sizeof(FragMultiplyUniform));
-      SDL_DrawGPUIndexedPrimitives(renderPass, 6, 1, 0, 0, 0);
-
-      // Bottom-left
-      matrixUniform = Matrix4x4_Multiply(
-          Matrix4x4_CreateRotationZ(t),
-          Matrix4x4_CreateTranslation(-0.5f, 0.5f + fallDownAmount, 0));
-      SDL_PushGPUVertexUniformData(cmdbuf, 0, &matrixUniform, sizeof(matrixUniform));
-      SDL_PushGPUFragmentUniformData(cmdbuf, 0, &(FragMultiplyUniform){1.0f, 0.5f + SDL_sinf(t) * 0.2f, 1.0f, 1.0f}, sizeof(FragMultiplyUniform));
-      SDL_DrawGPUIndexedPrimitives(renderPass, 6, 1, 0, 0, 0);
-
-      // Bottom-right
-      matrixUniform = Matrix4x4_Multiply(
-          Matrix4x4_CreateRotationZ(t),
-          Matrix4x4_CreateTranslation(0.5f, 0.5f + fallDownAmount, 0));
-      SDL_PushGPUVertexUniformData(cmdbuf, 0, &matrixUniform, sizeof(matrixUniform));
-      SDL_PushGPUFragmentUniformData(cmdbuf, 0, &(FragMultiplyUniform){1.0f, 0.5f + SDL_cosf(t) * 1.0f, 1.0f, 1.0f}, sizeof(FragMultiplyUniform));
-      SDL_DrawGPUIndexedPrimitives(renderPass, 6, 1, 0, 0, 0);
+      SDL_DrawGPUIndexedPrimitives(renderPass, 6, QUAD_COUNT, 0, 0, 0);
 
       SDL_EndGPURenderPass(renderPass);
+      TRACE_END();
     }
 
-    SDL_SubmitGPUCommandBuffer(cmdbuf);
+    UploadRing_EndFrame(context.Uploads, FrameTarget_SubmitAndAcquireFence(context.Target, cmdbuf));
+
+    UploadRingStats uploadStats = UploadRing_GetStats(context.Uploads);
+    if (uploadStats.stalls > 0)
+    {
+      SDL_Log("Upload ring stalled for %.3f ms", uploadStats.stallNS / 1e6);
+    }
   }
 
   // cleanup
-  SDL_ReleaseGPUGraphicsPipeline(context.Device, context.Pipeline);
   SDL_ReleaseGPUBuffer(context.Device, VertexBuffer);
   SDL_ReleaseGPUBuffer(context.Device, IndexBuffer);
+  SDL_ReleaseGPUBuffer(context.Device, TransformBuffer);
+  SDL_ReleaseGPUBuffer(context.Device, ColorBuffer);
   SDL_ReleaseGPUTexture(context.Device, Texture);
   SDL_ReleaseGPUSampler(context.Device, Sampler);
 
-  SDL_ReleaseGPUGraphicsPipeline(context.Device, context.Pipeline);
+  PipelineRegistry_Destroy(context.Pipelines);
+  ReleaseShaderCache(context.Device);
+  // After the target, whose fence tracker still polls the fences the ring owns
+  FrameTarget_Destroy(context.Target);
+  UploadRing_Destroy(context.Uploads);
   SDL_DestroyGPUDevice(context.Device);
-  SDL_DestroyWindow(context.Window);
 }
@@ -0,0 +1,431 @@
+#include <SDL3/SDL.h>
+#include "load.h"
+#include "pipeline_registry.h"
+#include "frame_target.h"
+#include "trace.h"
+#include "upload_ring.h"
+#include "texture_loader.h"
+#include "vertex_format.h"
+
+// A stress test for texture minification: a grid of small quads, each showing the whole of a large texture, drawn several times
+// over with texture_quad's TexturedQuad pipeline and a trilinear sampler. It steps through the mip filters, one texture each:
+// without mips every pixel fetches texels hundreds of bytes apart in level 0 and the texture cache misses on almost every fetch,
+// with mips the sampler reads a level about the size of a quad, which stays in the cache.
+// Run it with --offscreen so vsync doesn't cap the frame rate; each step logs the frame time and the level the quads read.
+//   --texture-size N  side of the generated noise texture, 2048 by default
+//   --image NAME      minify images/NAME instead
+//   --quads N         quads per side of the grid, up to 128
+//   --layers N        times the grid is drawn every frame
+//   --codec bc1|bc3|bc7  add a last step with the box filtered chain block compressed, a quarter to an eighth of the bytes to fetch
+#define DEFAULT_TEXTURE_SIZE 2048
+#define DEFAULT_QUADS 64
+#define MAX_QUADS 128
+#define DEFAULT_LAYERS 8
+#define FRAMES_PER_STEP 200
+
+typedef struct Context
+{
+  SDL_GPUDevice *Device;
+  SDL_Window *Window;
+  FrameTarget *Target;
+  SDL_GPUGraphicsPipeline *Pipeline;
+  PipelineRegistry *Pipelines;
+  UploadRing *Uploads;
+} Context;
+
+Context context = {0};
+
+static const char *GetStepName(int step, TextureCodec codec)
+{
+  return step < MIP_FILTER_COUNT ? MipFilter_GetName((MipFilter)step) : TextureCodec_GetName(codec);
+}
+
+// The box filtered chain of an ABGR8888 surface encoded with codec, level after level as LoadEncodedTexture takes it
+static Uint8 *EncodeChain(const SDL_Surface *surface, TextureCodec codec, Uint32 levelCount)
+{
+  Uint32 width = surface->w;
+  Uint32 height = surface->h;
+  Uint8 *chain = SDL_malloc(Mipmap_GetChainSize(width, height, levelCount));
+  Uint8 *encoded = SDL_malloc(TextureCodec_GetChainSize(codec, width, height, levelCount));
+  if (chain == NULL || encoded == NULL)
+  {
+    SDL_free(chain);
+    SDL_free(encoded);
+    return NULL;
+  }
+  SDL_memcpy(chain, surface->pixels, (size_t)width * height * 4);
+  Uint8 *level = chain;
+  Uint8 *out = encoded;
+  for (Uint32 i = 0; i < levelCount; i += 1)
+  {
+    Uint32 levelWidth = SDL_max(width >> i, 1);
+    Uint32 levelHeight = SDL_max(height >> i, 1);
+    TextureCodec_Encode(codec, level, levelWidth, levelHeight, out);
+    out += TextureCodec_GetLevelSize(codec, levelWidth, levelHeight);
+    Uint8 *next = level + (size_t)levelWidth * levelHeight * 4;
+    if (i + 1 < levelCount)
+    {
+      Mipmap_Downsample(level, levelWidth, levelHeight, next, MIP_FILTER_BOX);
+    }
+    level = next;
+  }
+  SDL_free(chain);
+  return encoded;
+}
+
+// Every texel its own color, so a fetch that skips texels can't be served by the one before
+static SDL_Surface *CreateNoiseSurface(Uint32 size)
+{
+  SDL_Surface *surface = SDL_CreateSurface(size, size, SDL_PIXELFORMAT_ABGR8888);
+  if (surface == NULL)
+  {
+    SDL_Log("Failed to create a %ux%u surface: %s", size, size, SDL_GetError());
+    return NULL;
+  }
+  for (Uint32 y = 0; y < size; y += 1)
+  {
+    Uint32 *row = (Uint32 *)((Uint8 *)surface->pixels + (size_t)y * surface->pitch);
+    for (Uint32 x = 0; x < size; x += 1)
+    {
+      Uint32 hash = (x * 73856093u) ^ (y * 19349663u);
+      hash ^= hash >> 13;
+      hash *= 0x5bd1e995u;
+      hash ^= hash >> 15;
+      row[x] = hash | 0xFF000000u;
+    }
+  }
+  return surface;
+}
+
+int main(int argc, char *argv[])
+{
+  FrameTargetOptions options;
+  Uint32 textureSize = DEFAULT_TEXTURE_SIZE;
+  Uint32 quads = DEFAULT_QUADS;
+  Uint32 layers = DEFAULT_LAYERS;
+  const char *imageName = NULL;
+  const char *codecName = NULL;
+  FrameTargetArg extraArgs[] = {
+      {.name = "--texture-size", .valueName = "N", .value = &textureSize},
+      {.name = "--image", .valueName = "NAME", .text = &imageName},
+      {.name = "--quads", .valueName = "N", .value = &quads},
+      {.name = "--layers", .valueName = "N", .value = &layers},
+      {.name = "--codec", .valueName = "bc1|bc3|bc7", .text = &codecName}};
+  if (!FrameTarget_ParseArgsEx(argc, argv, "texture_minify", &options, extraArgs, SDL_arraysize(extraArgs)))
+  {
+    return 1;
+  }
+  if (quads == 0 || quads > MAX_QUADS || layers == 0 || textureSize == 0)
+  {
+    SDL_Log("--quads takes 1 to %u, --layers and --texture-size at least 1", MAX_QUADS);
+    return 1;
+  }
+  TextureCodec codec = TEXTURE_CODEC_RGBA8;
+  if (codecName != NULL && (!TextureCodec_Parse(codecName, &codec) || codec == TEXTURE_CODEC_RGBA8))
+  {
+    SDL_Log("Unknown --codec '%s', expected bc1, bc3 or bc7", codecName);
+    return 1;
+  }
+  int stepCount = MIP_FILTER_COUNT + (codecName != NULL ? 1 : 0);
+
+  if (SDL_Init(FrameTarget_GetInitFlags(&options)) == false)
+  {
+    SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
+    return 1;
+  }
+  context.Device = SDL_CreateGPUDevice(
+      SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL,
+      false,
+      options.driver);
+
+  if (context.Device == NULL)
+  {
+    SDL_Log("GPUCreateDevice failed");
+    return -1;
+  }
+
+  context.Target = FrameTarget_Create(context.Device, "Texture Minify", 1280, 720, 0, &options);
+  if (context.Target == NULL)
+  {
+    return -1;
+  }
+  context.Window = FrameTarget_GetWindow(context.Target);
+
+  context.Pipelines = PipelineRegistry_Create(context.Device);
+  if (context.Pipelines == NULL)
+  {
+    SDL_Log("Failed to create pipeline registry!");
+    return -1;
+  }
+
+  SDL_Surface *imageData = imageName != NULL ? LoadImage(imageName, 4) : CreateNoiseSurface(textureSize);
+  if (imageData == NULL)
+  {
+    SDL_Log("Could not load image data!");
+    return -1;
+  }
+  Uint32 width = imageData->w;
+  Uint32 height = imageData->h;
+  Uint32 levelCount = Mipmap_GetLevelCount(width, height);
+
+  // One texture per frame of the ring, the largest needs its whole chain plus the alignment of every level.
+  // A block compressed chain is smaller, or as large if the device can't sample it and it's decoded.
+  Uint32 chainSize = Mipmap_GetChainSize(width, height, levelCount);
+  Uint32 vertexBytes = sizeof(PositionTextureVertex) * 4 * quads * quads;
+  Uint32 indexBytes = sizeof(Uint16) * 6 * quads * quads;
+  context.Uploads = UploadRing_Create(context.Device, chainSize + vertexBytes + indexBytes + levelCount * 512 + 64 * 1024, 1);
+  if (context.Uploads == NULL)
+  {
+    SDL_Log("Failed to create upload ring!");
+    return -1;
+  }
+
+  SDL_GPUShader *vertexShader = LoadShader(context.Device, "TexturedQuad.vert", 0, 0, 0, 0);
+  if (vertexShader == NULL)
+  {
+    SDL_Log("Failed to create vertex shader!");
+    return -1;
+  }
+
+  SDL_GPUShader *fragmentShader = LoadShader(context.Device, "TexturedQuad.frag", 1, 0, 0, 0);
+  if (fragmentShader == NULL)
+  {
+    SDL_Log("Failed to create fragment shader!");
+    return -1;
+  }
+
+  SDL_GPUGraphicsPipelineCreateInfo pipelineCreateInfo = {
+      .target_info = {
+          .num_color_targets = 1,
+          .color_target_descriptions = (SDL_GPUColorTargetDescription[]){{.format = FrameTarget_GetFormat(context.Target)}}},
+      .vertex_input_state = (SDL_GPUVertexInputState){
+          .num_vertex_buffers = 1,
+          .vertex_buffer_descriptions = (SDL_GPUVertexBufferDescription[]){{
+              .slot = 0,
+              .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+              .instance_step_rate = 0,
+              .pitch = sizeof(PositionTextureVertex)}},
+          .num_vertex_attributes = 2,
+          .vertex_attributes = (SDL_GPUVertexAttribute[]){
+              {.buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, .location = 0, .offset = 0},
+              {.buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2, .location = 1, .offset = sizeof(float) * 3}}},
+      .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+      .vertex_shader = vertexShader,
+      .fragment_shader = fragmentShader};
+
+  // Built on a worker thread while the textures are filtered, PipelineRegistry_Get below picks it up
+  if (!PipelineRegistry_Prewarm(context.Pipelines, &pipelineCreateInfo, 1, 1))
+  {
+    SDL_Log("Failed to start building the pipeline!");
+    return -1;
+  }
+
+  // texture_quad's LinearClamp: trilinear, blending the two levels nearest the quad's footprint
+  SDL_GPUSampler *Sampler = SDL_CreateGPUSampler(context.Device, &(SDL_GPUSamplerCreateInfo){
+                                                                     .min_filter = SDL_GPU_FILTER_LINEAR,
+                                                                     .mag_filter = SDL_GPU_FILTER_LINEAR,
+                                                                     .mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_LINEAR,
+                                                                     .address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+                                                                     .address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+                                                                     .address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+                                                                 });
+  SDL_GPUBuffer *VertexBuffer = SDL_CreateGPUBuffer(
+      context.Device,
+      &(SDL_GPUBufferCreateInfo){.usage = SDL_GPU_BUFFERUSAGE_VERTEX, .size = vertexBytes});
+  SDL_GPUBuffer *IndexBuffer = SDL_CreateGPUBuffer(
+      context.Device,
+      &(SDL_GPUBufferCreateInfo){.usage = SDL_GPU_BUFFERUSAGE_INDEX, .size = indexBytes});
+  if (Sampler == NULL || VertexBuffer == NULL || IndexBuffer == NULL)
+  {
+    SDL_Log("Failed to create the GPU resources: %s", SDL_GetError());
+    return -1;
+  }
+
+  // The textures go up one per ring frame, BeginFrame waits until the GPU is done with the last one's transfer buffer
+  SDL_GPUTexture *Textures[MIP_FILTER_COUNT + 1] = {0};
+  Uint64 loadNS[MIP_FILTER_COUNT + 1] = {0};
+  bool decoded = false;
+  for (int step = 0; step < stepCount; step += 1)
+  {
+    UploadRing_BeginFrame(context.Uploads);
+    SDL_GPUCommandBuffer *uploadCmdBuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    if (uploadCmdBuf == NULL)
+    {
+      SDL_Log("AcquireGPUCommandBuffer failed: %s", SDL_GetError());
+      return -1;
+    }
+    if (step == 0)
+    {
+      // Each quad covers the whole texture, in rows from the top left
+      PositionTextureVertex *vertices = UploadRing_AllocateBufferUpload(context.Uploads, vertexBytes, VertexBuffer, 0);
+      Uint16 *indices = UploadRing_AllocateBufferUpload(context.Uploads, indexBytes, IndexBuffer, 0);
+      if (vertices == NULL || indices == NULL)
+      {
+        SDL_Log("Failed to allocate buffer uploads!");
+        return -1;
+      }
+      float quadSize = 2.0f / quads;
+      for (Uint32 i = 0; i < quads * quads; i += 1)
+      {
+        float left = -1.0f + (i % quads) * quadSize;
+        float top = 1.0f - (i / quads) * quadSize;
+        vertices[i * 4 + 0] = (PositionTextureVertex){left, top, 0, 0, 0};
+        vertices[i * 4 + 1] = (PositionTextureVertex){left + quadSize, top, 0, 1, 0};
+        vertices[i * 4 + 2] = (PositionTextureVertex){left + quadSize, top - quadSize, 0, 1, 1};
+        vertices[i * 4 + 3] = (PositionTextureVertex){left, top - quadSize, 0, 0, 1};
+        Uint16 first = (Uint16)(i * 4);
+        Uint16 quad[6] = {first, first + 1, first + 2, first, first + 2, first + 3};
+        SDL_memcpy(indices + i * 6, quad, sizeof(quad));
+      }
+    }
+    Uint64 startNS = SDL_GetTicksNS();
+    if (step < MIP_FILTER_COUNT)
+    {
+      Textures[step] = LoadTexture(context.Device, context.Uploads, uploadCmdBuf, imageData, (MipFilter)step);
+    }
+    else
+    {
+      Uint8 *encoded = EncodeChain(imageData, codec, levelCount);
+      if (encoded != NULL)
+      {
+        Textures[step] = LoadEncodedTexture(context.Device, context.Uploads, codec, width, height, levelCount, encoded, &decoded);
+        SDL_free(encoded);
+      }
+    }
+    loadNS[step] = SDL_GetTicksNS() - startNS;
+    UploadRing_Submit(context.Uploads, uploadCmdBuf);
+    if (Textures[step] == NULL)
+    {
+      SDL_Log("Failed to create the texture!");
+      return -1;
+    }
+  }
+  SDL_DestroySurface(imageData);
+
+  context.Pipeline = PipelineRegistry_Get(context.Pipelines, &pipelineCreateInfo);
+  if (context.Pipeline == NULL)
+  {
+    SDL_Log("Failed to create pipeline!");
+    return -1;
+  }
+
+  int targetWidth, targetHeight;
+  FrameTarget_GetSize(context.Target, &targetWidth, &targetHeight);
+  // The level whose texels are about the size of a quad's pixels, where a trilinear sampler reads
+  float quadPixels = SDL_max(SDL_min(targetWidth, targetHeight) / (float)quads, 1.0f);
+  Uint32 readLevel = 0;
+  while (readLevel + 1 < levelCount && (SDL_max(width, height) >> (readLevel + 1)) >= quadPixels)
+  {
+    readLevel += 1;
+  }
+  Uint32 readLevelBytes = SDL_max(width >> readLevel, 1) * SDL_max(height >> readLevel, 1) * 4;
+  SDL_Log("%ux%u texture with %u levels on %ux%u quads of about %.0f pixels, %u layers: level 0 is %.1f KB, the quads read level %u, %.1f KB",
+          width, height, levelCount, quads, quads, quadPixels, layers, width * height * 4 / 1024.0, readLevel, readLevelBytes / 1024.0);
+  for (int step = 0; step < stepCount; step += 1)
+  {
+    SDL_Log("  %-6s texture built in %.2f ms of CPU", GetStepName(step, codec), loadNS[step] / 1e6);
+  }
+  if (codecName != NULL)
+  {
+    SDL_Log("  %s level %u is %.1f KB%s", codecName, readLevel,
+            TextureCodec_GetLevelSize(codec, SDL_max(width >> readLevel, 1), SDL_max(height >> readLevel, 1)) / 1024.0,
+            decoded ? ", but the device can't sample it and it was decoded" : "");
+  }
+
+  SDL_Event event;
+  int quit = 0;
+  int step = 0;
+  Uint32 stepFrames = 0;
+  double noMipsMS = 0.0;
+  SDL_WaitForGPUIdle(context.Device);
+  Uint64 stepStartNS = SDL_GetTicksNS();
+
+  while (!quit && !FrameTarget_IsDone(context.Target))
+  {
+    if (stepFrames == FRAMES_PER_STEP)
+    {
+      // Only the GPU's time counts, so wait for it to finish the step's frames
+      SDL_WaitForGPUIdle(context.Device);
+      double frameMS = (SDL_GetTicksNS() - stepStartNS) / 1e6 / stepFrames;
+      if (step == MIP_FILTER_NONE)
+      {
+        noMipsMS = frameMS;
+      }
+      SDL_Log("%-6s: %.3f ms per frame, %.2fx the time without mips", GetStepName(step, codec), frameMS, frameMS / noMipsMS);
+      step += 1;
+      if (step == stepCount)
+      {
+        break;
+      }
+      stepFrames = 0;
+      stepStartNS = SDL_GetTicksNS();
+    }
+
+    TRACE_BEGIN("poll events");
+    while (SDL_PollEvent(&event))
+    {
+      switch (event.type)
+      {
+      case SDL_EVENT_QUIT:
+        quit = true;
+        break;
+      }
+    }
+    TRACE_END();
+
+    TRACE_BEGIN("acquire command buffer");
+    SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    TRACE_END();
+    if (cmdbuf == NULL)
+    {
+      SDL_Log("AcquireGPUCommandBuffer failed: %s", SDL_GetError());
+      return -1;
+    }
+
+    SDL_GPUTexture *swapchainTexture;
+    if (!FrameTarget_Acquire(context.Target, cmdbuf, &swapchainTexture))
+    {
+      SDL_Log("WaitAndAcquireGPUSwapchainTexture failed: %s", SDL_GetError());
+      return -1;
+    }
+
+    if (swapchainTexture != NULL)
+    {
+      SDL_GPUColorTargetInfo colorTargetInfo = {0};
+      colorTargetInfo.texture = swapchainTexture;
+      colorTargetInfo.clear_color = (SDL_FColor){0.0f, 0.0f, 0.0f, 1.0f};
+      colorTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
+      colorTargetInfo.store_op = SDL_GPU_STOREOP_STORE;
+
+      TRACE_BEGIN("render pass");
+      SDL_GPURenderPass *renderPass = SDL_BeginGPURenderPass(cmdbuf, &colorTargetInfo, 1, NULL);
+      SDL_BindGPUGraphicsPipeline(renderPass, context.Pipeline);
+      SDL_BindGPUVertexBuffers(renderPass, 0, &(SDL_GPUBufferBinding){.buffer = VertexBuffer, .offset = 0}, 1);
+      SDL_BindGPUIndexBuffer(renderPass, &(SDL_GPUBufferBinding){.buffer = IndexBuffer, .offset = 0}, SDL_GPU_INDEXELEMENTSIZE_16BIT);
+      SDL_BindGPUFragmentSamplers(renderPass, 0, &(SDL_GPUTextureSamplerBinding){.texture = Textures[step], .sampler = Sampler}, 1);
+      // The vertex shader ignores the instance, every layer lands on the same pixels and samples the texture again
+      SDL_DrawGPUIndexedPrimitives(renderPass, 6 * quads * quads, layers, 0, 0, 0);
+      SDL_EndGPURenderPass(renderPass);
+      TRACE_END();
+      stepFrames += 1;
+    }
+
+    FrameTarget_Submit(context.Target, cmdbuf);
+  }
+
+  // cleanup
+  for (int i = 0; i < stepCount; i += 1)
+  {
+    SDL_ReleaseGPUTexture(context.Device, Textures[i]);
+  }
+  SDL_ReleaseGPUSampler(context.Device, Sampler);
+  SDL_ReleaseGPUBuffer(context.Device, VertexBuffer);
+  SDL_ReleaseGPUBuffer(context.Device, IndexBuffer);
+
+  UploadRing_Destroy(context.Uploads);
+  PipelineRegistry_LogStats(context.Pipelines);
+  PipelineRegistry_Destroy(context.Pipelines);
+  ReleaseShaderCache(context.Device);
+  FrameTarget_Destroy(context.Target);
+  SDL_DestroyGPUDevice(context.Device);
+}
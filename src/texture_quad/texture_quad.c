@@ -4,6 +4,12 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "load.h"
+#include "pipeline_registry.h"
+#include "frame_target.h"
+#include "trace.h"
+#include "upload_ring.h"
+#include "texture_loader.h"
+#include "vertex_format.h"
 
 const char *SamplerNames[] =
     {
@@ -18,29 +24,46 @@ typedef struct Context
 {
   SDL_GPUDevice *Device;
   SDL_Window *Window;
+  FrameTarget *Target;
   SDL_GPUGraphicsPipeline *Pipeline;
+  PipelineRegistry *Pipelines;
+  UploadRing *Uploads;
 } Context;
 static SDL_GPUSampler *Samplers[SDL_arraysize(SamplerNames)];
 
-typedef struct PositionColorVertex
-{
-  float x, y, z;
-  Uint8 r, g, b, a;
-} PositionColorVertex;
-typedef struct PositionTextureVertex
-{
-  float x, y, z;
-  float u, v;
-} PositionTextureVertex;
 float rand255()
 {
   return (float)rand() / (float)(RAND_MAX) * 255.0f;
 };
 Context context = {0};
 
-int main()
+int main(int argc, char *argv[])
 {
-  if (SDL_Init(SDL_INIT_VIDEO) == false)
+  FrameTargetOptions options;
+  const char *mipFilterName = "gpu";
+  const char *texturePath = NULL;
+  bool premultiply = false;
+  FrameTargetArg extraArgs[] = {
+      {.name = "--mips", .valueName = "none|gpu|box|kaiser", .text = &mipFilterName},
+      {.name = "--texture", .valueName = "PATH.tex", .text = &texturePath},
+      {.name = "--premultiply", .flag = &premultiply}};
+  if (!FrameTarget_ParseArgsEx(argc, argv, "texture_quad", &options, extraArgs, SDL_arraysize(extraArgs)))
+  {
+    return 1;
+  }
+  MipFilter mipFilter;
+  if (!MipFilter_Parse(mipFilterName, &mipFilter))
+  {
+    SDL_Log("Unknown --mips filter '%s', expected none, gpu, box or kaiser", mipFilterName);
+    return 1;
+  }
+  if (premultiply && texturePath != NULL)
+  {
+    SDL_Log("--premultiply only applies to the BMP, a baked texture is drawn as it was cooked");
+    premultiply = false;
+  }
+
+  if (SDL_Init(FrameTarget_GetInitFlags(&options)) == false)
   {
     SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
     return 1;
@@ -48,7 +71,7 @@ int main()
   context.Device = SDL_CreateGPUDevice(
       SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL,
       false,
-      NULL);
+      options.driver);
 
   if (context.Device == NULL)
   {
@@ -56,18 +79,34 @@ int main()
     return -1;
   }
 
-  context.Window = SDL_CreateWindow("Texture Quad", 640, 480, 0);
-  if (context.Window == NULL)
+  context.Target = FrameTarget_Create(context.Device, "Texture Quad", 640, 480, 0, &options);
+  if (context.Target == NULL)
+  {
+    return -1;
+  }
+  context.Window = FrameTarget_GetWindow(context.Target);
+
+  context.Pipelines = PipelineRegistry_Create(context.Device);
+  if (context.Pipelines == NULL)
   {
-    SDL_Log("CreateWindow failed: %s", SDL_GetError());
+    SDL_Log("Failed to create pipeline registry!");
     return -1;
   }
 
-  if (!SDL_ClaimWindowForGPUDevice(context.Device, context.Window))
+  // A baked texture decoded on the CPU takes up to 8 times its file's size in transfer memory
+  Uint32 uploadSize = 4 * 1024 * 1024;
+  SDL_PathInfo textureInfo;
+  if (texturePath != NULL && SDL_GetPathInfo(texturePath, &textureInfo))
+  {
+    uploadSize += (Uint32)SDL_min(textureInfo.size * 8, 512 * 1024 * 1024);
+  }
+  context.Uploads = UploadRing_Create(context.Device, uploadSize, 2);
+  if (context.Uploads == NULL)
   {
-    SDL_Log("GPUClaimWindow failed");
+    SDL_Log("Failed to create upload ring!");
     return -1;
   }
+
   // Create the shaders
   SDL_GPUShader *vertexShader = LoadShader(context.Device, "TexturedQuad.vert", 0, 0, 0, 0);
   if (vertexShader == NULL)
@@ -83,9 +122,9 @@ int main()
     return -1;
   }
 
-  // Load the image
-  SDL_Surface *imageData = LoadImage("ravioli.bmp", 4);
-  if (imageData == NULL)
+  // Open the image, its pixels (or a baked texture's blocks) are read straight into the upload ring further down
+  ImageFile *imageFile = texturePath == NULL ? ImageFile_Open("images/ravioli.bmp") : NULL;
+  if (texturePath == NULL && imageFile == NULL)
   {
     SDL_Log("Could not load image data!");
     return -1;
@@ -98,7 +137,16 @@ int main()
 
           .color_target_descriptions = (SDL_GPUColorTargetDescription[]){{
 
-              .format = SDL_GetGPUSwapchainTextureFormat(context.Device, context.Window)
+              .format = FrameTarget_GetFormat(context.Target),
+              // A premultiplied texture is blended over the clear color with its alpha already in the colors
+              .blend_state = {
+                  .enable_blend = premultiply,
+                  .src_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
+                  .dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                  .color_blend_op = SDL_GPU_BLENDOP_ADD,
+                  .src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
+                  .dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                  .alpha_blend_op = SDL_GPU_BLENDOP_ADD}
 
           }},
 
@@ -149,16 +197,13 @@ int main()
       .vertex_shader = vertexShader,
       .fragment_shader = fragmentShader};
 
-  context.Pipeline = SDL_CreateGPUGraphicsPipeline(context.Device, &pipelineCreateInfo);
+  context.Pipeline = PipelineRegistry_Get(context.Pipelines, &pipelineCreateInfo);
   if (context.Pipeline == NULL)
   {
     SDL_Log("Failed to create pipeline!");
     return -1;
   }
 
-  SDL_ReleaseGPUShader(context.Device, vertexShader);
-  SDL_ReleaseGPUShader(context.Device, fragmentShader);
-
   // PointClamp
   Samplers[0] = SDL_CreateGPUSampler(context.Device, &(SDL_GPUSamplerCreateInfo){
                                                          .min_filter = SDL_GPU_FILTER_NEAREST,
@@ -231,37 +276,29 @@ int main()
           .usage = SDL_GPU_BUFFERUSAGE_INDEX,
           .size = sizeof(Uint16) * 6});
 
-  SDL_GPUTexture *Texture = SDL_CreateGPUTexture(context.Device, &(SDL_GPUTextureCreateInfo){
-                                                                     .type = SDL_GPU_TEXTURETYPE_2D,
-                                                                     .format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
-                                                                     .width = imageData->w,
-                                                                     .height = imageData->h,
-                                                                     .layer_count_or_depth = 1,
-                                                                     .num_levels = 1,
-                                                                     .usage = SDL_GPU_TEXTUREUSAGE_SAMPLER});
-  SDL_SetGPUTextureName(
-      context.Device,
-      Texture,
-      "Ravioli Texture 🖼️");
-
   // Set up buffer data
-  SDL_GPUTransferBuffer *bufferTransferBuffer = SDL_CreateGPUTransferBuffer(
-      context.Device,
-      &(SDL_GPUTransferBufferCreateInfo){
-          .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-          .size = (sizeof(PositionTextureVertex) * 4) + (sizeof(Uint16) * 6)});
-
-  PositionTextureVertex *transferData = SDL_MapGPUTransferBuffer(
-      context.Device,
-      bufferTransferBuffer,
-      false);
+  UploadRing_BeginFrame(context.Uploads);
+  PositionTextureVertex *transferData = UploadRing_AllocateBufferUpload(
+      context.Uploads,
+      sizeof(PositionTextureVertex) * 4,
+      VertexBuffer,
+      0);
+  Uint16 *indexData = UploadRing_AllocateBufferUpload(
+      context.Uploads,
+      sizeof(Uint16) * 6,
+      IndexBuffer,
+      0);
+  if (transferData == NULL || indexData == NULL)
+  {
+    SDL_Log("Failed to allocate buffer uploads!");
+    return -1;
+  }
 
   transferData[0] = (PositionTextureVertex){-1, 1, 0, 0, 0};
   transferData[1] = (PositionTextureVertex){1, 1, 0, 4, 0};
   transferData[2] = (PositionTextureVertex){1, -1, 0, 4, 4};
   transferData[3] = (PositionTextureVertex){-1, -1, 0, 0, 4};
 
-  Uint16 *indexData = (Uint16 *)&transferData[4];
   indexData[0] = 0;
   indexData[1] = 1;
   indexData[2] = 2;
@@ -269,66 +306,41 @@ int main()
   indexData[4] = 2;
   indexData[5] = 3;
 
-  SDL_UnmapGPUTransferBuffer(context.Device, bufferTransferBuffer);
-
-  // Set up texture data
-  SDL_GPUTransferBuffer *textureTransferBuffer = SDL_CreateGPUTransferBuffer(
-      context.Device,
-      &(SDL_GPUTransferBufferCreateInfo){
-          .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-          .size = imageData->w * imageData->h * 4});
-
-  Uint8 *textureTransferPtr = SDL_MapGPUTransferBuffer(
+  // Set up texture data, with every mip level filled so the linear mipmap samplers have something to minify from
+  SDL_GPUCommandBuffer *uploadCmdBuf = SDL_AcquireGPUCommandBuffer(context.Device);
+  SDL_GPUTexture *Texture;
+  if (texturePath != NULL)
+  {
+    BakedTextureHeader header;
+    bool decoded;
+    Texture = LoadBakedTexture(context.Device, context.Uploads, texturePath, &header, &decoded);
+    if (Texture != NULL)
+    {
+      SDL_Log("Texture %s is %ux%u in %s with %u mip levels%s", texturePath, header.width, header.height,
+              TextureCodec_GetName(header.codec), header.levelCount, decoded ? ", decoded on the CPU" : "");
+    }
+  }
+  else
+  {
+    Texture = LoadImageTexture(context.Device, context.Uploads, uploadCmdBuf, imageFile, mipFilter, premultiply ? PIXEL_CONVERT_PREMULTIPLY_ALPHA : PIXEL_CONVERT_NONE);
+    if (Texture != NULL)
+    {
+      SDL_Log("Texture has %u mip levels, filled with the %s filter", mipFilter == MIP_FILTER_NONE ? 1 : Mipmap_GetLevelCount(ImageFile_GetInfo(imageFile)->width, ImageFile_GetInfo(imageFile)->height), MipFilter_GetName(mipFilter));
+    }
+  }
+  if (Texture == NULL)
+  {
+    SDL_Log("Failed to create the texture!");
+    return -1;
+  }
+  SDL_SetGPUTextureName(
       context.Device,
-      textureTransferBuffer,
-      false);
-  SDL_memcpy(textureTransferPtr, imageData->pixels, imageData->w * imageData->h * 4);
-  SDL_UnmapGPUTransferBuffer(context.Device, textureTransferBuffer);
+      Texture,
+      "Ravioli Texture 🖼️");
 
   // Upload the transfer data to the GPU resources
-  SDL_GPUCommandBuffer *uploadCmdBuf = SDL_AcquireGPUCommandBuffer(context.Device);
-  SDL_GPUCopyPass *copyPass = SDL_BeginGPUCopyPass(uploadCmdBuf);
-
-  SDL_UploadToGPUBuffer(
-      copyPass,
-      &(SDL_GPUTransferBufferLocation){
-          .transfer_buffer = bufferTransferBuffer,
-          .offset = 0},
-      &(SDL_GPUBufferRegion){
-          .buffer = VertexBuffer,
-          .offset = 0,
-          .size = sizeof(PositionTextureVertex) * 4},
-      false);
-
-  SDL_UploadToGPUBuffer(
-      copyPass,
-      &(SDL_GPUTransferBufferLocation){
-          .transfer_buffer = bufferTransferBuffer,
-          .offset = sizeof(PositionTextureVertex) * 4},
-      &(SDL_GPUBufferRegion){
-          .buffer = IndexBuffer,
-          .offset = 0,
-          .size = sizeof(Uint16) * 6},
-      false);
-
-  SDL_UploadToGPUTexture(
-      copyPass,
-      &(SDL_GPUTextureTransferInfo){
-          .transfer_buffer = textureTransferBuffer,
-          .offset = 0, /* Zeros out the rest */
-      },
-      &(SDL_GPUTextureRegion){
-          .texture = Texture,
-          .w = imageData->w,
-          .h = imageData->h,
-          .d = 1},
-      false);
-
-  SDL_EndGPUCopyPass(copyPass);
-  SDL_SubmitGPUCommandBuffer(uploadCmdBuf);
-  SDL_DestroySurface(imageData);
-  SDL_ReleaseGPUTransferBuffer(context.Device, bufferTransferBuffer);
-  SDL_ReleaseGPUTransferBuffer(context.Device, textureTransferBuffer);
+  UploadRing_Submit(context.Uploads, uploadCmdBuf);
+  ImageFile_Close(imageFile);
 
   // Finally, print instructions!
   SDL_Log("Press Left/Right to switch between sampler states");
@@ -338,10 +350,11 @@ int main()
   int quit = 0;
   int CurrentSamplerIndex = 0;
 
-  while (!quit)
+  while (!quit && !FrameTarget_IsDone(context.Target))
   {
     bool changeResolution = false;
 
+    TRACE_BEGIN("poll events");
     while (SDL_PollEvent(&event))
     {
       switch (event.type)
@@ -366,7 +379,10 @@ int main()
         }
       }
     }
+    TRACE_END();
+    TRACE_BEGIN("acquire command buffer");
     SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    TRACE_END();
     if (cmdbuf == NULL)
     {
       SDL_Log("AcquireGPUCommandBuffer failed: %s", SDL_GetError());
@@ -374,7 +390,7 @@ int main()
     }
 
     SDL_GPUTexture *swapchainTexture;
-    if (!SDL_WaitAndAcquireGPUSwapchainTexture(cmdbuf, context.Window, &swapchainTexture, NULL, NULL))
+    if (!FrameTarget_Acquire(context.Target, cmdbuf, &swapchainTexture))
     {
       SDL_Log("WaitAndAcquireGPUSwapchainTexture failed: %s", SDL_GetError());
       return -1;
@@ -388,6 +404,7 @@ int main()
       colorTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
       colorTargetInfo.store_op = SDL_GPU_STOREOP_STORE;
 
+      TRACE_BEGIN("render pass");
       SDL_GPURenderPass *renderPass = SDL_BeginGPURenderPass(cmdbuf, &colorTargetInfo, 1, NULL);
 
       SDL_BindGPUGraphicsPipeline(renderPass, context.Pipeline);
@@ -397,9 +414,10 @@ int main()
       SDL_DrawGPUIndexedPrimitives(renderPass, 6, 1, 0, 0, 0);
 
       SDL_EndGPURenderPass(renderPass);
+      TRACE_END();
     }
 
-    SDL_SubmitGPUCommandBuffer(cmdbuf);
+    FrameTarget_Submit(context.Target, cmdbuf);
   }
   for (int i = 0; i < SDL_arraysize(Samplers); i++)
   {
@@ -410,8 +428,9 @@ int main()
   SDL_ReleaseGPUBuffer(context.Device, VertexBuffer);
   SDL_ReleaseGPUBuffer(context.Device, IndexBuffer);
 
-  SDL_ReleaseGPUGraphicsPipeline(context.Device, context.Pipeline);
-
+  UploadRing_Destroy(context.Uploads);
+  PipelineRegistry_Destroy(context.Pipelines);
+  ReleaseShaderCache(context.Device);
+  FrameTarget_Destroy(context.Target);
   SDL_DestroyGPUDevice(context.Device);
-  SDL_DestroyWindow(context.Window);
 }
\ No newline at end of file
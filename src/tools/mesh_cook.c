@@ -0,0 +1,173 @@
+#include <SDL3/SDL.h>
+#include "vertex_format.h"
+#include "mesh_optimizer.h"
+#include "mesh_loader.h"
+
+// Cooks an OBJ or glTF mesh into a baked .mesh once, offline, so loading it at run time is a map and a single copy.
+// The indices are optimized for the vertex cache and overdraw, the vertices reordered for fetch and converted to the layout.
+//   mesh_cook input.obj|.gltf|.glb output.mesh [--positions float3|short4|half4] [--uvs float2|half2|ushort2] [--no-optimize]
+
+static void Usage(const char *program)
+{
+  SDL_Log("Usage: %s input.obj|.gltf|.glb output.mesh [--positions float3|short4|half4] [--uvs float2|half2|ushort2] [--no-optimize]", program);
+}
+
+int main(int argc, char *argv[])
+{
+  const char *inputPath = NULL;
+  const char *outputPath = NULL;
+  const char *positionsName = "float3";
+  const char *uvsName = "float2";
+  bool optimize = true;
+  for (int i = 1; i < argc; i += 1)
+  {
+    if (SDL_strcmp(argv[i], "--positions") == 0 && i + 1 < argc)
+    {
+      positionsName = argv[++i];
+    }
+    else if (SDL_strcmp(argv[i], "--uvs") == 0 && i + 1 < argc)
+    {
+      uvsName = argv[++i];
+    }
+    else if (SDL_strcmp(argv[i], "--no-optimize") == 0)
+    {
+      optimize = false;
+    }
+    else if (argv[i][0] != '-' && inputPath == NULL)
+    {
+      inputPath = argv[i];
+    }
+    else if (argv[i][0] != '-' && outputPath == NULL)
+    {
+      outputPath = argv[i];
+    }
+    else
+    {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  VertexPositionFormat positionFormat;
+  VertexUVFormat uvFormat;
+  if (inputPath == NULL || outputPath == NULL ||
+      !VertexFormat_FindPositionFormat(positionsName, &positionFormat) || !VertexFormat_FindUVFormat(uvsName, &uvFormat))
+  {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  MeshFile *file = MeshFile_Open(inputPath);
+  if (file == NULL)
+  {
+    return 1;
+  }
+  const MeshFileInfo *info = MeshFile_GetInfo(file);
+  if (info->baked)
+  {
+    SDL_Log("%s is already baked", inputPath);
+    MeshFile_Close(file);
+    return 1;
+  }
+
+  // Full precision vertices and 32 bit indices to optimize, converted at the end
+  Uint32 vertexCount = info->vertexCount;
+  Uint32 indexCount = info->indexCount;
+  PositionTextureVertex *vertices = SDL_malloc(sizeof(PositionTextureVertex) * vertexCount);
+  Uint32 *indices = SDL_malloc(sizeof(Uint32) * indexCount);
+  if (vertices == NULL || indices == NULL)
+  {
+    SDL_Log("Out of memory");
+    return 1;
+  }
+  VertexLayout floatLayout = VertexFormat_GetPositionTextureLayout(VERTEX_POSITION_FLOAT3, VERTEX_UV_FLOAT2);
+  VertexDequantization identity = VertexFormat_GetDequantization(info->min, info->max, VERTEX_POSITION_FLOAT3);
+  MeshFile_WriteVertices(file, &floatLayout, &identity, vertices);
+  MeshFile_WriteIndices(file, SDL_GPU_INDEXELEMENTSIZE_32BIT, indices);
+  MeshFile_Close(file);
+
+  Uint32 flags = 0;
+  if (optimize)
+  {
+    Uint64 optimizeStart = SDL_GetTicksNS();
+    MeshOptimizerMesh mesh = {
+        .indices = indices,
+        .indexCount = indexCount,
+        .vertices = vertices,
+        .vertexCount = vertexCount,
+        .vertexSize = sizeof(PositionTextureVertex),
+        .positionOffset = 0};
+    MeshOptimizer_Optimize(&mesh);
+    if (!mesh.optimized)
+    {
+      SDL_Log("Failed to optimize %s", inputPath);
+      return 1;
+    }
+    vertexCount = mesh.vertexCount;
+    flags |= BAKED_MESH_OPTIMIZED;
+    SDL_Log("Optimized in %.1f ms: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+            (SDL_GetTicksNS() - optimizeStart) / 1e6, mesh.before.acmr, mesh.after.acmr, mesh.before.atvr, mesh.after.atvr);
+  }
+
+  // Bounds of the vertices that are left, the sphere around the box's center
+  BakedMeshBounds bounds = {{vertices[0].x, vertices[0].y, vertices[0].z}, {vertices[0].x, vertices[0].y, vertices[0].z}};
+  for (Uint32 i = 1; i < vertexCount; i += 1)
+  {
+    const float *position = &vertices[i].x;
+    for (int axis = 0; axis < 3; axis += 1)
+    {
+      bounds.min[axis] = SDL_min(bounds.min[axis], position[axis]);
+      bounds.max[axis] = SDL_max(bounds.max[axis], position[axis]);
+    }
+  }
+  float radiusSquared = 0.0f;
+  for (int axis = 0; axis < 3; axis += 1)
+  {
+    bounds.center[axis] = (bounds.min[axis] + bounds.max[axis]) * 0.5f;
+  }
+  for (Uint32 i = 0; i < vertexCount; i += 1)
+  {
+    float dx = vertices[i].x - bounds.center[0];
+    float dy = vertices[i].y - bounds.center[1];
+    float dz = vertices[i].z - bounds.center[2];
+    radiusSquared = SDL_max(radiusSquared, dx * dx + dy * dy + dz * dz);
+  }
+  bounds.radius = SDL_sqrtf(radiusSquared);
+
+  VertexLayout layout = VertexFormat_GetPositionTextureLayout(positionFormat, uvFormat);
+  BakedMeshHeader header = {
+      .positionFormat = positionFormat,
+      .uvFormat = uvFormat,
+      .stride = layout.stride,
+      .vertexCount = vertexCount,
+      .indexCount = indexCount,
+      .indexSize = vertexCount <= SDL_MAX_UINT16 ? sizeof(Uint16) : sizeof(Uint32),
+      .flags = flags,
+      .dequantization = VertexFormat_GetDequantization(bounds.min, bounds.max, positionFormat)};
+  void *converted = SDL_malloc((size_t)layout.stride * vertexCount);
+  if (converted == NULL)
+  {
+    SDL_Log("Out of memory");
+    return 1;
+  }
+  VertexFormat_ConvertPositionTexture(vertices, vertexCount, &layout, &header.dequantization, converted);
+  // Narrowed in place, each 16 bit index is written behind the 32 bit one it came from
+  if (header.indexSize == sizeof(Uint16))
+  {
+    Uint16 *narrow = (Uint16 *)indices;
+    for (Uint32 i = 0; i < indexCount; i += 1)
+    {
+      narrow[i] = (Uint16)indices[i];
+    }
+  }
+  bool saved = SaveBakedMesh(outputPath, &header, converted, indices, &bounds);
+  if (saved)
+  {
+    SDL_Log("%s: %u vertices in %s + %s, %u bytes each, %u %u bit indices",
+            outputPath, vertexCount, positionsName, uvsName, layout.stride, indexCount, header.indexSize * 8);
+  }
+
+  SDL_free(converted);
+  SDL_free(vertices);
+  SDL_free(indices);
+  return saved ? 0 : 1;
+}
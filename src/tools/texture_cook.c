@@ -0,0 +1,146 @@
+#include <SDL3/SDL.h>
+#include "texture_codec.h"
+#include "texture_loader.h"
+
+// Cooks a BMP into a baked .tex once, offline: the mip chain is built on the CPU and every level block compressed,
+// so loading it at run time is a read into transfer memory and sampling it reads a quarter to an eighth of the bytes.
+//   texture_cook input.bmp output.tex [--codec bc1|bc3|bc7|rgba8] [--mips none|box|kaiser]
+
+static void Usage(const char *program)
+{
+  SDL_Log("Usage: %s input.bmp output.tex [--codec bc1|bc3|bc7|rgba8] [--mips none|box|kaiser]", program);
+}
+
+// Peak signal to noise ratio of level 0 after a round trip through the codec, in dB over the four channels, 0 if it's exact
+static double GetPSNR(const Uint8 *original, const Uint8 *decoded, Uint32 width, Uint32 height)
+{
+  double error = 0.0;
+  size_t count = (size_t)width * height * 4;
+  for (size_t i = 0; i < count; i += 1)
+  {
+    double difference = (double)original[i] - decoded[i];
+    error += difference * difference;
+  }
+  if (error == 0.0)
+  {
+    return 0.0;
+  }
+  return 10.0 * SDL_log10(255.0 * 255.0 * count / error);
+}
+
+int main(int argc, char *argv[])
+{
+  const char *inputPath = NULL;
+  const char *outputPath = NULL;
+  const char *codecName = "bc7";
+  const char *mipFilterName = "box";
+  for (int i = 1; i < argc; i += 1)
+  {
+    if (SDL_strcmp(argv[i], "--codec") == 0 && i + 1 < argc)
+    {
+      codecName = argv[++i];
+    }
+    else if (SDL_strcmp(argv[i], "--mips") == 0 && i + 1 < argc)
+    {
+      mipFilterName = argv[++i];
+    }
+    else if (argv[i][0] != '-' && inputPath == NULL)
+    {
+      inputPath = argv[i];
+    }
+    else if (argv[i][0] != '-' && outputPath == NULL)
+    {
+      outputPath = argv[i];
+    }
+    else
+    {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  TextureCodec codec;
+  MipFilter mipFilter;
+  // The GPU filter needs a device, the chain is built here
+  if (inputPath == NULL || outputPath == NULL || !TextureCodec_Parse(codecName, &codec) ||
+      !MipFilter_Parse(mipFilterName, &mipFilter) || mipFilter == MIP_FILTER_GPU)
+  {
+    Usage(argv[0]);
+    return 1;
+  }
+
+  SDL_Surface *loaded = SDL_LoadBMP(inputPath);
+  if (loaded == NULL)
+  {
+    SDL_Log("Failed to load %s: %s", inputPath, SDL_GetError());
+    return 1;
+  }
+  SDL_Surface *surface = SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_ABGR8888);
+  SDL_DestroySurface(loaded);
+  if (surface == NULL)
+  {
+    SDL_Log("Failed to convert %s: %s", inputPath, SDL_GetError());
+    return 1;
+  }
+  Uint32 width = surface->w;
+  Uint32 height = surface->h;
+  Uint32 levelCount = mipFilter == MIP_FILTER_NONE ? 1 : Mipmap_GetLevelCount(width, height);
+  if (width % 4 != 0 || height % 4 != 0)
+  {
+    SDL_Log("%ux%u isn't a multiple of 4, the BC formats can only be sampled after decoding it on the CPU", width, height);
+  }
+
+  Uint32 chainSize = Mipmap_GetChainSize(width, height, levelCount);
+  Uint32 encodedSize = TextureCodec_GetChainSize(codec, width, height, levelCount);
+  Uint8 *chain = SDL_malloc(chainSize);
+  Uint8 *encoded = SDL_malloc(encodedSize);
+  Uint8 *decoded = SDL_malloc((size_t)width * height * 4);
+  if (chain == NULL || encoded == NULL || decoded == NULL)
+  {
+    SDL_Log("Out of memory");
+    return 1;
+  }
+  for (Uint32 y = 0; y < height; y += 1)
+  {
+    SDL_memcpy(chain + (size_t)y * width * 4, (Uint8 *)surface->pixels + (size_t)y * surface->pitch, (size_t)width * 4);
+  }
+  SDL_DestroySurface(surface);
+
+  Uint64 encodeNS = 0;
+  Uint8 *level = chain;
+  Uint8 *out = encoded;
+  for (Uint32 i = 0; i < levelCount; i += 1)
+  {
+    Uint32 levelWidth = SDL_max(width >> i, 1);
+    Uint32 levelHeight = SDL_max(height >> i, 1);
+    Uint8 *next = level + (size_t)levelWidth * levelHeight * 4;
+    if (i + 1 < levelCount && !Mipmap_Downsample(level, levelWidth, levelHeight, next, mipFilter))
+    {
+      SDL_Log("Out of memory");
+      return 1;
+    }
+    Uint64 startNS = SDL_GetTicksNS();
+    TextureCodec_Encode(codec, level, levelWidth, levelHeight, out);
+    encodeNS += SDL_GetTicksNS() - startNS;
+    out += TextureCodec_GetLevelSize(codec, levelWidth, levelHeight);
+    level = next;
+  }
+  TextureCodec_Decode(codec, encoded, width, height, decoded, width * 4);
+  double psnr = GetPSNR(chain, decoded, width, height);
+
+  bool saved = SaveBakedTexture(outputPath, codec, width, height, levelCount, encoded);
+  if (saved)
+  {
+    SDL_Log("%s: %ux%u in %s, %u levels (%s), %.1f KB instead of %.1f KB (%.1fx), encoded in %.1f ms",
+            outputPath, width, height, TextureCodec_GetName(codec), levelCount, MipFilter_GetName(mipFilter), encodedSize / 1024.0,
+            chainSize / 1024.0, (double)chainSize / encodedSize, encodeNS / 1e6);
+    if (psnr > 0.0)
+    {
+      SDL_Log("Level 0 PSNR %.2f dB", psnr);
+    }
+  }
+
+  SDL_free(chain);
+  SDL_free(encoded);
+  SDL_free(decoded);
+  return saved ? 0 : 1;
+}
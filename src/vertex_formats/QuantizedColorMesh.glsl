@@ -0,0 +1,32 @@
+#version 450
+
+#ifdef VERTEX
+layout(set = 1, binding = 0) uniform UBO {
+    mat4 ViewProjection;
+    // The mesh's VertexDequantization, identity for float3 positions
+    vec4 PositionScale;
+    vec4 PositionOffset;
+};
+
+// float3, or short4 / half4 already unpacked to [-1, 1] by the vertex fetch
+layout(location = 0) in vec4 inPosition;
+// ubyte4, unpacked to [0, 1] by the vertex fetch
+layout(location = 1) in vec4 inColor;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    vec3 position = inPosition.xyz * PositionScale.xyz + PositionOffset.xyz;
+    outColor = inColor;
+    gl_Position = ViewProjection * vec4(position, 1.0);
+}
+#endif
+
+#ifdef FRAGMENT
+layout(location = 0) in vec4 inColor;
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    outColor = inColor;
+}
+#endif
@@ -0,0 +1,35 @@
+#version 450
+
+#ifdef VERTEX
+layout(set = 1, binding = 0) uniform UBO {
+    mat4 ViewProjection;
+    // The mesh's VertexDequantization, identity for float3 positions
+    vec4 PositionScale;
+    vec4 PositionOffset;
+};
+
+// float3, or short4 / half4 already unpacked to [-1, 1] by the vertex fetch
+layout(location = 0) in vec4 inPosition;
+// float2, half2 or ushort2, unpacked by the vertex fetch
+layout(location = 1) in vec2 inTexCoord;
+
+layout(location = 0) out vec2 outTexCoord;
+
+void main() {
+    vec3 position = inPosition.xyz * PositionScale.xyz + PositionOffset.xyz;
+    outTexCoord = inTexCoord;
+    gl_Position = ViewProjection * vec4(position, 1.0);
+}
+#endif
+
+#ifdef FRAGMENT
+layout(location = 0) in vec2 inTexCoord;
+layout(location = 0) out vec4 outColor;
+
+// A checkerboard from the UVs, so UV precision shows without a texture
+void main() {
+    vec2 cell = floor(inTexCoord * 64.0);
+    float checker = mod(cell.x + cell.y, 2.0);
+    outColor = vec4(mix(vec3(0.2, 0.3, 0.4), vec3(0.9, 0.8, 0.6), checker), 1.0);
+}
+#endif
@@ -0,0 +1,30 @@
+cbuffer UBO : register(b0, space1)
+{
+    float4x4 ViewProjection : packoffset(c0);
+    // The mesh's VertexDequantization, identity for float3 positions
+    float4 PositionScale : packoffset(c4);
+    float4 PositionOffset : packoffset(c5);
+};
+
+struct Input
+{
+    // float3, or short4 / half4 already unpacked to [-1, 1] by the vertex fetch
+    float4 Position : TEXCOORD0;
+    // ubyte4, unpacked to [0, 1] by the vertex fetch
+    float4 Color : TEXCOORD1;
+};
+
+struct Output
+{
+    float4 Color : TEXCOORD0;
+    float4 Position : SV_Position;
+};
+
+Output main(Input input)
+{
+    float3 position = input.Position.xyz * PositionScale.xyz + PositionOffset.xyz;
+    Output output;
+    output.Color = input.Color;
+    output.Position = mul(ViewProjection, float4(position, 1.0f));
+    return output;
+}
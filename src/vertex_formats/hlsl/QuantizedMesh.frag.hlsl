@@ -0,0 +1,7 @@
+// A checkerboard from the UVs, so UV precision shows without a texture
+float4 main(float2 TexCoord : TEXCOORD0) : SV_Target0
+{
+    float2 cell = floor(TexCoord * 64.0f);
+    float checker = fmod(cell.x + cell.y, 2.0f);
+    return float4(lerp(float3(0.2f, 0.3f, 0.4f), float3(0.9f, 0.8f, 0.6f), checker), 1.0f);
+}
@@ -0,0 +1,30 @@
+cbuffer UBO : register(b0, space1)
+{
+    float4x4 ViewProjection : packoffset(c0);
+    // The mesh's VertexDequantization, identity for float3 positions
+    float4 PositionScale : packoffset(c4);
+    float4 PositionOffset : packoffset(c5);
+};
+
+struct Input
+{
+    // float3, or short4 / half4 already unpacked to [-1, 1] by the vertex fetch
+    float4 Position : TEXCOORD0;
+    // float2, half2 or ushort2, unpacked by the vertex fetch
+    float2 TexCoord : TEXCOORD1;
+};
+
+struct Output
+{
+    float2 TexCoord : TEXCOORD0;
+    float4 Position : SV_Position;
+};
+
+Output main(Input input)
+{
+    float3 position = input.Position.xyz * PositionScale.xyz + PositionOffset.xyz;
+    Output output;
+    output.TexCoord = input.TexCoord;
+    output.Position = mul(ViewProjection, float4(position, 1.0f));
+    return output;
+}
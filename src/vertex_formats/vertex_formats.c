@@ -0,0 +1,640 @@
+#include <SDL3/SDL.h>
+#include "load.h"
+#include "pipeline_registry.h"
+#include "frame_target.h"
+#include "trace.h"
+#include "upload_ring.h"
+#include "linear_algebra.h"
+#include "vertex_format.h"
+#include "job_system.h"
+#include "mesh_optimizer.h"
+
+// A heightfield grid of about a million vertices, drawn small enough that its triangles cover about a pixel each,
+// so the frame time is mostly vertex fetch. The mesh is built as PositionTextureVertex (float3 + float2, 20 bytes)
+// and converted to the layout asked for, down to 12 bytes with quantized positions and UVs.
+//   --positions float3|short4|half4 and --uvs float2|half2|ushort2 pick the layout
+//   --colors draws PositionColorVertex instead (float3 + ubyte4, 16 bytes, down to 12) with QuantizedColorMesh, --uvs is ignored
+//   --compare draws every layout for COMPARE_FRAMES frames and logs frame time against vertex bytes
+//   --shuffle puts the triangles in random order, like a mesh from a tool that didn't care
+//   --optimize reorders the mesh with mesh_optimizer on worker threads while the GPU resources are created
+#define DEFAULT_GRID_SIZE 1000
+#define DEFAULT_DRAWS 8
+#define COMPARE_FRAMES 300
+// The grid covers [-GRID_EXTENT, GRID_EXTENT] on x and z
+#define GRID_EXTENT 50.0f
+#define GRID_HEIGHT 4.0f
+
+typedef struct Context
+{
+  SDL_GPUDevice *Device;
+  SDL_Window *Window;
+  FrameTarget *Target;
+  PipelineRegistry *Pipelines;
+  UploadRing *Uploads;
+} Context;
+
+// Matches the vertex UBO of QuantizedMesh and QuantizedColorMesh
+typedef struct MeshUniforms
+{
+  Matrix4x4 viewProjection;
+  VertexDequantization dequantization;
+} MeshUniforms;
+
+// The mesh in one layout
+typedef struct MeshLayout
+{
+  VertexLayout layout;
+  VertexDequantization dequantization;
+  SDL_GPUGraphicsPipeline *pipeline; // owned by the registry
+  SDL_GPUBuffer *vertexBuffer;
+  float maxPositionError; // in mesh units, against the float3 position
+  bool colors;            // a PositionColor layout, layout.uvFormat is unused
+} MeshLayout;
+
+Context context = {0};
+
+static PositionTextureVertex *BuildGridVertices(Uint32 gridSize, Uint32 *vertexCount)
+{
+  Uint32 side = gridSize + 1;
+  *vertexCount = side * side;
+  PositionTextureVertex *vertices = SDL_malloc(sizeof(PositionTextureVertex) * *vertexCount);
+  if (vertices == NULL)
+  {
+    return NULL;
+  }
+  for (Uint32 row = 0; row < side; row += 1)
+  {
+    for (Uint32 column = 0; column < side; column += 1)
+    {
+      float u = column / (float)gridSize;
+      float v = row / (float)gridSize;
+      float x = (u * 2.0f - 1.0f) * GRID_EXTENT;
+      float z = (v * 2.0f - 1.0f) * GRID_EXTENT;
+      float y = GRID_HEIGHT * (SDL_sinf(x * 0.3f) * SDL_cosf(z * 0.2f) + 0.25f * SDL_sinf(x * 1.7f + z * 1.3f));
+      vertices[row * side + column] = (PositionTextureVertex){x, y, z, u, v};
+    }
+  }
+  return vertices;
+}
+
+// The same grid colored by height, x and z, the color is what PositionColor layouts carry instead of the UVs
+static PositionColorVertex *BuildGridColors(const PositionTextureVertex *vertices, Uint32 vertexCount)
+{
+  PositionColorVertex *colored = SDL_malloc(sizeof(PositionColorVertex) * vertexCount);
+  if (colored == NULL)
+  {
+    return NULL;
+  }
+  for (Uint32 i = 0; i < vertexCount; i += 1)
+  {
+    const PositionTextureVertex *vertex = &vertices[i];
+    float height = SDL_clamp(vertex->y / (GRID_HEIGHT * 2.5f) + 0.5f, 0.0f, 1.0f);
+    colored[i] = (PositionColorVertex){
+        vertex->x, vertex->y, vertex->z,
+        (Uint8)(vertex->u * 255.0f), (Uint8)(height * 255.0f), (Uint8)(vertex->v * 255.0f), 255};
+  }
+  return colored;
+}
+
+static void WriteGridIndices(Uint32 gridSize, Uint32 *indices)
+{
+  Uint32 side = gridSize + 1;
+  for (Uint32 row = 0; row < gridSize; row += 1)
+  {
+    for (Uint32 column = 0; column < gridSize; column += 1)
+    {
+      Uint32 corner = row * side + column;
+      Uint32 *quad = indices + (row * gridSize + column) * 6;
+      quad[0] = corner;
+      quad[1] = corner + side;
+      quad[2] = corner + 1;
+      quad[3] = corner + 1;
+      quad[4] = corner + side;
+      quad[5] = corner + side + 1;
+    }
+  }
+}
+
+// Fisher-Yates over whole triangles, so the winding stays
+static void ShuffleTriangles(Uint32 *indices, Uint32 triangleCount)
+{
+  SDL_srand(1);
+  for (Uint32 i = triangleCount - 1; i > 0; i -= 1)
+  {
+    Uint32 other = (Uint32)SDL_rand((Sint32)i + 1);
+    for (Uint32 corner = 0; corner < 3; corner += 1)
+    {
+      Uint32 index = indices[i * 3 + corner];
+      indices[i * 3 + corner] = indices[other * 3 + corner];
+      indices[other * 3 + corner] = index;
+    }
+  }
+}
+
+static void ReleaseMeshLayout(MeshLayout *mesh)
+{
+  SDL_ReleaseGPUBuffer(context.Device, mesh->vertexBuffer);
+  mesh->vertexBuffer = NULL;
+}
+
+// Points createInfo's vertex input at a single buffer of layout, the description and attributes are filled in here
+static void SetVertexInput(
+    const VertexLayout *layout,
+    SDL_GPUVertexBufferDescription *bufferDescription,
+    SDL_GPUVertexAttribute attributes[2],
+    SDL_GPUGraphicsPipelineCreateInfo *createInfo)
+{
+  VertexFormat_GetAttributes(layout, attributes);
+  *bufferDescription = (SDL_GPUVertexBufferDescription){
+      .slot = 0,
+      .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+      .instance_step_rate = 0,
+      .pitch = layout->stride};
+  createInfo->vertex_input_state = (SDL_GPUVertexInputState){
+      .num_vertex_buffers = 1,
+      .vertex_buffer_descriptions = bufferDescription,
+      .num_vertex_attributes = 2,
+      .vertex_attributes = attributes};
+}
+
+// Converts the mesh straight into upload memory and gets the pipeline for its layout.
+// With colored vertices the mesh is drawn in a PositionColor layout, with their colors instead of the UVs.
+static bool CreateMeshLayout(
+    VertexPositionFormat positionFormat,
+    VertexUVFormat uvFormat,
+    const PositionTextureVertex *vertices,
+    const PositionColorVertex *coloredVertices,
+    Uint32 vertexCount,
+    SDL_GPUGraphicsPipelineCreateInfo *pipelineCreateInfo,
+    MeshLayout *mesh)
+{
+  mesh->colors = coloredVertices != NULL;
+  mesh->layout = mesh->colors ? VertexFormat_GetPositionColorLayout(positionFormat) : VertexFormat_GetPositionTextureLayout(positionFormat, uvFormat);
+  mesh->dequantization = VertexFormat_ComputeDequantization(&vertices[0].x, sizeof(PositionTextureVertex), vertexCount, positionFormat);
+
+  SDL_GPUVertexAttribute attributes[2];
+  SDL_GPUVertexBufferDescription bufferDescription;
+  SetVertexInput(&mesh->layout, &bufferDescription, attributes, pipelineCreateInfo);
+  mesh->pipeline = PipelineRegistry_Get(context.Pipelines, pipelineCreateInfo);
+  if (mesh->pipeline == NULL)
+  {
+    SDL_Log("Failed to create the pipeline for %s positions and %s!",
+            VertexFormat_GetPositionFormatName(positionFormat), mesh->colors ? "colors" : VertexFormat_GetUVFormatName(uvFormat));
+    return false;
+  }
+
+  Uint32 size = mesh->layout.stride * vertexCount;
+  mesh->vertexBuffer = SDL_CreateGPUBuffer(
+      context.Device,
+      &(SDL_GPUBufferCreateInfo){.usage = SDL_GPU_BUFFERUSAGE_VERTEX, .size = size});
+  if (mesh->vertexBuffer == NULL)
+  {
+    SDL_Log("Failed to create the vertex buffer: %s", SDL_GetError());
+    return false;
+  }
+  if (!UploadRing_BeginFrame(context.Uploads))
+  {
+    ReleaseMeshLayout(mesh);
+    return false;
+  }
+  void *transferData = UploadRing_AllocateBufferUpload(context.Uploads, size, mesh->vertexBuffer, 0);
+  if (transferData == NULL)
+  {
+    SDL_Log("Failed to allocate the vertex upload!");
+    ReleaseMeshLayout(mesh);
+    return false;
+  }
+  TRACE_BEGIN("convert vertices");
+  if (mesh->colors)
+  {
+    VertexFormat_ConvertPositionColor(coloredVertices, vertexCount, &mesh->layout, &mesh->dequantization, transferData);
+  }
+  else
+  {
+    VertexFormat_ConvertPositionTexture(vertices, vertexCount, &mesh->layout, &mesh->dequantization, transferData);
+  }
+  TRACE_END();
+  SDL_GPUCommandBuffer *uploadCmdBuf = SDL_AcquireGPUCommandBuffer(context.Device);
+  if (uploadCmdBuf == NULL || !UploadRing_Submit(context.Uploads, uploadCmdBuf))
+  {
+    SDL_Log("Failed to upload the vertices: %s", SDL_GetError());
+    ReleaseMeshLayout(mesh);
+    return false;
+  }
+
+  // Converted again one vertex at a time, reading the transfer buffer back could be slow write-combined memory
+  mesh->maxPositionError = 0.0f;
+  for (Uint32 i = 0; i < vertexCount; i += 1)
+  {
+    Uint8 converted[sizeof(PositionTextureVertex)];
+    float position[3];
+    if (mesh->colors)
+    {
+      VertexFormat_ConvertPositionColor(&coloredVertices[i], 1, &mesh->layout, &mesh->dequantization, converted);
+    }
+    else
+    {
+      VertexFormat_ConvertPositionTexture(&vertices[i], 1, &mesh->layout, &mesh->dequantization, converted);
+    }
+    VertexFormat_DecodePosition(converted, &mesh->layout, &mesh->dequantization, position);
+    mesh->maxPositionError = SDL_max(mesh->maxPositionError, SDL_fabsf(position[0] - vertices[i].x));
+    mesh->maxPositionError = SDL_max(mesh->maxPositionError, SDL_fabsf(position[1] - vertices[i].y));
+    mesh->maxPositionError = SDL_max(mesh->maxPositionError, SDL_fabsf(position[2] - vertices[i].z));
+  }
+  return true;
+}
+
+static void LogLayoutResult(const MeshLayout *mesh, Uint32 vertexCount, Uint32 draws, Uint64 frames, Uint64 elapsedNS)
+{
+  double msPerFrame = elapsedNS / 1e6 / frames;
+  double vertexBytes = (double)mesh->layout.stride * vertexCount * draws;
+  SDL_Log("%-6s + %-7s %2u bytes/vertex, max position error %.5f, %7.3f ms per frame, %5.1f MB of vertices per frame, %6.1f GB/s",
+          VertexFormat_GetPositionFormatName(mesh->layout.positionFormat), mesh->colors ? "color" : VertexFormat_GetUVFormatName(mesh->layout.uvFormat),
+          mesh->layout.stride, mesh->maxPositionError, msPerFrame, vertexBytes / 1e6, vertexBytes / (msPerFrame / 1e3) / 1e9);
+}
+
+int main(int argc, char *argv[])
+{
+  FrameTargetOptions options;
+  Uint32 gridSize = DEFAULT_GRID_SIZE;
+  Uint32 draws = DEFAULT_DRAWS;
+  const char *positionsName = "float3";
+  const char *uvsName = "float2";
+  bool compare = false;
+  bool shuffle = false;
+  bool optimize = false;
+  bool colors = false;
+  FrameTargetArg extraArgs[] = {
+      {.name = "--grid", .valueName = "N", .value = &gridSize},
+      {.name = "--draws", .valueName = "N", .value = &draws},
+      {.name = "--positions", .valueName = "float3|short4|half4", .text = &positionsName},
+      {.name = "--uvs", .valueName = "float2|half2|ushort2", .text = &uvsName},
+      {.name = "--colors", .flag = &colors},
+      {.name = "--compare", .flag = &compare},
+      {.name = "--shuffle", .flag = &shuffle},
+      {.name = "--optimize", .flag = &optimize}};
+  if (!FrameTarget_ParseArgsEx(argc, argv, "vertex_formats", &options, extraArgs, SDL_arraysize(extraArgs)))
+  {
+    return 1;
+  }
+  VertexPositionFormat positionFormat;
+  VertexUVFormat uvFormat;
+  if (!VertexFormat_FindPositionFormat(positionsName, &positionFormat) || !VertexFormat_FindUVFormat(uvsName, &uvFormat))
+  {
+    SDL_Log("Unknown layout '%s' + '%s', positions are float3, short4 or half4 and UVs float2, half2 or ushort2", positionsName, uvsName);
+    return 1;
+  }
+  // The index upload has to fit in one transfer buffer, 2048 is already 100 MB of indices
+  if (gridSize == 0 || gridSize > 2048 || draws == 0)
+  {
+    SDL_Log("--grid takes 1 to 2048 cells per side and --draws at least 1");
+    return 1;
+  }
+  if (compare)
+  {
+    positionFormat = VERTEX_POSITION_FLOAT3;
+    uvFormat = VERTEX_UV_FLOAT2;
+  }
+
+  if (SDL_Init(FrameTarget_GetInitFlags(&options)) == false)
+  {
+    SDL_Log("Failed to initialize SDL: %s", SDL_GetError());
+    return 1;
+  }
+
+  context.Device = SDL_CreateGPUDevice(
+      SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_MSL,
+      false,
+      options.driver);
+  if (context.Device == NULL)
+  {
+    SDL_Log("GPUCreateDevice failed");
+    return -1;
+  }
+
+  context.Target = FrameTarget_Create(context.Device, "Vertex Formats", 640, 480, 0, &options);
+  if (context.Target == NULL)
+  {
+    return -1;
+  }
+  context.Window = FrameTarget_GetWindow(context.Target);
+
+  context.Pipelines = PipelineRegistry_Create(context.Device);
+  if (context.Pipelines == NULL)
+  {
+    SDL_Log("Failed to create pipeline registry!");
+    return -1;
+  }
+
+  Uint32 vertexCount;
+  PositionTextureVertex *vertices = BuildGridVertices(gridSize, &vertexCount);
+  Uint32 indexCount = gridSize * gridSize * 6;
+  Uint32 *indices = SDL_malloc(sizeof(Uint32) * indexCount);
+  if (vertices == NULL || indices == NULL)
+  {
+    SDL_Log("Failed to allocate %u vertices", vertexCount);
+    return -1;
+  }
+  SDL_Log("%u vertices, %u triangles, drawn %u times per frame", vertexCount, indexCount / 3, draws);
+  WriteGridIndices(gridSize, indices);
+  if (shuffle)
+  {
+    ShuffleTriangles(indices, indexCount / 3);
+  }
+
+  // The optimizer has the mesh until it is waited for, right before the upload
+  JobSystem *jobs = NULL;
+  JobCounter optimizing = {0};
+  MeshOptimizerMesh optimizerMesh = {
+      .indices = indices,
+      .indexCount = indexCount,
+      .vertices = vertices,
+      .vertexCount = vertexCount,
+      .vertexSize = sizeof(PositionTextureVertex),
+      .positionOffset = 0};
+  if (optimize)
+  {
+    jobs = JobSystem_Create((Uint32)SDL_max(SDL_GetNumLogicalCPUCores() - 1, 1));
+    if (jobs == NULL)
+    {
+      SDL_Log("Failed to create the job system!");
+      return -1;
+    }
+    MeshOptimizer_OptimizeMeshes(jobs, &optimizerMesh, 1, &optimizing);
+  }
+
+  // One upload at a time: the indices, then the vertices of each layout
+  Uint32 uploadSize = SDL_max(sizeof(PositionTextureVertex) * vertexCount, sizeof(Uint32) * indexCount);
+  context.Uploads = UploadRing_Create(context.Device, uploadSize, 1);
+  if (context.Uploads == NULL)
+  {
+    SDL_Log("Failed to create upload ring!");
+    return -1;
+  }
+
+  SDL_GPUShader *vertexShader = LoadShader(context.Device, colors ? "QuantizedColorMesh.vert" : "QuantizedMesh.vert", 0, 1, 0, 0);
+  if (vertexShader == NULL)
+  {
+    SDL_Log("Failed to create vertex shader!");
+    return -1;
+  }
+  SDL_GPUShader *fragmentShader = LoadShader(context.Device, colors ? "QuantizedColorMesh.frag" : "QuantizedMesh.frag", 0, 0, 0, 0);
+  if (fragmentShader == NULL)
+  {
+    SDL_Log("Failed to create fragment shader!");
+    return -1;
+  }
+
+  // The vertex input state is filled in per layout
+  SDL_GPUGraphicsPipelineCreateInfo pipelineCreateInfo = {
+      .target_info = {
+          .num_color_targets = 1,
+          .color_target_descriptions = (SDL_GPUColorTargetDescription[]){{.format = FrameTarget_GetFormat(context.Target)}},
+          .has_depth_stencil_target = true,
+          .depth_stencil_format = SDL_GPU_TEXTUREFORMAT_D16_UNORM},
+      .depth_stencil_state = (SDL_GPUDepthStencilState){
+          .enable_depth_test = true,
+          .enable_depth_write = true,
+          .compare_op = SDL_GPU_COMPAREOP_LESS},
+      .rasterizer_state = (SDL_GPURasterizerState){
+          .cull_mode = SDL_GPU_CULLMODE_NONE,
+          .fill_mode = SDL_GPU_FILLMODE_FILL,
+          .front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE},
+      .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+      .vertex_shader = vertexShader,
+      .fragment_shader = fragmentShader};
+
+  // Color layouts only vary the position
+  Uint32 compareSteps = colors ? VERTEX_POSITION_FORMAT_COUNT : VERTEX_POSITION_FORMAT_COUNT * VERTEX_UV_FORMAT_COUNT;
+  Uint32 uvFormatCount = colors ? 1 : VERTEX_UV_FORMAT_COUNT;
+  if (compare)
+  {
+    // Every layout's pipeline is built on worker threads while the mesh is optimized and the first layout draws,
+    // so switching layouts doesn't hitch or count a pipeline build against the next layout's frames
+    SDL_GPUGraphicsPipelineCreateInfo compareCreateInfos[VERTEX_POSITION_FORMAT_COUNT * VERTEX_UV_FORMAT_COUNT];
+    SDL_GPUVertexBufferDescription compareBuffers[VERTEX_POSITION_FORMAT_COUNT * VERTEX_UV_FORMAT_COUNT];
+    SDL_GPUVertexAttribute compareAttributes[VERTEX_POSITION_FORMAT_COUNT * VERTEX_UV_FORMAT_COUNT][2];
+    for (Uint32 step = 0; step < compareSteps; step += 1)
+    {
+      VertexPositionFormat stepPositionFormat = (VertexPositionFormat)(step / uvFormatCount);
+      VertexLayout layout = colors ? VertexFormat_GetPositionColorLayout(stepPositionFormat)
+                                   : VertexFormat_GetPositionTextureLayout(stepPositionFormat, (VertexUVFormat)(step % uvFormatCount));
+      compareCreateInfos[step] = pipelineCreateInfo;
+      SetVertexInput(&layout, &compareBuffers[step], compareAttributes[step], &compareCreateInfos[step]);
+    }
+    if (!PipelineRegistry_Prewarm(context.Pipelines, compareCreateInfos, compareSteps, 2))
+    {
+      SDL_Log("Failed to start building the pipelines!");
+      return -1;
+    }
+  }
+
+  int width, height;
+  FrameTarget_GetSize(context.Target, &width, &height);
+  SDL_GPUTexture *DepthTexture = SDL_CreateGPUTexture(
+      context.Device,
+      &(SDL_GPUTextureCreateInfo){
+          .type = SDL_GPU_TEXTURETYPE_2D,
+          .width = width,
+          .height = height,
+          .layer_count_or_depth = 1,
+          .num_levels = 1,
+          .sample_count = SDL_GPU_SAMPLECOUNT_1,
+          .format = SDL_GPU_TEXTUREFORMAT_D16_UNORM,
+          .usage = SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET});
+  SDL_GPUBuffer *IndexBuffer = SDL_CreateGPUBuffer(
+      context.Device,
+      &(SDL_GPUBufferCreateInfo){
+          .usage = SDL_GPU_BUFFERUSAGE_INDEX,
+          .size = sizeof(Uint32) * indexCount});
+  if (DepthTexture == NULL || IndexBuffer == NULL)
+  {
+    SDL_Log("Failed to create the GPU resources: %s", SDL_GetError());
+    return -1;
+  }
+
+  if (optimize)
+  {
+    TRACE_BEGIN("wait for mesh optimizer");
+    JobSystem_Wait(jobs, &optimizing);
+    TRACE_END();
+    JobSystem_Destroy(jobs);
+    if (!optimizerMesh.optimized)
+    {
+      SDL_Log("Failed to optimize the mesh, drawing it as is");
+    }
+    vertexCount = optimizerMesh.vertexCount;
+    SDL_Log("Vertex cache: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f",
+            optimizerMesh.before.acmr, optimizerMesh.after.acmr, optimizerMesh.before.atvr, optimizerMesh.after.atvr);
+  }
+  else
+  {
+    MeshCacheStats stats = MeshOptimizer_AnalyzeVertexCache(indices, indexCount, vertexCount, MESH_OPTIMIZER_CACHE_SIZE);
+    SDL_Log("Vertex cache: ACMR %.3f, ATVR %.3f", stats.acmr, stats.atvr);
+  }
+
+  UploadRing_BeginFrame(context.Uploads);
+  Uint32 *indexData = UploadRing_AllocateBufferUpload(context.Uploads, sizeof(Uint32) * indexCount, IndexBuffer, 0);
+  if (indexData == NULL)
+  {
+    SDL_Log("Failed to allocate the index upload!");
+    return -1;
+  }
+  SDL_memcpy(indexData, indices, sizeof(Uint32) * indexCount);
+  SDL_free(indices);
+  UploadRing_Submit(context.Uploads, SDL_AcquireGPUCommandBuffer(context.Device));
+
+  // After the optimizer, which reorders the vertices
+  PositionColorVertex *coloredVertices = NULL;
+  if (colors)
+  {
+    coloredVertices = BuildGridColors(vertices, vertexCount);
+    if (coloredVertices == NULL)
+    {
+      SDL_Log("Failed to allocate %u colored vertices", vertexCount);
+      return -1;
+    }
+  }
+
+  MeshLayout mesh = {0};
+  if (!CreateMeshLayout(positionFormat, uvFormat, vertices, coloredVertices, vertexCount, &pipelineCreateInfo, &mesh))
+  {
+    return -1;
+  }
+
+  SDL_Event event;
+  int quit = 0;
+  float rotationAngle = 0.0f;
+  float rotationSpeed = 0.2f;
+  Uint64 lastTime = SDL_GetTicksNS();
+  Uint32 compareStep = 0;
+  Uint64 layoutFrames = 0;
+  Uint64 layoutStartNS = SDL_GetTicksNS();
+
+  while (!quit && !FrameTarget_IsDone(context.Target))
+  {
+    if (compare && layoutFrames == COMPARE_FRAMES)
+    {
+      // Wait for the GPU so the frames' time is all in
+      SDL_WaitForGPUIdle(context.Device);
+      LogLayoutResult(&mesh, vertexCount, draws, layoutFrames, SDL_GetTicksNS() - layoutStartNS);
+      compareStep += 1;
+      if (compareStep == compareSteps)
+      {
+        break;
+      }
+      ReleaseMeshLayout(&mesh);
+      if (!CreateMeshLayout(
+              (VertexPositionFormat)(compareStep / uvFormatCount),
+              (VertexUVFormat)(compareStep % uvFormatCount),
+              vertices,
+              coloredVertices,
+              vertexCount,
+              &pipelineCreateInfo,
+              &mesh))
+      {
+        return -1;
+      }
+      SDL_WaitForGPUIdle(context.Device);
+      layoutFrames = 0;
+      layoutStartNS = SDL_GetTicksNS();
+    }
+
+    Uint64 currentTime = SDL_GetTicksNS();
+    float deltaTime = (currentTime - lastTime) / 1e9f;
+    lastTime = currentTime;
+
+    TRACE_BEGIN("poll events");
+    while (SDL_PollEvent(&event))
+    {
+      switch (event.type)
+      {
+      case SDL_EVENT_QUIT:
+        quit = true;
+        break;
+      }
+    }
+    TRACE_END();
+
+    TRACE_BEGIN("acquire command buffer");
+    SDL_GPUCommandBuffer *cmdbuf = SDL_AcquireGPUCommandBuffer(context.Device);
+    TRACE_END();
+    if (cmdbuf == NULL)
+    {
+      SDL_Log("AcquireGPUCommandBuffer failed: %s", SDL_GetError());
+      return -1;
+    }
+
+    SDL_GPUTexture *swapchainTexture;
+    if (!FrameTarget_Acquire(context.Target, cmdbuf, &swapchainTexture))
+    {
+      SDL_Log("WaitAndAcquireGPUSwapchainTexture failed: %s", SDL_GetError());
+      return -1;
+    }
+    if (swapchainTexture == NULL)
+    {
+      FrameTarget_Submit(context.Target, cmdbuf);
+      continue;
+    }
+
+    // Far enough away that the whole grid fits in a few hundred pixels
+    rotationAngle += rotationSpeed * deltaTime;
+    Vector3 cameraPosition = {SDL_cosf(rotationAngle) * GRID_EXTENT * 3.0f, GRID_EXTENT * 2.0f, SDL_sinf(rotationAngle) * GRID_EXTENT * 3.0f};
+    Matrix4x4 proj = Matrix4x4_CreatePerspectiveFieldOfView(60.0f * SDL_PI_F / 180.0f, width / (float)height, 1.0f, GRID_EXTENT * 10.0f);
+    Matrix4x4 view = Matrix4x4_CreateLookAt(cameraPosition, (Vector3){0, 0, 0}, (Vector3){0, 1, 0});
+    MeshUniforms uniforms = {Matrix4x4_Multiply(view, proj), mesh.dequantization};
+    SDL_PushGPUVertexUniformData(cmdbuf, 0, &uniforms, sizeof(uniforms));
+
+    SDL_GPUColorTargetInfo colorTargetInfo = {0};
+    colorTargetInfo.texture = swapchainTexture;
+    colorTargetInfo.clear_color = (SDL_FColor){0.0f, 0.0f, 0.0f, 1.0f};
+    colorTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
+    colorTargetInfo.store_op = SDL_GPU_STOREOP_STORE;
+
+    SDL_GPUDepthStencilTargetInfo depthStencilTargetInfo = {0};
+    depthStencilTargetInfo.texture = DepthTexture;
+    depthStencilTargetInfo.cycle = true;
+    depthStencilTargetInfo.clear_depth = 1;
+    depthStencilTargetInfo.load_op = SDL_GPU_LOADOP_CLEAR;
+    depthStencilTargetInfo.store_op = SDL_GPU_STOREOP_DONT_CARE;
+    depthStencilTargetInfo.stencil_load_op = SDL_GPU_LOADOP_DONT_CARE;
+    depthStencilTargetInfo.stencil_store_op = SDL_GPU_STOREOP_DONT_CARE;
+
+    TRACE_BEGIN("render pass");
+    SDL_GPURenderPass *renderPass = SDL_BeginGPURenderPass(cmdbuf, &colorTargetInfo, 1, &depthStencilTargetInfo);
+    SDL_BindGPUGraphicsPipeline(renderPass, mesh.pipeline);
+    SDL_BindGPUVertexBuffers(renderPass, 0, &(SDL_GPUBufferBinding){.buffer = mesh.vertexBuffer, .offset = 0}, 1);
+    SDL_BindGPUIndexBuffer(renderPass, &(SDL_GPUBufferBinding){.buffer = IndexBuffer, .offset = 0}, SDL_GPU_INDEXELEMENTSIZE_32BIT);
+    // The same mesh on top of itself: every draw fetches every vertex again, the depth test throws most pixels away early
+    for (Uint32 i = 0; i < draws; i += 1)
+    {
+      SDL_DrawGPUIndexedPrimitives(renderPass, indexCount, 1, 0, 0, 0);
+    }
+    SDL_EndGPURenderPass(renderPass);
+    TRACE_END();
+    FrameTarget_Submit(context.Target, cmdbuf);
+    layoutFrames += 1;
+  }
+
+  if (!compare && layoutFrames > 0)
+  {
+    SDL_WaitForGPUIdle(context.Device);
+    LogLayoutResult(&mesh, vertexCount, draws, layoutFrames, SDL_GetTicksNS() - layoutStartNS);
+  }
+
+  // cleanup
+  ReleaseMeshLayout(&mesh);
+  SDL_ReleaseGPUBuffer(context.Device, IndexBuffer);
+  SDL_ReleaseGPUTexture(context.Device, DepthTexture);
+  SDL_free(vertices);
+  SDL_free(coloredVertices);
+
+  UploadRing_Destroy(context.Uploads);
+  PipelineRegistry_LogStats(context.Pipelines);
+  PipelineRegistry_Destroy(context.Pipelines);
+
+  ReleaseShaderCache(context.Device);
+  FrameTarget_Destroy(context.Target);
+  SDL_DestroyGPUDevice(context.Device);
+  return 0;
+}